@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Scalable barriers for the threaded clock servers.
+ **/
+
+#ifndef ASIM_BARRIER_H
+#define ASIM_BARRIER_H
+
+#include <vector>
+
+#include "asim/syntax.h"
+#include "asim/atomic.h"
+
+using namespace std;
+
+// Size used to pad shared synchronization words, so that no two threads
+// ever spin on the same cache line.
+#define ASIM_BARRIER_LINE_SIZE 64
+
+//
+// Adaptive spin budget, one per waiting thread.  A waiter spins for up
+// to Get() iterations before going to sleep in the kernel.  The budget
+// doubles (up to the limit) each time spinning was enough, and halves
+// each time the waiter had to sleep, so that threads that usually wait
+// a long time stop burning the cpu.
+//
+class ASIM_SPIN_BUDGET_CLASS
+{
+  private:
+    UINT32 spins;
+    UINT32 limit;
+
+  public:
+    ASIM_SPIN_BUDGET_CLASS(UINT32 lim = 1024)
+      : spins(lim ? lim : 1),
+        limit(lim ? lim : 1)
+    {}
+
+    UINT32 Get() const { return spins; }
+    void SpinWorked() { spins = (spins * 2 > limit) ? limit : spins * 2; }
+    void HadToSleep() { spins = (spins > 16) ? spins / 2 : 8; }
+};
+
+//
+// A 32 bit counter, alone on its cache line, that threads can wait on.
+// Waiters spin on it for a while, then sleep on a futex.  The writer only
+// makes a system call if somebody is actually asleep.  Values are compared
+// modulo 2^32, so counters may wrap.
+//
+class ASIM_WAIT_WORD_CLASS
+{
+  private:
+    volatile UINT32 value;
+    volatile UINT32 sleepers;
+    char pad[ASIM_BARRIER_LINE_SIZE - 2 * sizeof(UINT32)];
+
+    void Wake();
+
+  public:
+    ASIM_WAIT_WORD_CLASS(UINT32 v = 0) : value(v), sleepers(0) {}
+
+    UINT32 Get() const { return value; }
+
+    // publish a new value and wake up anybody waiting on it
+    void Set(UINT32 v);
+    void Increment();
+
+    // wait until the value reaches at least target, or *abort becomes true
+    void WaitUntil(UINT32 target,
+                   ASIM_SPIN_BUDGET_CLASS & budget,
+                   volatile bool * abort = NULL);
+
+    static bool Reached(UINT32 v, UINT32 target)
+    {
+        return INT32(v - target) >= 0;
+    }
+};
+
+//
+// Reusable barrier for a fixed set of participants numbered 0..N-1.
+// Each participant calls Wait() with its own number; Wait() returns once
+// all N participants have arrived.  Abort() releases everybody, now and
+// forever, and makes Wait() return false, which is how the clock servers
+// shut down worker threads blocked in the barrier.
+//
+typedef class ASIM_BARRIER_CLASS *ASIM_BARRIER;
+class ASIM_BARRIER_CLASS
+{
+  public:
+    enum BARRIER_TYPE
+    {
+        BARRIER_CENTRAL       = 1,  // single shared counter and release word
+        BARRIER_TREE          = 2,  // combining tree, fan-in ASIM_BARRIER_TREE_FANIN
+        BARRIER_DISSEMINATION = 3   // log2(N) rounds of pairwise flags, no shared counter
+    };
+
+    // factory: build a barrier of the given type for nThreads participants,
+    // whose waiters spin up to spinLimit iterations before sleeping
+    static ASIM_BARRIER Create(UINT32 type, UINT32 nThreads, UINT32 spinLimit);
+
+    virtual ~ASIM_BARRIER_CLASS() {}
+
+    virtual bool Wait(UINT32 tid) = 0;
+
+    void Abort();
+    bool Aborted() const { return aborted; }
+
+    UINT32 GetNumThreads() const { return nThreads; }
+
+  protected:
+    // per-participant private state, padded so nobody shares its line
+    struct PARTICIPANT
+    {
+        ASIM_SPIN_BUDGET_CLASS budget;
+        UINT32 epoch;
+        char pad[ASIM_BARRIER_LINE_SIZE - sizeof(ASIM_SPIN_BUDGET_CLASS) - sizeof(UINT32)];
+    };
+
+    ASIM_BARRIER_CLASS(UINT32 n, UINT32 spinLimit);
+
+    // wake every word a participant might be sleeping on
+    virtual void WakeAll() = 0;
+
+    const UINT32 nThreads;
+    vector<PARTICIPANT> participants;
+    volatile bool aborted;
+};
+
+#endif // ASIM_BARRIER_H
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Binary checkpoint files of the simulator state.
+ **/
+
+#ifndef ASIM_CHECKPOINT_H
+#define ASIM_CHECKPOINT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <map>
+
+#include "asim/syntax.h"
+#include "asim/mesg.h"
+
+using namespace std;
+
+typedef class ASIM_MODULE_CLASS *ASIM_MODULE;
+
+//
+// A checkpoint file holds a sequence of named sections, one per clock
+// server, module and port.  A small header is followed by the sections,
+// which are deflated as one stream unless the file was written without
+// compression.  Each section is built in memory and streamed out when it
+// is closed, so saving never holds more than one section.  The reader
+// maps the file; an uncompressed checkpoint is read in place and a
+// compressed one is inflated once into an anonymous mapping.  Sections
+// are looked up by name so that a model that gained or lost state can
+// still restore what matches.
+//
+// Values are stored in host byte order: checkpoints are meant to restart
+// or fork runs on the same kind of host, not to be archived.
+//
+typedef class ASIM_CHECKPOINT_WRITER_CLASS *ASIM_CHECKPOINT_WRITER;
+class ASIM_CHECKPOINT_WRITER_CLASS
+{
+  public:
+    ASIM_CHECKPOINT_WRITER_CLASS(const char *fileName, bool compress = true);
+    ~ASIM_CHECKPOINT_WRITER_CLASS();
+
+    bool IsOpen(void) const { return file != NULL; }
+
+    void BeginSection(const string &name);
+    void EndSection(void);
+
+    void WriteBytes(const void *data, UINT64 len)
+    {
+        ASSERTX(inSection);
+        section.append((const char *)data, len);
+    }
+    void WriteUINT64(UINT64 v) { WriteBytes(&v, sizeof(v)); }
+    void WriteINT64(INT64 v) { WriteBytes(&v, sizeof(v)); }
+    void WriteDouble(double v) { WriteBytes(&v, sizeof(v)); }
+    void WriteBool(bool v) { UINT8 b = v; WriteBytes(&b, sizeof(b)); }
+    void WriteString(const string &s)
+    {
+        WriteUINT64(s.size());
+        WriteBytes(s.data(), s.size());
+    }
+
+    // A record is length prefixed inside its section, so that a reader
+    // that cannot use it is able to Skip() it.
+    UINT64 BeginRecord(void)
+    {
+        UINT64 mark = section.size();
+        WriteUINT64(0);
+        return mark;
+    }
+    void EndRecord(UINT64 mark)
+    {
+        UINT64 len = section.size() - mark - sizeof(len);
+        section.replace(mark, sizeof(len), (const char *)&len, sizeof(len));
+    }
+
+    // Flush and close the file.  False if anything failed to be written.
+    bool Close(void);
+
+  private:
+    void Emit(const void *data, UINT64 len, bool finish);
+
+    FILE *file;
+    void *stream;               // z_stream, NULL when not compressing
+    bool ok;
+    bool inSection;
+    string sectionName;
+    string section;             // section being built
+    UINT64 rawSize;             // uncompressed bytes after the header
+    char *outBuf;
+};
+
+
+typedef class ASIM_CHECKPOINT_READER_CLASS *ASIM_CHECKPOINT_READER;
+class ASIM_CHECKPOINT_READER_CLASS
+{
+  public:
+    ASIM_CHECKPOINT_READER_CLASS(const char *fileName);
+    ~ASIM_CHECKPOINT_READER_CLASS();
+
+    bool IsOpen(void) const { return data != NULL; }
+
+    // Position the reader at the start of a section.  False if the
+    // checkpoint does not hold it.
+    bool OpenSection(const string &name);
+
+    // Bytes of the open section not read yet
+    UINT64 Left(void) const { return end - pos; }
+
+    void ReadBytes(void *dst, UINT64 len)
+    {
+        VERIFY(len <= Left(), "Checkpoint section " << sectionName << " is truncated");
+        memcpy(dst, data + pos, len);
+        pos += len;
+    }
+    void Skip(UINT64 len)
+    {
+        VERIFY(len <= Left(), "Checkpoint section " << sectionName << " is truncated");
+        pos += len;
+    }
+    UINT64 ReadUINT64(void) { UINT64 v; ReadBytes(&v, sizeof(v)); return v; }
+    INT64 ReadINT64(void) { INT64 v; ReadBytes(&v, sizeof(v)); return v; }
+    double ReadDouble(void) { double v; ReadBytes(&v, sizeof(v)); return v; }
+    bool ReadBool(void) { UINT8 b; ReadBytes(&b, sizeof(b)); return b != 0; }
+    string ReadString(void)
+    {
+        UINT64 len = ReadUINT64();
+        VERIFY(len <= Left(), "Checkpoint section " << sectionName << " is truncated");
+        string s(data + pos, len);
+        pos += len;
+        return s;
+    }
+
+  private:
+    const char *data;           // sections, NULL if the file is not usable
+    void *fileMap;
+    UINT64 fileMapSize;
+    void *rawMap;               // inflated sections of a compressed file
+    UINT64 rawMapSize;
+    map<string, pair<UINT64, UINT64> > sections;    // offset and length
+    string sectionName;
+    UINT64 pos;
+    UINT64 end;
+};
+
+
+//
+// How the values a port carries go into a checkpoint.  Plain scalars are
+// copied as they are.  Anything else (pointers, smart pointers to items
+// in MM pools, classes) is not checkpointable unless the model provides
+// a specialization, and a port holding it must be empty when saved.
+//
+template <class T>
+struct ASIM_CHECKPOINT_DATA
+{
+    enum { CHECKPOINTABLE = 0 };
+    static void Save(ASIM_CHECKPOINT_WRITER ckpt, const T &v) { }
+    static void Restore(ASIM_CHECKPOINT_READER ckpt, T &v) { }
+};
+
+#define ASIM_CHECKPOINT_RAW_DATA(TYPE)                                  \
+template <>                                                             \
+struct ASIM_CHECKPOINT_DATA<TYPE>                                       \
+{                                                                       \
+    enum { CHECKPOINTABLE = 1 };                                        \
+    static void Save(ASIM_CHECKPOINT_WRITER ckpt, const TYPE &v)        \
+    { ckpt->WriteBytes(&v, sizeof(TYPE)); }                             \
+    static void Restore(ASIM_CHECKPOINT_READER ckpt, TYPE &v)           \
+    { ckpt->ReadBytes(&v, sizeof(TYPE)); }                              \
+};
+
+ASIM_CHECKPOINT_RAW_DATA(bool)
+ASIM_CHECKPOINT_RAW_DATA(char)
+ASIM_CHECKPOINT_RAW_DATA(signed char)
+ASIM_CHECKPOINT_RAW_DATA(unsigned char)
+ASIM_CHECKPOINT_RAW_DATA(short)
+ASIM_CHECKPOINT_RAW_DATA(unsigned short)
+ASIM_CHECKPOINT_RAW_DATA(int)
+ASIM_CHECKPOINT_RAW_DATA(unsigned int)
+ASIM_CHECKPOINT_RAW_DATA(long)
+ASIM_CHECKPOINT_RAW_DATA(unsigned long)
+ASIM_CHECKPOINT_RAW_DATA(long long)
+ASIM_CHECKPOINT_RAW_DATA(unsigned long long)
+ASIM_CHECKPOINT_RAW_DATA(float)
+ASIM_CHECKPOINT_RAW_DATA(double)
+
+
+//
+// Save or restore the whole simulator: the clock server cycles and the
+// random state, the state and stats of every module below root and the
+// contents of the ports.
+//
+class ASIM_CHECKPOINT_CLASS
+{
+  public:
+    static bool Save(ASIM_MODULE root, const char *fileName, bool compress = true);
+    static bool Restore(ASIM_MODULE root, const char *fileName);
+};
+
+#endif // ASIM_CHECKPOINT_H
@@ -80,13 +80,6 @@ class ASIM_CLOCKABLE_CLASS : public TRACEABLE_CLASS
         
     ASIM_CLOCKABLE parent;
     
-    UINT64 nCycles;
-    UINT64 nCyclesMin;
-    UINT64 nCyclesMax;
-    UINT64 nClocked;
-    UINT64 nCyclesWrapAround;
-    UINT64 nWrapAround;
-    
     // List of callbacks created by this clockable just to be able to delete them
     list<CLOCK_CALLBACK_INTERFACE> cbL;
 
@@ -106,12 +99,6 @@ class ASIM_CLOCKABLE_CLASS : public TRACEABLE_CLASS
         registeredDral(false),
         thread(NULL),
         parent(p),
-        nCycles(0),
-        nCyclesMin(UINT64_MAX),
-        nCyclesMax(0),
-        nClocked(0),
-        nCyclesWrapAround(0),
-        nWrapAround(0),
         host_thread(NULL)
     { }
 
@@ -457,51 +444,14 @@ class ASIM_CLOCKABLE_CLASS : public TRACEABLE_CLASS
     void RegisterRateMatcherReader(RATE_MATCHER r);    
     
     
-    #if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
-    
     /** 
-     * Method to identify the elem to dump profiling information 
-     * Transient implementation. At the moment we only use this
-     * method on Alpha, due to profile is not implemented on x86
-     * yet. --> a x86 version has been also implemented!
+     * Method to identify the elem to dump profiling information.
+     * The host profiler charges the time spent clocking this element
+     * to this name, split into one frame per '/'.
      *
      * @return An identifyer to be dumped by the profiling file
      **/
     virtual const char *ProfileId(void) const = 0; 
-    
-    #endif
-        
-    /**
-     * Updates the number of cycles spent by the clock routine. This
-     * information is for profiling purpose.
-     *
-     * @param cycles Number of cycles spent by the clock method
-     **/
-    void IncCyclesSpent(UINT64 cycles)
-    { 
-    	if(cycles < nCyclesMin && cycles > 0) nCyclesMin = cycles;
-    	if(cycles > nCyclesMax) nCyclesMax = cycles;
-    	nCycles += cycles;
-    	nClocked++;
-    }
-
-    /**
-     * Updates the stats about the wrap around counted cycles
-     *
-     * @param cycles Cycles counted in wrap around lecture
-     **/
-    void IncWrapAround(UINT64 cycles) 
-    { 
-    	nCyclesWrapAround += cycles;
-    	nWrapAround++; 
-    } 
-
-    UINT64 GetCycles(void) { return nCycles; } 
-    UINT64 GetCyclesMin(void) { return nCyclesMin; } 
-    UINT64 GetCyclesMax(void) { return nCyclesMax; }
-    UINT64 GetNumInvocations(void) { return nClocked; }
-    UINT64 GetWrapAroundCycles(void) { return nCyclesWrapAround; } 
-    UINT64 GetWrapAround(void) { return nWrapAround; }
 
     /**
      * Virtual method that the clock server will call when the DRAL events are
@@ -76,6 +76,9 @@
 #include "asim/event.h"
 #include "asim/phase.h"
 #include "asim/dynamic_array.h"
+#include "asim/host_profiler.h"
+#include "asim/thread_activity.h"
+#include "asim/checkpoint.h"
 
 using namespace std;
 
@@ -95,6 +98,9 @@ typedef class ClockCallBackInterface
   public:
 
     UINT64 currentCycle;
+
+    /** Thread sink step of the current cycle (threaded clockserver) */
+    UINT32 sinkStep;
     
     CLOCK_REGISTRY cReg;
     
@@ -103,6 +109,13 @@ typedef class ClockCallBackInterface
     virtual void setClkEdge(CLK_EDGE ed) = 0;
     virtual bool withPhases() = 0;
     
+    ClockCallBackInterface()
+      : sinkStep(0),
+        cReg(NULL),
+        profileObject(NULL),
+        profilePhase(HOST_PROFILE_MODULE_CLOCK)
+    { }
+
     virtual ~ClockCallBackInterface() { };
 
     void setClockRegistry(CLOCK_REGISTRY _cReg)
@@ -110,106 +123,16 @@ typedef class ClockCallBackInterface
         cReg = _cReg;
     }
 
-  protected:
-
-    #ifdef HOST_LINUX_X86
-
-    /** Profile support methods */
-    UINT32 nCycleBeforeHigh;
-    UINT32 nCycleBeforeLow;
-
-    /* 
-     * Set *hi and *lo to the high and low order bits of the cycle counter.
-     * Implementation requires assembly code to use the rdtsc instruction.  
-     */
-    inline void accessCounter(UINT32 *hi, UINT32 *lo)
-    {
-         asm volatile("rdtsc; movl %%edx, %0; movl %%eax, %1" /* read cycle counter */
-                      : "=r" (*hi), "=r" (*lo)                /* and move results to */
-                      : /* No input */                        /* the two outputs */
-                      : "%edx", "%eax");
-    }
-
-    /* Record the current value of the cycle counter. */
-    inline void startCounter()
-    {
-         accessCounter(&nCycleBeforeHigh, &nCycleBeforeLow);
-    }
-
-    /* 
-     * Computes the number of cycles since the last call to start_counter. 
-     * @return If the result has wrapped around
-     */
-    inline bool getCounter(UINT64 &result)
-    {
-         UINT32 nCycleAfterHigh, nCycleAfterLow;
-         UINT32 hi, lo, borrow;
-    
-         /* get cycle counter */
-         accessCounter(&nCycleAfterHigh, &nCycleAfterLow);   
-         //cerr << "nCycleBeforeHigh = " << nCycleBeforeHigh <<
-         //     " nCycleBeforeLow = " << nCycleBeforeLow <<
-         //     " nCycleAfterHigh = " << nCycleAfterHigh <<
-         //     " nCycleAfterLow = " << nCycleAfterLow << endl;
-         /*  double precision subtraction */
-         lo = nCycleAfterLow - nCycleBeforeLow;
-         borrow = lo > nCycleAfterLow;
-         hi = nCycleAfterHigh - nCycleBeforeHigh - borrow;
-         result = static_cast<UINT64>(hi * (1 << 30) * 4 + lo);
-         return false;
-         
-         /*
-         // This is a simpler alternative to the double precision subtraction code
-         result = ComputeResult (nCycleAfterHigh, nCycleAfterLow, nCycleBeforeHigh, nCycleBeforeLow);
-         return false;
-         */
-    }
-
-    /*
-    // The ComputeResult function
-    static UINT64 ComputeResult (UINT32 ahi, UINT32 alo, UINT32 bhi, UINT32 blo)
-    {
-        const UINT64 lowmask = 0xffffffff;
-        UINT64 ahi64 = ahi, alo64 = alo, a64 = (ahi64 << 32) | (alo64 & lowmask);
-        UINT64 bhi64 = bhi, blo64 = blo, b64 = (bhi64 << 32) | (blo64 & lowmask);
-        return a64 - b64;
-    }
-    */
-
-    #elif HOST_DUNIX
-
-    UINT64 nCycleBefore;
-    inline void accessCounter(UINT64 *cycle)
-    {
-        asm volatile("rpcc $0; sll $0, 32, $1; addq $0, $1, $0; srl $0, 32, %0;"
-                     : "=r"(*cycle));
-    }
+    /** What the host profiler charges the time spent in Clock() to */
+    const void *profileObject;
+    ASIM_HOST_PROFILE_PHASE profilePhase;
 
-    inline void startCounter()
+    void setProfile(const void *_object, ASIM_HOST_PROFILE_PHASE _phase)
     {
-         accessCounter(&nCycleBefore);
+        profileObject = _object;
+        profilePhase = _phase;
     }
 
-    inline bool getCounter(UINT64 &result)
-    {
-        bool bWrapped = false;
-        UINT64 nCycleAfter = 0;
-        asm volatile("rpcc $0; sll $0, 32, $1; addq $0, $1, $0; srl $0, 32, %0;"
-                     : "=r"(nCycleAfter));
-        if(nCycleAfter < nCycleBefore)
-        {
-            result = (0xFFFFFFFF - nCycleBefore) + nCycleAfter;
-            bWrapped = true;
-        }
-        else
-        {
-            result = nCycleAfter - nCycleBefore + 1;
-        }
-        return bWrapped;
-    }
-    
-    #endif
-   
 } CLOCK_CALLBACK_INTERFACE_CLASS, *CLOCK_CALLBACK_INTERFACE;
 
 template <class Class>
@@ -251,24 +174,9 @@ class ClockCallBack: public ClockCallBackInterface
 
     void Clock()
     {           
-        #ifdef ASIM_ENABLE_PROFILE
-        #if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
-        startCounter();
-        #endif
-        #endif
-                  
-        (class_instance->*method)(currentCycle);        
+        ASIM_HOST_PROFILE_SCOPE profile(profileObject, profilePhase);
 
-        #ifdef ASIM_ENABLE_PROFILE
-        #if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
-        UINT64 result = 0;
-        if(getCounter(result)) // Wrapped 
-        {
-            class_instance->IncWrapAround(result);
-        }
-        class_instance->IncCyclesSpent(result);
-        #endif
-        #endif
+        (class_instance->*method)(currentCycle);        
     };
 
 };
@@ -331,12 +239,8 @@ class ClockCallBackPhase: public ClockCallBackInterface
     
     void Clock()
     {
-        #ifdef ASIM_ENABLE_PROFILE
-        #if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
-        startCounter();
-        #endif
-        #endif
-        
+        ASIM_HOST_PROFILE_SCOPE profile(profileObject, profilePhase);
+
         if(type)
         {
             (class_instance->*method_a)(currentCycle, edge);
@@ -346,17 +250,6 @@ class ClockCallBackPhase: public ClockCallBackInterface
             PHASE ph(currentCycle, edge);
             (class_instance->*method_b)(ph);
         }
-
-        #ifdef ASIM_ENABLE_PROFILE
-        #if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
-        UINT64 result = 0;
-        if(getCounter(result)) // Wrapped 
-        {
-            class_instance->IncWrapAround(result);
-        }
-        class_instance->IncCyclesSpent(result);
-        #endif
-        #endif
     };
 
 };
@@ -650,6 +543,7 @@ class ClockRegistry
         (
             if (runWithEventsOn)
             {
+                ASIM_HOST_PROFILE_SCOPE profile(NULL, HOST_PROFILE_EVENTS);
                 DRALEVENT
                 (
                     Cycle(clockId, nCycle, edge)
@@ -657,6 +551,10 @@ class ClockRegistry
             }
         );
     }
+
+    // Same marker, queued for the threaded clockserver to write out ahead
+    // of the given step of the thread sinks (see ASIM_THREAD_SINK_CLASS)
+    void DralSinkCycle(UINT32 step);
     
 };
 
@@ -698,6 +596,9 @@ class ASIM_CLOCK_SERVER_CLASS : public TRACEABLE_CLASS
         
     /** Threaded clocking? */
     bool threaded;
+
+    /** Do the worker threads buffer trace and DRAL output in thread sinks? */
+    bool threadedSinks;
         
     /** Clock registry of the reference clock domain */
     CLOCK_REGISTRY referenceClockRegitry;
@@ -743,6 +644,9 @@ class ASIM_CLOCK_SERVER_CLASS : public TRACEABLE_CLASS
     string threadLookahead;
     void InitClockServerThreaded();
 
+    /** turn on thread time accounting, strip charted every stripInterval cycles */
+    void InitThreadActivity( UINT64 stripInterval );
+
     /** parse the fuzzy barrier lookahead parameter string and return base cycles */
     UINT64 LookaheadParam2BaseCycles( const string &lookahead );
 
@@ -766,6 +670,12 @@ class ASIM_CLOCK_SERVER_CLASS : public TRACEABLE_CLASS
     /** Dump the profile info? */
     bool bDumpProfile;
 
+    /** Host profiler sampling rate, when dumping the profile */
+    UINT32 profileHz;
+
+    /** Profile names of all the clocked modules and rate matchers */
+    void GetProfileNames(map<const void *, string> &names);
+
     /**
      * @param a First operand
      * @param b Second operand
@@ -863,10 +773,16 @@ class ASIM_CLOCK_SERVER_CLASS : public TRACEABLE_CLASS
     void InitClockServer(void);
     void StopClockServer(void);
 
+    /** Save or restore the cycle counters, the event order and the
+        random state.  Restore fails if the clock domains differ. */
+    void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt);
+    bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
+
     /** Some methods to configure the clockserver */
-    void SetDumpProfile(bool _bDumpProfile)
+    void SetDumpProfile(bool _bDumpProfile, UINT32 _profileHz = 997)
     {
         bDumpProfile = _bDumpProfile;
+        profileHz = _profileHz;
     }
 
     void SetRandomClockingSeed(UINT64 _random_seed)
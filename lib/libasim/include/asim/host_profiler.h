@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Sampling host profiler for the clock server.
+ **/
+
+#ifndef ASIM_HOST_PROFILER_H
+#define ASIM_HOST_PROFILER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "asim/syntax.h"
+#include "asim/smp.h"
+
+using namespace std;
+
+//
+// What a simulator thread is doing on behalf of the clock server.
+// These fit in the low bits of an object pointer.
+//
+enum ASIM_HOST_PROFILE_PHASE
+{
+    HOST_PROFILE_OTHER = 0,         // outside the clock server
+    HOST_PROFILE_SCHEDULE,          // clock server bookkeeping
+    HOST_PROFILE_MODULE_CLOCK,      // a module's clock method
+    HOST_PROFILE_RATE_MATCHER,      // a write rate matcher's clock method
+    HOST_PROFILE_BARRIER_WAIT,      // waiting for the other threads
+    HOST_PROFILE_EVENTS,            // writing trace and DRAL output
+    HOST_PROFILE_NPHASES
+};
+
+#ifdef TLS_AVAILABLE
+//
+// The object the running thread is working on, or'ed with the phase.
+// This is a single word so that the sampling signal always sees a
+// consistent pair.
+//
+extern __thread volatile PTR_SIZED_UINT ASIM_HOST_PROFILE_Current;
+#endif
+
+
+//
+// The host profiler samples the clock server state of whichever simulator
+// thread is consuming host cpu time, driven by the ITIMER_PROF timer.
+// The kernel fires that timer at most once per scheduler tick for the
+// whole process, so the sample count is only proportional to the host
+// time; GetCpuSeconds() gives the host time the samples represent.
+// Marking the current object and phase costs a thread-local store, so the
+// clock server marks every callback whether the profiler runs or not.
+// Without thread local storage the profiler records nothing.
+//
+class ASIM_HOST_PROFILER_CLASS
+{
+  public:
+    // One aggregated sample bucket
+    struct SAMPLE
+    {
+        const void *object;             // clockable being worked on, or NULL
+        ASIM_HOST_PROFILE_PHASE phase;
+        INT32 thread;                   // ASIM running thread number
+        UINT64 count;
+    };
+
+    // Start sampling every host thread at the given rate
+    static void Start(UINT32 hz);
+    static void Stop(void);
+    static bool IsRunning(void) { return running; }
+    static UINT32 GetHz(void) { return hz; }
+
+    // Forget all the samples taken so far
+    static void Reset(void);
+
+    // All the samples taken so far, aggregated per object, phase and thread
+    static void GetSamples(vector<SAMPLE> &samples);
+
+    // Samples that did not fit in the per-thread tables
+    static UINT64 GetDropped(void);
+
+    // Host cpu time the process spent while sampling was on
+    static double GetCpuSeconds(void);
+
+    static const char *PhaseName(ASIM_HOST_PROFILE_PHASE phase);
+
+    // Write the samples as folded stacks, one "frame;frame;... count"
+    // line per bucket, for flame graph tools.  Object names are split
+    // into frames at each '/'.
+    static void WriteFolded(ostream &out, const map<const void *, string> &names);
+
+    // Mark what the calling thread is doing, and return the previous mark
+    static inline PTR_SIZED_UINT Enter(const void *object, ASIM_HOST_PROFILE_PHASE phase)
+    {
+#ifdef TLS_AVAILABLE
+        PTR_SIZED_UINT prev = ASIM_HOST_PROFILE_Current;
+        ASIM_HOST_PROFILE_Current = PTR_SIZED_UINT(object) | phase;
+        return prev;
+#else
+        return 0;
+#endif
+    }
+
+    static inline void Leave(PTR_SIZED_UINT prev)
+    {
+#ifdef TLS_AVAILABLE
+        ASIM_HOST_PROFILE_Current = prev;
+#endif
+    }
+
+  private:
+    static volatile bool running;
+    static UINT32 hz;
+    static double cpuSeconds;       // while sampling, before the last Start()
+    static double startCpuSeconds;
+};
+
+
+//
+// Marks the calling thread for the lifetime of the scope
+//
+class ASIM_HOST_PROFILE_SCOPE
+{
+  private:
+    PTR_SIZED_UINT prev;
+
+  public:
+    ASIM_HOST_PROFILE_SCOPE(const void *object, ASIM_HOST_PROFILE_PHASE phase)
+      : prev(ASIM_HOST_PROFILER_CLASS::Enter(object, phase))
+    {}
+
+    ~ASIM_HOST_PROFILE_SCOPE()
+    {
+        ASIM_HOST_PROFILER_CLASS::Leave(prev);
+    }
+};
+
+#endif // ASIM_HOST_PROFILER_H
@@ -244,6 +244,29 @@ class ASIM_ITEM_CLASS
         }
     }
 
+    //
+    // Tags and strings registered once with the dral server, for the
+    // items tagged every cycle.
+    //
+    inline void
+    SetItemTag (DRAL_TAG_HANDLE tag, UINT64 value, bool persistent=false)
+    {
+        if (runWithEventsOn && eventsEnabled)
+        {
+            DRALEVENT(SetItemTag(itemId, tag, value, persistent));
+        }
+    }
+
+    inline void
+    SetItemTag (
+        DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str, bool persistent=false)
+    {
+        if (runWithEventsOn && eventsEnabled)
+        {
+            DRALEVENT(SetItemTag(itemId, tag, str, persistent));
+        }
+    }
+
     // accessors for the event record id.  it is not terribly wise to play with
     // these, but they are nevertheless provided for portability and power users.
     // dont use these unless you know what you are doing.  there are likely 
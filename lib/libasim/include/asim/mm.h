@@ -653,7 +653,9 @@ ASIM_MM_CLASS<MM_TYPE>::DATA::PreAllocateMemory (void)
 
         // object is on the freelist, no deletion necessary
         newMmObj->mmCnt = MMCNT_ON_FREELIST_AND_DELETED;
-        mmFreeList.Push(newMmObj, /*threadId=*/0);
+        // keep the object on the list of the thread that first touched it,
+        // which is also the thread whose NUMA node it lives on
+        mmFreeList.Push(newMmObj);
 
 #ifdef MM_VALGRIND
         // object is on the free list and should not be accessed anymore!
@@ -703,6 +703,21 @@ class ASIM_MODULE_CLASS : public ASIM_REGISTRY_CLASS, public ASIM_DRAL_NODE_CLAS
          * of all contained modules.
          */
         virtual void ClearModuleStats ();
+
+        /*
+         * Hooks for a module to save and restore timing state that is
+         * not held in registered stats or ports.  The restore hook must
+         * consume exactly what the save hook wrote.
+         */
+        virtual void SaveCheckpoint (ASIM_CHECKPOINT_WRITER ckpt) {}
+        virtual void RestoreCheckpoint (ASIM_CHECKPOINT_READER ckpt) {}
+
+        /*
+         * Checkpoint this module's stats and hook state and then
+         * recursively those of all contained modules.
+         */
+        void SaveCheckpointTree (ASIM_CHECKPOINT_WRITER ckpt);
+        void RestoreCheckpointTree (ASIM_CHECKPOINT_READER ckpt);
         
 
         /*                                                                                                               
@@ -167,6 +167,17 @@ public:
 
   virtual PortType GetType() const = 0;
   const char *GetTypeName() const;
+
+  // Checkpoint the contents of every port that owns a buffer.  Save
+  // returns the number of ports whose contents could not be saved.
+  static UINT32 SaveAllPorts(ASIM_CHECKPOINT_WRITER ckpt);
+  static void RestoreAllPorts(ASIM_CHECKPOINT_READER ckpt);
+
+protected:
+  // Overridden by the ports that own a buffer.  Save returns false if
+  // the contents could not be saved, restore if they were not restored.
+  virtual bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const { return true; }
+  virtual bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt) { return true; }
 };
 
 
@@ -299,6 +310,12 @@ public:
   bool IsActive(){ return active; } 
 
   void Clear(); // empty out all data from the buffer
+
+  // Save the buffer contents.  Nothing is saved, and false returned, if
+  // the buffer holds data that is not checkpointable.  Restore clears
+  // the buffer if it was not saved and returns false.
+  bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const;
+  bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
 };
 
 template <class T, int S = 0>
@@ -475,6 +492,10 @@ public:
 
   void Clear(); // empty out all data from the port buffer
 
+protected:
+  virtual bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const;
+  virtual bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
+
 protected:
   // this is used to ensure the endpoints of a connected port have the same type:
   virtual const type_info &GetDataType() { return typeid( T ); };
@@ -519,6 +540,10 @@ public:
 
   void Clear(); // empty out all data from the port buffer
 
+protected:
+  virtual bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const;
+  virtual bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
+
 protected:
   // this is used to ensure the endpoints of a connected port have the same type:
   virtual const type_info &GetDataType() { return typeid( T ); };
@@ -567,6 +592,10 @@ public:
 
   void Clear(); // empty out all data from the port buffer
 
+protected:
+  virtual bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const;
+  virtual bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
+
 protected:
   // this is used to ensure the endpoints of a connected port have the same type:
   virtual const type_info &GetDataType() { return typeid( T ); };
@@ -698,6 +727,10 @@ public:
 
   void Clear(); // empty out all data from the port buffer
 
+protected:
+  virtual bool SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const;
+  virtual bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt);
+
 protected:
   // this is used to ensure the endpoints of a connected port have the same type:
   virtual const type_info &GetDataType() { return typeid( T ); };
@@ -1108,6 +1141,93 @@ BufferStorage<T,S>::Clear()
     }
 }
 
+template<class T, int S>
+inline bool
+BufferStorage<T,S>::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+{
+    bool empty = true;
+    for (int count = 0; count < BufferSize && empty; count++)
+    {
+        empty = IsEmpty(count);
+    }
+
+    bool saved = empty || ASIM_CHECKPOINT_DATA<T>::CHECKPOINTABLE;
+    ckpt->WriteINT64(BufferSize);
+    ckpt->WriteINT64(Bandwidth);
+    ckpt->WriteBool(saved);
+    if (! saved)
+    {
+        return false;
+    }
+
+    ckpt->WriteBool(active);
+    ckpt->WriteBool(stalled);
+    ckpt->WriteINT64(ReadIndex);
+    ckpt->WriteINT64(WriteIndex);
+    ckpt->WriteINT64(CycleRowRead);
+    ckpt->WriteINT64(PeekStart);
+    ckpt->WriteINT64(PeekReadIndex);
+    ckpt->WriteUINT64(LastAccessed);
+    ckpt->WriteUINT64(LastWritten);
+    ckpt->WriteUINT64(SequentialWrites);
+
+    for (int count = 0; count < BufferSize; count++)
+    {
+        int start = Store[count].Start;
+        int end = Store[count].End;
+        ckpt->WriteINT64(Store[count].CycleWritten);
+        ckpt->WriteINT64(start);
+        ckpt->WriteINT64(end);
+        for (int position = start; position < end; position++)
+        {
+            ASIM_CHECKPOINT_DATA<T>::Save(ckpt, Store[count].Data[position]);
+        }
+    }
+    return true;
+}
+
+template<class T, int S>
+inline bool
+BufferStorage<T,S>::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{
+    Clear();
+
+    INT64 size = ckpt->ReadINT64();
+    INT64 bandwidth = ckpt->ReadINT64();
+    bool saved = ckpt->ReadBool();
+    if (! saved || size != BufferSize || bandwidth != Bandwidth)
+    {
+        return false;
+    }
+
+    active = ckpt->ReadBool();
+    stalled = ckpt->ReadBool();
+    ReadIndex = ckpt->ReadINT64();
+    WriteIndex = ckpt->ReadINT64();
+    CycleRowRead = ckpt->ReadINT64();
+    PeekStart = ckpt->ReadINT64();
+    PeekReadIndex = ckpt->ReadINT64();
+    LastAccessed = ckpt->ReadUINT64();
+    LastWritten = ckpt->ReadUINT64();
+    SequentialWrites = ckpt->ReadUINT64();
+
+    for (int count = 0; count < BufferSize; count++)
+    {
+        Store[count].CycleWritten = ckpt->ReadINT64();
+        int start = ckpt->ReadINT64();
+        int end = ckpt->ReadINT64();
+        VERIFY(0 <= start && start <= end && end <= Bandwidth,
+               "Corrupt port buffer in checkpoint");
+        Store[count].Start = start;
+        Store[count].End = end;
+        for (int position = start; position < end; position++)
+        {
+            ASIM_CHECKPOINT_DATA<T>::Restore(ckpt, Store[count].Data[position]);
+        }
+    }
+    return true;
+}
+
 template<class T, int S>
 inline int
 BufferStorage<T,S>::GetBandwidth() const
@@ -1593,6 +1713,16 @@ inline void
 ReadPort<T>::Clear()
 { Buffer.Clear(); }
 
+template <class T>
+inline bool
+ReadPort<T>::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+{ return Buffer.SaveCheckpoint(ckpt); }
+
+template <class T>
+inline bool
+ReadPort<T>::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{ return Buffer.RestoreCheckpoint(ckpt); }
+
 
 ///////////////////////////
 // class ReadSkidPort<T, Storage>
@@ -1655,6 +1785,16 @@ inline void
 ReadSkidPort<T,S>::Clear()
 { Buffer.Clear(); }
 
+template <class T, int S>
+inline bool
+ReadSkidPort<T,S>::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+{ return Buffer.SaveCheckpoint(ckpt); }
+
+template <class T, int S>
+inline bool
+ReadSkidPort<T,S>::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{ return Buffer.RestoreCheckpoint(ckpt); }
+
 
 ///////////////////////////
 // class ReadStallPort<T, Storage>
@@ -1751,6 +1891,16 @@ inline void
 ReadStallPort<T>::Clear()
 { Buffer.Clear(); }
 
+template <class T>
+inline bool
+ReadStallPort<T>::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+{ return Buffer.SaveCheckpoint(ckpt); }
+
+template <class T>
+inline bool
+ReadStallPort<T>::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{ return Buffer.RestoreCheckpoint(ckpt); }
+
 ///////////////////////////
 // class ReadRemotePort<T, Storage>
 //
@@ -2018,6 +2168,16 @@ inline void
 ReadPhasePort<T>::Clear()
 { Buffer.Clear(); }
 
+template <class T>
+inline bool
+ReadPhasePort<T>::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+{ return Buffer.SaveCheckpoint(ckpt); }
+
+template <class T>
+inline bool
+ReadPhasePort<T>::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{ return Buffer.RestoreCheckpoint(ckpt); }
+
 ////////////////////////////
 // class WritePort<T,F>
 //
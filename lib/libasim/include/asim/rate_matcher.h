@@ -69,6 +69,7 @@ class RateMatcher: public ASIM_CLOCKABLE_CLASS
     protected:
     
       string id;            //> Rate matcher id
+      mutable string profileId; //> Rate matcher id for the profiler
       bool listCreated;     //> Has the connectedRateMatchers list been created?
       bool initialized;     //> Has the RateMatcher been initialized?
       
@@ -126,8 +127,8 @@ class RateMatcher: public ASIM_CLOCKABLE_CLASS
       const char *ProfileId(void) const
       {
           VERIFYX(initialized);
-          string tmp = id + "_Rate_Matcher";
-          return tmp.c_str();
+          profileId = id + "_Rate_Matcher";
+          return profileId.c_str();
       }
       
       // return the module we are instantiated in
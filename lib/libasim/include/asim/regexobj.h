@@ -91,6 +91,9 @@ public:
     // return whether the regex is ready for matching 
     bool ok();
 
+    // the pattern this regex was last compiled from
+    const string &getPattern() const { return pattern; }
+
     ~Regex() {
 	dispose();
     }
@@ -98,6 +101,7 @@ public:
 protected:
     bool initialized;
     regex_t regexPattern;
+    string pattern;
 
     // For pattern substitution, keep an array for reuse.
     unsigned subArraySize;
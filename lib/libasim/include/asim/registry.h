@@ -113,6 +113,13 @@ protected:
    */
   virtual void ClearStats ();
 
+  /*
+   * Write registered statistics to the open checkpoint section, or
+   * restore them from it.
+   */
+  void SaveStats (ASIM_CHECKPOINT_WRITER ckpt);
+  void RestoreStats (ASIM_CHECKPOINT_READER ckpt);
+
   
 public:
 
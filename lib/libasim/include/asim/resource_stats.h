@@ -71,6 +71,7 @@
 // ASIM core
 #include "asim/ioformat.h"
 #include "asim/stateout.h"
+#include "asim/checkpoint.h"
 
 namespace iof = IoFormat;
 using namespace iof;
@@ -97,6 +98,8 @@ class HISTOGRAM_TEMPLATE {
   bool rowFlexcap;         // Flexible cap on max entries in row
   bool colFlexcap;         // Flexible cap on max entries in col
                            // pooled into maximum bin. 
+  INT32 rowShift;          // log2(rowSize), or -1 if rowSize is not a
+  INT32 colShift;          // power of two; same for colSize
   UINT32 maxRowsUsed;      // High water mark for rows actually holding data.
   UINT32 maxRowVal;        // This is the maximum row in histogram.  If
                            // we exceed this number, then pooled data must 
@@ -112,6 +115,8 @@ class HISTOGRAM_TEMPLATE {
 
  protected: 
   UINT64 **histData;       // histogram structure. 
+  UINT64 *histBlock;       // all rows in one block, or NULL if the rows
+                           // are allocated one by one (see WriteRow)
   UINT64 *total;           // Total number of events in histogram
   bool enabled;            // Flag which notes whether this histogram
                            // stat should be collected or not. 
@@ -195,6 +200,9 @@ class HISTOGRAM_TEMPLATE {
           
           ASSERT (col_size > 0, Name());
           colSize = col_size;
+
+          rowShift = BucketShift(rowSize);
+          colShift = BucketShift(colSize);
           
           ASSERT (num_rows > 0, Name());
           numRows = num_rows;
@@ -260,13 +268,18 @@ class HISTOGRAM_TEMPLATE {
           }
           
           // histData
-          if (histData) {
+          if (histBlock) {
+              delete [] histBlock;
+          }
+          else if (histData) {
               for (UINT32 i = 0; i < numRows; i++)
               {
                   if (histData[i]) {
                       delete [] histData[i];
                   }
               }
+          }
+          if (histData) {
               delete [] histData;
           }
 
@@ -421,11 +434,13 @@ class HISTOGRAM_TEMPLATE {
           //
           numRows = 0;
           rowSize = 0;
+          rowShift = 0;
           rowFlexcap = false;
           maxRowVal = 0;
           maxRowsUsed = 0;
           
           colSize = 0;
+          colShift = 0;
           colFlexcap = false;
           numCols = 0;
           maxColVal = 0;
@@ -443,6 +458,7 @@ class HISTOGRAM_TEMPLATE {
           rowNames = NULL;
           name = NULL;
           histData = NULL;
+          histBlock = NULL;
           total = NULL;
           accumulated = NULL;
       }
@@ -492,7 +508,7 @@ class HISTOGRAM_TEMPLATE {
   // 
   void InitializeHistogram() {
       if (enabled == true) {
-          UINT32 i, j;
+          UINT32 i;
           
           // Allocate memory for histogram
           /*
@@ -505,7 +521,6 @@ class HISTOGRAM_TEMPLATE {
           ASSERT (accumulated == NULL, this->Name());
           ASSERT (numRows != 0, this->Name());
           ASSERT (numCols != 0, this->Name());
-          histData = new UINT64*[numRows];
           total = new UINT64[numCols];
           accumulated = new UINT64[numCols];
           
@@ -518,20 +533,100 @@ class HISTOGRAM_TEMPLATE {
           //         << ": Rows: " << numRows
           //         << ", Cols: " << numCols << endl;
           
-          //
-          // Initialize data members. 
-          // Note we always initialize to maxBins + 1 because
-          // we have bins labeled "0" through "maxBins"
-          //
-          for (i = 0; i < numRows; i++) {
-              histData[i] = new UINT64[numCols];
-              // cout << "Row: " << i << ", Addr: " << fmt_x(histData[i]) << endl;
-              // cout << flush;
-              for (j = 0; j < numCols; j++) {
-                  histData[i][j] = 0;
+          AllocateRows();
+      }
+  }
+
+  //
+  // Histograms of up to maxBlockEntries buckets keep all rows in one
+  // zeroed block, so updates never allocate.  In bigger ones a row is
+  // not allocated until it receives its first event (see WriteRow), so
+  // a big flexcap histogram that stays mostly empty only pays for the
+  // rows it actually uses.
+  //
+  static const UINT32 maxBlockEntries = 4096;
+
+  void AllocateRows() {
+      histData = new UINT64*[numRows];
+      if (UINT64(numRows) * numCols <= maxBlockEntries) {
+          UINT32 n = numRows * numCols;
+          histBlock = new UINT64[n];
+          memset(histBlock, 0, n * sizeof(UINT64));
+          for (UINT32 i = 0; i < numRows; i++) {
+              histData[i] = histBlock + i * numCols;
+          }
+      }
+      else {
+          histBlock = NULL;
+          for (UINT32 i = 0; i < numRows; i++) {
+              histData[i] = NULL;
+          }
+      }
+  }
+
+  //
+  // Return log2(size) if size is a power of two, -1 otherwise.
+  //
+  static INT32 BucketShift(UINT32 size) {
+      if (size & (size - 1)) {
+          return -1;
+      }
+      INT32 shift = 0;
+      while ((1U << shift) < size) {
+          shift++;
+      }
+      return shift;
+  }
+
+  UINT32 RowBucket(UINT32 row_val) const {
+      return (rowShift >= 0) ? (row_val >> rowShift) : (row_val / rowSize);
+  }
+
+  UINT32 ColBucket(UINT32 col_val) const {
+      return (colShift >= 0) ? (col_val >> colShift) : (col_val / colSize);
+  }
+
+  //
+  // Return row 'row' for writing, allocating and zeroing it on first use.
+  //
+  UINT64 *WriteRow(UINT32 row) {
+      UINT64 *data = histData[row];
+      if (data == NULL) {
+          data = new UINT64[numCols];
+          for (UINT32 j = 0; j < numCols; j++) {
+              data[j] = 0;
+          }
+          histData[row] = data;
+      }
+      return data;
+  }
+
+  //
+  // Forget the counts of row 'row'.
+  //
+  void DropRow(UINT32 row) {
+      if (histBlock != NULL) {
+          memset(histData[row], 0, numCols * sizeof(UINT64));
+      }
+      else if (histData[row] != NULL) {
+          delete [] histData[row];
+          histData[row] = NULL;
+      }
+  }
+
+  //
+  // Does row 'row' hold any non-zero bucket?
+  //
+  bool RowInUse(UINT32 row) const {
+      const UINT64 *data = histData[row];
+      if (data != NULL) {
+          for (UINT32 j = 0; j < numCols; j++) {
+              if (data[j] != 0) {
+                  return true;
               }
           }
       }
+      return false;
   }
  public:
   //
@@ -550,6 +645,9 @@ class HISTOGRAM_TEMPLATE {
   const HISTOGRAM_TEMPLATE &operator=(const HISTOGRAM_TEMPLATE &save) {
 
       if (enabled == true) {
+          FlushEvents();
+          save.FlushEvents();
+
           // 
           // They two classes must have the same
           // size histogram, or the new class has to have a NULL
@@ -574,21 +672,19 @@ class HISTOGRAM_TEMPLATE {
               //
               // We're copying to a uninitialized instance of HISTOGRAM.
               // 
-              histData = new UINT64*[save.numRows];
               ASSERT (total == NULL, this->Name());
               ASSERT (accumulated == NULL, this->Name());
               total = new UINT64[save.numCols];
               accumulated = new UINT64[save.numCols];
               
-              for (i = 0; i < save.numRows; i++) {
-                  histData[i] = new UINT64[save.numCols];
-              }
-              
               numRows = save.numRows;
               maxRowsUsed = save.maxRowsUsed;
               numCols = save.numCols;
+              AllocateRows();
               rowSize = save.rowSize;
               colSize = save.colSize;
+              rowShift = save.rowShift;
+              colShift = save.colShift;
               maxRowVal = save.maxRowVal;
               maxColVal = save.maxColVal;
               rowFlexcap = save.rowFlexcap;
@@ -650,11 +746,24 @@ class HISTOGRAM_TEMPLATE {
           //    cout << flush;
           //
           // Copy data which changes while the stats are not being
-          // collected.  
+          // collected.  Rows that were never written in 'save' are
+          // only zeroed here if we already allocated them.
           //
-          for (i = 0; i < numRows; i++) {
-              for (j = 0; j < numCols; j++) {
-                  histData[i][j] = save.histData[i][j];
+          if (histBlock != NULL && save.histBlock != NULL) {
+              memcpy(histBlock, save.histBlock,
+                     numRows * numCols * sizeof(UINT64));
+          }
+          else for (i = 0; i < numRows; i++) {
+              if (save.histData[i] != NULL) {
+                  UINT64 *data = WriteRow(i);
+                  for (j = 0; j < numCols; j++) {
+                      data[j] = save.histData[i][j];
+                  }
+              }
+              else if (histData[i] != NULL) {
+                  for (j = 0; j < numCols; j++) {
+                      histData[i][j] = 0;
+                  }
               }
           }
           
@@ -692,10 +801,16 @@ class HISTOGRAM_TEMPLATE {
   // method because it's faster. 
   //
   void AddEvent(UINT32 row_val, UINT32 col_val = 0, UINT64 value = 1) {
-      if (enabled == true) {
-          // Profiling showed updating histogram entries to be slow.  Prefetch.
-          __builtin_prefetch(&histData[row_val][col_val], 1, 1);
+      AddEvents(row_val, col_val, value, 1);
+  }
 
+ protected:
+  //
+  // Same as 'samples' calls of AddEvent(row_val, col_val) whose values
+  // add up to 'value'.
+  //
+  void AddEvents(UINT32 row_val, UINT32 col_val, UINT64 value, UINT64 samples) {
+      if (enabled == true) {
           ASSERT ((rowSize == 1) && (colSize == 1), this->Name());
           if (row_val >= numRows) {
               ASSERT (rowFlexcap == true, this->Name());
@@ -710,10 +825,18 @@ class HISTOGRAM_TEMPLATE {
               col_val = numCols - 1;
           }
           total[col_val] += value;
-          accumulated[col_val] += row_val;
-          histData[row_val][col_val] += value;
+          accumulated[col_val] += row_val * samples;
+          WriteRow(row_val)[col_val] += value;
       }
   }
+
+  //
+  // Derived classes that buffer events add them to the histogram here.
+  // Called before the counters are read, copied, cleared or saved.
+  //
+  virtual void FlushEvents() const {}
+
+ public:
     
   //
   // DON'T USE THIS METHOD UNLESS YOU HAVE NON-UNIT SIZE ROWS AND
@@ -722,16 +845,8 @@ class HISTOGRAM_TEMPLATE {
   //
   void AddEventWideBins(UINT32 row_val, UINT32 col_val = 0, UINT64 value = 1) {
       if (enabled == true) {
-          INT32 row_number = row_val;
-          INT32 col_number = col_val;
-          
-          if (rowSize != 1) {
-              row_number = (INT32)(floor((double)(row_number)/(double)(rowSize)));
-          }
-          
-          if (colSize != 1) {
-              col_number = (INT32)(floor((double)(col_number)/(double)(colSize)));
-          }
+          INT32 row_number = RowBucket(row_val);
+          INT32 col_number = ColBucket(col_val);
           
           if (row_number >= INT32(numRows)) {
               if (rowFlexcap == true) {
@@ -755,9 +870,9 @@ class HISTOGRAM_TEMPLATE {
               }
           }
           
-          histData[row_number][col_number] += value;
+          WriteRow(row_number)[col_number] += value;
           total[col_number] += value;
-          accumulated[col_val] += row_val;
+          accumulated[col_number] += row_val;
       }
   }
 
@@ -802,6 +917,8 @@ class HISTOGRAM_TEMPLATE {
   //
   virtual void Dump(STATE_OUT stateOut) {
       if (enabled == true) {
+          FlushEvents();
+
           ostringstream os;
           
           UINT32 i;
@@ -888,11 +1005,13 @@ class HISTOGRAM_TEMPLATE {
               UINT32 min_size = 0;
               UINT32 max_size = rowSize - 1;
               for (i = 0; i < nActualRows; i++) {
-                  os.str(""); // clear
-                  os << min_size << "-" << max_size;
+                  if (RowInUse(i)) {
+                      os.str(""); // clear
+                      os << min_size << "-" << max_size;
                   
-                  stateOut->AddVector("row", os.str().c_str(), NULL,
-                                      & histData[i][0], & histData[i][numCols]);
+                      stateOut->AddSparseVector("row", os.str().c_str(), NULL,
+                                                & histData[i][0], & histData[i][numCols]);
+                  }
                   
                   min_size = max_size + 1;
                   max_size = min_size + rowSize - 1;
@@ -905,6 +1024,9 @@ class HISTOGRAM_TEMPLATE {
               //
               if (rowNames != NULL) {
                   for (i = 0; i < nActualRows; i++) {
+                      if ( ! RowInUse(i)) {
+                          continue;
+                      }
                       const char *name = rowNames[i];
                       if (name == NULL)
                       {
@@ -916,8 +1038,8 @@ class HISTOGRAM_TEMPLATE {
                           name = os.str().c_str();
                       }
 
-                      stateOut->AddVector("row", name, NULL,
-                                          & histData[i][0], & histData[i][numCols]);
+                      stateOut->AddSparseVector("row", name, NULL,
+                                                & histData[i][0], & histData[i][numCols]);
                   }
               }
               
@@ -926,11 +1048,14 @@ class HISTOGRAM_TEMPLATE {
               //
               else {
                   for (i = 0; i < nActualRows; i++) {
+                      if ( ! RowInUse(i)) {
+                          continue;
+                      }
                       os.str(""); // clear
                       os << i;
                       
-                      stateOut->AddVector("row", os.str().c_str(), NULL,
-                                          & histData[i][0], & histData[i][numCols]);
+                      stateOut->AddSparseVector("row", os.str().c_str(), NULL,
+                                                & histData[i][0], & histData[i][numCols]);
                   }
               }
           }
@@ -938,11 +1063,62 @@ class HISTOGRAM_TEMPLATE {
       }
   }
   
+  //
+  // Write the counters to a checkpoint or read them back.  The shape,
+  // names and flags belong to the model and are not saved, so a
+  // histogram that changed shape is not restored (returns false).
+  //
+  void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const {
+      UINT32 rows = enabled ? numRows : 0;
+      UINT32 cols = enabled ? numCols : 0;
+      ckpt->WriteUINT64(rows);
+      ckpt->WriteUINT64(cols);
+      if (rows == 0 || cols == 0) {
+          return;
+      }
+      FlushEvents();
+      ckpt->WriteUINT64(maxRowsUsed);
+      for (UINT32 i = 0; i < rows; i++) {
+          ckpt->WriteBool(RowInUse(i));
+          if (RowInUse(i)) {
+              ckpt->WriteBytes(histData[i], cols * sizeof(UINT64));
+          }
+      }
+      ckpt->WriteBytes(total, cols * sizeof(UINT64));
+      ckpt->WriteBytes(accumulated, cols * sizeof(UINT64));
+  }
+
+  bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt) {
+      UINT64 rows = ckpt->ReadUINT64();
+      UINT64 cols = ckpt->ReadUINT64();
+      if (rows != (enabled ? numRows : 0) || cols != (enabled ? numCols : 0)) {
+          return false;
+      }
+      if (rows == 0 || cols == 0) {
+          return true;
+      }
+      FlushEvents();
+      maxRowsUsed = ckpt->ReadUINT64();
+      for (UINT32 i = 0; i < rows; i++) {
+          if (ckpt->ReadBool()) {
+              ckpt->ReadBytes(WriteRow(i), cols * sizeof(UINT64));
+          }
+          else {
+              DropRow(i);
+          }
+      }
+      ckpt->ReadBytes(total, cols * sizeof(UINT64));
+      ckpt->ReadBytes(accumulated, cols * sizeof(UINT64));
+      return true;
+  }
+
   //
   // Clear information about the histogram. 
   //
   virtual void ClearValues() {
       if (enabled == true) {          
+          FlushEvents();
+
           UINT32 i, j;
           UINT64 count = 0;
           UINT32 nActualRows = numRows;
@@ -966,8 +1142,10 @@ class HISTOGRAM_TEMPLATE {
           }
           
           for (i = 0; i < nActualRows; i++) {
-              for(j = 0; j < numCols; ++j)
-                 histData[i][j] = 0;
+              if (histData[i] != NULL) {
+                  for(j = 0; j < numCols; ++j)
+                     histData[i][j] = 0;
+              }
           }
       }
   }
@@ -976,16 +1154,10 @@ class HISTOGRAM_TEMPLATE {
     // Return the value of an element at a given row/col
     //
     UINT32 GetValue (UINT32 row_val, UINT32 col_val = 0) {
-        INT32 row_number = row_val;
-        INT32 col_number = col_val;
-          
-        if (rowSize != 1) {
-            row_number = (INT32)(floor((double)(row_number)/(double)(rowSize)));
-        }
-        
-        if (colSize != 1) {
-            col_number = (INT32)(floor((double)(col_number)/(double)(colSize)));
-        }
+        FlushEvents();
+
+        INT32 row_number = RowBucket(row_val);
+        INT32 col_number = ColBucket(col_val);
         
         if (row_number >= INT32(numRows)) {
             if (rowFlexcap == true) {
@@ -1004,6 +1176,9 @@ class HISTOGRAM_TEMPLATE {
                 VERIFY(false, "Exceeding number of cols of histogram");
             }
         }
+        if (histData[row_number] == NULL) {
+            return 0;
+        }
         return (histData[row_number][col_number]);
     }
     
@@ -1011,6 +1186,25 @@ class HISTOGRAM_TEMPLATE {
  //
  // HISTOGRAM ACCESS METHODS
  //
+ public:
+  //
+  // Raw counters for clients that read the histogram directly.
+  // RowData returns NULL for a row that holds no counts.
+  //
+  UINT32 NumRows() const { return enabled ? numRows : 0; }
+  UINT32 NumCols() const { return enabled ? numCols : 0; }
+  UINT32 RowsUsed() const {
+      if (!enabled) {
+          return 0;
+      }
+      FlushEvents();
+      return maxRowsUsed;
+  }
+  const UINT64 *RowData(UINT32 row) const {
+      FlushEvents();
+      return RowInUse(row) ? histData[row] : NULL;
+  }
+
  protected:
   UINT32 MaxRowVal() const { return maxRowVal; }
 } ;
@@ -1039,6 +1233,12 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
   INT32 numEntries;        // Number of current entries in resource
   UINT64 lastModifiedCycle;// Last time number of entries was modified
 
+  // Occupancy samples not yet added to the histogram.  They all belong
+  // to row numEntries, so they are added in one go when numEntries
+  // changes or the histogram is read.
+  mutable UINT64 pendingCycles;
+  mutable UINT64 pendingSamples;
+
  public:
   RESOURCE_TEMPLATE () : HISTOGRAM_TEMPLATE<E>() {
       if (this->enabled == true) {
@@ -1051,6 +1251,8 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
           hwmEnabledCycles = 0;
           numEntries = 0;
           lastModifiedCycle = 0;
+          pendingCycles = 0;
+          pendingSamples = 0;
       }
   }
 
@@ -1066,6 +1268,8 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
           hwmEnabledCycles = 0;
           numEntries = 0;
           lastModifiedCycle = 0;
+          pendingCycles = 0;
+          pendingSamples = 0;
       }
   }
 
@@ -1170,6 +1374,27 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
 
  private:
 
+  //
+  // Record that the resource held numEntries entries for 'cycles' cycles.
+  //
+  void Sample(UINT64 cycles) {
+      pendingCycles += cycles;
+      pendingSamples++;
+  }
+
+ protected:
+  void FlushEvents() const {
+      if (pendingSamples != 0) {
+          // the samples already count as part of the histogram
+          const_cast<RESOURCE_TEMPLATE *>(this)->AddEvents(numEntries, 0,
+                                                           pendingCycles,
+                                                           pendingSamples);
+          pendingCycles = 0;
+          pendingSamples = 0;
+      }
+  }
+
+ private:
   //
   // This method is called once for every request which is added or subracted
   // from the resource.  It may be called multiple times per cycle. 
@@ -1182,9 +1407,10 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
 	// We're changing the status of the resource.  Therefore, update
 	// the occupancy histogram with existing information.
 	//
-	this->AddEvent(numEntries, 0, (cycle - lastModifiedCycle));
+	Sample(cycle - lastModifiedCycle);
 	lastModifiedCycle = cycle;
       }
+      FlushEvents();
       // Update the number of entries, depending on whether we're adding or
       // deleting requests 
       if (add_req == true) {
@@ -1205,7 +1431,10 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
   void ModifyResource(UINT64 cycle, UINT32 num_requests, bool add_req) {
     if (this->enabled == true) {
       ASSERT (lastModifiedCycle < cycle, this->Name());
-      this->AddEvent(numEntries, 0, (cycle - lastModifiedCycle));
+      Sample(cycle - lastModifiedCycle);
+      if (num_requests != 0) {
+        FlushEvents();
+      }
       if (add_req == true) {
 	numEntries += num_requests;
 	ASSERT (numEntries <= INT32(this->MaxRowVal()), this->Name());
@@ -1245,16 +1474,55 @@ class RESOURCE_TEMPLATE : public HISTOGRAM_TEMPLATE<E> {
     }
   }
 
+  //
+  // Usually called every cycle.  While the occupancy stays the same the
+  // samples are only counted; they reach the histogram when it changes.
+  //
   void CurrentEntries(UINT64 cycle, UINT32 cur_entries) {
     if (this->enabled == true) {
       ASSERT (lastModifiedCycle <= cycle, this->Name());
-      this->AddEvent(numEntries, 0, (cycle - lastModifiedCycle));
+      Sample(cycle - lastModifiedCycle);
+      if (INT32(cur_entries) != numEntries) {
+        FlushEvents();
+      }
       numEntries = cur_entries;
       ASSERT (numEntries <= INT32(this->MaxRowVal()), this->Name());
       lastModifiedCycle = cycle;
     }
   }
 
+  //
+  // Checkpoint the histogram and the occupancy and nack counters.
+  //
+  void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const {
+      HISTOGRAM_TEMPLATE<E>::SaveCheckpoint(ckpt);
+      if (this->enabled == true) {
+          ckpt->WriteUINT64(numNacks);
+          ckpt->WriteUINT64(numRequestsNacked);
+          ckpt->WriteUINT64(lastCycleNacked);
+          ckpt->WriteUINT64(hwmEnableTime);
+          ckpt->WriteUINT64(hwmEnabledCycles);
+          ckpt->WriteINT64(numEntries);
+          ckpt->WriteUINT64(lastModifiedCycle);
+      }
+  }
+
+  bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt) {
+      if (!HISTOGRAM_TEMPLATE<E>::RestoreCheckpoint(ckpt)) {
+          return false;
+      }
+      if (this->enabled == true) {
+          numNacks = ckpt->ReadUINT64();
+          numRequestsNacked = ckpt->ReadUINT64();
+          lastCycleNacked = ckpt->ReadUINT64();
+          hwmEnableTime = ckpt->ReadUINT64();
+          hwmEnabledCycles = ckpt->ReadUINT64();
+          numEntries = ckpt->ReadINT64();
+          lastModifiedCycle = ckpt->ReadUINT64();
+      }
+      return true;
+  }
+
   // Print information about this resource. 
   //
   void Dump(STATE_OUT stateOut) {
@@ -1421,6 +1689,12 @@ class THREE_DIM_HISTOGRAM_TEMPLATE {
     return *this;
   }
 
+  //
+  // Access to the individual histograms.
+  //
+  UINT32 NumHist() const { return this->enabled ? numHist : 0; }
+  const HISTOGRAM_TEMPLATE<E> &Hist(UINT32 i) const { return histArray[i]; }
+
   void AddEventWideBins(UINT32 array_loc, UINT32 row_number,
 		UINT32 col = 0, UINT64 value = 1) {
     if (this->enabled == true) {
@@ -1449,6 +1723,27 @@ class THREE_DIM_HISTOGRAM_TEMPLATE {
     }
   }
   
+  void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const {
+    UINT32 n = this->enabled ? numHist : 0;
+    ckpt->WriteUINT64(n);
+    for (UINT32 i = 0; i < n; i++) {
+      histArray[i].SaveCheckpoint(ckpt);
+    }
+  }
+
+  bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt) {
+    UINT64 n = ckpt->ReadUINT64();
+    if (n != (this->enabled ? numHist : 0)) {
+      return false;
+    }
+    for (UINT32 i = 0; i < n; i++) {
+      if (!histArray[i].RestoreCheckpoint(ckpt)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   void ClearValues() {
     if (this->enabled == true) {
       UINT32 i;
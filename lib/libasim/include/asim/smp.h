@@ -43,6 +43,7 @@
 
 #include "asim/atomic.h"
 #include <pthread.h>
+#include <vector>
 
 
 //
@@ -153,6 +154,14 @@ class ASIM_SMP_CLASS
         return ASIM_SMP_THREAD_HANDLE_CLASS::threadUidGen;
     };
 
+    //
+    // Host threads that run no model code, such as the strip chart writer
+    // or the Tarati server thread.  They are not counted as running threads.
+    //
+    static void NoteHelperThreadStarted(void) { helperThreads++; };
+    static void NoteHelperThreadStopped(void) { helperThreads--; };
+    static UINT32 GetRunningHelperThreads(void) { return helperThreads; };
+
     static INT32 GetRunningThreadNumber(void)
     {
 #if MAX_PTHREADS == 1
@@ -180,7 +189,30 @@ class ASIM_SMP_CLASS
         return ASIM_SMP_THREAD_HANDLE_CLASS::threadUidGen - 1;
     };
 
+    //
+    // Host placement.  SetCpuMap() takes a list of host cpus such as
+    // "0-7,16-23".  Running thread number N is pinned to entry N (modulo
+    // the list length) when it starts, so that it stays on one core and
+    // everything it allocates is first touched on that core's NUMA node.
+    // The calling thread is pinned immediately.  An empty or NULL list
+    // turns placement off.
+    //
+    static void SetCpuMap(const char *cpuList);
+
+    static bool PlacementEnabled(void) { return ! cpuMap.empty(); };
+
+    // Host cpu / NUMA node chosen for a running thread number, -1 if none
+    static INT32 GetThreadCpu(INT32 threadNumber);
+    static INT32 GetThreadNode(INT32 threadNumber);
+
+    // NUMA node of a host cpu, -1 if unknown
+    static INT32 GetCpuNode(INT32 cpu);
+
   private:
+    static void PinCurrentThread(void);
+
+    static std::vector<INT32> cpuMap;
+
     static ASIM_SMP_THREAD_HANDLE mainThread;
 
     static pthread_key_t threadLocalKey;
@@ -189,6 +221,7 @@ class ASIM_SMP_CLASS
 
     static UINT32 maxThreads;
     static ATOMIC32_CLASS activeThreads;
+    static ATOMIC32_CLASS helperThreads;
 };
 
 #endif
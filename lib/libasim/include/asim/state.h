@@ -592,6 +592,83 @@ class ASIM_STATE_CLASS
             }
         }
 
+        /*
+         * Write the state's value to a checkpoint, or read it back. While
+         * the state is suspended the value it will report is the one in
+         * 'save', so that is the one checkpointed and restored. Restore
+         * returns false if the state changed shape since it was saved.
+         */
+        void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt) const
+        {
+            ckpt->WriteUINT64(type);
+            ckpt->WriteUINT64(size);
+            if (type == STATE_UINT)
+            {
+                ckpt->WriteBytes(suspended ? save : u.iPtr, saveSz);
+            }
+            else if (type == STATE_FP)
+            {
+                ckpt->WriteBytes(suspended ? save : u.fPtr, saveSz);
+            }
+            else if (type == STATE_STRING)
+            {
+                ckpt->WriteString(suspended ? *((string *)save) : *(u.sPtr));
+            }
+            else if (type == STATE_HISTOGRAM)
+            {
+                (suspended ? (HISTOGRAM_TEMPLATE<true> *)save : u.hPtr)->SaveCheckpoint(ckpt);
+            }
+            else if (type == STATE_THREE_DIM_HISTOGRAM)
+            {
+                (suspended ? (THREE_DIM_HISTOGRAM_TEMPLATE<true> *)save : u.tdhPtr)->SaveCheckpoint(ckpt);
+            }
+            else if (type == STATE_RESOURCE)
+            {
+                (suspended ? (RESOURCE_TEMPLATE<true> *)save : u.rPtr)->SaveCheckpoint(ckpt);
+            }
+            else
+            {
+                ASSERTX(false);
+            }
+        }
+
+        bool RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+        {
+            if ((ckpt->ReadUINT64() != (UINT64)type) || (ckpt->ReadUINT64() != size))
+            {
+                return false;
+            }
+            if (type == STATE_UINT)
+            {
+                ckpt->ReadBytes(suspended ? save : u.iPtr, saveSz);
+            }
+            else if (type == STATE_FP)
+            {
+                ckpt->ReadBytes(suspended ? save : u.fPtr, saveSz);
+            }
+            else if (type == STATE_STRING)
+            {
+                (suspended ? *((string *)save) : *(u.sPtr)) = ckpt->ReadString();
+            }
+            else if (type == STATE_HISTOGRAM)
+            {
+                return (suspended ? (HISTOGRAM_TEMPLATE<true> *)save : u.hPtr)->RestoreCheckpoint(ckpt);
+            }
+            else if (type == STATE_THREE_DIM_HISTOGRAM)
+            {
+                return (suspended ? (THREE_DIM_HISTOGRAM_TEMPLATE<true> *)save : u.tdhPtr)->RestoreCheckpoint(ckpt);
+            }
+            else if (type == STATE_RESOURCE)
+            {
+                return (suspended ? (RESOURCE_TEMPLATE<true> *)save : u.rPtr)->RestoreCheckpoint(ckpt);
+            }
+            else
+            {
+                ASSERTX(false);
+            }
+            return true;
+        }
+
         /*
           * Return the state's value as either an integer or a float.
           * For an array state, we add all the entries and return that value.
@@ -626,6 +703,21 @@ class ASIM_STATE_CLASS
             ASSERTX(el < size);
             return((type == STATE_UINT) ? (double)(u.iPtr[el]) : (u.fPtr[el]));
         }
+
+        /*
+         * Return the histogram of a STATE_HISTOGRAM or STATE_RESOURCE
+         * state, or the histograms of a STATE_THREE_DIM_HISTOGRAM state.
+         * NULL if the state is of another type.
+         */
+        const HISTOGRAM_TEMPLATE<true> * HistValue (void) const
+        {
+            return((type == STATE_HISTOGRAM) ? u.hPtr :
+                   (type == STATE_RESOURCE) ? u.rPtr : NULL);
+        }
+        const THREE_DIM_HISTOGRAM_TEMPLATE<true> * ThreeDimHistValue (void) const
+        {
+            return((type == STATE_THREE_DIM_HISTOGRAM) ? u.tdhPtr : NULL);
+        }
         
 };
 
@@ -113,6 +113,11 @@ typedef class STATE_OUT_CLASS *STATE_OUT;
  *       as there are elements in the vector.
  *   </dd>    
  * </dl>
+ * A mostly zero vector can be written in sparse form instead. The
+ * <vector> element then carries a <i>size</i> attribute with the full
+ * vector length, and only the non-zero values are listed, each
+ * <value> carrying an <i>index</i> attribute with its position in the
+ * vector. All values not listed are zero.
  *
  * @par <compound>
  * Description: A compound is a container for arbitrary collections.
@@ -148,6 +153,12 @@ class STATE_OUT_CLASS
     static const char * const elementDesc;
     /// @}
 
+    /// @name Constants for XML attribute names
+    /// @{
+    static const char * const attributeSize;
+    static const char * const attributeIndex;
+    /// @}
+
     // variables
     XMLOut * xmlStats;  ///< the XML output object for the stats
 
@@ -197,6 +208,12 @@ class STATE_OUT_CLASS
     AddVector (const char* type, const char* name, const char* desc,
                InputIterator first, InputIterator last);
 
+    /// Add a vector state to the output, in sparse form if mostly zero
+    template <class InputIterator>
+    void
+    AddSparseVector (const char* type, const char* name, const char* desc,
+                     InputIterator first, InputIterator last);
+
     /// Add arbitrary text to the output - use is <b>deprecated!</b>
     void
     AddText (const char* text);
@@ -266,5 +283,61 @@ STATE_OUT_CLASS::AddVector (
     xmlStats->CloseElement();
 }
 
+/**
+ * Add a vector element to the output, like AddVector, but list only
+ * the non-zero values with their index if fewer than half of the
+ * values are non-zero. Dense vectors are written exactly as AddVector
+ * writes them.
+ * @note Requirements:
+ * <ul>
+ * <li> InputIterator must allow two passes over the range.
+ * <li> Type needs an operator<< (ostream, Type) and compare with 0.
+ * </ul>
+ */
+template <class InputIterator>
+void
+STATE_OUT_CLASS::AddSparseVector (
+    const char* type,    ///< type of the scalar element
+    const char* name,    ///< name of the scalar element
+    const char* desc,    ///< description of the scalar element
+    InputIterator first, ///< iterator for first element
+    InputIterator last)  ///< iterator past last element
+{
+    UINT64 size = 0;
+    UINT64 nonZero = 0;
+    for (InputIterator i = first; i != last; i++) {
+        size++;
+        if (*i != 0) {
+            nonZero++;
+        }
+    }
+
+    if (nonZero * 2 >= size) {
+        AddVector(type, name, desc, first, last);
+        return;
+    }
+
+    xmlStats->AddElement(elementVector);
+    ostringstream os;
+    os << size;
+    xmlStats->AddAttribute(attributeSize, os.str().c_str());
+    AddCommonInfo(type, name, desc);
+
+    // add the non-zero values only
+    for (UINT64 index = 0; first != last; first++, index++) {
+        if (*first != 0) {
+            xmlStats->AddElement(elementValue);
+            os.str("");
+            os << index;
+            xmlStats->AddAttribute(attributeIndex, os.str().c_str());
+            os.str("");
+            os << *first;
+            xmlStats->AddText(os.str().c_str());
+            xmlStats->CloseElement();
+        }
+    }
+    xmlStats->CloseElement();
+}
+
 
 #endif /* _STATE_OUT_ */
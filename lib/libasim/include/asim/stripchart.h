@@ -41,9 +41,12 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 // generic (C)
 #include <stdio.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 // ASIM core
 #include "asim/syntax.h"
@@ -53,14 +56,8 @@ using namespace std;
 /*
  * At this level CPU_THREADS isn't available. We define the number of
  * threads with an alternative define.
- *
- * Current stripchart code stores statically the different stripcharts
- * and I define a maximun of 100. If you need extra stripcharts you only
- * must change MAX_STRIP_CHART define.
- *
  */
 
-#define MAX_STRIP_CHART 4000
 #define THREADS 32
 
 /**
@@ -106,7 +103,7 @@ typedef class ASIM_STRIP_NODE_CLASS * ASIM_STRIP_NODE;
 class ASIM_STRIP_CHART_CLASS
 {
   private:
-    ASIM_STRIP_NODE_CLASS table[MAX_STRIP_CHART];   ///< ? documentation ?
+    vector<ASIM_STRIP_NODE_CLASS> table; ///< registered stripcharts
     UINT64 actives;           ///< Number of stripchart registered
     UINT64 general_frequency; ///< greatest common divisor of all frequencies
     ofstream out;             ///< output file
@@ -119,6 +116,31 @@ class ASIM_STRIP_CHART_CLASS
     UINT64 markers;
     UINT64 bytes_per_line;
 
+    //
+    // Records waiting for the writer thread.  Every record has the
+    // size of one line in the file: a head id followed by the cycle
+    // and one value per strip, or by a marker string padded to the
+    // same length.  Only the simulation thread adds records and only
+    // the writer removes them, so the two indices need no lock.
+    //
+    UINT64 *ring;
+    UINT64 ring_slots;
+    UINT64 record_bytes;
+    volatile UINT64 ring_head;  ///< next record to write to the file
+    volatile UINT64 ring_tail;  ///< next free record
+
+    pthread_t writer;
+    bool writer_running;
+    volatile bool writer_stop;
+    sem_t ring_ready;           ///< posted once per added record
+
+    UINT8 *NewRecord(void);
+    void PushRecord(void);
+    void StartWriter(void);
+    void StopWriter(void);
+    void WriteRecords(void);
+    static void *WriterMain(void *arg);
+
   protected:
     
   public:
@@ -133,6 +155,10 @@ class ASIM_STRIP_CHART_CLASS
     void Dump(const UINT64 cycle);
     void DumpRAWString(const string & str);
     void WriteCounters();
+
+    // Around fork(), which does not copy the writer thread
+    void PrepareFork(void);
+    void ForkedChild(void);
 };
 
 typedef class ASIM_STRIP_CHART_CLASS * ASIM_STRIP_CHART;
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Host time accounting for the threads of threaded clockservers.
+ **/
+
+#ifndef ASIM_THREAD_ACTIVITY_H
+#define ASIM_THREAD_ACTIVITY_H
+
+#include <time.h>
+#include <sched.h>
+
+#include "asim/syntax.h"
+#include "asim/smp.h"
+
+using namespace std;
+
+//
+// What a clockserver pthread is doing with its host time
+//
+enum ASIM_THREAD_ACTIVITY
+{
+    THREAD_ACTIVITY_WORK = 0,       // clocking modules or server bookkeeping
+    THREAD_ACTIVITY_SPIN,           // spinning while waiting for other threads
+    THREAD_ACTIVITY_YIELD,          // yielded or asleep while waiting
+    THREAD_ACTIVITY_LOCK,           // blocked on a clockserver lock
+    THREAD_ACTIVITY_NACTIVITIES
+};
+
+
+//
+// Each pthread of a threaded run claims one slot the first time it
+// switches activity; the clock server thread claims slot 0.  A thread
+// is always in exactly one activity, and Switch() charges the host time
+// since its previous switch to the activity it leaves, in the thread's
+// own slot.  Only the clock server thread touches the per-slot interval
+// arrays that feed the clockserver strip charts: once per cycle it adds
+// what each slot accumulated since its previous snapshot, and the strip
+// charts clear the arrays.  Accounting needs thread local storage and is
+// off unless enabled.
+//
+class ASIM_THREAD_ACTIVITY_CLASS
+{
+  public:
+    // Turn accounting on for up to nSlots pthreads, and fill the
+    // interval arrays if asked to
+    static void Enable(UINT32 nSlots, bool intervals = false);
+    static bool IsEnabled(void) { return enabled; }
+
+    // Make the calling thread switch activities, and return the activity
+    // it was in, so that it can switch back
+    static inline ASIM_THREAD_ACTIVITY Switch(ASIM_THREAD_ACTIVITY activity)
+    {
+        if (! enabled)
+        {
+            return activity;
+        }
+        return SwitchSlow(activity);
+    }
+
+    // Yield the processor, charging the time to THREAD_ACTIVITY_YIELD
+    static inline void Yield(void)
+    {
+        ASIM_THREAD_ACTIVITY prev = Switch(THREAD_ACTIVITY_YIELD);
+        sched_yield();
+        Switch(prev);
+    }
+
+    // Charge the current cycle to the slot whose work ended last since
+    // sinceNs, and bring the interval arrays up to date.  Only call this
+    // from the clock server thread.
+    static void CountCriticalPath(UINT64 sinceNs);
+
+    static UINT64 NowNs(void)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return UINT64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    // Accessors for the stats dump
+    static UINT32 GetNumSlots(void);
+    static UINT64 GetTime(UINT32 slot, ASIM_THREAD_ACTIVITY activity);
+    static UINT64 GetCriticalCycles(UINT32 slot);
+    static const char *ActivityName(ASIM_THREAD_ACTIVITY activity);
+
+    // Per-slot counts since the last strip chart dump, one array per
+    // activity plus one for the critical path, each GetNumSlots() long
+    static UINT64 *GetIntervalTime(ASIM_THREAD_ACTIVITY activity);
+    static UINT64 *GetIntervalCritical(void);
+
+  private:
+    static bool enabled;
+
+    static ASIM_THREAD_ACTIVITY SwitchSlow(ASIM_THREAD_ACTIVITY activity);
+};
+
+
+//
+// Switches the calling thread to an activity for the lifetime of the scope
+//
+class ASIM_THREAD_ACTIVITY_SCOPE
+{
+  private:
+    ASIM_THREAD_ACTIVITY prev;
+
+  public:
+    ASIM_THREAD_ACTIVITY_SCOPE(ASIM_THREAD_ACTIVITY activity)
+      : prev(ASIM_THREAD_ACTIVITY_CLASS::Switch(activity))
+    {}
+
+    ~ASIM_THREAD_ACTIVITY_SCOPE()
+    {
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(prev);
+    }
+};
+
+#endif // ASIM_THREAD_ACTIVITY_H
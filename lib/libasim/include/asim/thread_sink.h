@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Per-thread buffered trace and DRAL event output.
+ **/
+
+#ifndef ASIM_THREAD_SINK_H
+#define ASIM_THREAD_SINK_H
+
+#include <string>
+#include <sstream>
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+#include "asim/syntax.h"
+#include "asim/dralServerRecorder.h"
+
+using namespace std;
+
+//
+// A thread sink collects the trace lines and DRAL events that one worker
+// thread produces while the threaded clockserver is running, so that the
+// worker never touches the shared trace stream or DRAL file.  Output is
+// grouped into segments, one per step of each base cycle the worker
+// executes; the clockserver numbers the steps of a base cycle in the order
+// the sequential clockserver runs them (each domain's modules, then each
+// domain's write rate matchers).  At its barrier points the clockserver
+// calls Merge(), which writes the closed segments of all the sinks out in
+// (cycle, step, sink) order, each step preceded by its DRAL cycle marker
+// (see Marker()).  Automatically
+// assigned DRAL item ids come from one lane per thread (see Prepare()).
+// The result does not depend on how the threads happened to interleave.
+//
+typedef class ASIM_THREAD_SINK_CLASS *ASIM_THREAD_SINK;
+class ASIM_THREAD_SINK_CLASS
+{
+  public:
+    ASIM_THREAD_SINK_CLASS();
+    ~ASIM_THREAD_SINK_CLASS();
+
+    // Direct the calling thread's output to a sink, or back to the
+    // shared outputs if NULL.
+    static void Attach(ASIM_THREAD_SINK sink);
+    static ASIM_THREAD_SINK Current(void);
+
+    // Set up the DRAL server for the given sinks before their threads
+    // start: the thread attached to sinks[i] gets item id lane i + 1,
+    // and the calling thread lane 0.
+    static void Prepare(const vector<ASIM_THREAD_SINK> &sinks);
+
+    // Output of the calling thread from now on belongs to baseCycle
+    void BeginCycle(UINT64 baseCycle);
+
+    // Output of the calling thread from now on belongs to the given step
+    // of the current base cycle.  Steps only go up within a base cycle.
+    void SetStep(UINT32 step);
+
+    // Hand the output since BeginCycle() over to Merge()
+    void EndCycle(void);
+
+    // Buffer a trace line; called by TRACEABLE_CLASS::Trace()
+    void Trace(const std::ostringstream &out);
+
+    // Queue the DRAL cycle marker of a step of the base cycle passed to
+    // the next Merge().  Only call this from the clockserver thread.
+    static void Marker(UINT32 step, UINT16 clockId, UINT64 cycle, UINT16 phase);
+
+    // Write out the closed segments of all sinks up to and including
+    // baseCycle, and the queued markers.  Only call this from the
+    // clockserver thread.
+    static void Merge(const vector<ASIM_THREAD_SINK> &sinks, UINT64 baseCycle);
+
+  private:
+    struct SEGMENT
+    {
+        UINT64 cycle;
+        UINT32 step;
+        string trace;
+        DRAL_SERVER_RECORDER_CLASS dral;
+    };
+
+    struct MARKER
+    {
+        UINT32 step;
+        UINT16 clockId;
+        UINT64 cycle;
+        UINT16 phase;
+    };
+
+    SEGMENT *NewSegment(void);
+    static void WriteMarkers(UINT32 step);
+
+    static vector<MARKER> markers;  // queued by Marker(), in step order
+    static UINT32 nextMarker;       // first marker Merge() has not written
+
+    UINT32 itemIdLane;          // DRAL item id lane of the owning thread
+    SEGMENT *open;              // segment being filled by the owning thread
+    deque<SEGMENT *> closed;    // waiting for Merge(), in cycle order
+    vector<SEGMENT *> spare;    // recycled segments
+    pthread_mutex_t lock;       // protects closed and spare
+};
+
+#endif // ASIM_THREAD_SINK_H
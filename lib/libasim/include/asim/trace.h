@@ -32,12 +32,14 @@
 #define TRACE_H
 
 #include <list>
+#include <map>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <pthread.h>
 #include <asim/regexobj.h>
+#include <asim/thread_sink.h>
 
 // Include support for the old trace format.
 #include <asim/trace_legacy.h>
@@ -161,13 +163,24 @@ struct TRACEABLE_REGEX_CLASS
 {
     Regex *regex;
     int level;
-    TRACEABLE_REGEX_CLASS(Regex *r, int l) : regex(r), level(l)
+    // Literal text that every matching name starts with, compared
+    // without case. Empty if the pattern has no such prefix.
+    string prefix;
+    TRACEABLE_REGEX_CLASS(Regex *r, int l) :
+        regex(r), level(l), prefix(LiteralPrefix(r->getPattern()))
     {
     }
     ~TRACEABLE_REGEX_CLASS()
     {
         delete regex;
     }
+
+    // Does name match the regex?
+    bool Matches(const string &name);
+
+    // Extract the literal prefix of an anchored pattern. Patterns
+    // that are not anchored or use alternation return "".
+    static string LiteralPrefix(const string &pattern);
 };
 typedef list<TRACEABLE_REGEX> TRACEABLE_REGEX_LIST;
 
@@ -208,6 +221,31 @@ struct TRACEABLE_DELAYED_ACTION_CLASS
 
 class TRACEABLE_CLASS;
 typedef TRACEABLE_CLASS *TRACEABLE;
+
+// The traceable objects sharing one name, along with the trace state
+// that replaying the saved regular expressions gives that name. The
+// saved state lets objects that are named later skip the regexes.
+struct TRACEABLE_NAME_CLASS
+{
+    std::list<TRACEABLE> members;
+    // The regex generation the saved state was computed for. It is
+    // stale (and recomputed on demand) for any other generation.
+    unsigned int generation;
+    bool traceOn;
+    int level;
+    TRACEABLE_NAME_CLASS() : generation(0), traceOn(false), level(1)
+    {
+    }
+};
+
+// Order names without case first so that all names starting with a
+// given prefix, in any case, are adjacent.
+struct TRACEABLE_NAME_LESS
+{
+    bool operator()(const std::string &a, const std::string &b) const;
+};
+typedef std::map<std::string, TRACEABLE_NAME_CLASS, TRACEABLE_NAME_LESS> TRACEABLE_NAME_MAP;
+
 class TRACEABLE_CLASS
 {
     friend struct TRACEABLE_DELAYED_ACTION_CLASS;
@@ -233,23 +271,30 @@ class TRACEABLE_CLASS
     // The maximum traceLevel allowed.
     static const int maxTraceLevel = 2;
 
-    // Keep a list of all traceable objects.
-    static std::list<TRACEABLE> *traceables;
+    // Keep all traceable objects, grouped by objectName.
+    static TRACEABLE_NAME_MAP *traceables;
     static pthread_mutex_t traceablesMutex;
 
-    // An iterator pointing to the location of
-    // this traceable object in the traceables list.
+    // Iterators pointing to the name group of this traceable
+    // object and to its location in that group.
+    TRACEABLE_NAME_MAP::iterator myName;
     std::list<TRACEABLE>::iterator myTraceablesEntry;
 
     // The regular expressions in effect.
     static TRACEABLE_REGEX_LIST *regexes;
     static pthread_mutex_t regexesMutex;
 
+    // Bumped whenever the saved regexes are replaced rather than
+    // appended to, which makes every saved name state stale.
+    static unsigned int regexGeneration;
+
     // Compute the value of traceOnArr.
     void RecomputeTraceArr();
 
-    // Apply a regex to a trace object.
-    void EnableByRegex(Regex *regex, int level);
+    // Add this object to (remove it from) the group of its
+    // objectName. The caller holds traceablesMutex.
+    void AddToName();
+    void RemoveFromName();
 
     // Setting this to false will disable the thread safety features
     // of traceable.
@@ -300,6 +345,10 @@ class TRACEABLE_CLASS
     // Get output trace stream object
     static std::ostream* GetTraceStream() {return TRACEABLE_CLASS::traceStream;}
 
+    // Around fork(): the child must not write into the parent's trace
+    static void PrepareFork();
+    static void ForkedChild();
+
 protected:
     static bool EnableTraceByRegex(std::string regex, int level, bool saveRegex);
     static bool EnableTraceByRegex(Regex *regex, int level, bool saveRegex);
@@ -335,11 +384,6 @@ inline void TRACEABLE_CLASS::RecomputeTraceArr()
     }
 }
 
-inline void TRACEABLE_CLASS::SetObjectName(std::string _n)
-{
-    objectName = _n;
-}
-
 inline void TRACEABLE_CLASS::SetTraceLevel(int level)
 {
     assert(level <= maxTraceLevel);
@@ -356,6 +400,13 @@ inline void TRACEABLE_CLASS::SetTraceOn(bool enabled)
 inline void TRACEABLE_CLASS::Trace(std::ostringstream &out) const
 {
 #if MAX_PTHREADS > 1
+    // worker threads of the threaded clockserver buffer their output
+    ASIM_THREAD_SINK sink = ASIM_THREAD_SINK_CLASS::Current();
+    if (sink)
+    {
+        sink->Trace(out);
+        return;
+    }
     get_thread_safe_log(TRACEABLE_CLASS::traceStream).ts() << std::dec << pthread_self() << ": " <<  out.str() << endl;
 #else
     *(TRACEABLE_CLASS::traceStream) << out.str() << std::endl;
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Scalable barriers for the threaded clock servers.
+ **/
+
+#include <limits.h>
+#include <sched.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "asim/barrier.h"
+#include "asim/mesg.h"
+#include "asim/thread_activity.h"
+
+// fan-in of each node of the combining tree barrier
+#define ASIM_BARRIER_TREE_FANIN 4
+
+
+//
+// Sleeping and waking.  On Linux we sleep on the wait word itself using
+// a futex;  elsewhere we fall back to yielding the processor.
+//
+static inline void
+FutexWait(volatile UINT32 *addr, UINT32 expected)
+{
+#ifdef __linux__
+    ASIM_THREAD_ACTIVITY prev = ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_YIELD);
+    syscall(SYS_futex, (UINT32 *)addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(prev);
+#else
+    ASIM_THREAD_ACTIVITY_CLASS::Yield();
+#endif
+}
+
+static inline void
+FutexWakeAll(volatile UINT32 *addr)
+{
+#ifdef __linux__
+    syscall(SYS_futex, (UINT32 *)addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+
+//
+// ASIM_WAIT_WORD_CLASS
+//
+void
+ASIM_WAIT_WORD_CLASS::Wake()
+{
+    // the caller has already fenced the new value against this read
+    if (sleepers)
+    {
+        FutexWakeAll(&value);
+    }
+}
+
+void
+ASIM_WAIT_WORD_CLASS::Set(UINT32 v)
+{
+    value = v;
+    MemBarrier();
+    Wake();
+}
+
+void
+ASIM_WAIT_WORD_CLASS::Increment()
+{
+    __sync_fetch_and_add(&value, 1);
+    Wake();
+}
+
+void
+ASIM_WAIT_WORD_CLASS::WaitUntil(
+    UINT32 target,
+    ASIM_SPIN_BUDGET_CLASS & budget,
+    volatile bool * abort)
+{
+    if (Reached(value, target))
+    {
+        return;
+    }
+
+    // spin phase
+    for (UINT32 i = budget.Get(); i > 0; i--)
+    {
+        CpuPause();
+        if (Reached(value, target) || (abort && *abort))
+        {
+            budget.SpinWorked();
+            return;
+        }
+    }
+    budget.HadToSleep();
+
+    // sleep phase.  Registering as a sleeper is a full barrier, so either
+    // the writer sees us and wakes us, or we see its new value and don't
+    // sleep at all.
+    while (true)
+    {
+        __sync_fetch_and_add(&sleepers, 1);
+        UINT32 v = value;
+        bool done = Reached(v, target) || (abort && *abort);
+        if (! done)
+        {
+            FutexWait(&value, v);
+        }
+        __sync_fetch_and_sub(&sleepers, 1);
+        if (done)
+        {
+            return;
+        }
+    }
+}
+
+
+//
+// ASIM_BARRIER_CLASS
+//
+ASIM_BARRIER_CLASS::ASIM_BARRIER_CLASS(UINT32 n, UINT32 spinLimit)
+  : nThreads(n),
+    participants(n),
+    aborted(false)
+{
+    VERIFYX(n > 0);
+    for (UINT32 i = 0; i < n; i++)
+    {
+        participants[i].budget = ASIM_SPIN_BUDGET_CLASS(spinLimit);
+        participants[i].epoch  = 0;
+    }
+}
+
+void
+ASIM_BARRIER_CLASS::Abort()
+{
+    aborted = true;
+    MemBarrier();
+    WakeAll();
+}
+
+
+//
+// Central barrier.  Everybody decrements one counter;  the last one to
+// arrive resets it and publishes the episode number on the release word.
+//
+class ASIM_CENTRAL_BARRIER_CLASS : public ASIM_BARRIER_CLASS
+{
+  private:
+    volatile UINT32 count;
+    char pad[ASIM_BARRIER_LINE_SIZE - sizeof(UINT32)];
+    ASIM_WAIT_WORD_CLASS release;
+
+  protected:
+    void WakeAll() { release.Increment(); }
+
+  public:
+    ASIM_CENTRAL_BARRIER_CLASS(UINT32 n, UINT32 spinLimit)
+      : ASIM_BARRIER_CLASS(n, spinLimit),
+        count(n)
+    {}
+
+    bool Wait(UINT32 tid)
+    {
+        PARTICIPANT & p = participants[tid];
+        UINT32 episode = ++p.epoch;
+        if (__sync_sub_and_fetch(&count, 1) == 0)
+        {
+            count = nThreads;
+            MemBarrier();
+            release.Set(episode);
+        }
+        else
+        {
+            release.WaitUntil(episode, p.budget, &aborted);
+        }
+        return ! aborted;
+    }
+};
+
+
+//
+// Combining tree barrier.  Participants arrive at a leaf counter shared
+// with at most ASIM_BARRIER_TREE_FANIN-1 others;  the last one to arrive
+// at a node continues up to its parent, so no counter ever sees more than
+// FANIN arrivals.  The winner at the root releases everybody.
+//
+class ASIM_TREE_BARRIER_CLASS : public ASIM_BARRIER_CLASS
+{
+  private:
+    struct NODE
+    {
+        volatile UINT32 count;
+        UINT32 expected;
+        INT32 parent;
+        char pad[ASIM_BARRIER_LINE_SIZE - 3 * sizeof(UINT32)];
+    };
+
+    vector<NODE> nodes;
+    ASIM_WAIT_WORD_CLASS release;
+
+  protected:
+    void WakeAll() { release.Increment(); }
+
+  public:
+    ASIM_TREE_BARRIER_CLASS(UINT32 n, UINT32 spinLimit)
+      : ASIM_BARRIER_CLASS(n, spinLimit)
+    {
+        // build the tree one level at a time, leaves first
+        UINT32 first    = 0;
+        UINT32 children = n;
+        do
+        {
+            UINT32 width = (children + ASIM_BARRIER_TREE_FANIN - 1) / ASIM_BARRIER_TREE_FANIN;
+            for (UINT32 i = 0; i < width; i++)
+            {
+                NODE node;
+                UINT32 left = children - i * ASIM_BARRIER_TREE_FANIN;
+                node.expected = left < ASIM_BARRIER_TREE_FANIN ? left : ASIM_BARRIER_TREE_FANIN;
+                node.count    = node.expected;
+                node.parent   = -1;
+                nodes.push_back(node);
+            }
+            if (first != nodes.size() - width)
+            {
+                // link the previous level to this one
+                UINT32 level = nodes.size() - width;
+                for (UINT32 i = first; i < level; i++)
+                {
+                    nodes[i].parent = level + (i - first) / ASIM_BARRIER_TREE_FANIN;
+                }
+                first = level;
+            }
+            children = width;
+        }
+        while (children > 1);
+    }
+
+    bool Wait(UINT32 tid)
+    {
+        PARTICIPANT & p = participants[tid];
+        UINT32 episode = ++p.epoch;
+        INT32 n = tid / ASIM_BARRIER_TREE_FANIN;
+        while (__sync_sub_and_fetch(&nodes[n].count, 1) == 0)
+        {
+            nodes[n].count = nodes[n].expected;
+            n = nodes[n].parent;
+            if (n < 0)
+            {
+                MemBarrier();
+                release.Set(episode);
+                return ! aborted;
+            }
+        }
+        release.WaitUntil(episode, p.budget, &aborted);
+        return ! aborted;
+    }
+};
+
+
+//
+// Dissemination barrier.  In round r participant i signals participant
+// (i + 2^r) mod N and waits for participant (i - 2^r) mod N.  After
+// ceil(log2 N) rounds everybody has heard from everybody, transitively.
+// Each flag has exactly one writer and one reader, and holds the episode
+// number rather than a sense bit, so flags never need resetting.
+//
+class ASIM_DISSEMINATION_BARRIER_CLASS : public ASIM_BARRIER_CLASS
+{
+  private:
+    UINT32 rounds;
+    vector<ASIM_WAIT_WORD_CLASS> flags;   // flags[tid * rounds + round]
+
+  protected:
+    void WakeAll()
+    {
+        for (UINT32 i = 0; i < flags.size(); i++)
+        {
+            flags[i].Increment();
+        }
+    }
+
+  public:
+    ASIM_DISSEMINATION_BARRIER_CLASS(UINT32 n, UINT32 spinLimit)
+      : ASIM_BARRIER_CLASS(n, spinLimit),
+        rounds(0)
+    {
+        while ((1U << rounds) < n)
+        {
+            rounds++;
+        }
+        flags.resize(n * rounds);
+    }
+
+    bool Wait(UINT32 tid)
+    {
+        PARTICIPANT & p = participants[tid];
+        UINT32 episode = ++p.epoch;
+        for (UINT32 r = 0; r < rounds; r++)
+        {
+            UINT32 partner = (tid + (1U << r)) % nThreads;
+            flags[partner * rounds + r].Set(episode);
+            flags[tid * rounds + r].WaitUntil(episode, p.budget, &aborted);
+            if (aborted)
+            {
+                return false;
+            }
+        }
+        return ! aborted;
+    }
+};
+
+
+ASIM_BARRIER
+ASIM_BARRIER_CLASS::Create(UINT32 type, UINT32 nThreads, UINT32 spinLimit)
+{
+    switch (type)
+    {
+      case BARRIER_CENTRAL:
+        return new ASIM_CENTRAL_BARRIER_CLASS(nThreads, spinLimit);
+      case BARRIER_TREE:
+        return new ASIM_TREE_BARRIER_CLASS(nThreads, spinLimit);
+      case BARRIER_DISSEMINATION:
+        return new ASIM_DISSEMINATION_BARRIER_CLASS(nThreads, spinLimit);
+      default:
+        ASIMERROR("Unknown barrier type " << type << endl);
+    }
+    return NULL;
+}
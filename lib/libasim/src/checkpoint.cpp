@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Binary checkpoint files of the simulator state.
+ **/
+
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "asim/checkpoint.h"
+#include "asim/module.h"
+#include "asim/port.h"
+#include "asim/clockable.h"
+
+
+//
+// File header.  rawSize is patched when the writer is closed.
+//
+#define ASIM_CHECKPOINT_MAGIC     "ASIMCKPT"
+#define ASIM_CHECKPOINT_VERSION   1
+#define ASIM_CHECKPOINT_DEFLATED  0x1
+
+struct ASIM_CHECKPOINT_HEADER
+{
+    char magic[8];
+    UINT32 version;
+    UINT32 flags;
+    UINT64 rawSize;
+};
+
+// zlib takes at most 4GB per call
+static const UINT64 CHECKPOINT_ZLIB_CHUNK = 1ULL << 30;
+
+static const UINT32 CHECKPOINT_OUT_BUF = 256 * 1024;
+
+
+ASIM_CHECKPOINT_WRITER_CLASS::ASIM_CHECKPOINT_WRITER_CLASS(
+    const char *fileName,
+    bool compress)
+  : file(NULL),
+    stream(NULL),
+    ok(true),
+    inSection(false),
+    rawSize(0),
+    outBuf(NULL)
+{
+    file = fopen(fileName, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    ASIM_CHECKPOINT_HEADER header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ASIM_CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = ASIM_CHECKPOINT_VERSION;
+    header.flags = compress ? ASIM_CHECKPOINT_DEFLATED : 0;
+    ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    if (compress)
+    {
+        z_stream *zs = new z_stream;
+        memset(zs, 0, sizeof(*zs));
+        // favor speed: checkpoints are written in the middle of a run
+        VERIFY(deflateInit(zs, Z_BEST_SPEED) == Z_OK, "deflateInit failed");
+        stream = zs;
+        outBuf = new char[CHECKPOINT_OUT_BUF];
+    }
+}
+
+
+ASIM_CHECKPOINT_WRITER_CLASS::~ASIM_CHECKPOINT_WRITER_CLASS()
+{
+    Close();
+}
+
+
+void
+ASIM_CHECKPOINT_WRITER_CLASS::BeginSection(const string &name)
+{
+    ASSERT(!inSection, "Checkpoint section " << sectionName << " was not closed");
+    inSection = true;
+    sectionName = name;
+    section.clear();
+}
+
+
+void
+ASIM_CHECKPOINT_WRITER_CLASS::EndSection(void)
+{
+    ASSERTX(inSection);
+    inSection = false;
+
+    UINT32 nameLen = sectionName.size();
+    UINT64 len = section.size();
+    Emit(&nameLen, sizeof(nameLen), false);
+    Emit(sectionName.data(), nameLen, false);
+    Emit(&len, sizeof(len), false);
+    Emit(section.data(), len, false);
+    rawSize += sizeof(nameLen) + nameLen + sizeof(len) + len;
+
+    section.clear();
+}
+
+
+//
+// Write raw bytes to the file, deflating them if compressing.  finish
+// flushes the deflate stream.
+//
+void
+ASIM_CHECKPOINT_WRITER_CLASS::Emit(const void *data, UINT64 len, bool finish)
+{
+    if (file == NULL)
+    {
+        return;
+    }
+
+    if (stream == NULL)
+    {
+        if (len > 0)
+        {
+            ok = ok && (fwrite(data, len, 1, file) == 1);
+        }
+        return;
+    }
+
+    z_stream *zs = (z_stream *)stream;
+    const char *next = (const char *)data;
+    do
+    {
+        UINT64 chunk = (len < CHECKPOINT_ZLIB_CHUNK) ? len : CHECKPOINT_ZLIB_CHUNK;
+        bool last = (chunk == len);
+        zs->next_in = (Bytef *)next;
+        zs->avail_in = chunk;
+        next += chunk;
+        len -= chunk;
+
+        int flush = (finish && last) ? Z_FINISH : Z_NO_FLUSH;
+        int rc;
+        do
+        {
+            zs->next_out = (Bytef *)outBuf;
+            zs->avail_out = CHECKPOINT_OUT_BUF;
+            rc = deflate(zs, flush);
+            VERIFY(rc != Z_STREAM_ERROR, "deflate failed");
+            UINT32 have = CHECKPOINT_OUT_BUF - zs->avail_out;
+            if (have > 0)
+            {
+                ok = ok && (fwrite(outBuf, have, 1, file) == 1);
+            }
+        }
+        while (zs->avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+    }
+    while (len > 0);
+}
+
+
+bool
+ASIM_CHECKPOINT_WRITER_CLASS::Close(void)
+{
+    if (file == NULL)
+    {
+        return ok;
+    }
+    ASSERT(!inSection, "Checkpoint section " << sectionName << " was not closed");
+
+    if (stream != NULL)
+    {
+        Emit(NULL, 0, true);
+        deflateEnd((z_stream *)stream);
+        delete (z_stream *)stream;
+        stream = NULL;
+        delete [] outBuf;
+        outBuf = NULL;
+    }
+
+    ok = ok && (fseek(file, offsetof(ASIM_CHECKPOINT_HEADER, rawSize), SEEK_SET) == 0);
+    ok = ok && (fwrite(&rawSize, sizeof(rawSize), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    file = NULL;
+
+    return ok;
+}
+
+
+ASIM_CHECKPOINT_READER_CLASS::ASIM_CHECKPOINT_READER_CLASS(const char *fileName)
+  : data(NULL),
+    fileMap(NULL),
+    fileMapSize(0),
+    rawMap(NULL),
+    rawMapSize(0),
+    pos(0),
+    end(0)
+{
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((UINT64)st.st_size < sizeof(ASIM_CHECKPOINT_HEADER)))
+    {
+        close(fd);
+        return;
+    }
+    fileMapSize = st.st_size;
+    fileMap = mmap(NULL, fileMapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (fileMap == MAP_FAILED)
+    {
+        fileMap = NULL;
+        return;
+    }
+
+    const ASIM_CHECKPOINT_HEADER *header = (const ASIM_CHECKPOINT_HEADER *)fileMap;
+    if (memcmp(header->magic, ASIM_CHECKPOINT_MAGIC, sizeof(header->magic)) ||
+        (header->version != ASIM_CHECKPOINT_VERSION))
+    {
+        ASIMWARNING(fileName << " is not a checkpoint of this version" << endl);
+        return;
+    }
+
+    UINT64 rawSize = header->rawSize;
+    const char *body = (const char *)fileMap + sizeof(ASIM_CHECKPOINT_HEADER);
+    UINT64 bodySize = fileMapSize - sizeof(ASIM_CHECKPOINT_HEADER);
+    static const char empty = 0;
+
+    if (rawSize == 0)
+    {
+        data = &empty;
+    }
+    else if (!(header->flags & ASIM_CHECKPOINT_DEFLATED))
+    {
+        if (bodySize < rawSize)
+        {
+            ASIMWARNING(fileName << " is truncated" << endl);
+            return;
+        }
+        data = body;
+    }
+    else
+    {
+        rawMapSize = rawSize;
+        rawMap = mmap(NULL, rawMapSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (rawMap == MAP_FAILED)
+        {
+            rawMap = NULL;
+            return;
+        }
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        VERIFY(inflateInit(&zs) == Z_OK, "inflateInit failed");
+        UINT64 inLeft = bodySize;
+        UINT64 outLeft = rawMapSize;
+        zs.next_in = (Bytef *)body;
+        zs.next_out = (Bytef *)rawMap;
+        int rc = Z_OK;
+        while (rc == Z_OK)
+        {
+            if (zs.avail_in == 0)
+            {
+                zs.avail_in = (inLeft < CHECKPOINT_ZLIB_CHUNK) ? inLeft : CHECKPOINT_ZLIB_CHUNK;
+                inLeft -= zs.avail_in;
+            }
+            if (zs.avail_out == 0)
+            {
+                zs.avail_out = (outLeft < CHECKPOINT_ZLIB_CHUNK) ? outLeft : CHECKPOINT_ZLIB_CHUNK;
+                outLeft -= zs.avail_out;
+            }
+            rc = inflate(&zs, Z_NO_FLUSH);
+            if ((rc == Z_BUF_ERROR) && (zs.avail_out == 0) && (outLeft > 0))
+            {
+                rc = Z_OK;
+            }
+        }
+        bool complete = (rc == Z_STREAM_END) && (zs.total_out == rawMapSize);
+        inflateEnd(&zs);
+
+        // the compressed file is not needed anymore
+        munmap(fileMap, fileMapSize);
+        fileMap = NULL;
+
+        if (!complete)
+        {
+            ASIMWARNING(fileName << " is corrupt" << endl);
+            return;
+        }
+        data = (const char *)rawMap;
+    }
+
+    //
+    // Index the sections
+    //
+    UINT64 off = 0;
+    while (off < rawSize)
+    {
+        UINT32 nameLen;
+        UINT64 len;
+        if (rawSize - off < sizeof(nameLen))
+        {
+            break;
+        }
+        memcpy(&nameLen, data + off, sizeof(nameLen));
+        off += sizeof(nameLen);
+        if (rawSize - off < nameLen + sizeof(len))
+        {
+            break;
+        }
+        string name(data + off, nameLen);
+        off += nameLen;
+        memcpy(&len, data + off, sizeof(len));
+        off += sizeof(len);
+        if (rawSize - off < len)
+        {
+            break;
+        }
+        sections[name] = make_pair(off, len);
+        off += len;
+    }
+
+    if (off != rawSize)
+    {
+        ASIMWARNING(fileName << " is corrupt" << endl);
+        data = NULL;
+    }
+}
+
+
+ASIM_CHECKPOINT_READER_CLASS::~ASIM_CHECKPOINT_READER_CLASS()
+{
+    if (fileMap != NULL)
+    {
+        munmap(fileMap, fileMapSize);
+    }
+    if (rawMap != NULL)
+    {
+        munmap(rawMap, rawMapSize);
+    }
+}
+
+
+bool
+ASIM_CHECKPOINT_READER_CLASS::OpenSection(const string &name)
+{
+    map<string, pair<UINT64, UINT64> >::const_iterator s = sections.find(name);
+    if ((data == NULL) || (s == sections.end()))
+    {
+        return false;
+    }
+
+    sectionName = name;
+    pos = s->second.first;
+    end = pos + s->second.second;
+    return true;
+}
+
+
+bool
+ASIM_CHECKPOINT_CLASS::Save(ASIM_MODULE root, const char *fileName, bool compress)
+{
+    ASIM_CHECKPOINT_WRITER_CLASS ckpt(fileName, compress);
+    if (!ckpt.IsOpen())
+    {
+        ASIMWARNING("Unable to create checkpoint " << fileName << endl);
+        return false;
+    }
+
+    ASIM_CLOCKABLE_CLASS::GetClockServer()->SaveCheckpoint(&ckpt);
+    root->SaveCheckpointTree(&ckpt);
+    UINT32 dropped = BasePort::SaveAllPorts(&ckpt);
+    if (dropped > 0)
+    {
+        ASIMWARNING("Checkpoint " << fileName << ": " << dropped
+                    << " ports hold data that cannot be checkpointed,"
+                    << " they will be restored empty" << endl);
+    }
+
+    if (!ckpt.Close())
+    {
+        ASIMWARNING("Error writing checkpoint " << fileName << endl);
+        return false;
+    }
+    return true;
+}
+
+
+bool
+ASIM_CHECKPOINT_CLASS::Restore(ASIM_MODULE root, const char *fileName)
+{
+    ASIM_CHECKPOINT_READER_CLASS ckpt(fileName);
+    if (!ckpt.IsOpen())
+    {
+        ASIMWARNING("Unable to read checkpoint " << fileName << endl);
+        return false;
+    }
+
+    if (!ASIM_CLOCKABLE_CLASS::GetClockServer()->RestoreCheckpoint(&ckpt))
+    {
+        return false;
+    }
+    root->RestoreCheckpointTree(&ckpt);
+    BasePort::RestoreAllPorts(&ckpt);
+    return true;
+}
@@ -44,6 +44,8 @@
 #include "asim/module.h"
 #include "asim/smp.h"
 #include "asim/rate_matcher.h"
+#include "asim/registry.h"
+#include "asim/thread_sink.h"
 
 
 /******************************************************************************
@@ -158,11 +160,13 @@ ASIM_CLOCK_SERVER_CLASS::ASIM_CLOCK_SERVER_CLASS()
       uniqueClockDomain(false),
       uniqueDomainOptimization(true),
       threaded(false),
+      threadedSinks(false),
       referenceClockRegitry(NULL),
       firstClockRegitry(NULL),
       firstClockRegitrySet(false),
       random_seed(0),
-      bDumpProfile(false)
+      bDumpProfile(false),
+      profileHz(997)
 {    
     SetTraceableName("ASIM_CLOCK_SERVER_CLASS");
 }
@@ -247,76 +251,274 @@ ASIM_CLOCK_SERVER_CLASS::DumpStats(STATE_OUT state_out, UINT64 total_base_cycles
                 (*iter_dom)->currentFrequency * 10);
         }
     }
+
+    // host placement of the server and worker threads, if they were pinned
+    if (ASIM_SMP_CLASS::PlacementEnabled())
+    {
+        state_out->AddScalar("int", "Thread_0_host_cpu",
+            "host cpu the clock server thread is pinned to",
+            ASIM_SMP_CLASS::GetThreadCpu(0));
+        state_out->AddScalar("int", "Thread_0_numa_node",
+            "NUMA node of the clock server thread's cpu",
+            ASIM_SMP_CLASS::GetThreadNode(0));
+
+        CLOCKSERVER_THREADS_ITERATOR iter_threads;
+        for (iter_threads = lThreads.begin(); iter_threads != lThreads.end(); ++iter_threads)
+        {
+            INT32 tnum = (*iter_threads)->GetAsimThreadHandle()->GetRunningThreadNumber();
+            if (tnum <= 0)
+            {
+                continue;
+            }
+
+            os.str("");
+            os << "Thread_" << tnum << "_host_cpu";
+            state_out->AddScalar("int", os.str().c_str(),
+                "host cpu this worker thread is pinned to",
+                ASIM_SMP_CLASS::GetThreadCpu(tnum));
+
+            os.str("");
+            os << "Thread_" << tnum << "_numa_node";
+            state_out->AddScalar("int", os.str().c_str(),
+                "NUMA node of this worker thread's cpu",
+                ASIM_SMP_CLASS::GetThreadNode(tnum));
+        }
+    }
+
+    // host time of each thread by activity; thread 0 is the server
+    if (ASIM_THREAD_ACTIVITY_CLASS::IsEnabled())
+    {
+        UINT32 nSlots = ASIM_THREAD_ACTIVITY_CLASS::GetNumSlots();
+        UINT64 maxWork = 0;
+        UINT64 sumWork = 0;
+        for (UINT32 slot = 0; slot < nSlots; slot++)
+        {
+            for (UINT32 a = 0; a < THREAD_ACTIVITY_NACTIVITIES; a++)
+            {
+                os.str("");
+                os << "Clockserver_thread_" << slot << "_"
+                   << ASIM_THREAD_ACTIVITY_CLASS::ActivityName(ASIM_THREAD_ACTIVITY(a))
+                   << "_ns";
+                state_out->AddScalar("uint", os.str().c_str(),
+                    "host time this clockserver thread spent in this activity",
+                    ASIM_THREAD_ACTIVITY_CLASS::GetTime(slot, ASIM_THREAD_ACTIVITY(a)));
+            }
+
+            os.str("");
+            os << "Clockserver_thread_" << slot << "_critical_path_cycles";
+            state_out->AddScalar("uint", os.str().c_str(),
+                "cycles in which this thread was the last one to finish its work",
+                ASIM_THREAD_ACTIVITY_CLASS::GetCriticalCycles(slot));
+
+            if (slot > 0)
+            {
+                UINT64 work = ASIM_THREAD_ACTIVITY_CLASS::GetTime(slot, THREAD_ACTIVITY_WORK);
+                maxWork = max(maxWork, work);
+                sumWork += work;
+            }
+        }
+
+        // 1.0 means perfectly balanced workers
+        state_out->AddScalar("double", "Clockserver_worker_load_imbalance",
+            "busiest worker's work time over the average worker's",
+            (nSlots > 1 && sumWork) ? double(maxWork) * (nSlots - 1) / sumWork : 1.0);
+    }
+
+    // where the host time went, if the host profiler ran
+    if (ASIM_HOST_PROFILER_CLASS::GetHz() > 0)
+    {
+        vector<ASIM_HOST_PROFILER_CLASS::SAMPLE> samples;
+        ASIM_HOST_PROFILER_CLASS::GetSamples(samples);
+
+        map<const void *, string> names;
+        GetProfileNames(names);
+
+        UINT64 total = 0;
+        vector<UINT64> perPhase(HOST_PROFILE_NPHASES, 0);
+        map<INT32, UINT64> perThread;
+        map<string, UINT64> perModule;
+        for (UINT32 i = 0; i < samples.size(); i++)
+        {
+            total += samples[i].count;
+            perPhase[samples[i].phase] += samples[i].count;
+            perThread[samples[i].thread] += samples[i].count;
+            if (samples[i].object && names.count(samples[i].object))
+            {
+                perModule[names[samples[i].object]] += samples[i].count;
+            }
+        }
+
+        state_out->AddScalar("uint", "Host_profile_sample_rate_Hz",
+            "host profiler sampling rate",
+            ASIM_HOST_PROFILER_CLASS::GetHz());
+        state_out->AddScalar("uint", "Host_profile_samples",
+            "host profiler samples taken",
+            total);
+        state_out->AddScalar("uint", "Host_profile_samples_dropped",
+            "host profiler samples that did not fit in its tables",
+            ASIM_HOST_PROFILER_CLASS::GetDropped());
+        state_out->AddScalar("double", "Host_profile_cpu_seconds",
+            "host cpu time the samples represent",
+            ASIM_HOST_PROFILER_CLASS::GetCpuSeconds());
+
+        for (UINT32 p = 0; p < HOST_PROFILE_NPHASES; p++)
+        {
+            os.str("");
+            os << "Host_profile_" <<
+                ASIM_HOST_PROFILER_CLASS::PhaseName(ASIM_HOST_PROFILE_PHASE(p)) << "_samples";
+            state_out->AddScalar("uint", os.str().c_str(),
+                "host profiler samples taken in this clockserver phase",
+                perPhase[p]);
+        }
+
+        map<INT32, UINT64>::iterator iter_thread;
+        for (iter_thread = perThread.begin(); iter_thread != perThread.end(); ++iter_thread)
+        {
+            os.str("");
+            os << "Host_profile_thread_" << iter_thread->first << "_samples";
+            state_out->AddScalar("uint", os.str().c_str(),
+                "host profiler samples taken in this thread",
+                iter_thread->second);
+        }
+
+        map<string, UINT64>::iterator iter_module;
+        for (iter_module = perModule.begin(); iter_module != perModule.end(); ++iter_module)
+        {
+            os.str("");
+            os << "Host_profile_module_" << iter_module->first << "_samples";
+            state_out->AddScalar("uint", os.str().c_str(),
+                "host profiler samples taken clocking this module",
+                iter_module->second);
+        }
+    }
 }
 
 
-/** 
- * Dumps all the profiling info for each ClockRegistry 
- * entry.
+/**
+ * Turn on host time accounting for the server and worker threads.
+ * Each activity, and the critical path thread, gets a strip chart
+ * with one entry per thread if stripInterval is nonzero.
  **/
-void ASIM_CLOCK_SERVER_CLASS::DumpProfile()
+void ASIM_CLOCK_SERVER_CLASS::InitThreadActivity(UINT64 stripInterval)
 {
-    
-#if defined(HOST_DUNIX) | defined(HOST_LINUX_X86)
+    if (ASIM_THREAD_ACTIVITY_CLASS::IsEnabled())
+    {
+        return;
+    }
 
-    if(bDumpProfile)
+    UINT32 nSlots = lThreads.size() + 1;
+    ASIM_THREAD_ACTIVITY_CLASS::Enable(nSlots, stripInterval != 0);
+
+    if (stripInterval)
     {
-        ofstream ofsProfiling("clockserver.profile");
-
-        list<CLOCK_DOMAIN>::iterator iter_dom;
-        for(iter_dom = lDomain.begin(); iter_dom != lDomain.end(); ++iter_dom)
-        {        
-            list<CLOCK_REGISTRY>::iterator iterFreq;
-            for(iterFreq = (*iter_dom)->lClock.begin();
-                iterFreq != (*iter_dom)->lClock.end(); ++iterFreq)
+        for (UINT32 a = 0; a < THREAD_ACTIVITY_NACTIVITIES; a++)
+        {
+            ostringstream os;
+            os << "Clockserver thread "
+               << ASIM_THREAD_ACTIVITY_CLASS::ActivityName(ASIM_THREAD_ACTIVITY(a))
+               << " ns";
+            ASIM_REGISTRY_CLASS::strip.RegisterStripChart(os.str(), stripInterval,
+                ASIM_THREAD_ACTIVITY_CLASS::GetIntervalTime(ASIM_THREAD_ACTIVITY(a)),
+                nSlots);
+        }
+        ASIM_REGISTRY_CLASS::strip.RegisterStripChart(
+            "Clockserver thread critical path cycles", stripInterval,
+            ASIM_THREAD_ACTIVITY_CLASS::GetIntervalCritical(), nSlots);
+    }
+}
+
+
+/** 
+ * Profile names of every clocked module and write rate matcher,
+ * keyed the way their callbacks are marked for the host profiler.
+ **/
+void ASIM_CLOCK_SERVER_CLASS::GetProfileNames(map<const void *, string> &names)
+{
+    list<CLOCK_DOMAIN>::iterator iter_dom;
+    for(iter_dom = lDomain.begin(); iter_dom != lDomain.end(); ++iter_dom)
+    {        
+        list<CLOCK_REGISTRY>::iterator iterFreq;
+        for(iterFreq = (*iter_dom)->lClock.begin();
+            iterFreq != (*iter_dom)->lClock.end(); ++iterFreq)
+        {
+            CLOCK_REGISTRY_MODULES_ITERATOR iterModule;
+            for(iterModule = (*iterFreq)->lModules.begin();
+                iterModule != (*iterFreq)->lModules.end(); ++iterModule)
             {
-                vector< pair<ASIM_CLOCKABLE, CLOCK_CALLBACK_INTERFACE> >::iterator
-                    endModule = (*iterFreq)->lModules.end();
-                vector< pair<ASIM_CLOCKABLE, CLOCK_CALLBACK_INTERFACE> >::iterator
-                    iterModule = (*iterFreq)->lModules.begin();
-                for( ; iterModule != endModule; ++iterModule)
-                {
-                    ASIM_CLOCKABLE mCurrent = (*iterModule).first;
-        
-                    TTMSG(Trace_Sys, "~ASIM_CLOCK_SERVER_CLASS: Logging " <<
-                        mCurrent->ProfileId());
-        
-                    if(mCurrent->GetCycles() != 0)
-                    {
-                        ofsProfiling << mCurrent->ProfileId() << endl;
-                        
-                        ofsProfiling << "\tCycles spent : " <<
-                            mCurrent->GetCycles() << endl;
-                        ofsProfiling << "\tMax Cycles  : " <<
-                            mCurrent->GetCyclesMax() << endl;
-                        ofsProfiling << "\tMin Cycles  : " <<
-                            mCurrent->GetCyclesMin() << endl;
-                        ofsProfiling << "\tInvocations : " <<
-                            mCurrent->GetNumInvocations() << endl;
-                        ofsProfiling << "\tWrap around cycles spent : " <<
-                            mCurrent->GetWrapAroundCycles() << endl;
-                        ofsProfiling << "\tWrap around : " <<
-                            mCurrent->GetWrapAround() << endl;
-                        ofsProfiling << "\tWrap around cycles/invocation: " << 
-                            ( mCurrent->GetWrapAround() > 0 ?
-                              mCurrent->GetWrapAroundCycles() / mCurrent->GetWrapAround()
-                              : 0) << endl;
-    
-                        ofsProfiling << "\t----------------------------" << endl;
-                        ofsProfiling << "\tCycles/Invocation : " <<
-                            (mCurrent->GetCycles() / mCurrent->GetNumInvocations()) <<
-                            endl;
-                        ofsProfiling << "\t----------------------------" << endl;
-                    }
-                }
+                names[(*iterModule).first] = (*iterModule).first->ProfileId();
+            }
+            for(iterModule = (*iterFreq)->lWriterRM.begin();
+                iterModule != (*iterFreq)->lWriterRM.end(); ++iterModule)
+            {
+                names[(*iterModule).first] = (*iterModule).first->ProfileId();
             }
         }
+    }
+}
 
-        ofsProfiling.close();
+
+/** 
+ * Stops the host profiler and dumps what it sampled: a per-module
+ * summary to clockserver.profile, and folded stacks for flame graph
+ * tools to clockserver.folded.
+ **/
+void ASIM_CLOCK_SERVER_CLASS::DumpProfile()
+{
+    if(!bDumpProfile || ASIM_HOST_PROFILER_CLASS::GetHz() == 0)
+    {
+        return;
+    }
+
+    ASIM_HOST_PROFILER_CLASS::Stop();
+
+    map<const void *, string> names;
+    GetProfileNames(names);
+
+    vector<ASIM_HOST_PROFILER_CLASS::SAMPLE> samples;
+    ASIM_HOST_PROFILER_CLASS::GetSamples(samples);
+
+    // add up each module's samples over all the threads
+    map<const void *, UINT64> perModule;
+    UINT64 total = 0;
+    for(UINT32 i = 0; i < samples.size(); i++)
+    {
+        total += samples[i].count;
+        if(samples[i].object)
+        {
+            perModule[samples[i].object] += samples[i].count;
+        }
     }
 
-#endif
+    // the samples split the host cpu time spent while sampling
+    double cpuMs = 1000.0 * ASIM_HOST_PROFILER_CLASS::GetCpuSeconds();
+    double msPerSample = total ? cpuMs / total : 0;
+
+    ofstream ofsProfiling("clockserver.profile");
+    ofsProfiling << "Host profile: " << total << " samples at "
+                 << ASIM_HOST_PROFILER_CLASS::GetHz() << " Hz over "
+                 << cpuMs << " ms of host cpu time, "
+                 << ASIM_HOST_PROFILER_CLASS::GetDropped() << " dropped" << endl;
 
+    map<const void *, UINT64>::iterator iterModule;
+    for(iterModule = perModule.begin(); iterModule != perModule.end(); ++iterModule)
+    {
+        map<const void *, string>::iterator n = names.find(iterModule->first);
+
+        TTMSG(Trace_Sys, "~ASIM_CLOCK_SERVER_CLASS: Logging " <<
+            (n == names.end() ? "unknown" : n->second));
+
+        ofsProfiling << (n == names.end() ? "unknown" : n->second) << endl;
+        ofsProfiling << "\tSamples : " << iterModule->second << endl;
+        ofsProfiling << "\tHost time (ms) : " << iterModule->second * msPerSample << endl;
+        ofsProfiling << "\tShare of samples : " <<
+            100.0 * iterModule->second / total << "%" << endl;
+        ofsProfiling << "\t----------------------------" << endl;
+    }
+    ofsProfiling.close();
+
+    ofstream ofsFolded("clockserver.folded");
+    ASIM_HOST_PROFILER_CLASS::WriteFolded(ofsFolded, names);
+    ofsFolded.close();
 }
 
 
@@ -484,6 +686,7 @@ ASIM_CLOCK_SERVER_CLASS::RegisterWriterRateMatcherClock( RATE_MATCHER wrm,
             
             wrm->SetClockInfo(pcrCurrent);
             cb->setClockRegistry(pcrCurrent);
+            cb->setProfile(wrm, HOST_PROFILE_RATE_MATCHER);
     	}
     }
 
@@ -629,6 +832,7 @@ ASIM_CLOCK_SERVER_CLASS::RegisterClock(
     }
 
     cb->setClockRegistry(pcrCurrent);
+    cb->setProfile(m, HOST_PROFILE_MODULE_CLOCK);
 
     EVENT
     (
@@ -885,11 +1089,18 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServer(void)
     // Init the random state
     initstate(random_seed, (char*)random_state, CLOCKSERVER_RANDOM_STATE_LENGTH);
 
+    // sample where the host time goes, if we are to dump the profile
+    if(bDumpProfile && !ASIM_HOST_PROFILER_CLASS::IsRunning())
+    {
+        ASIM_HOST_PROFILER_CLASS::Start(profileHz);
+    }
+
     // initialize multi-threaded clockserver
     if(threaded)
     {
-        VERIFY(!runWithEventsOn, "DRAL Events unavailable in multi-threaded runs");
         InitClockServerThreaded();
+        VERIFY(!runWithEventsOn || threadedSinks,
+               "DRAL Events unavailable in multi-threaded runs");
     }
     
 }
@@ -917,6 +1128,172 @@ void ASIM_CLOCK_SERVER_CLASS::StopClockServer(void)
 }       
 
 
+/**
+ * Save the clocking state in the "clockserver" section of a checkpoint.
+ **/
+void ASIM_CLOCK_SERVER_CLASS::SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt)
+{
+    ckpt->BeginSection("clockserver");
+    ckpt->WriteUINT64(Bf);
+    ckpt->WriteUINT64(internalBaseCycle);
+
+    // Registries are identified by their position in their domain
+    map<CLOCK_REGISTRY, pair<UINT64, UINT64> > position;
+
+    ckpt->WriteUINT64(lDomain.size());
+    UINT64 d = 0;
+    for (list<CLOCK_DOMAIN>::const_iterator iter_dom = lDomain.begin();
+         iter_dom != lDomain.end();
+         ++iter_dom, ++d)
+    {
+        ckpt->WriteString((*iter_dom)->name);
+        ckpt->WriteUINT64((*iter_dom)->currentFrequency);
+        ckpt->WriteUINT64((*iter_dom)->lClock.size());
+
+        UINT64 r = 0;
+        for (list<CLOCK_REGISTRY>::const_iterator iter = (*iter_dom)->lClock.begin();
+             iter != (*iter_dom)->lClock.end();
+             ++iter, ++r)
+        {
+            position[*iter] = make_pair(d, r);
+            ckpt->WriteUINT64((*iter)->nFrequency);
+            ckpt->WriteUINT64((*iter)->nSkew);
+            ckpt->WriteUINT64((*iter)->nStep);
+            ckpt->WriteUINT64((*iter)->nBaseCycle);
+            ckpt->WriteUINT64((*iter)->nCycle);
+        }
+    }
+
+    // The event order breaks ties between registries due the same cycle
+    ckpt->WriteUINT64(lTimeEvents.size());
+    for (deque<CLOCK_REGISTRY>::const_iterator iter = lTimeEvents.begin();
+         iter != lTimeEvents.end();
+         ++iter)
+    {
+        ckpt->WriteUINT64(position[*iter].first);
+        ckpt->WriteUINT64(position[*iter].second);
+    }
+
+    // Have random() store its current position in random_state
+    char *cur_state = setstate((char *)random_state);
+    setstate(cur_state);
+    ckpt->WriteUINT64(random_seed);
+    ckpt->WriteBytes(random_state, sizeof(random_state));
+
+    ckpt->EndSection();
+}
+
+
+/**
+ * Restore the clocking state saved by SaveCheckpoint.  The clock domains
+ * must have been created and the clock server initialized as they were
+ * when the checkpoint was taken.
+ **/
+bool ASIM_CLOCK_SERVER_CLASS::RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+{
+    if (threaded)
+    {
+        ASIMWARNING("Checkpoints cannot be restored with threaded clocking" << endl);
+        return false;
+    }
+    if (! ckpt->OpenSection("clockserver"))
+    {
+        ASIMWARNING("Checkpoint has no clockserver state" << endl);
+        return false;
+    }
+    if (ckpt->ReadUINT64() != Bf)
+    {
+        ASIMWARNING("Checkpoint was taken with a different base frequency" << endl);
+        return false;
+    }
+    UINT64 baseCycle = ckpt->ReadUINT64();
+
+    // Check the domain layout before changing anything
+    vector<CLOCK_REGISTRY> registries;
+    vector<UINT64> firstRegistry;
+    if (ckpt->ReadUINT64() != lDomain.size())
+    {
+        ASIMWARNING("Checkpoint was taken with different clock domains" << endl);
+        return false;
+    }
+    vector<UINT64> values;
+    for (list<CLOCK_DOMAIN>::const_iterator iter_dom = lDomain.begin();
+         iter_dom != lDomain.end();
+         ++iter_dom)
+    {
+        string name = ckpt->ReadString();
+        UINT64 frequency = ckpt->ReadUINT64();
+        if (name != (*iter_dom)->name ||
+            ckpt->ReadUINT64() != (*iter_dom)->lClock.size())
+        {
+            ASIMWARNING("Checkpoint was taken with different clock domains" << endl);
+            return false;
+        }
+        values.push_back(frequency);
+
+        firstRegistry.push_back(registries.size());
+        for (list<CLOCK_REGISTRY>::const_iterator iter = (*iter_dom)->lClock.begin();
+             iter != (*iter_dom)->lClock.end();
+             ++iter)
+        {
+            registries.push_back(*iter);
+            for (int i = 0; i < 5; i++)
+            {
+                values.push_back(ckpt->ReadUINT64());
+            }
+        }
+    }
+
+    deque<CLOCK_REGISTRY> events;
+    UINT64 nEvents = ckpt->ReadUINT64();
+    for (UINT64 i = 0; i < nEvents; i++)
+    {
+        UINT64 d = ckpt->ReadUINT64();
+        UINT64 r = ckpt->ReadUINT64();
+        VERIFY(d < firstRegistry.size() && firstRegistry[d] + r < registries.size(),
+               "Corrupt clockserver checkpoint");
+        events.push_back(registries[firstRegistry[d] + r]);
+    }
+
+    // Everything matches, restore
+    internalBaseCycle = baseCycle;
+    vector<UINT64>::const_iterator value = values.begin();
+    for (list<CLOCK_DOMAIN>::const_iterator iter_dom = lDomain.begin();
+         iter_dom != lDomain.end();
+         ++iter_dom)
+    {
+        (*iter_dom)->currentFrequency = *value++;
+        for (list<CLOCK_REGISTRY>::const_iterator iter = (*iter_dom)->lClock.begin();
+             iter != (*iter_dom)->lClock.end();
+             ++iter)
+        {
+            (*iter)->nFrequency = *value++;
+            (*iter)->nSkew = *value++;
+            (*iter)->nStep = *value++;
+            (*iter)->nBaseCycle = *value++;
+            (*iter)->nCycle = *value++;
+        }
+    }
+    lTimeEvents = events;
+
+    // random() writes its position back to the active state when it
+    // switches, so switch away from random_state while overwriting it
+    // and then have random() pick up the restored position, keeping
+    // whichever state was active
+    char tmp_state[CLOCKSERVER_RANDOM_STATE_LENGTH];
+    char *cur_state = initstate(1, tmp_state, sizeof(tmp_state));
+    random_seed = ckpt->ReadUINT64();
+    ckpt->ReadBytes(random_state, sizeof(random_state));
+    setstate((char *)random_state);
+    if (cur_state != (char *)random_state)
+    {
+        setstate(cur_state);
+    }
+
+    return true;
+}
+
+
 /**
  * Calls the DralEventsTurnedOn method of all the ASIM_CLOCKABLE instances.
  */
@@ -950,6 +1327,9 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::Clock()
         
     ASSERTX(!lTimeEvents.empty());
 
+    // time not spent in the callbacks is clockserver overhead
+    ASIM_HOST_PROFILE_SCOPE profile(NULL, HOST_PROFILE_SCHEDULE);
+
     // Check some basic conditions to execute specialized clock methods
     // and avoid unnecessary work
     
@@ -958,7 +1338,8 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::Clock()
         return RandomClock();        
     }
     
-    if(threaded && !eventsOn && !traceOn)
+    // implementations with thread sinks keep events and traces ordered
+    if(threaded && (threadedSinks || (!eventsOn && !traceOn)))
     {
         return ThreadedClock();
     }
@@ -1275,3 +1656,18 @@ void ClockRegistry::DralEventsTurnedOn ()
         (*iter)->DralEventsTurnedOn();
     }
 }
+
+/**
+ * Queues the DRAL cycle marker of this clock registry for the thread
+ * sinks to write out ahead of the given step of the current base cycle
+ */
+void ClockRegistry::DralSinkCycle (UINT32 step)
+{
+    EVENT
+    (
+        if (runWithEventsOn)
+        {
+            ASIM_THREAD_SINK_CLASS::Marker(step, clockId, nCycle, edge);
+        }
+    );
+}
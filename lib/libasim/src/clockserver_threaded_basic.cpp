@@ -39,12 +39,15 @@
 #include <cstdlib>
 #include <ctime>
 #include <sched.h>
+#include <algorithm>
 
 #include "asim/provides/clockserver.h"
 #include "asim/clockable.h"
 #include "asim/module.h"
 #include "asim/smp.h"
 #include "asim/rate_matcher.h"
+#include "asim/barrier.h"
+#include "asim/thread_sink.h"
 
 
 #if CLOCKSERVER_SINGLE_WORKER_SIGNAL==1
@@ -59,12 +62,78 @@ static ATOMIC32_CLASS BarrierCount    = 0;
 #endif
 
 
+// If CLOCKSERVER_BARRIER is nonzero, the server and all the workers
+// synchronize on a shared ASIM_BARRIER_CLASS instead, twice per cycle:
+// once to start the workers, and once to wait for them to finish.
+// The server is the last participant.
+static ASIM_BARRIER ClockBarrier = NULL;
+
+
+// Trace and DRAL output of the workers is buffered in one sink per worker
+// and merged by the server once all the workers are done with a cycle.
+static vector<ASIM_THREAD_SINK> ThreadSinks;
+static volatile UINT64 SinkBaseCycle = 0;
+
+
+//
+// Worker thread that knows its slot in the clock barrier, and can get
+// itself out of the barrier when the clock server shuts it down.
+//
+typedef
+class CLOCKSERVER_BARRIER_THREAD_CLASS *CLOCKSERVER_BARRIER_THREAD;
+class CLOCKSERVER_BARRIER_THREAD_CLASS : public ASIM_CLOCKSERVER_THREAD_CLASS
+{
+  public:
+    UINT32 barrierSlot;
+    ASIM_THREAD_SINK sink;
+
+    CLOCKSERVER_BARRIER_THREAD_CLASS( ASIM_SMP_THREAD_HANDLE th )
+      : ASIM_CLOCKSERVER_THREAD_CLASS( th ),
+        barrierSlot( 0 ),
+        sink( new ASIM_THREAD_SINK_CLASS() )
+    {}
+
+    ~CLOCKSERVER_BARRIER_THREAD_CLASS()
+    {
+        ThreadSinks.erase( remove( ThreadSinks.begin(), ThreadSinks.end(), sink ),
+                           ThreadSinks.end() );
+        delete sink;
+    }
+
+    // execute all our tasks, buffering their output in our sink
+    void PerformTasks()
+    {
+        ASIM_THREAD_ACTIVITY_CLASS::Switch( THREAD_ACTIVITY_WORK );
+        sink->BeginCycle( SinkBaseCycle );
+        CLOCK_CALLBACK_INTERFACE cb = GetNextWorkItem();
+        while(cb != NULL)
+        {
+            sink->SetStep( cb->sinkStep );
+            cb->Clock();
+            cb = GetNextWorkItem();
+        }
+        sink->EndCycle();
+        ASIM_THREAD_ACTIVITY_CLASS::Switch( THREAD_ACTIVITY_SPIN );
+    }
+
+    bool DestroyPthread()
+    {
+        if ( ThreadActive() && ClockBarrier )
+        {
+            threadForceExit = true;
+            ClockBarrier->Abort();
+        }
+        return ASIM_CLOCKSERVER_THREAD_CLASS::DestroyPthread();
+    }
+};
+
+
 //
 // the required factory method to create clockserver thread objects.
 //
 ASIM_CLOCKSERVER_THREAD new_ASIM_CLOCKSERVER_THREAD_CLASS( ASIM_SMP_THREAD_HANDLE th )
 {
-    return new ASIM_CLOCKSERVER_THREAD_CLASS( th );
+    return new CLOCKSERVER_BARRIER_THREAD_CLASS( th );
 }
 
 
@@ -78,12 +147,44 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServerThreaded()
             << max_pthreads << " and the model is trying to create "
             << lThreads.size() << " pthreads");
 
-    // Create the pthreads if requested
+    // pin the server here, and the workers as they start, to host cpus
+    ASIM_SMP_CLASS::SetCpuMap( CLOCKSERVER_CPU_MAP );
+
+    // account where the server's and the workers' host time goes
+    if ( CLOCKSERVER_THREAD_STATS )
+    {
+        InitThreadActivity( CLOCKSERVER_THREAD_STATS_STRIPCHART );
+    }
+
+    // Build the barrier, if requested, with one slot per worker plus the server
+    delete ClockBarrier;
+    ClockBarrier = NULL;
+    if ( CLOCKSERVER_BARRIER )
+    {
+        ClockBarrier = ASIM_BARRIER_CLASS::Create( CLOCKSERVER_BARRIER,
+                                                   lThreads.size() + 1,
+                                                   CLOCKSERVER_SPINWAIT_YIELD_INTERVAL );
+    }
+
+    // Collect the workers' sinks before any of them starts
+    UINT32 slot = 0;
+    ThreadSinks.clear();
     list<ASIM_CLOCKSERVER_THREAD>::iterator iter_threads = lThreads.begin();
     for( ; iter_threads != lThreads.end(); ++iter_threads)
+    {
+        CLOCKSERVER_BARRIER_THREAD(*iter_threads)->barrierSlot = slot++;
+        ThreadSinks.push_back( CLOCKSERVER_BARRIER_THREAD(*iter_threads)->sink );
+    }
+    ASIM_THREAD_SINK_CLASS::Prepare( ThreadSinks );
+
+    // Create the pthreads if requested
+    for( iter_threads = lThreads.begin(); iter_threads != lThreads.end(); ++iter_threads)
     {
         (*iter_threads)->CreatePthread();
     }
+
+    // the workers' trace and DRAL output is merged back in cycle order
+    threadedSinks = true;
 }
 
 
@@ -109,6 +210,28 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
     VERIFYX(parent != NULL);
 
     parent->threadActive = true;
+
+    CLOCKSERVER_BARRIER_THREAD worker = CLOCKSERVER_BARRIER_THREAD(parent);
+    ASIM_THREAD_SINK_CLASS::Attach( worker->sink );
+
+    // outside of its tasks a worker is waiting for the others
+    ASIM_HOST_PROFILER_CLASS::Enter( NULL, HOST_PROFILE_BARRIER_WAIT );
+
+    if ( ClockBarrier )
+    {
+        UINT32 slot = worker->barrierSlot;
+
+        // start barrier, execute our tasks, finish barrier
+        while ( ClockBarrier->Wait( slot ) && ! parent->threadForceExit )
+        {
+            worker->PerformTasks();
+            if ( ! ClockBarrier->Wait( slot ) )
+            {
+                break;
+            }
+        }
+        pthread_exit(0);
+    }
     
     // Before enter the loop lock the task_list_mutex to avoid any race condition
 #if CLOCKSERVER_USES_PTHREADS_SIGNALLING==1
@@ -127,7 +250,7 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
 #else
             UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
             while ( --retries && SPIN_WAIT_CONDITION );
-            sched_yield();
+            ASIM_THREAD_ACTIVITY_CLASS::Yield();
 #endif
         }
 
@@ -143,12 +266,7 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
             pthread_exit(0);
         }
         
-        CLOCK_CALLBACK_INTERFACE cb = parent->GetNextWorkItem();
-        while(cb != NULL)
-        {              
-            cb->Clock();
-            cb = parent->GetNextWorkItem();
-        }
+        worker->PerformTasks();
 
         // Tell the master thread that all the work is done
 #if CLOCKSERVER_USES_PTHREADS_SIGNALLING==1
@@ -189,7 +307,7 @@ bool ASIM_CLOCKSERVER_THREAD_CLASS::CheckAllTasksCompleted()
 #else
         UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
         while ( --retries && !tasks_completed );
-        sched_yield();
+        ASIM_THREAD_ACTIVITY_CLASS::Yield();
 #endif
     }
 #if CLOCKSERVER_USES_PTHREADS_SIGNALLING==1
@@ -241,6 +359,7 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // run through the list of events and find all events at the current point in time
     //
     UINT64  currentBaseCycle =  lTimeEvents.front()->nBaseCycle;
+    SinkBaseCycle = currentBaseCycle;
     while ( currentBaseCycle == lTimeEvents.front()->nBaseCycle )
     {
         CLOCK_REGISTRY currentEvent = lTimeEvents.front();
@@ -251,14 +370,20 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     //
     // for each event at the current time point, run through all the modules
     // that must be clocked for this event, and assign the task to its worker thread.
+    // The modules of the n-th event are step n of the thread sinks, and the
+    // event's cycle marker gets written out ahead of them.
     //
-    for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event)
+    UINT32 step = 0;
+    for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event, ++step)
     {   
+        (*it_event)->DralSinkCycle( step );
+
         CLOCK_REGISTRY_MODULES_ITERATOR endM = (*it_event)->lModules.end();
         CLOCK_REGISTRY_MODULES_ITERATOR iter = (*it_event)->lModules.begin();
         for( ; iter != endM; ++iter)
         {
             (*iter).second->currentCycle = (*it_event)->nCycle;
+            (*iter).second->sinkStep = step;
             (*iter).first->GetClockingThread()->AssignTask((*iter).second);
         }
     }
@@ -267,14 +392,21 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // Do the same for the write rate matcher ports, assign them to the worker threads.
     // This relies on the fact that AssignTask queues tasks in the order that they get
     // executed, since the write rate matchers must be clocked AFTER the module clock calls.
+    // Like the sequential clockserver, a domain with write rate matchers gets
+    // a second cycle marker ahead of them.
     //
-    for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event)
+    for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event, ++step)
     {   
         CLOCK_REGISTRY_MODULES_ITERATOR endM = (*it_event)->lWriterRM.end();
         CLOCK_REGISTRY_MODULES_ITERATOR iter = (*it_event)->lWriterRM.begin();
+        if ( iter != endM )
+        {
+            (*it_event)->DralSinkCycle( step );
+        }
         for( ; iter != endM; ++iter)
         {
             (*iter).second->currentCycle = (*it_event)->nCycle;
+            (*iter).second->sinkStep = step;
             // !!$#@!!! RATE_MATCHER and ASIM_CLOCKABLE both have different
             // GetClockingThread() routines, that do not inherit from one another.
             // We need to do this cast here to make sure we call the RATE_MATCHER one
@@ -286,6 +418,8 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     //
     // wake up all the worker threads
     //
+    UINT64 cycleStartNs = ASIM_THREAD_ACTIVITY_CLASS::IsEnabled() ?
+                          ASIM_THREAD_ACTIVITY_CLASS::NowNs() : 0;
     StartAllWorkerThreads();
 
 #if CLOCKSERVER_READDS_EVENTS_CONCURRENTLY==0
@@ -315,8 +449,13 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     //
     WaitForAllWorkerThreads();
 #endif
+    ASIM_THREAD_ACTIVITY_CLASS::CountCriticalPath( cycleStartNs );
 
-    // FIX FIX FIX !?! generate DRAL new cycle event if necessary.
+    //
+    // write out the cycle markers, and the trace and DRAL output the workers
+    // buffered this cycle
+    //
+    ASIM_THREAD_SINK_CLASS::Merge( ThreadSinks, currentBaseCycle );
 
     //
     // Return the number of base cycles forwarded                       
@@ -333,6 +472,15 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
 //
 void ASIM_CLOCK_SERVER_CLASS::StartAllWorkerThreads()
 {
+    ASIM_HOST_PROFILE_SCOPE profile(NULL, HOST_PROFILE_BARRIER_WAIT);
+    ASIM_THREAD_ACTIVITY_SCOPE activity(THREAD_ACTIVITY_SPIN);
+
+    if ( ClockBarrier )
+    {
+        ClockBarrier->Wait( lThreads.size() );
+        return;
+    }
+
 #if CLOCKSERVER_SINGLE_WORKER_SIGNAL==1
     ///
     /// NEW VERSION.  USES A SINGLE SHARED BARRIER VARIABLE
@@ -374,6 +522,15 @@ void ASIM_CLOCK_SERVER_CLASS::StartAllWorkerThreads()
 //
 void ASIM_CLOCK_SERVER_CLASS::WaitForAllWorkerThreads()
 {
+    ASIM_HOST_PROFILE_SCOPE profile(NULL, HOST_PROFILE_BARRIER_WAIT);
+    ASIM_THREAD_ACTIVITY_SCOPE activity(THREAD_ACTIVITY_SPIN);
+
+    if ( ClockBarrier )
+    {
+        ClockBarrier->Wait( lThreads.size() );
+        return;
+    }
+
 #if CLOCKSERVER_SINGLE_WORKER_SIGNAL==1
     ///
     /// NEW VERSION.  USES A SINGLE SHARED BARRIER VARIABLE
@@ -381,7 +538,7 @@ void ASIM_CLOCK_SERVER_CLASS::WaitForAllWorkerThreads()
     while ( int(BarrierCount) > 0 ) {
         UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
         while ( --retries && int(BarrierCount) > 0 );
-        sched_yield();
+        ASIM_THREAD_ACTIVITY_CLASS::Yield();
     }
 
 #else
@@ -53,6 +53,9 @@
 // If compiling the clockserver into libasim, get the header files from the
 // libasim common area, and hardwire some necessary param values...
 #ifdef CLOCKSERVER_IN_LIBASIM
+# define CLOCKSERVER_CPU_MAP                 ""
+# define CLOCKSERVER_THREAD_STATS            0
+# define CLOCKSERVER_THREAD_STATS_STRIPCHART 0
 # define CLOCKSERVER_SPINWAIT_YIELD_INTERVAL 2
 # define CLOCKSERVER_MAX_WORKER_PTHREADS     7
 # define CLOCKSERVER_THREAD_IS_WORKER        0
@@ -203,7 +206,11 @@ class DYNAMIC_SCHEDULER_AE_CLASS : public DYNAMIC_SCHEDULER_CLASS
     //
     void                       qins( DYNAMIC_TASK );          // insert something into the queue
     DYNAMIC_TASK               qrem(              );          // remove the next item from the queue
-    void lock()   { pthread_mutex_lock  ( &mutex ); };        // get exclusive access to the queue
+    void lock()                                               // get exclusive access to the queue
+    {
+        ASIM_THREAD_ACTIVITY_SCOPE activity( THREAD_ACTIVITY_LOCK );
+        pthread_mutex_lock  ( &mutex );
+    };
     void unlock() { pthread_mutex_unlock( &mutex ); };        // end exclusive access critial section
 };
 class DYNAMIC_SCHEDULER_AE_MASTER_CLASS : public DYNAMIC_SCHEDULER_AE_CLASS
@@ -648,6 +655,15 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServerThreaded()
             << max_pthreads << " and the model is trying to create "
             << lThreads.size() << " pthreads");
 
+    // pin the server here, and the workers as they start, to host cpus
+    ASIM_SMP_CLASS::SetCpuMap( CLOCKSERVER_CPU_MAP );
+
+    // account where the server's and the workers' host time goes
+    if ( CLOCKSERVER_THREAD_STATS )
+    {
+        InitThreadActivity( CLOCKSERVER_THREAD_STATS_STRIPCHART );
+    }
+
     // set the fuzy barrier lookahead
     GlobalTimeRing.set_lookahead( LookaheadParam2BaseCycles( threadLookahead ) );
     
@@ -790,7 +806,10 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         if ( task->is_ready() )
         {
             WORKER_END_WAIT;
+            ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+            ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
             task->DoWork();
+            ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
             WORKER_SEND_SIGNAL;
             retries = 0;
         }
@@ -799,10 +818,11 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
             WorkerScheduler->TaskSwitch( task );
             if ( ++retries >= CLOCKSERVER_SPINWAIT_YIELD_INTERVAL )
             {
-                sched_yield();
+                ASIM_THREAD_ACTIVITY_CLASS::Yield();
                 retries = 0;
             }
             WORKER_BEGIN_WAIT;
+            ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
         }
     }
     WORKER_CANCEL_WAIT;
@@ -822,6 +842,8 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // advance simulation time to the timepoint at the head of the events list.
     // This will allow worker threads to proceed forward.
     //
+    UINT64 cycleStartNs = ASIM_THREAD_ACTIVITY_CLASS::IsEnabled() ?
+                          ASIM_THREAD_ACTIVITY_CLASS::NowNs() : 0;
     INT64 currentBaseCycle = GlobalTimeRing.advance_time();
     SERVER_SEND_SIGNAL;
 
@@ -831,12 +853,16 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     //
     DYNAMIC_TASK task = NULL;
     UINT32 retries = 0;
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
     while ( GetGlobalDoneTime() < currentBaseCycle )
     {
         if ( task->is_ready() )
         {
             SERVER_CANCEL_WAIT;
+            ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+            ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
             task->DoWork();
+            ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
             retries = 0;
         }
         else
@@ -844,15 +870,22 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
             MasterScheduler->TaskSwitch( task );
             if ( ++retries >= CLOCKSERVER_SPINWAIT_YIELD_INTERVAL )
             {
-                sched_yield();
+                ASIM_THREAD_ACTIVITY_CLASS::Yield();
                 retries = 0;
             }
             SERVER_BEGIN_WAIT;
+            ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
         }
     }
     SERVER_END_WAIT;
+    ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
     MasterScheduler->MainThreadTaskRelease( task );
 
+    // tasks migrate between pthreads, so this credits the pthread that
+    // ran the last task to finish, not the task itself
+    ASIM_THREAD_ACTIVITY_CLASS::CountCriticalPath(cycleStartNs);
+
     //
     // remove all events at the current time point from the front of the list,
     // and re-add them to the events list at their next time step.
@@ -38,6 +38,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <sched.h>
+#include <algorithm>
 
 #include "asim/provides/clockserver.h"
 
@@ -45,6 +46,8 @@
 #include "asim/module.h"
 #include "asim/smp.h"
 #include "asim/rate_matcher.h"
+#include "asim/barrier.h"
+#include "asim/thread_sink.h"
 
 
 // The global ready time is the time step that the clock server wants the workers to execute.
@@ -55,7 +58,21 @@ static deque<CLOCK_REGISTRY> *GlobalTimeEvents = NULL;
 static pthread_mutex_t        GlobalTimeEventsLock = PTHREAD_MUTEX_INITIALIZER;
 static volatile INT64         CLOCKSERVER_FUZZY_BARRIER_LOOKAHEAD = 0;
 
-#define BEGIN_GLOBAL_TIME_EVENTS_ACCESS pthread_mutex_lock  ( & GlobalTimeEventsLock );
+// Bumped every time the global ready time advances.  Idle workers wait on
+// this (spinning, then sleeping) instead of polling GlobalReadyTime.
+static ASIM_WAIT_WORD_CLASS   GlobalReadyEpoch;
+
+// Trace and DRAL output of the workers is buffered in one sink per worker.
+// Workers may run ahead of the server, so the server only merges the output
+// for the time points that every worker has finished.
+static vector<ASIM_THREAD_SINK> ThreadSinks;
+
+#define BEGIN_GLOBAL_TIME_EVENTS_ACCESS \
+    {                                                                                           \
+        ASIM_THREAD_ACTIVITY prev = ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_LOCK);   \
+        pthread_mutex_lock  ( & GlobalTimeEventsLock );                                         \
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(prev);                                               \
+    }
 #define   END_GLOBAL_TIME_EVENTS_ACCESS pthread_mutex_unlock( & GlobalTimeEventsLock );
 
 
@@ -90,9 +107,42 @@ UINT64 worker2server_bogus_sync = 0;
 //
 // the required factory method to create clockserver thread objects.
 //
+//
+// Worker thread that can wake itself up when the clock server shuts it down.
+//
+typedef
+class CLOCKSERVER_FUZZY_THREAD_CLASS *CLOCKSERVER_FUZZY_THREAD;
+class CLOCKSERVER_FUZZY_THREAD_CLASS : public ASIM_CLOCKSERVER_THREAD_CLASS
+{
+  public:
+    ASIM_THREAD_SINK sink;
+
+    CLOCKSERVER_FUZZY_THREAD_CLASS( ASIM_SMP_THREAD_HANDLE th )
+      : ASIM_CLOCKSERVER_THREAD_CLASS( th ),
+        sink( new ASIM_THREAD_SINK_CLASS() )
+    {}
+
+    ~CLOCKSERVER_FUZZY_THREAD_CLASS()
+    {
+        ThreadSinks.erase( remove( ThreadSinks.begin(), ThreadSinks.end(), sink ),
+                           ThreadSinks.end() );
+        delete sink;
+    }
+
+    bool DestroyPthread()
+    {
+        if ( ThreadActive() )
+        {
+            threadForceExit = true;
+            GlobalReadyEpoch.Increment();
+        }
+        return ASIM_CLOCKSERVER_THREAD_CLASS::DestroyPthread();
+    }
+};
+
 ASIM_CLOCKSERVER_THREAD new_ASIM_CLOCKSERVER_THREAD_CLASS( ASIM_SMP_THREAD_HANDLE th )
 {
-    return new ASIM_CLOCKSERVER_THREAD_CLASS( th );
+    return new CLOCKSERVER_FUZZY_THREAD_CLASS( th );
 }
 
 
@@ -106,6 +156,15 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServerThreaded()
             << max_pthreads << " and the model is trying to create "
             << lThreads.size() << " pthreads");
 
+    // pin the server here, and the workers as they start, to host cpus
+    ASIM_SMP_CLASS::SetCpuMap( CLOCKSERVER_CPU_MAP );
+
+    // account where the server's and the workers' host time goes
+    if ( CLOCKSERVER_THREAD_STATS )
+    {
+        InitThreadActivity( CLOCKSERVER_THREAD_STATS_STRIPCHART );
+    }
+
     // set the fuzy barrier lookahead
     CLOCKSERVER_FUZZY_BARRIER_LOOKAHEAD = LookaheadParam2BaseCycles( threadLookahead );
     list<CLOCK_DOMAIN>::iterator iter_dom = lDomain.begin();
@@ -119,12 +178,23 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServerThreaded()
     // publish the event list
     GlobalTimeEvents = & lTimeEvents;
 
-    // Create the pthreads if requested
+    // Collect the workers' sinks before any of them starts
+    ThreadSinks.clear();
     list<ASIM_CLOCKSERVER_THREAD>::iterator iter_threads = lThreads.begin();
     for( ; iter_threads != lThreads.end(); ++iter_threads)
+    {
+        ThreadSinks.push_back( CLOCKSERVER_FUZZY_THREAD(*iter_threads)->sink );
+    }
+    ASIM_THREAD_SINK_CLASS::Prepare( ThreadSinks );
+
+    // Create the pthreads if requested
+    for( iter_threads = lThreads.begin(); iter_threads != lThreads.end(); ++iter_threads)
     {
         (*iter_threads)->CreatePthread();
     }
+
+    // the workers' trace and DRAL output is merged back in cycle order
+    threadedSinks = true;
 }
 
 
@@ -139,10 +209,14 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
     VERIFYX(parent != NULL);
 
     parent->threadActive = true;
+
+    ASIM_THREAD_SINK sink = CLOCKSERVER_FUZZY_THREAD(parent)->sink;
+    ASIM_THREAD_SINK_CLASS::Attach( sink );
     
     INT64 localReadyTime  = -1;  // time we are currently processing
     parent->localDoneTime = -1;  // time we are done processing
     INT64 lastTimeFailed  = -1;  // last global ready time at which we found no work to do
+    ASIM_SPIN_BUDGET_CLASS budget( CLOCKSERVER_SPINWAIT_YIELD_INTERVAL );
 
     while(1)
     {      
@@ -151,20 +225,27 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         // or until clockserver terminates this thread.
         //
         WORKER_BEGIN_WAIT;
-        while( parent->localDoneTime >= GlobalReadyTime + CLOCKSERVER_FUZZY_BARRIER_LOOKAHEAD
-               || GlobalReadyTime == lastTimeFailed )
+        ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
+        while( 1 )
         {
+            // sample the epoch first, so that an advance after our check wakes us
+            UINT32 epoch = GlobalReadyEpoch.Get();
+            if( parent->localDoneTime < GlobalReadyTime + CLOCKSERVER_FUZZY_BARRIER_LOOKAHEAD
+                && GlobalReadyTime != lastTimeFailed )
+            {
+                break;
+            }
             if( parent->threadForceExit )                 // if thread is being terminated...
             {
                 parent->localDoneTime = GlobalReadyTime;  // ...notify clock server that we are done
                 WORKER_CANCEL_WAIT;
                 pthread_exit(0);                          // ...and exit
             }
-            UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
-            while ( --retries && parent->localDoneTime >= GlobalReadyTime + CLOCKSERVER_FUZZY_BARRIER_LOOKAHEAD );
-            sched_yield();
+            GlobalReadyEpoch.WaitUntil( epoch + 1, budget, & parent->threadForceExit );
         }
         WORKER_END_WAIT;
+        ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
         
         //
         // find all events at the thread local point in time.
@@ -211,13 +292,17 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         END_GLOBAL_TIME_EVENTS_ACCESS
 
         UINT32 workDone = 0;
+        sink->BeginCycle( localReadyTime );
 
         //
         // for each event at the current time point, run through all the modules
         // that must be clocked for this event, and execute it if it belongs to this thread.
+        // The modules of the n-th event are step n of the thread sink.
         //
-        for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event)
+        UINT32 step = 0;
+        for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event, ++step)
         {   
+            sink->SetStep( step );
             CLOCK_REGISTRY_MODULES_ITERATOR endM = (*it_event)->lModules.end();
             CLOCK_REGISTRY_MODULES_ITERATOR iter = (*it_event)->lModules.begin();
             for( ; iter != endM; ++iter)
@@ -233,8 +318,9 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         //
         // Do the same for the write rate matcher ports, execute them if they belong to me.
         //
-        for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event)
+        for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event, ++step)
         {   
+            sink->SetStep( step );
             CLOCK_REGISTRY_MODULES_ITERATOR endM = (*it_event)->lWriterRM.end();
             CLOCK_REGISTRY_MODULES_ITERATOR iter = (*it_event)->lWriterRM.begin();
             for( ; iter != endM; ++iter)
@@ -261,6 +347,8 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         //
         // now advance my local time
         //
+        sink->EndCycle();
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
         parent->localDoneTime = localReadyTime;
         WORKER_SEND_SIGNAL;
     }
@@ -280,20 +368,46 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // This will allow worker threads to proceed forward.
     //
     INT64 currentBaseCycle = lTimeEvents.front()->nBaseCycle;
+    UINT64 cycleStartNs = ASIM_THREAD_ACTIVITY_CLASS::IsEnabled() ?
+                          ASIM_THREAD_ACTIVITY_CLASS::NowNs() : 0;
     GlobalReadyTime = currentBaseCycle;             // signal the worker threads!
+    GlobalReadyEpoch.Increment();
     SERVER_SEND_SIGNAL;
 
     //
-    // spin-wait for all worker threads to finish the current time point
+    // spin-wait for all worker threads to finish the current time point.
+    // Done times only move forward, so rather than recomputing the global
+    // minimum on every spin we wait on one laggard at a time, and never
+    // look at a thread again once it has caught up.
     //
     SERVER_BEGIN_WAIT;
-    while ( GetGlobalDoneTime() < currentBaseCycle )
+    ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
+    CLOCKSERVER_THREADS_ITERATOR laggard = lThreads.begin();
+    while ( laggard != lThreads.end() )
     {
+        if ( (*laggard)->GetLocalDoneTime() >= currentBaseCycle )
+        {
+            ++laggard;
+            continue;
+        }
         UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
-        while ( --retries && GetGlobalDoneTime() < currentBaseCycle );
-        sched_yield();
+        while ( --retries && (*laggard)->GetLocalDoneTime() < currentBaseCycle )
+        {
+            CpuPause();
+        }
+        if ( retries == 0 )
+        {
+            ASIM_THREAD_ACTIVITY_CLASS::Yield();
+        }
     }
     SERVER_END_WAIT;
+    ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
+
+    // with lookahead a worker may have finished this time point early,
+    // so this only approximates which thread held the server up
+    ASIM_THREAD_ACTIVITY_CLASS::CountCriticalPath(cycleStartNs);
 
     //
     // remove all events at the current time point from the front of the list,
@@ -302,12 +416,29 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // the workers traverse the events list themselves, and also since the
     // step may have been modified by setDomainFrequency during the clocking.
     //
+    // The events come off the list in the order the workers saw them, so
+    // the n-th one's cycle marker goes ahead of step n of the thread sinks,
+    // and, if it has write rate matchers, a second one ahead of their step.
+    //
+    deque<CLOCK_REGISTRY> lClockedEvents;
+    CLOCK_REGISTRY_EVENTS_ITERATOR it_event;
     BEGIN_GLOBAL_TIME_EVENTS_ACCESS
     while ( currentBaseCycle == (INT64)lTimeEvents.front()->nBaseCycle )
     {
         // remove event from head of list at current time
         CLOCK_REGISTRY currentEvent = lTimeEvents.front();
         lTimeEvents.pop_front();
+        currentEvent->DralSinkCycle( lClockedEvents.size() );
+        lClockedEvents.push_back( currentEvent );
+    }
+    UINT32 step = lClockedEvents.size();
+    for( it_event = lClockedEvents.begin(); it_event != lClockedEvents.end(); ++it_event, ++step)
+    {
+        CLOCK_REGISTRY currentEvent = *it_event;
+        if ( ! currentEvent->lWriterRM.empty() )
+        {
+            currentEvent->DralSinkCycle( step );
+        }
         // update cycle count and time
         currentEvent->nCycle++;
         currentEvent->nBaseCycle += currentEvent->nStep;
@@ -316,7 +447,11 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     }
     END_GLOBAL_TIME_EVENTS_ACCESS
 
-    // FIX FIX FIX !?! generate DRAL new cycle event if necessary.
+    //
+    // write out the cycle markers, and the trace and DRAL output the workers
+    // buffered up to now
+    //
+    ASIM_THREAD_SINK_CLASS::Merge( ThreadSinks, currentBaseCycle );
 
     //
     // Return the number of base cycles forwarded                       
@@ -44,6 +44,9 @@
 // If compiling the clockserver into libasim, get the header files from the
 // libasim common area, and hardwire some necessary param values...
 #ifdef CLOCKSERVER_IN_LIBASIM
+# define CLOCKSERVER_CPU_MAP                 ""
+# define CLOCKSERVER_THREAD_STATS            0
+# define CLOCKSERVER_THREAD_STATS_STRIPCHART 0
 # define CLOCKSERVER_SPINWAIT_YIELD_INTERVAL 500
 # define CLOCKSERVER_INSTRUMENT_TPROFILER    0
 # include "asim/clockserver.h"
@@ -111,6 +114,15 @@ void ASIM_CLOCK_SERVER_CLASS::InitClockServerThreaded()
             << max_pthreads << " and the model is trying to create "
             << lThreads.size() << " pthreads");
 
+    // pin the server here, and the workers as they start, to host cpus
+    ASIM_SMP_CLASS::SetCpuMap( CLOCKSERVER_CPU_MAP );
+
+    // account where the server's and the workers' host time goes
+    if ( CLOCKSERVER_THREAD_STATS )
+    {
+        InitThreadActivity( CLOCKSERVER_THREAD_STATS_STRIPCHART );
+    }
+
     // set the fuzy barrier lookahead
     GlobalTimeRing.set_lookahead( LookaheadParam2BaseCycles( threadLookahead ) );
     
@@ -150,6 +162,7 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         // or until clockserver terminates this thread.
         //
         WORKER_BEGIN_WAIT;
+        ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
         while( ! myNextEvent.is_ready() )
         {
             if( parent->threadForceExit )                     // if thread is being terminated...
@@ -160,9 +173,11 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
             }
             UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
             while ( ! myNextEvent.is_ready() && --retries ) ;
-            sched_yield();
+            ASIM_THREAD_ACTIVITY_CLASS::Yield();
         }
         WORKER_END_WAIT;
+        ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
         
         //
         // find all events at the thread local point in time,
@@ -219,6 +234,7 @@ void * ASIM_CLOCKSERVER_THREAD_CLASS::ThreadWork(void* param)
         // This is a synchronization update, since it tells the
         // clock server thread that time can advance.
         //
+        ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
         parent->localDoneTime = localReadyTime;
         WORKER_SEND_SIGNAL;
     }
@@ -238,6 +254,8 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // advance simulation time to the timepoint at the head of the events list.
     // This will allow worker threads to proceed forward.
     //
+    UINT64 cycleStartNs = ASIM_THREAD_ACTIVITY_CLASS::IsEnabled() ?
+                          ASIM_THREAD_ACTIVITY_CLASS::NowNs() : 0;
     INT64 currentBaseCycle = GlobalTimeRing.advance_time();
     SERVER_SEND_SIGNAL;
 
@@ -247,13 +265,20 @@ UINT64 ASIM_CLOCK_SERVER_CLASS::ThreadedClock()
     // spin-wait for all worker threads to finish the current time point
     //
     SERVER_BEGIN_WAIT;
+    ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_BARRIER_WAIT);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_SPIN);
     while ( WAIT_CONDITION )
     {
         UINT32 retries = CLOCKSERVER_SPINWAIT_YIELD_INTERVAL;
         while ( --retries && WAIT_CONDITION ) ;
-        sched_yield();
+        ASIM_THREAD_ACTIVITY_CLASS::Yield();
     }
     SERVER_END_WAIT;
+    ASIM_HOST_PROFILER_CLASS::Enter(NULL, HOST_PROFILE_SCHEDULE);
+    ASIM_THREAD_ACTIVITY_CLASS::Switch(THREAD_ACTIVITY_WORK);
+
+    // workers may run ahead, so this only approximates the critical path
+    ASIM_THREAD_ACTIVITY_CLASS::CountCriticalPath(cycleStartNs);
 
     //
     // remove all events at the current time point from the front of the list,
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Sampling host profiler for the clock server.
+ **/
+
+#include <signal.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sstream>
+
+#include "asim/host_profiler.h"
+#include "asim/atomic.h"
+#include "asim/mesg.h"
+
+
+#ifdef TLS_AVAILABLE
+__thread volatile PTR_SIZED_UINT ASIM_HOST_PROFILE_Current = 0;
+#endif
+
+volatile bool ASIM_HOST_PROFILER_CLASS::running = false;
+UINT32 ASIM_HOST_PROFILER_CLASS::hz = 0;
+double ASIM_HOST_PROFILER_CLASS::cpuSeconds = 0;
+double ASIM_HOST_PROFILER_CLASS::startCpuSeconds = 0;
+
+
+static double
+ProcessCpuSeconds(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+
+//
+// Each host thread claims a sample table the first time it is sampled.
+// The tables are allocated up front, since the signal handler cannot
+// allocate memory, and are never freed.  An entry is empty while its
+// count is zero.
+//
+#define HOST_PROFILE_TABLE_SIZE 4096
+#define HOST_PROFILE_MAX_PROBES 16
+
+struct HOST_PROFILE_ENTRY
+{
+    PTR_SIZED_UINT key;
+    INT32 thread;
+    volatile UINT64 count;
+};
+
+struct HOST_PROFILE_TABLE
+{
+    HOST_PROFILE_ENTRY entry[HOST_PROFILE_TABLE_SIZE];
+    volatile UINT64 dropped;
+};
+
+static HOST_PROFILE_TABLE *profileTables = NULL;
+static UINT32 numProfileTables = 0;
+static ATOMIC32_CLASS nextProfileTable = 0;
+static ATOMIC32_CLASS unclaimedSamples = 0;
+
+#ifdef TLS_AVAILABLE
+static __thread HOST_PROFILE_TABLE *myProfileTable = NULL;
+#endif
+
+
+static void
+HostProfileSignalHandler(int sig)
+{
+#ifdef TLS_AVAILABLE
+    int savedErrno = errno;
+
+    HOST_PROFILE_TABLE *table = myProfileTable;
+    if (table == NULL)
+    {
+        UINT32 t = nextProfileTable++;
+        if (t >= numProfileTables)
+        {
+            unclaimedSamples++;
+            errno = savedErrno;
+            return;
+        }
+        table = myProfileTable = &profileTables[t];
+    }
+
+    PTR_SIZED_UINT key = ASIM_HOST_PROFILE_Current;
+    INT32 thread = ASIM_SMP_RunningThreadNumber;
+
+    UINT32 h = UINT32((key >> 3) ^ (key >> 17) ^ (thread * 0x9e3779b1));
+    for (UINT32 probe = 0; probe < HOST_PROFILE_MAX_PROBES; probe++)
+    {
+        HOST_PROFILE_ENTRY &e = table->entry[(h + probe) & (HOST_PROFILE_TABLE_SIZE - 1)];
+        if (e.count == 0)
+        {
+            // publish the key before the count makes the entry visible
+            e.key = key;
+            e.thread = thread;
+            MemBarrier();
+            e.count = 1;
+            errno = savedErrno;
+            return;
+        }
+        if (e.key == key && e.thread == thread)
+        {
+            e.count++;
+            errno = savedErrno;
+            return;
+        }
+    }
+    table->dropped++;
+
+    errno = savedErrno;
+#endif
+}
+
+
+void
+ASIM_HOST_PROFILER_CLASS::Start(UINT32 sampleHz)
+{
+    VERIFY(sampleHz > 0 && sampleHz <= 1000000,
+           "Host profiler rate " << sampleHz << " Hz out of range");
+
+    if (profileTables == NULL)
+    {
+        numProfileTables = ASIM_SMP_CLASS::GetMaxThreads() + 4;
+        profileTables = (HOST_PROFILE_TABLE *)
+            calloc(numProfileTables, sizeof(HOST_PROFILE_TABLE));
+        VERIFYX(profileTables != NULL);
+
+        // the handler stays installed after Stop(), since an expiration
+        // may still be pending and SIGPROF would otherwise kill us
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = HostProfileSignalHandler;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        VERIFY(sigaction(SIGPROF, &sa, NULL) == 0,
+               "Host profiler cannot install its SIGPROF handler");
+    }
+
+    hz = sampleHz;
+    startCpuSeconds = ProcessCpuSeconds();
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    VERIFY(setitimer(ITIMER_PROF, &timer, NULL) == 0,
+           "Host profiler cannot start the profiling timer");
+
+    running = true;
+}
+
+
+void
+ASIM_HOST_PROFILER_CLASS::Stop(void)
+{
+    if (! running)
+    {
+        return;
+    }
+
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    cpuSeconds += ProcessCpuSeconds() - startCpuSeconds;
+    running = false;
+}
+
+
+void
+ASIM_HOST_PROFILER_CLASS::Reset(void)
+{
+    VERIFY(! running, "Host profiler reset while sampling");
+
+    for (UINT32 t = 0; t < numProfileTables; t++)
+    {
+        memset(&profileTables[t], 0, sizeof(HOST_PROFILE_TABLE));
+    }
+    unclaimedSamples = 0;
+    cpuSeconds = 0;
+}
+
+
+double
+ASIM_HOST_PROFILER_CLASS::GetCpuSeconds(void)
+{
+    return running ? cpuSeconds + ProcessCpuSeconds() - startCpuSeconds
+                   : cpuSeconds;
+}
+
+
+void
+ASIM_HOST_PROFILER_CLASS::GetSamples(vector<SAMPLE> &samples)
+{
+    // a thread may have changed tables or a table threads, so merge them
+    map< pair<PTR_SIZED_UINT, INT32>, UINT64 > merged;
+    UINT32 claimed = min(UINT32(nextProfileTable), numProfileTables);
+    for (UINT32 t = 0; t < claimed; t++)
+    {
+        for (UINT32 i = 0; i < HOST_PROFILE_TABLE_SIZE; i++)
+        {
+            HOST_PROFILE_ENTRY &e = profileTables[t].entry[i];
+            UINT64 count = e.count;
+            if (count)
+            {
+                MemBarrier();
+                merged[make_pair(e.key, e.thread)] += count;
+            }
+        }
+    }
+
+    samples.clear();
+    map< pair<PTR_SIZED_UINT, INT32>, UINT64 >::iterator it;
+    for (it = merged.begin(); it != merged.end(); ++it)
+    {
+        SAMPLE s;
+        s.object = (const void *)(it->first.first & ~PTR_SIZED_UINT(7));
+        s.phase = ASIM_HOST_PROFILE_PHASE(it->first.first & 7);
+        s.thread = it->first.second;
+        s.count = it->second;
+        samples.push_back(s);
+    }
+}
+
+
+UINT64
+ASIM_HOST_PROFILER_CLASS::GetDropped(void)
+{
+    UINT64 dropped = UINT32(unclaimedSamples);
+    UINT32 claimed = min(UINT32(nextProfileTable), numProfileTables);
+    for (UINT32 t = 0; t < claimed; t++)
+    {
+        dropped += profileTables[t].dropped;
+    }
+    return dropped;
+}
+
+
+const char *
+ASIM_HOST_PROFILER_CLASS::PhaseName(ASIM_HOST_PROFILE_PHASE phase)
+{
+    switch (phase)
+    {
+      case HOST_PROFILE_OTHER:        return "other";
+      case HOST_PROFILE_SCHEDULE:     return "schedule";
+      case HOST_PROFILE_MODULE_CLOCK: return "module_clock";
+      case HOST_PROFILE_RATE_MATCHER: return "rate_matcher";
+      case HOST_PROFILE_BARRIER_WAIT: return "barrier_wait";
+      case HOST_PROFILE_EVENTS:       return "events";
+      default:                        return "unknown";
+    }
+}
+
+
+void
+ASIM_HOST_PROFILER_CLASS::WriteFolded(ostream &out, const map<const void *, string> &names)
+{
+    vector<SAMPLE> samples;
+    GetSamples(samples);
+
+    // build the stacks first, so that equal stacks merge and the output is sorted
+    map<string, UINT64> stacks;
+    for (UINT32 i = 0; i < samples.size(); i++)
+    {
+        ostringstream stack;
+        stack << "thread_" << samples[i].thread << ";" << PhaseName(samples[i].phase);
+
+        if (samples[i].object)
+        {
+            map<const void *, string>::const_iterator n = names.find(samples[i].object);
+            if (n == names.end())
+            {
+                stack << ";" << samples[i].object;
+            }
+            else
+            {
+                // one frame per level of the module hierarchy
+                const string &name = n->second;
+                size_t pos = 0;
+                while (pos < name.size())
+                {
+                    size_t next = name.find('/', pos);
+                    if (next == string::npos)
+                    {
+                        next = name.size();
+                    }
+                    if (next > pos)
+                    {
+                        stack << ";" << name.substr(pos, next - pos);
+                    }
+                    pos = next + 1;
+                }
+            }
+        }
+
+        stacks[stack.str()] += samples[i].count;
+    }
+
+    map<string, UINT64>::iterator it;
+    for (it = stacks.begin(); it != stacks.end(); ++it)
+    {
+        out << it->first << " " << it->second << endl;
+    }
+}
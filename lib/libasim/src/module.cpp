@@ -227,6 +227,57 @@ ASIM_MODULE_CLASS::ClearModuleStats ()
     }
 }
 
+void
+ASIM_MODULE_CLASS::SaveCheckpointTree (ASIM_CHECKPOINT_WRITER ckpt)
+/*
+ * Write a checkpoint section for this module and then recursively for
+ * all contained modules.
+ */
+{
+    ckpt->BeginSection(string("module ") + Path());
+    SaveStats(ckpt);
+    UINT64 mark = ckpt->BeginRecord();
+    SaveCheckpoint(ckpt);
+    ckpt->EndRecord(mark);
+    ckpt->EndSection();
+
+    ASIM_MODULELINK scan = contained;
+    while (scan != NULL)
+    {
+        scan->module->SaveCheckpointTree(ckpt);
+        scan = scan->next;
+    }
+}
+
+void
+ASIM_MODULE_CLASS::RestoreCheckpointTree (ASIM_CHECKPOINT_READER ckpt)
+/*
+ * Restore this module and all contained modules from their checkpoint
+ * sections.  Modules missing from the checkpoint keep their state.
+ */
+{
+    if (ckpt->OpenSection(string("module ") + Path()))
+    {
+        RestoreStats(ckpt);
+        UINT64 len = ckpt->ReadUINT64();
+        VERIFY(len == ckpt->Left(), "Corrupt checkpoint of module " << Path());
+        RestoreCheckpoint(ckpt);
+        VERIFY(ckpt->Left() == 0,
+               "Module " << Path() << " did not restore its checkpoint state");
+    }
+    else
+    {
+        ASIMWARNING("Module " << Path() << " not found in the checkpoint" << endl);
+    }
+
+    ASIM_MODULELINK scan = contained;
+    while (scan != NULL)
+    {
+        scan->module->RestoreCheckpointTree(ckpt);
+        scan = scan->next;
+    }
+}
+
 // Functional save
 void
 ASIM_MODULE_CLASS::DumpFunctionalState (ostream& saveFuncState)
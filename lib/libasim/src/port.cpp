@@ -37,6 +37,8 @@
 // generic
 #include <typeinfo>
 #include <iostream>
+#include <sstream>
+#include <map>
 
 // ASIM core
 #include "asim/port.h"
@@ -474,3 +476,71 @@ BasePort::ConnectAll()
     }
 }
 
+
+//
+// Each port that owns a buffer gets its own checkpoint section, named
+// after the port and its position among ports of the same name, so
+// that ports are matched by name rather than by creation order.
+//
+static string
+PortCheckpointSection(const BasePort *port, map<string, int> &seen)
+{
+    ostringstream key;
+    key << port->GetName() << "[" << port->GetInstance() << "]";
+    ostringstream section;
+    section << "port " << key.str() << " " << seen[key.str()]++;
+    return section.str();
+}
+
+UINT32
+BasePort::SaveAllPorts(ASIM_CHECKPOINT_WRITER ckpt)
+{
+    UINT32 dropped = 0;
+    map<string, int> seen;
+
+    for (asim::Vector<BasePort*>::Iterator i = AllPorts.Begin();
+         i != AllPorts.End();
+         ++i)
+    {
+        if ((*i)->GetName() == NULL ||
+            ((*i)->GetType() != ReadType && (*i)->GetType() != ReadPhaseType))
+        {
+            continue;
+        }
+
+        ckpt->BeginSection(PortCheckpointSection(*i, seen));
+        if (! (*i)->SaveCheckpoint(ckpt))
+        {
+            ASIMWARNING("Port " << (*i)->GetName() << "[" << (*i)->GetInstance()
+                        << "] holds data that cannot be checkpointed" << endl);
+            dropped++;
+        }
+        ckpt->EndSection();
+    }
+
+    return dropped;
+}
+
+void
+BasePort::RestoreAllPorts(ASIM_CHECKPOINT_READER ckpt)
+{
+    map<string, int> seen;
+
+    for (asim::Vector<BasePort*>::Iterator i = AllPorts.Begin();
+         i != AllPorts.End();
+         ++i)
+    {
+        if ((*i)->GetName() == NULL ||
+            ((*i)->GetType() != ReadType && (*i)->GetType() != ReadPhaseType))
+        {
+            continue;
+        }
+
+        if (! ckpt->OpenSection(PortCheckpointSection(*i, seen)) ||
+            ! (*i)->RestoreCheckpoint(ckpt))
+        {
+            ASIMWARNING("Port " << (*i)->GetName() << "[" << (*i)->GetInstance()
+                        << "] not restored from the checkpoint" << endl);
+        }
+    }
+}
@@ -79,6 +79,7 @@ Regex::Regex()
 int
 Regex::create(const char *pattern, bool caseSensitive)
 {
+    this->pattern = pattern;
     int flags = REG_EXTENDED;
     if (! caseSensitive)
     {
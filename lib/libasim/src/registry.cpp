@@ -238,6 +238,73 @@ ASIM_REGISTRY_CLASS::ClearStats ()
     }
 }
 
+void
+ASIM_REGISTRY_CLASS::SaveStats (ASIM_CHECKPOINT_WRITER ckpt)
+/*
+ * Checkpoint stats, each as a record named after the state
+ */
+{
+    UINT64 n = 0;
+    for (ASIM_STATELINK sscan = states; sscan != NULL; sscan = sscan->next)
+    {
+        n++;
+    }
+    ckpt->WriteUINT64(n);
+
+    for (ASIM_STATELINK sscan = states; sscan != NULL; sscan = sscan->next)
+    {
+        ckpt->WriteString(sscan->state->Name());
+        UINT64 mark = ckpt->BeginRecord();
+        sscan->state->SaveCheckpoint(ckpt);
+        ckpt->EndRecord(mark);
+    }
+}
+
+void
+ASIM_REGISTRY_CLASS::RestoreStats (ASIM_CHECKPOINT_READER ckpt)
+/*
+ * Restore checkpointed stats.  They are normally found in the order
+ * they were saved; stats that are gone or changed shape are skipped.
+ */
+{
+    UINT64 n = ckpt->ReadUINT64();
+    ASIM_STATELINK next = states;
+    for (UINT64 i = 0; i < n; i++)
+    {
+        string name = ckpt->ReadString();
+        UINT64 len = ckpt->ReadUINT64();
+        VERIFY(len <= ckpt->Left(), "Corrupt checkpoint of stats " << regPath);
+        UINT64 after = ckpt->Left() - len;
+
+        ASIM_STATE state = NULL;
+        if (next != NULL && name == next->state->Name())
+        {
+            state = next->state;
+            next = next->next;
+        }
+        else
+        {
+            ASIM_STATELINK sscan = states;
+            while (sscan != NULL && name != sscan->state->Name())
+            {
+                sscan = sscan->next;
+            }
+            if (sscan != NULL)
+            {
+                state = sscan->state;
+                next = sscan->next;
+            }
+        }
+
+        if (state == NULL || !state->RestoreCheckpoint(ckpt))
+        {
+            ASIMWARNING("Stat " << (regPath ? regPath : "") << "/" << name
+                        << " not restored from the checkpoint" << endl);
+        }
+        ckpt->Skip(ckpt->Left() - after);
+    }
+}
+
 void
 ASIM_REGISTRY_CLASS::RegisterStripChart (const char *description, UINT64 frequency, UINT64 *data, UINT64 threads, UINT64 max_elems, UINT32 cpunum)
 {
@@ -37,6 +37,12 @@
 #include "asim/smp.h"
 #include "asim/atomic.h"
 #include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
 #include "asim/mesg.h"
 
 
@@ -46,6 +52,8 @@ ASIM_SMP_THREAD_HANDLE ASIM_SMP_CLASS::mainThread;
 pthread_key_t ASIM_SMP_CLASS::threadLocalKey;
 UINT32 ASIM_SMP_CLASS::maxThreads = 0;
 ATOMIC32_CLASS ASIM_SMP_CLASS::activeThreads = 0;
+ATOMIC32_CLASS ASIM_SMP_CLASS::helperThreads = 0;
+std::vector<INT32> ASIM_SMP_CLASS::cpuMap;
 
 #ifdef TLS_AVAILABLE
 __thread INT32 ASIM_SMP_RunningThreadNumber = 0;
@@ -143,8 +151,15 @@ ASIM_SMP_CLASS::ThreadEntry(void *arg)
     ASIM_SMP_THREAD_HANDLE threadHandle = ASIM_SMP_THREAD_HANDLE(arg);
 
     SetThreadHandle(threadHandle);
+    PinCurrentThread();
 
-    cout << "Thread " << GetRunningThreadNumber() << " created." << endl;
+    cout << "Thread " << GetRunningThreadNumber() << " created";
+    if (PlacementEnabled())
+    {
+        cout << " on cpu " << GetThreadCpu(GetRunningThreadNumber())
+             << " node " << GetThreadNode(GetRunningThreadNumber());
+    }
+    cout << "." << endl;
     
     // Call the real entry function
     return (*(threadHandle->start_routine))(threadHandle->threadCreateArg);
@@ -178,3 +193,127 @@ ASIM_SMP_CLASS::SetThreadHandle(ASIM_SMP_THREAD_HANDLE threadHandle)
 
     VERIFYX(0 == pthread_setspecific(threadLocalKey, threadHandle));
 }
+
+
+//
+// Parse a cpu list of the form "0-3,8,10-11" into the cpu map.
+//
+void
+ASIM_SMP_CLASS::SetCpuMap(const char *cpuList)
+{
+    cpuMap.clear();
+    if (cpuList == NULL)
+    {
+        return;
+    }
+
+    const char *p = cpuList;
+    while (*p)
+    {
+        char *end;
+        long first = strtol(p, &end, 10);
+        VERIFY(end != p && first >= 0, "Bad cpu map \"" << cpuList << "\"");
+        long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            VERIFY(end != p + 1 && last >= first, "Bad cpu map \"" << cpuList << "\"");
+            p = end;
+        }
+        for (long c = first; c <= last; c++)
+        {
+            cpuMap.push_back(c);
+        }
+        if (*p == ',')
+        {
+            p++;
+        }
+        else
+        {
+            VERIFY(*p == 0, "Bad cpu map \"" << cpuList << "\"");
+        }
+    }
+
+    PinCurrentThread();
+}
+
+
+INT32
+ASIM_SMP_CLASS::GetThreadCpu(INT32 threadNumber)
+{
+    if (cpuMap.empty() || threadNumber < 0)
+    {
+        return -1;
+    }
+    return cpuMap[threadNumber % cpuMap.size()];
+}
+
+
+INT32
+ASIM_SMP_CLASS::GetThreadNode(INT32 threadNumber)
+{
+    return GetCpuNode(GetThreadCpu(threadNumber));
+}
+
+
+//
+// Linux exposes the node of each cpu as a nodeN entry in its sysfs directory.
+//
+INT32
+ASIM_SMP_CLASS::GetCpuNode(INT32 cpu)
+{
+    if (cpu < 0)
+    {
+        return -1;
+    }
+
+    INT32 node = -1;
+#ifdef __linux__
+    ostringstream path;
+    path << "/sys/devices/system/cpu/cpu" << cpu;
+    DIR *dir = opendir(path.str().c_str());
+    if (dir == NULL)
+    {
+        return -1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        int n;
+        if (sscanf(entry->d_name, "node%d", &n) == 1)
+        {
+            node = n;
+            break;
+        }
+    }
+    closedir(dir);
+#endif
+    return node;
+}
+
+
+//
+// Pin the calling thread to its entry in the cpu map, if there is one.
+// Failure (e.g. a cpu outside our cpuset) is reported but not fatal.
+//
+void
+ASIM_SMP_CLASS::PinCurrentThread(void)
+{
+#ifdef __linux__
+    INT32 cpu = GetThreadCpu(GetRunningThreadNumber());
+    if (cpu < 0)
+    {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        cerr << "WARNING: unable to pin thread " << GetRunningThreadNumber()
+             << " to cpu " << cpu << endl;
+    }
+#endif
+}
@@ -55,6 +55,8 @@ const char * const STATE_OUT_CLASS::elementText     = "text";
 const char * const STATE_OUT_CLASS::elementType     = "type";
 const char * const STATE_OUT_CLASS::elementName     = "name";
 const char * const STATE_OUT_CLASS::elementDesc     = "desc";
+const char * const STATE_OUT_CLASS::attributeSize   = "size";
+const char * const STATE_OUT_CLASS::attributeIndex  = "index";
 
 /**
  * Create a new stats ouput object and associate it with output
@@ -41,10 +41,16 @@ char stripFile[128] = "strips.stb";
 #include <string>
 #include <sstream>
 
+// generic (C)
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
 // ASIM core
 #include "asim/stripchart.h"
 #include "asim/mesg.h"
 #include "asim/ioformat.h"
+#include "asim/smp.h"
 
 /**
  * GCD() and GCD2() are two recursive functions to calculate Greatest
@@ -205,13 +211,22 @@ ASIM_STRIP_CHART_CLASS::ASIM_STRIP_CHART_CLASS()
     lines=strips=blocks=markers=bytes_per_line=0;
     version=11;
     WriteCounters();
+
+    ring=NULL;
+    ring_slots=0;
+    record_bytes=0;
+    ring_head=ring_tail=0;
+    writer_running=false;
+    writer_stop=false;
 }
 
 /**
- * Default destructor. It only close the opened file.
+ * Default destructor. It writes out the pending samples and closes
+ * the opened file.
  */
 ASIM_STRIP_CHART_CLASS::~ASIM_STRIP_CHART_CLASS()
 {
+    StopWriter();
     out.close();
 }
 
@@ -250,15 +265,16 @@ ASIM_STRIP_CHART_CLASS::RegisterStripChart(
     const UINT32 cpunum)        ///< ? documentation ?
 {
     //
-    // If code breaks at this assert you are adding
-    // extra stripcharts and you must increase MAX_STRIP_CHART
-    // to allow the new value.
+    // A new stripchart makes every line longer, so the records already
+    // taken are written out and the ring is sized again on the next
+    // Dump.
     //
-    ASSERTX(actives<MAX_STRIP_CHART);
+    StopWriter();
 
     //
     // Takes an stripchart an assign the values.
     //
+    table.push_back(ASIM_STRIP_NODE_CLASS());
     table[actives].AssignValues(description,frequency,data,threads,max_elems,
         cpunum);
     general_frequency=actives==0? frequency : GCD(general_frequency,frequency);
@@ -288,19 +304,20 @@ ASIM_STRIP_CHART_CLASS::RegisterStripChart(
 void
 ASIM_STRIP_CHART_CLASS::HeadDump()
 {
+    StopWriter();
     out.flush();
 }
 
 /**
  * This routine takes the data assigned to all the stripcharts and
- * puts this data into output file.
+ * hands it to the writer thread.  Only the raw values are copied
+ * here; the file is written in the background.
  */
 void
 ASIM_STRIP_CHART_CLASS::Dump(
     const UINT64 cycle) ///< ? documentation ?
 {
     UINT64 *tmp_data;
-    UINT64 head_id=0;
 
     if(stripsOn==false) return;
 
@@ -309,18 +326,17 @@ ASIM_STRIP_CHART_CLASS::Dump(
     }
 
     if((cycle % general_frequency)==0) {
-        out.write((char *)&head_id,sizeof(head_id));
-        out.write((char *)&cycle,sizeof(cycle));
+        UINT64 *record=(UINT64 *)NewRecord();
+        *record++=0; // head id
+        *record++=cycle;
         for(UINT32 i=0; i<actives;i++) {
             tmp_data=table[i].Dump();
             for(UINT64 j=0; j<table[i].Threads();j++){
-        	out.write((char *)&(tmp_data[j]),sizeof(tmp_data[j]));
+                *record++=tmp_data[j];
             }
             table[i].Reset();
         }
-        lines++;
-        WriteCounters();
-        out.flush();
+        PushRecord();
     }
 }
 
@@ -329,22 +345,171 @@ void
 ASIM_STRIP_CHART_CLASS::DumpRAWString(
     const string & str) ///< ? documentation ?
 {
-    UINT64 bytes=8;
     UINT64 head_id=1;
 
     if(stripsOn==false) return;
 
-    for(UINT32 i=0; i<actives;i++) {
-        bytes=bytes+(table[i].Threads()*8);
+    UINT8 *record=NewRecord();
+    UINT64 bytes=record_bytes-sizeof(head_id);
+    UINT64 length=str.length() < bytes ? str.length() : bytes;
+
+    memcpy(record,&head_id,sizeof(head_id));
+    memcpy(record+sizeof(head_id),str.data(),length);
+    memset(record+sizeof(head_id)+length,' ',bytes-length);
+    PushRecord();
+}
+
+/**
+ * Called before fork(): write out the pending records and stop the
+ * writer, so that the file is up to date and no thread is running.
+ * The next Dump starts the writer again.
+ */
+void
+ASIM_STRIP_CHART_CLASS::PrepareFork()
+{
+    StopWriter();
+    out.flush();
+}
+
+/**
+ * Called in the child after fork(): the file belongs to the parent, so
+ * the child stops adding strips and closes its copy without writing.
+ */
+void
+ASIM_STRIP_CHART_CLASS::ForkedChild()
+{
+    stripsOn=false;
+    out.close();
+}
+
+//----------------------------------------------------------------------------
+// writer thread
+//----------------------------------------------------------------------------
+
+/**
+ * Return the next free record, starting the writer on first use.  If
+ * the ring is full the simulation waits for the writer to catch up.
+ */
+UINT8 *
+ASIM_STRIP_CHART_CLASS::NewRecord()
+{
+    if(ring==NULL) {
+        StartWriter();
+    }
+    while(ring_tail-ring_head==ring_slots) {
+        if(writer_running) {
+            sched_yield();
+        } else {
+            WriteRecords();
+        }
+    }
+    __sync_synchronize();
+    return (UINT8 *)ring+(ring_tail%ring_slots)*record_bytes;
+}
+
+/**
+ * Publish the record returned by NewRecord to the writer.
+ */
+void
+ASIM_STRIP_CHART_CLASS::PushRecord()
+{
+    __sync_synchronize();
+    ring_tail++;
+    if(writer_running) {
+        sem_post(&ring_ready);
+    } else {
+        WriteRecords();
+    }
+}
+
+/**
+ * Size the ring for the current lines, up to 16MB or 1024 lines, and
+ * start the writer.  Without a thread the records are written as soon
+ * as they are added, like they always were.
+ */
+void
+ASIM_STRIP_CHART_CLASS::StartWriter()
+{
+    record_bytes=2*sizeof(UINT64)+strips*sizeof(UINT64);
+    ring_slots=(16<<20)/record_bytes;
+    ring_slots=ring_slots<4 ? 4 : (ring_slots>1024 ? 1024 : ring_slots);
+    ring=new UINT64[ring_slots*record_bytes/sizeof(UINT64)];
+    ring_head=ring_tail=0;
+
+    writer_stop=false;
+    VERIFYX(sem_init(&ring_ready,0,0)==0);
+    writer_running=(pthread_create(&writer,NULL,WriterMain,this)==0);
+    if(writer_running) {
+        ASIM_SMP_CLASS::NoteHelperThreadStarted();
+    } else {
+        ASIMWARNING("Strip charts: no writer thread, writing in line"
+                    << endl);
+        sem_destroy(&ring_ready);
+    }
+}
+
+/**
+ * Write out the pending records and stop the writer.  The ring is
+ * freed too, so the next Dump sizes it again.
+ */
+void
+ASIM_STRIP_CHART_CLASS::StopWriter()
+{
+    if(writer_running) {
+        writer_stop=true;
+        sem_post(&ring_ready);
+        pthread_join(writer,NULL);
+        sem_destroy(&ring_ready);
+        writer_running=false;
+        ASIM_SMP_CLASS::NoteHelperThreadStopped();
+    }
+    if(ring!=NULL) {
+        WriteRecords();
+        delete [] ring;
+        ring=NULL;
+    }
+}
+
+/**
+ * Append all published records to the file and update the header.
+ * Called by the writer thread, or by the simulation thread when there
+ * is no writer.
+ */
+void
+ASIM_STRIP_CHART_CLASS::WriteRecords()
+{
+    UINT64 tail=ring_tail;
+    __sync_synchronize();
+
+    if(ring_head==tail) {
+        return;
+    }
+    while(ring_head!=tail) {
+        UINT64 *record=ring+(ring_head%ring_slots)*(record_bytes/sizeof(UINT64));
+        out.write((char *)record,record_bytes);
+        lines++;
+        if(record[0]==1) {
+            markers++;
+        }
+        __sync_synchronize();
+        ring_head++;
     }
-    
-    
-    out.write((char *)&head_id,sizeof(head_id));
-    out.write(str.c_str(),str.length());
-    for(UINT32 i=0;i<bytes-str.length();i++) out.write(" ",1);
-    lines++;
-    markers++;
     WriteCounters();
     out.flush();
 }
 
+void *
+ASIM_STRIP_CHART_CLASS::WriterMain(
+    void *arg)
+{
+    ASIM_STRIP_CHART strip=(ASIM_STRIP_CHART)arg;
+
+    for(;;) {
+        while(sem_wait(&strip->ring_ready)!=0 && errno==EINTR);
+        strip->WriteRecords();
+        if(strip->writer_stop && strip->ring_head==strip->ring_tail) {
+            break;
+        }
+    }
+    return NULL;
+}
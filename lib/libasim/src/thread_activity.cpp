@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Host time accounting for the threads of threaded clockservers.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "asim/thread_activity.h"
+#include "asim/atomic.h"
+#include "asim/mesg.h"
+
+
+bool ASIM_THREAD_ACTIVITY_CLASS::enabled = false;
+
+
+//
+// One slot per pthread, padded so that threads never share a line.
+// Only the owning thread writes it.
+//
+struct THREAD_ACTIVITY_SLOT
+{
+    volatile UINT64 time[THREAD_ACTIVITY_NACTIVITIES];
+    volatile UINT64 workEndNs;      // when this thread last stopped working
+    UINT64 lastSwitchNs;
+    ASIM_THREAD_ACTIVITY current;
+    UINT32 index;
+} __attribute__ ((aligned (64)));
+
+static THREAD_ACTIVITY_SLOT *activitySlots = NULL;
+static UINT32 numActivitySlots = 0;
+static ATOMIC32_CLASS nextActivitySlot = 0;
+
+// Owned by the clock server thread
+static UINT64 *criticalCycles = NULL;
+static bool intervalsOn = false;
+static UINT64 *snapshotTime[THREAD_ACTIVITY_NACTIVITIES];
+static UINT64 *intervalTime[THREAD_ACTIVITY_NACTIVITIES];
+static UINT64 *intervalCritical = NULL;
+
+#ifdef TLS_AVAILABLE
+static __thread THREAD_ACTIVITY_SLOT *myActivitySlot = NULL;
+static __thread bool myActivitySlotFull = false;
+#endif
+
+
+void
+ASIM_THREAD_ACTIVITY_CLASS::Enable(UINT32 nSlots, bool intervals)
+{
+#ifdef TLS_AVAILABLE
+    if (enabled)
+    {
+        return;
+    }
+
+    numActivitySlots = nSlots;
+    activitySlots = new THREAD_ACTIVITY_SLOT[nSlots];
+    memset(activitySlots, 0, nSlots * sizeof(THREAD_ACTIVITY_SLOT));
+    criticalCycles = new UINT64[nSlots];
+    memset(criticalCycles, 0, nSlots * sizeof(UINT64));
+    for (UINT32 a = 0; a < THREAD_ACTIVITY_NACTIVITIES; a++)
+    {
+        snapshotTime[a] = new UINT64[nSlots];
+        memset(snapshotTime[a], 0, nSlots * sizeof(UINT64));
+        intervalTime[a] = new UINT64[nSlots];
+        memset(intervalTime[a], 0, nSlots * sizeof(UINT64));
+    }
+    intervalCritical = new UINT64[nSlots];
+    memset(intervalCritical, 0, nSlots * sizeof(UINT64));
+    intervalsOn = intervals;
+
+    enabled = true;
+
+    // the calling (clock server) thread takes slot 0, and is working
+    Switch(THREAD_ACTIVITY_WORK);
+#endif
+}
+
+
+ASIM_THREAD_ACTIVITY
+ASIM_THREAD_ACTIVITY_CLASS::SwitchSlow(ASIM_THREAD_ACTIVITY activity)
+{
+#ifdef TLS_AVAILABLE
+    UINT64 now = NowNs();
+
+    THREAD_ACTIVITY_SLOT *slot = myActivitySlot;
+    if (slot == NULL)
+    {
+        if (myActivitySlotFull)
+        {
+            return activity;
+        }
+        UINT32 n = nextActivitySlot++;
+        if (n >= numActivitySlots)
+        {
+            myActivitySlotFull = true;
+            return activity;
+        }
+
+        // a new thread starts out waiting for work
+        slot = myActivitySlot = &activitySlots[n];
+        slot->index = n;
+        slot->current = (n == 0) ? THREAD_ACTIVITY_WORK : THREAD_ACTIVITY_SPIN;
+        slot->lastSwitchNs = now;
+    }
+
+    ASIM_THREAD_ACTIVITY prev = slot->current;
+    UINT64 delta = now - slot->lastSwitchNs;
+    slot->time[prev] += delta;
+
+    if (prev == THREAD_ACTIVITY_WORK && activity != THREAD_ACTIVITY_WORK)
+    {
+        slot->workEndNs = now;
+    }
+
+    slot->current = activity;
+    slot->lastSwitchNs = now;
+    return prev;
+#else
+    return activity;
+#endif
+}
+
+
+void
+ASIM_THREAD_ACTIVITY_CLASS::CountCriticalPath(UINT64 sinceNs)
+{
+    if (! enabled)
+    {
+        return;
+    }
+
+    THREAD_ACTIVITY_SLOT *last = NULL;
+    UINT32 claimed = GetNumSlots();
+    for (UINT32 n = 0; n < claimed; n++)
+    {
+        UINT64 end = activitySlots[n].workEndNs;
+        if (end >= sinceNs && (last == NULL || end > last->workEndNs))
+        {
+            last = &activitySlots[n];
+        }
+    }
+
+    if (last)
+    {
+        criticalCycles[last->index]++;
+        intervalCritical[last->index]++;
+    }
+
+    // add what every slot accumulated since the previous cycle; the
+    // strip charts clear the interval arrays, never the slots
+    if (intervalsOn)
+    {
+        for (UINT32 n = 0; n < claimed; n++)
+        {
+            for (UINT32 a = 0; a < THREAD_ACTIVITY_NACTIVITIES; a++)
+            {
+                UINT64 now = activitySlots[n].time[a];
+                intervalTime[a][n] += now - snapshotTime[a][n];
+                snapshotTime[a][n] = now;
+            }
+        }
+    }
+}
+
+
+UINT32
+ASIM_THREAD_ACTIVITY_CLASS::GetNumSlots(void)
+{
+    UINT32 claimed = UINT32(int(nextActivitySlot));
+    return claimed < numActivitySlots ? claimed : numActivitySlots;
+}
+
+
+UINT64
+ASIM_THREAD_ACTIVITY_CLASS::GetTime(UINT32 slot, ASIM_THREAD_ACTIVITY activity)
+{
+    ASSERTX(slot < numActivitySlots);
+    return activitySlots[slot].time[activity];
+}
+
+
+UINT64
+ASIM_THREAD_ACTIVITY_CLASS::GetCriticalCycles(UINT32 slot)
+{
+    ASSERTX(slot < numActivitySlots);
+    return criticalCycles[slot];
+}
+
+
+UINT64 *
+ASIM_THREAD_ACTIVITY_CLASS::GetIntervalTime(ASIM_THREAD_ACTIVITY activity)
+{
+    return intervalTime[activity];
+}
+
+
+UINT64 *
+ASIM_THREAD_ACTIVITY_CLASS::GetIntervalCritical(void)
+{
+    return intervalCritical;
+}
+
+
+const char *
+ASIM_THREAD_ACTIVITY_CLASS::ActivityName(ASIM_THREAD_ACTIVITY activity)
+{
+    switch (activity)
+    {
+      case THREAD_ACTIVITY_WORK:  return "work";
+      case THREAD_ACTIVITY_SPIN:  return "spin";
+      case THREAD_ACTIVITY_YIELD: return "yield";
+      case THREAD_ACTIVITY_LOCK:  return "lock";
+      default:                    return "unknown";
+    }
+}
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief Per-thread buffered trace and DRAL event output.
+ **/
+
+#include "asim/thread_sink.h"
+#include "asim/smp.h"
+#include "asim/trace.h"
+#include "asim/event.h"
+#include "asim/mesg.h"
+#include "asim/host_profiler.h"
+
+
+#ifdef TLS_AVAILABLE
+static __thread ASIM_THREAD_SINK currentSink = NULL;
+#else
+static pthread_key_t currentSinkKey;
+static pthread_once_t currentSinkOnce = PTHREAD_ONCE_INIT;
+static void CreateSinkKey(void) { pthread_key_create(&currentSinkKey, NULL); }
+#endif
+
+vector<ASIM_THREAD_SINK_CLASS::MARKER> ASIM_THREAD_SINK_CLASS::markers;
+UINT32 ASIM_THREAD_SINK_CLASS::nextMarker = 0;
+
+
+ASIM_THREAD_SINK_CLASS::ASIM_THREAD_SINK_CLASS()
+  : itemIdLane(0),
+    open(NULL)
+{
+    pthread_mutex_init(&lock, NULL);
+}
+
+
+ASIM_THREAD_SINK_CLASS::~ASIM_THREAD_SINK_CLASS()
+{
+    delete open;
+    for (UINT32 i = 0; i < closed.size(); i++)
+    {
+        delete closed[i];
+    }
+    for (UINT32 i = 0; i < spare.size(); i++)
+    {
+        delete spare[i];
+    }
+    pthread_mutex_destroy(&lock);
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::Attach(ASIM_THREAD_SINK sink)
+{
+#ifdef TLS_AVAILABLE
+    currentSink = sink;
+#else
+    pthread_once(&currentSinkOnce, CreateSinkKey);
+    pthread_setspecific(currentSinkKey, sink);
+#endif
+    DRAL_SERVER_CLASS::SetThreadIndex(sink ? sink->itemIdLane : 0);
+    if (sink == NULL)
+    {
+        DRAL_SERVER_CLASS::AttachRecorder(NULL);
+    }
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::Prepare(const vector<ASIM_THREAD_SINK> &sinks)
+{
+    for (UINT32 s = 0; s < sinks.size(); s++)
+    {
+        sinks[s]->itemIdLane = s + 1;
+    }
+    DRAL_SERVER_CLASS::SetThreads(sinks.size() + 1);
+}
+
+
+ASIM_THREAD_SINK
+ASIM_THREAD_SINK_CLASS::Current(void)
+{
+#ifdef TLS_AVAILABLE
+    return currentSink;
+#else
+    pthread_once(&currentSinkOnce, CreateSinkKey);
+    return (ASIM_THREAD_SINK) pthread_getspecific(currentSinkKey);
+#endif
+}
+
+
+ASIM_THREAD_SINK_CLASS::SEGMENT *
+ASIM_THREAD_SINK_CLASS::NewSegment(void)
+{
+    SEGMENT *seg = NULL;
+    pthread_mutex_lock(&lock);
+    if (! spare.empty())
+    {
+        seg = spare.back();
+        spare.pop_back();
+    }
+    pthread_mutex_unlock(&lock);
+    return seg ? seg : new SEGMENT;
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::BeginCycle(UINT64 baseCycle)
+{
+    if (open == NULL)
+    {
+        open = NewSegment();
+    }
+    open->cycle = baseCycle;
+    open->step = 0;
+    DRAL_SERVER_CLASS::AttachRecorder(&open->dral);
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::SetStep(UINT32 step)
+{
+    ASSERTX(open != NULL && step >= open->step);
+
+    if (step == open->step)
+    {
+        return;
+    }
+
+    // the output of the previous step goes into its own segment
+    UINT64 cycle = open->cycle;
+    EndCycle();
+    BeginCycle(cycle);
+    open->step = step;
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::EndCycle(void)
+{
+    ASSERTX(open != NULL);
+
+    // nothing was produced: keep the segment for the next cycle
+    if (open->trace.empty() && open->dral.Empty())
+    {
+        return;
+    }
+
+    DRAL_SERVER_CLASS::AttachRecorder(NULL);
+    pthread_mutex_lock(&lock);
+    closed.push_back(open);
+    pthread_mutex_unlock(&lock);
+    open = NULL;
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::Trace(const std::ostringstream &out)
+{
+    ASSERTX(open != NULL);
+
+    std::ostringstream line;
+    line << std::dec << pthread_self() << ": " << out.str() << endl;
+    open->trace += line.str();
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::Marker(UINT32 step, UINT16 clockId, UINT64 cycle, UINT16 phase)
+{
+    ASSERTX(markers.empty() || markers.back().step <= step);
+
+    MARKER m;
+    m.step = step;
+    m.clockId = clockId;
+    m.cycle = cycle;
+    m.phase = phase;
+    markers.push_back(m);
+}
+
+
+//
+// Write the queued markers of the steps up to and including step through
+// the DRAL server, so auto-flush nodes and sync points are handled the
+// way the sequential clockserver handles them.
+//
+void
+ASIM_THREAD_SINK_CLASS::WriteMarkers(UINT32 step)
+{
+    for ( ; nextMarker < markers.size() && markers[nextMarker].step <= step; nextMarker++)
+    {
+        const MARKER &m = markers[nextMarker];
+        if (ASIM_DRAL_EVENT_CLASS::event)
+        {
+            ASIM_DRAL_EVENT_CLASS::event->Cycle(m.clockId, m.cycle, m.phase);
+        }
+    }
+}
+
+
+void
+ASIM_THREAD_SINK_CLASS::Merge(const vector<ASIM_THREAD_SINK> &sinks, UINT64 baseCycle)
+{
+    ASIM_HOST_PROFILE_SCOPE profile(NULL, HOST_PROFILE_EVENTS);
+
+    // take the segments that are ready from every sink
+    vector< deque<SEGMENT *> > ready(sinks.size());
+    UINT32 pending = 0;
+    for (UINT32 s = 0; s < sinks.size(); s++)
+    {
+        ASIM_THREAD_SINK sink = sinks[s];
+        pthread_mutex_lock(&sink->lock);
+        while (! sink->closed.empty() && sink->closed.front()->cycle <= baseCycle)
+        {
+            ready[s].push_back(sink->closed.front());
+            sink->closed.pop_front();
+            pending++;
+        }
+        pthread_mutex_unlock(&sink->lock);
+    }
+
+    // write them out, earliest (cycle, step) first, ties broken by sink
+    // order, with the markers of baseCycle ahead of their steps
+    while (pending > 0)
+    {
+        UINT32 best = 0;
+        for (UINT32 s = 0; s < ready.size(); s++)
+        {
+            if (ready[s].empty())
+            {
+                continue;
+            }
+            if (ready[best].empty())
+            {
+                best = s;
+                continue;
+            }
+            SEGMENT *a = ready[s].front();
+            SEGMENT *b = ready[best].front();
+            if (a->cycle < b->cycle || (a->cycle == b->cycle && a->step < b->step))
+            {
+                best = s;
+            }
+        }
+
+        SEGMENT *seg = ready[best].front();
+        ready[best].pop_front();
+        pending--;
+
+        if (seg->cycle == baseCycle)
+        {
+            WriteMarkers(seg->step);
+        }
+
+        if (! seg->trace.empty())
+        {
+            *TRACEABLE_CLASS::GetTraceStream() << seg->trace;
+        }
+        if (! seg->dral.Empty() && ASIM_DRAL_EVENT_CLASS::event)
+        {
+            ASIM_DRAL_EVENT_CLASS::event->ReplayRecorder(&seg->dral);
+        }
+
+        seg->trace.clear();
+        seg->dral.Clear();
+        pthread_mutex_lock(&sinks[best]->lock);
+        sinks[best]->spare.push_back(seg);
+        pthread_mutex_unlock(&sinks[best]->lock);
+    }
+
+    // markers of the steps that produced no output
+    WriteMarkers(UINT32_MAX);
+    markers.clear();
+    nextMarker = 0;
+}
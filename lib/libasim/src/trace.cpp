@@ -28,6 +28,10 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <strings.h>
+#include <string.h>
+#include <ctype.h>
+
 #include <asim/trace.h>
 
 // Include support for the old trace format.
@@ -40,7 +44,7 @@ using namespace std;
 
 bool printTraceNames = false;
 
-list<TRACEABLE> *TRACEABLE_CLASS::traceables = 0;
+TRACEABLE_NAME_MAP *TRACEABLE_CLASS::traceables = 0;
 pthread_mutex_t TRACEABLE_CLASS::traceablesMutex = PTHREAD_MUTEX_INITIALIZER;
 
 UNCONDITIONAL_TRACEABLE_CLASS _unconditionalTraceable;
@@ -48,6 +52,7 @@ UNCONDITIONAL_TRACEABLE unconditionalTraceable = &_unconditionalTraceable;
 
 TRACEABLE_REGEX_LIST *TRACEABLE_CLASS::regexes = 0;
 pthread_mutex_t TRACEABLE_CLASS::regexesMutex = PTHREAD_MUTEX_INITIALIZER;
+unsigned int TRACEABLE_CLASS::regexGeneration = 1;
 
 bool TRACEABLE_CLASS::enableThreadProtection = true;
 
@@ -61,17 +66,13 @@ TRACEABLE_CLASS::TRACEABLE_CLASS()
         LOCK_MUTEX(traceablesMutex);
         if(!traceables) 
         {
-            traceables = new list<TRACEABLE>();
+            traceables = new TRACEABLE_NAME_MAP();
         }
         UNLOCK_MUTEX(traceablesMutex);
     }
-    // Append this to the traceables list
+    // Add this to the (unnamed) traceables
     LOCK_MUTEX(traceablesMutex);
-    traceables->push_back(this);
-
-    // Store an iterator pointing to me on the list to make removal fast.
-    myTraceablesEntry = traceables->end();
-    --myTraceablesEntry;
+    AddToName();
     UNLOCK_MUTEX(traceablesMutex);
 
     SetTraceOn(false);
@@ -81,18 +82,13 @@ TRACEABLE_CLASS::TRACEABLE_CLASS()
 TRACEABLE_CLASS::TRACEABLE_CLASS(const TRACEABLE_CLASS& t) 
 {
     assert(traceables);
+    objectName = t.objectName;
     LOCK_MUTEX(traceablesMutex);
-    // Append this to the traceables list
-    traceables->push_back(this);
-
-    // Store an interator pointing to me on the list to make removal fast.
-    myTraceablesEntry = traceables->end();
-    --myTraceablesEntry;
+    AddToName();
     UNLOCK_MUTEX(traceablesMutex);
 
     SetTraceOn(t.myTraceOn);
     SetTraceLevel(t.traceLevel);
-    SetObjectName(t.objectName);
 }
 
 TRACEABLE_CLASS::~TRACEABLE_CLASS() 
@@ -100,7 +96,7 @@ TRACEABLE_CLASS::~TRACEABLE_CLASS()
     assert(traceables);
     assert(*myTraceablesEntry == this);
     LOCK_MUTEX(traceablesMutex);
-    traceables->erase(myTraceablesEntry);
+    RemoveFromName();
     if(traceables->empty()) 
     {
         delete(traceables);
@@ -109,36 +105,69 @@ TRACEABLE_CLASS::~TRACEABLE_CLASS()
     UNLOCK_MUTEX(traceablesMutex);
 }
 
+void TRACEABLE_CLASS::AddToName()
+{
+    myName = traceables->insert(make_pair(objectName, TRACEABLE_NAME_CLASS())).first;
+    list<TRACEABLE> &members = myName->second.members;
+    myTraceablesEntry = members.insert(members.end(), this);
+}
+
+void TRACEABLE_CLASS::RemoveFromName()
+{
+    myName->second.members.erase(myTraceablesEntry);
+    if(myName->second.members.empty())
+    {
+        traceables->erase(myName);
+    }
+}
+
+void TRACEABLE_CLASS::SetObjectName(std::string _n)
+{
+    LOCK_MUTEX(traceablesMutex);
+    RemoveFromName();
+    objectName = _n;
+    AddToName();
+    UNLOCK_MUTEX(traceablesMutex);
+}
+
 void TRACEABLE_CLASS::SetTraceableName(string name) 
 {
-    SetTraceOn(false);
-    SetTraceLevel(1);
-    objectName = name;
     if(name == "") 
     {
         cerr << "WARNING: Traceable object has no traceable name." << endl;
     }
-    if(regexes) 
+    LOCK_MUTEX(traceablesMutex);
+    RemoveFromName();
+    objectName = name;
+    AddToName();
+
+    // Objects sharing a name share the outcome of the saved regexes,
+    // so they are only replayed for the first object with this name.
+    TRACEABLE_NAME_CLASS &group = myName->second;
+    if(group.generation != regexGeneration) 
     {
-        LOCK_MUTEX(regexesMutex);
-        // replay any regexes that have already been applied
-        for(list<TRACEABLE_REGEX>::iterator iter = regexes->begin(); iter != regexes->end(); iter++) 
+        group.traceOn = false;
+        group.level = 1;
+        if(regexes) 
         {
-            TRACEABLE_REGEX r = *iter;
-            EnableByRegex(r->regex, r->level);
+            LOCK_MUTEX(regexesMutex);
+            // replay any regexes that have already been applied
+            for(list<TRACEABLE_REGEX>::iterator iter = regexes->begin(); iter != regexes->end(); iter++) 
+            {
+                TRACEABLE_REGEX r = *iter;
+                if(r->Matches(objectName)) 
+                {
+                    group.traceOn = true;
+                    group.level = r->level;
+                }
+            }
+            UNLOCK_MUTEX(regexesMutex);
         }
-        UNLOCK_MUTEX(regexesMutex);
-    }
-}
-
-void TRACEABLE_CLASS::EnableByRegex(Regex *regex, int level) 
-{
-    // If this object matches the regular expression, set it's trace level.
-    if(regex->match(objectName)) 
-    {
-        SetTraceOn(true);
-        SetTraceLevel(level);
+        group.generation = regexGeneration;
     }
+    SetTraceOn(group.traceOn);
+    SetTraceLevel(group.level);
+    UNLOCK_MUTEX(traceablesMutex);
 }
 
 bool TRACEABLE_CLASS::EnableTraceByRegex(string regexStr, int level, bool saveRegex) 
@@ -157,30 +186,60 @@ bool TRACEABLE_CLASS::EnableTraceByRegex(Regex *regex, int level, bool saveRegex
 {
     assert(traceables);
 
+    LOCK_MUTEX(traceablesMutex);
+
     // record the regex
     if(saveRegex) 
     {
+        LOCK_MUTEX(regexesMutex);
         if(!regexes) 
         {
-            LOCK_MUTEX(regexesMutex);
-            if(!regexes) 
-            {
-                regexes = new TRACEABLE_REGEX_LIST();
-            }
-            UNLOCK_MUTEX(regexesMutex);
+            regexes = new TRACEABLE_REGEX_LIST();
         }
-        LOCK_MUTEX(regexesMutex);
         regexes->push_back(new TRACEABLE_REGEX_CLASS(regex, level));
         UNLOCK_MUTEX(regexesMutex);
     }
-    
-    // Walk through the list of traceable objects.
-    LOCK_MUTEX(traceablesMutex);
-    for(list<TRACEABLE>::iterator iter = TRACEABLE_CLASS::traceables->begin(); 
-        iter != TRACEABLE_CLASS::traceables->end(); iter++) 
+
+    // Walk through the names that can match. An anchored prefix limits
+    // the walk to the adjacent names starting with it. Upper case sorts
+    // first among names that differ only in case.
+    string prefix = TRACEABLE_REGEX_CLASS::LiteralPrefix(regex->getPattern());
+    TRACEABLE_NAME_MAP::iterator iter = traceables->begin();
+    if(!prefix.empty())
+    {
+        string first = prefix;
+        for(string::iterator c = first.begin(); c != first.end(); c++)
+        {
+            *c = toupper(*c);
+        }
+        iter = traceables->lower_bound(first);
+    }
+    for(; iter != traceables->end(); iter++) 
     {
-        TRACEABLE t = *iter;
-        t->EnableByRegex(regex, level);
+        const string &name = iter->first;
+        if(!prefix.empty() && strncasecmp(name.c_str(), prefix.c_str(), prefix.size()) != 0)
+        {
+            break;
+        }
+        if(!regex->match(name))
+        {
+            continue;
+        }
+
+        // A regex appended to the saved ones overrides the earlier
+        // ones, so an up to date name state just takes its level.
+        TRACEABLE_NAME_CLASS &group = iter->second;
+        if(saveRegex && group.generation == regexGeneration)
+        {
+            group.traceOn = true;
+            group.level = level;
+        }
+        for(list<TRACEABLE>::iterator m = group.members.begin(); m != group.members.end(); m++) 
+        {
+            TRACEABLE t = *m;
+            t->SetTraceOn(true);
+            t->SetTraceLevel(level);
+        }
     }
     UNLOCK_MUTEX(traceablesMutex);
     return(true);
@@ -190,17 +249,15 @@ void TRACEABLE_CLASS::PrintNames()
 {
     assert(traceables);
     list<string> names;
-    // Walk through the list of traceable objects.
+    // Walk through the names of the traceable objects.
     LOCK_MUTEX(traceablesMutex);
-    for(list<TRACEABLE>::iterator iter = TRACEABLE_CLASS::traceables->begin();
+    for(TRACEABLE_NAME_MAP::iterator iter = TRACEABLE_CLASS::traceables->begin();
         iter != TRACEABLE_CLASS::traceables->end(); iter++) 
     {
-        TRACEABLE t = *iter;
-        names.push_back(t->objectName);
+        names.push_back(iter->first);
     }
     UNLOCK_MUTEX(traceablesMutex);
     names.sort();
-    names.unique();
     for(list<string>::iterator iter = names.begin(); iter != names.end(); iter++) 
     {
         string name = *iter;
@@ -208,6 +265,45 @@ void TRACEABLE_CLASS::PrintNames()
     }
 }
 
+/**
+ * Called before fork(): write out what is buffered for the trace
+ * stream, so that the child has nothing left to write again.
+ */
+void TRACEABLE_CLASS::PrepareFork()
+{
+    traceStream->flush();
+}
+
+/**
+ * Called in the child after fork(): the trace stream belongs to the
+ * parent, so every traceable object is turned off and whatever is still
+ * traced, e.g. after a delayed trace action, is discarded.
+ */
+void TRACEABLE_CLASS::ForkedChild()
+{
+    static std::ostream discard(NULL);
+
+    LOCK_MUTEX(traceablesMutex);
+    if(traceables)
+    {
+        for(TRACEABLE_NAME_MAP::iterator iter = traceables->begin(); iter != traceables->end(); iter++)
+        {
+            list<TRACEABLE> &members = iter->second.members;
+            for(list<TRACEABLE>::iterator m = members.begin(); m != members.end(); m++)
+            {
+                (*m)->SetTraceOn(false);
+            }
+        }
+    }
+    UNLOCK_MUTEX(traceablesMutex);
+
+    traceStream = &discard;
+    if(fb.is_open())
+    {
+        fb.close();
+    }
+}
+
 UNCONDITIONAL_TRACEABLE_CLASS::UNCONDITIONAL_TRACEABLE_CLASS() 
 {
     SetTraceableName("_UNCONDITIONAL_");
@@ -217,10 +313,13 @@ UNCONDITIONAL_TRACEABLE_CLASS::UNCONDITIONAL_TRACEABLE_CLASS()
 
 TRACEABLE_DELAYED_ACTION_CLASS::TRACEABLE_DELAYED_ACTION_CLASS() 
 {
+    LOCK_MUTEX(TRACEABLE_CLASS::traceablesMutex);
     LOCK_MUTEX(TRACEABLE_CLASS::regexesMutex);
     savedRegexes = TRACEABLE_CLASS::regexes;
     TRACEABLE_CLASS::regexes = 0;
+    TRACEABLE_CLASS::regexGeneration++;
     UNLOCK_MUTEX(TRACEABLE_CLASS::regexesMutex);
+    UNLOCK_MUTEX(TRACEABLE_CLASS::traceablesMutex);
     
     // reapply the saved regexes with trace level 0 but
     // don't save the regex
@@ -256,3 +355,46 @@ void TRACEABLE_DELAYED_ACTION_CLASS::go()
         }
     }
 }
+
+bool TRACEABLE_NAME_LESS::operator()(const string &a, const string &b) const
+{
+    int order = strcasecmp(a.c_str(), b.c_str());
+    return order ? (order < 0) : (a < b);
+}
+
+bool TRACEABLE_REGEX_CLASS::Matches(const string &name)
+{
+    if(!prefix.empty() && strncasecmp(name.c_str(), prefix.c_str(), prefix.size()) != 0)
+    {
+        return(false);
+    }
+    return(regex->match(name));
+}
+
+string TRACEABLE_REGEX_CLASS::LiteralPrefix(const string &pattern)
+{
+    string prefix;
+    if(pattern.empty() || pattern[0] != '^' || pattern.find('|') != string::npos)
+    {
+        return(prefix);
+    }
+    for(string::size_type i = 1; i < pattern.size(); i++)
+    {
+        char c = pattern[i];
+        if(strchr("*?{", c))
+        {
+            // the character before a repeat may not appear at all
+            if(!prefix.empty())
+            {
+                prefix.erase(prefix.size() - 1);
+            }
+            break;
+        }
+        if(strchr(".[]()+^$\\", c))
+        {
+            break;
+        }
+        prefix += c;
+    }
+    return(prefix);
+}
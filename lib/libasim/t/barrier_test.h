@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BARRIER_TEST_H__
+#define __BARRIER_TEST_H__
+
+#include <vector>
+#include <pthread.h>
+#include <cxxtest/FTestSuite.h>
+
+#include "asim/syntax.h"
+#include "asim/barrier.h"
+
+using namespace std;
+
+//
+// Each participant publishes the episode it has reached, then waits at
+// the barrier.  Once through, nobody may still be at an earlier episode.
+//
+struct BARRIER_TEST_ARGS
+{
+    ASIM_BARRIER barrier;
+    UINT32 tid;
+    UINT32 episodes;
+    volatile UINT32 *reached;
+    UINT32 errors;
+    bool result;
+};
+
+static void *
+BarrierTestWorker(void *param)
+{
+    BARRIER_TEST_ARGS *args = (BARRIER_TEST_ARGS *)param;
+    UINT32 n = args->barrier->GetNumThreads();
+    for (UINT32 e = 1; e <= args->episodes; e++)
+    {
+        args->reached[args->tid] = e;
+        args->result = args->barrier->Wait(args->tid);
+        if (! args->result)
+        {
+            return NULL;
+        }
+        for (UINT32 i = 0; i < n; i++)
+        {
+            if (args->reached[i] < e)
+            {
+                args->errors++;
+            }
+        }
+        // second barrier, so nobody races ahead into the next episode
+        // while somebody else is still checking this one
+        args->barrier->Wait(args->tid);
+    }
+    return NULL;
+}
+
+// run nThreads participants through the barrier, return the number of errors
+static UINT32
+RunBarrierTest(UINT32 type, UINT32 nThreads, UINT32 episodes, UINT32 spin)
+{
+    ASIM_BARRIER barrier = ASIM_BARRIER_CLASS::Create(type, nThreads, spin);
+    vector<UINT32> reached(nThreads, 0);
+    vector<BARRIER_TEST_ARGS> args(nThreads);
+    vector<pthread_t> threads(nThreads);
+
+    for (UINT32 i = 0; i < nThreads; i++)
+    {
+        args[i].barrier  = barrier;
+        args[i].tid      = i;
+        args[i].episodes = episodes;
+        args[i].reached  = &reached[0];
+        args[i].errors   = 0;
+        args[i].result   = false;
+        pthread_create(&threads[i], NULL, BarrierTestWorker, &args[i]);
+    }
+
+    UINT32 errors = 0;
+    for (UINT32 i = 0; i < nThreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        errors += args[i].errors;
+        if (! args[i].result)
+        {
+            errors++;
+        }
+    }
+    delete barrier;
+    return errors;
+}
+
+class BarrierTestSuite : public CxxTest::TestSuite
+{
+  public:
+    void testCentral()
+    {
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_CENTRAL, 1, 100, 100), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_CENTRAL, 5, 1000, 100), 0U);
+    }
+
+    void testTree()
+    {
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_TREE, 1, 100, 100), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_TREE, 4, 1000, 100), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_TREE, 17, 200, 100), 0U);
+    }
+
+    void testDissemination()
+    {
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_DISSEMINATION, 1, 100, 100), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_DISSEMINATION, 6, 1000, 100), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_DISSEMINATION, 13, 200, 100), 0U);
+    }
+
+    // a tiny spin budget forces waiters to sleep, exercising the futex path
+    void testSleepingWaiters()
+    {
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_TREE, 9, 200, 1), 0U);
+        TS_ASSERT_EQUALS(RunBarrierTest(ASIM_BARRIER_CLASS::BARRIER_DISSEMINATION, 9, 200, 1), 0U);
+    }
+
+    // participants blocked in the barrier get out, with false, on Abort()
+    void testAbort()
+    {
+        for (UINT32 type = ASIM_BARRIER_CLASS::BARRIER_CENTRAL;
+             type <= ASIM_BARRIER_CLASS::BARRIER_DISSEMINATION; type++)
+        {
+            const UINT32 n = 4;
+            ASIM_BARRIER barrier = ASIM_BARRIER_CLASS::Create(type, n + 1, 10);
+            vector<UINT32> reached(n + 1, 0);
+            vector<BARRIER_TEST_ARGS> args(n);
+            vector<pthread_t> threads(n);
+            for (UINT32 i = 0; i < n; i++)
+            {
+                args[i].barrier  = barrier;
+                args[i].tid      = i;
+                args[i].episodes = 1;
+                args[i].reached  = &reached[0];
+                args[i].errors   = 0;
+                args[i].result   = true;
+                pthread_create(&threads[i], NULL, BarrierTestWorker, &args[i]);
+            }
+            // participant n never shows up
+            barrier->Abort();
+            for (UINT32 i = 0; i < n; i++)
+            {
+                pthread_join(threads[i], NULL);
+                TS_ASSERT(! args[i].result);
+            }
+            TS_ASSERT(barrier->Aborted());
+            TS_ASSERT(! barrier->Wait(n));
+            delete barrier;
+        }
+    }
+};
+
+#endif // __BARRIER_TEST_H__
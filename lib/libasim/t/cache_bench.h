@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Microbenchmark for the generic cache templates (gen_cache_class in
+// cache.h and dyn_cache_class in cache_dyn.h) and their replacement
+// policies.  Every policy and geometry is driven with the same streaming,
+// random, zipfian and pointer-chase address streams, and one record per
+// run is written in the format described in cache_bench_streams.h.
+//
+// Knobs (environment):
+//     CACHE_BENCH_ACCESSES    accesses per stream (default 2M)
+//     CACHE_BENCH_SEED        stream seed
+//     CACHE_BENCH_FOOTPRINT   footprint in percent of the cache capacity
+//                             (default 200)
+//     CACHE_BENCH_OUTPUT      file to append the results to (default stdout)
+//
+
+#ifndef __CACHE_BENCH_H__
+#define __CACHE_BENCH_H__
+
+#include <cxxtest/FTestSuite.h>
+
+#include "asim/syntax.h"
+#include "asim/cache.h"
+#include "asim/cache_dyn.h"
+
+#include "cache_bench_streams.h"
+
+using namespace std;
+
+// Benchmarked geometries: a small L1-like and a larger L2-like cache.
+static const UINT8  CACHE_BENCH_L1_WAYS = 8;
+static const UINT32 CACHE_BENCH_L1_SETS = 64;
+static const UINT8  CACHE_BENCH_L2_WAYS = 16;
+static const UINT32 CACHE_BENCH_L2_SETS = 1024;
+
+//
+// Look up one address and, on a miss, fill it into the victim way.  The
+// same sequence of calls a timing model performs on a demand access.
+//
+template <class CACHE>
+inline bool
+CacheBenchAccess(CACHE *cache, UINT64 addr)
+{
+    UINT64 index = cache->Index(addr);
+    UINT64 tag = cache->Tag(addr);
+    bool miss = false;
+
+    typename CACHE::lineState *line = cache->GetLineState(index, tag);
+    if (line == NULL)
+    {
+        miss = true;
+        line = cache->GetVictimState(index);
+        line->SetTag(tag);
+        line->SetStatus(S_SHARED);
+    }
+    cache->MakeMRU(index, line->GetWay());
+
+    return miss;
+}
+
+template <class CACHE>
+inline UINT64
+CacheBenchRun(
+    CACHE *cache,
+    CACHE_BENCH_STREAM_KIND kind,
+    const vector<UINT64> &stream,
+    UINT64 accesses,
+    double &seconds)
+{
+    UINT64 misses = 0;
+    double start = CacheBenchNow();
+    UINT64 addr = CacheBenchFirst(stream);
+    for (UINT64 i = 0; i < accesses; i++)
+    {
+        misses += CacheBenchAccess(cache, addr);
+        addr = CacheBenchNext(kind, stream, i, addr);
+    }
+    seconds = CacheBenchNow() - start;
+    return misses;
+}
+
+// Approximate heap footprint of a dyn_cache_class, which keeps its tag and
+// LRU state behind pointers.
+inline UINT64
+CacheBenchDynBytes(UINT8 ways, UINT32 sets, UINT32 objects)
+{
+    UINT64 perLine = sizeof(line_state_dynamic *) + sizeof(line_state_dynamic) +
+                     2 * objects * sizeof(bool);
+    UINT64 perSet = sizeof(line_state_dynamic **) + ways * perLine +
+                    sizeof(lru_info_dynamic *) + sizeof(lru_info_dynamic) +
+                    ways * 2 * sizeof(INT8);
+    return sizeof(dyn_cache_class) + sets * perSet;
+}
+
+class CacheBenchSuite : public CxxTest::TestSuite
+{
+  private:
+    CACHE_BENCH_REPORT_CLASS *report;
+    UINT64 accesses;
+    UINT64 seed;
+    UINT64 footprintPct;
+    char randomState[CACHE_RANDOM_STATE_LENGTH];
+
+    UINT64 Footprint(UINT32 ways, UINT32 sets)
+    {
+        UINT64 lines = (UINT64(ways) * sets * footprintPct) / 100;
+        return lines ? lines : 1;
+    }
+
+    //
+    // Run every stream against a freshly built gen_cache_class.  The cache
+    // object is large, so it lives in the heap.
+    //
+    template <UINT8 NumWays, UINT32 NumLinesPerWay,
+              template <UINT8,UINT32> class VictimPolicy>
+    void RunGen(const char *policy)
+    {
+        typedef gen_cache_class<NumWays, NumLinesPerWay, CACHE_BENCH_OBJECTS_PER_LINE,
+                                UINT64, false, VictimPolicy> CACHE;
+
+        UINT64 footprint = Footprint(NumWays, NumLinesPerWay);
+        vector<UINT64> stream;
+
+        for (int k = 0; k < CBS_MAX_STREAM; k++)
+        {
+            CACHE_BENCH_STREAM_KIND kind = CACHE_BENCH_STREAM_KIND(k);
+            CacheBenchMakeStream(kind, footprint, accesses, seed, stream);
+
+            CACHE *cache = new CACHE(0, S_SHARED, 0);
+            // The random policies draw from random().  The cache
+            // constructors leave random() pointing at their private
+            // state, so switch it back to a freshly seeded local one.
+            initstate(seed, randomState, sizeof(randomState));
+            double seconds;
+            UINT64 misses = CacheBenchRun(cache, kind, stream, accesses, seconds);
+            report->Record("gen", policy, NumWays, NumLinesPerWay, kind,
+                           footprint, accesses, misses, seconds, sizeof(CACHE));
+            delete cache;
+
+            TS_ASSERT(misses > 0);
+            TS_ASSERT(misses <= accesses);
+        }
+    }
+
+    void RunDyn(UINT8 ways, UINT32 sets, VICTIM_POLICY vp, const char *policy)
+    {
+        UINT64 footprint = Footprint(ways, sets);
+        vector<UINT64> stream;
+
+        for (int k = 0; k < CBS_MAX_STREAM; k++)
+        {
+            CACHE_BENCH_STREAM_KIND kind = CACHE_BENCH_STREAM_KIND(k);
+            CacheBenchMakeStream(kind, footprint, accesses, seed, stream);
+
+            dyn_cache_class *cache = new dyn_cache_class(
+                ways, sets, CACHE_BENCH_OBJECTS_PER_LINE, vp, 0, S_SHARED, 0);
+            // The random policies draw from random().  The cache
+            // constructors leave random() pointing at their private
+            // state, so switch it back to a freshly seeded local one.
+            initstate(seed, randomState, sizeof(randomState));
+            double seconds;
+            UINT64 misses = CacheBenchRun(cache, kind, stream, accesses, seconds);
+            report->Record("dyn", policy, ways, sets, kind, footprint, accesses,
+                           misses, seconds,
+                           CacheBenchDynBytes(ways, sets, CACHE_BENCH_OBJECTS_PER_LINE));
+            delete cache;
+
+            TS_ASSERT(misses > 0);
+            TS_ASSERT(misses <= accesses);
+        }
+    }
+
+  public:
+    void setUp()
+    {
+        accesses = CacheBenchEnv("CACHE_BENCH_ACCESSES", CACHE_BENCH_DEFAULT_ACCESSES);
+        seed = CacheBenchEnv("CACHE_BENCH_SEED", CACHE_BENCH_DEFAULT_SEED);
+        footprintPct = CacheBenchEnv("CACHE_BENCH_FOOTPRINT", 200);
+        report = new CACHE_BENCH_REPORT_CLASS();
+    }
+
+    void tearDown()
+    {
+        delete report;
+    }
+
+    void testLRU()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, LRUReplacement>("lru");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, LRUReplacement>("lru");
+    }
+
+    void testRandom()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, RandomReplacement>("random");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, RandomReplacement>("random");
+    }
+
+    void testRandomNotMRU()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, RandomNotMRUReplacement>("random_not_mru");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, RandomNotMRUReplacement>("random_not_mru");
+    }
+
+    void testEV7()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, EV7_scheme_replacement>("ev7");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, EV7_scheme_replacement>("ev7");
+    }
+
+    // Plain tree PLRU (PLRUTree underneath GeneralizedPseudoLRUReplacement)
+    void testNehalemPLRU()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, NehalemPlruReplacement>("plru");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, NehalemPlruReplacement>("plru");
+    }
+
+    // PLRU with a random choice among two trees at the top
+    void testPLRURandomTop()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS,
+               GeneralizedPseudoLRUReplacement<2,1>::T>("plru_rand_top2");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS,
+               GeneralizedPseudoLRUReplacement<2,1>::T>("plru_rand_top2");
+    }
+
+    // PLRU with a random choice among two ways at the bottom
+    void testPLRURandomBottom()
+    {
+        RunGen<CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS,
+               GeneralizedPseudoLRUReplacement<1,2>::T>("plru_rand_bottom2");
+        RunGen<CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS,
+               GeneralizedPseudoLRUReplacement<1,2>::T>("plru_rand_bottom2");
+    }
+
+    // VP_PseudoLRUReplacement is left out: pseudo_lru_info_dynamic never
+    // fills in its masks.
+    void testDynamic()
+    {
+        RunDyn(CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, VP_LRUReplacement, "lru");
+        RunDyn(CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, VP_LRUReplacement, "lru");
+        RunDyn(CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, VP_RandomReplacement, "random");
+        RunDyn(CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, VP_RandomReplacement, "random");
+        RunDyn(CACHE_BENCH_L1_WAYS, CACHE_BENCH_L1_SETS, VP_RandomNotMRUReplacement, "random_not_mru");
+        RunDyn(CACHE_BENCH_L2_WAYS, CACHE_BENCH_L2_SETS, VP_RandomNotMRUReplacement, "random_not_mru");
+    }
+};
+
+#endif // __CACHE_BENCH_H__
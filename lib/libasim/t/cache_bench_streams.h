@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Synthetic address streams and result reporting shared by the cache
+// model benchmarks (cache_bench.h and cache_mesi_bench.h).
+//
+// All streams are generated up front from a private xorshift generator
+// so that every run (and every policy within a run) sees exactly the same
+// sequence of addresses, independently of whatever else calls random().
+//
+
+#ifndef __CACHE_BENCH_STREAMS_H__
+#define __CACHE_BENCH_STREAMS_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "asim/syntax.h"
+
+using namespace std;
+
+// Number of accesses generated for every stream.  Can be overridden at run
+// time with CACHE_BENCH_ACCESSES.
+static const UINT64 CACHE_BENCH_DEFAULT_ACCESSES = 2000000;
+
+// Seed shared by all the streams.  Can be overridden at run time with
+// CACHE_BENCH_SEED.
+static const UINT64 CACHE_BENCH_DEFAULT_SEED = 0x5eed;
+
+// Bytes covered by a single cache line in the benchmarked geometries
+// (8 objects of 8 bytes each).
+static const UINT32 CACHE_BENCH_OBJECTS_PER_LINE = 8;
+static const UINT32 CACHE_BENCH_LINE_SHIFT = 6;
+
+typedef enum
+{
+    CBS_STREAMING,      ///< sequential walk over the footprint, wrapping around
+    CBS_RANDOM,         ///< uniformly distributed lines within the footprint
+    CBS_ZIPF,           ///< zipfian popularity (s = 0.99) over the footprint
+    CBS_POINTER_CHASE,  ///< a single random cycle visiting every line once,
+                        ///< each address loaded from the previous one
+    CBS_MAX_STREAM
+} CACHE_BENCH_STREAM_KIND;
+
+static const char *CACHE_BENCH_STREAM_NAMES[CBS_MAX_STREAM] =
+{
+    "streaming", "random", "zipf", "chase"
+};
+
+//
+// Tiny reproducible random number generator (xorshift64*).
+//
+class CACHE_BENCH_RANDOM_CLASS
+{
+  private:
+    UINT64 state;
+
+  public:
+    CACHE_BENCH_RANDOM_CLASS(UINT64 seed)
+      : state(seed ? seed : 0x9e3779b97f4a7c15ULL)
+    { }
+
+    UINT64 Next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dULL;
+    }
+
+    // uniform integer in [0, n)
+    UINT64 Below(UINT64 n) { return Next() % n; }
+
+    // uniform double in [0, 1)
+    double Uniform() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+//
+// Run time knobs, read from the environment so the benchmark can be
+// resized without regenerating the unit test model.
+//
+inline UINT64
+CacheBenchEnv(const char *name, UINT64 dflt)
+{
+    const char *v = getenv(name);
+    return (v && *v) ? strtoull(v, NULL, 0) : dflt;
+}
+
+inline double
+CacheBenchNow()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+//
+// Generate a stream of byte addresses touching 'footprint' distinct lines.
+// Line numbers are scattered over the address space through a random
+// permutation so that zipfian hot lines do not all land in the same set.
+//
+// The pointer-chase stream is not a list of addresses but a chain: entry
+// 'line' holds the address that follows that line, so each address is the
+// result of the previous load (see CacheBenchNext).
+//
+inline void
+CacheBenchMakeStream(
+    CACHE_BENCH_STREAM_KIND kind,
+    UINT64 footprint,
+    UINT64 accesses,
+    UINT64 seed,
+    vector<UINT64> &stream)
+{
+    CACHE_BENCH_RANDOM_CLASS rnd(seed + kind);
+
+    // random relabeling of the lines in the footprint
+    vector<UINT64> lines(footprint);
+    for (UINT64 i = 0; i < footprint; i++)
+    {
+        lines[i] = i;
+    }
+    for (UINT64 i = footprint - 1; i > 0; i--)
+    {
+        swap(lines[i], lines[rnd.Below(i + 1)]);
+    }
+
+    stream.clear();
+    stream.reserve(accesses);
+
+    switch (kind)
+    {
+      case CBS_STREAMING:
+        for (UINT64 i = 0; i < accesses; i++)
+        {
+            stream.push_back((i % footprint) << CACHE_BENCH_LINE_SHIFT);
+        }
+        break;
+
+      case CBS_RANDOM:
+        for (UINT64 i = 0; i < accesses; i++)
+        {
+            stream.push_back(lines[rnd.Below(footprint)] << CACHE_BENCH_LINE_SHIFT);
+        }
+        break;
+
+      case CBS_ZIPF:
+        {
+            vector<double> cdf(footprint);
+            double sum = 0.0;
+            for (UINT64 i = 0; i < footprint; i++)
+            {
+                sum += 1.0 / pow(double(i + 1), 0.99);
+                cdf[i] = sum;
+            }
+            for (UINT64 i = 0; i < accesses; i++)
+            {
+                double u = rnd.Uniform() * sum;
+                UINT64 rank = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+                if (rank >= footprint)
+                {
+                    rank = footprint - 1;
+                }
+                stream.push_back(lines[rank] << CACHE_BENCH_LINE_SHIFT);
+            }
+        }
+        break;
+
+      case CBS_POINTER_CHASE:
+        // 'lines' is a random permutation, so linking each line to the
+        // one after it visits every line exactly once per lap
+        stream.resize(footprint);
+        for (UINT64 i = 0; i < footprint; i++)
+        {
+            stream[lines[i]] = lines[(i + 1) % footprint] << CACHE_BENCH_LINE_SHIFT;
+        }
+        break;
+
+      default:
+        break;
+    }
+}
+
+//
+// Iterate over a stream built by CacheBenchMakeStream: the first address,
+// then the one following access number 'i' to 'addr'.  Pointer-chase
+// addresses are loaded from the previous one, so walking that stream is
+// bound by load latency.
+//
+inline UINT64
+CacheBenchFirst(const vector<UINT64> &stream)
+{
+    return stream[0];
+}
+
+inline UINT64
+CacheBenchNext(
+    CACHE_BENCH_STREAM_KIND kind,
+    const vector<UINT64> &stream,
+    UINT64 i,
+    UINT64 addr)
+{
+    if (kind == CBS_POINTER_CHASE)
+    {
+        return stream[addr >> CACHE_BENCH_LINE_SHIFT];
+    }
+    return (i + 1 < stream.size()) ? stream[i + 1] : 0;
+}
+
+//
+// Machine readable results, one comma separated record per run, written
+// to CACHE_BENCH_OUTPUT or to stdout.
+//
+class CACHE_BENCH_REPORT_CLASS
+{
+  private:
+    FILE *out;
+    bool ownFile;
+
+  public:
+    CACHE_BENCH_REPORT_CLASS()
+      : out(stdout),
+        ownFile(false)
+    {
+        const char *fname = getenv("CACHE_BENCH_OUTPUT");
+        if (fname && *fname)
+        {
+            out = fopen(fname, "a");
+            ownFile = (out != NULL);
+            if (! out)
+            {
+                out = stdout;
+            }
+        }
+        static bool headerDone = false;
+        if (! headerDone)
+        {
+            fprintf(out, "#impl,policy,ways,sets,stream,footprint_lines,accesses,"
+                         "misses,seconds,lookups_per_sec,model_bytes\n");
+            headerDone = true;
+        }
+    }
+
+    ~CACHE_BENCH_REPORT_CLASS()
+    {
+        fflush(out);
+        if (ownFile)
+        {
+            fclose(out);
+        }
+    }
+
+    void Record(
+        const char *impl,
+        const char *policy,
+        UINT32 ways,
+        UINT32 sets,
+        CACHE_BENCH_STREAM_KIND kind,
+        UINT64 footprint,
+        UINT64 accesses,
+        UINT64 misses,
+        double seconds,
+        UINT64 bytes)
+    {
+        fprintf(out, "%s,%s,%u,%u,%s,%llu,%llu,%llu,%.6f,%.0f,%llu\n",
+                impl, policy, ways, sets, CACHE_BENCH_STREAM_NAMES[kind],
+                (unsigned long long)footprint,
+                (unsigned long long)accesses,
+                (unsigned long long)misses,
+                seconds,
+                seconds > 0 ? accesses / seconds : 0.0,
+                (unsigned long long)bytes);
+        fflush(out);
+    }
+};
+
+#endif // __CACHE_BENCH_STREAMS_H__
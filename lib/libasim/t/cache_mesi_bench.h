@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+// Microbenchmark for the older MESI cache template in cache_mesi.h.  It
+// defines its own gen_cache_class and LINE_STATUS, so it cannot share a
+// unit test model with cache_bench.h; the streams and the output format
+// are the same (see cache_bench_streams.h).
+//
+
+#ifndef __CACHE_MESI_BENCH_H__
+#define __CACHE_MESI_BENCH_H__
+
+#include <cxxtest/FTestSuite.h>
+
+#include "asim/syntax.h"
+#include "asim/mesg.h"
+#include "asim/trace.h"
+#include "asim/cache_mesi.h"
+
+#include "cache_bench_streams.h"
+
+using namespace std;
+
+//
+// cache_mesi.h has no victim selection besides the LRU list and never
+// leaves a line without a tag, so a miss simply replaces the LRU way.
+//
+template <class CACHE>
+inline UINT64
+CacheMesiBenchRun(
+    CACHE *cache,
+    CACHE_BENCH_STREAM_KIND kind,
+    const vector<UINT64> &stream,
+    UINT64 accesses,
+    double &seconds)
+{
+    UINT64 misses = 0;
+    double start = CacheBenchNow();
+    UINT64 addr = CacheBenchFirst(stream);
+    for (UINT64 i = 0; i < accesses; i++)
+    {
+        UINT64 index = cache->Index(addr);
+        UINT64 tag = cache->Tag(addr);
+
+        line_state<CACHE_BENCH_OBJECTS_PER_LINE> *line = cache->GetLineState(index, tag);
+        if (line == NULL)
+        {
+            misses++;
+            line = cache->GetLRUState(index);
+            line->SetTag(tag);
+            line->SetStatus(S_SHARED);
+        }
+        cache->MakeMRU(index, line->GetWay());
+        addr = CacheBenchNext(kind, stream, i, addr);
+    }
+    seconds = CacheBenchNow() - start;
+    return misses;
+}
+
+class CacheMesiBenchSuite : public CxxTest::TestSuite
+{
+  private:
+    CACHE_BENCH_REPORT_CLASS *report;
+    UINT64 accesses;
+    UINT64 seed;
+    UINT64 footprintPct;
+
+    template <UINT8 NumWays, UINT32 NumLinesPerWay>
+    void Run()
+    {
+        typedef gen_cache_class<NumWays, NumLinesPerWay, CACHE_BENCH_OBJECTS_PER_LINE> CACHE;
+
+        UINT64 footprint = (UINT64(NumWays) * NumLinesPerWay * footprintPct) / 100;
+        footprint = footprint ? footprint : 1;
+        vector<UINT64> stream;
+
+        for (int k = 0; k < CBS_MAX_STREAM; k++)
+        {
+            CACHE_BENCH_STREAM_KIND kind = CACHE_BENCH_STREAM_KIND(k);
+            CacheBenchMakeStream(kind, footprint, accesses, seed, stream);
+
+            CACHE *cache = new CACHE();
+            double seconds;
+            UINT64 misses = CacheMesiBenchRun(cache, kind, stream, accesses, seconds);
+            report->Record("mesi", "lru", NumWays, NumLinesPerWay, kind,
+                           footprint, accesses, misses, seconds, sizeof(CACHE));
+            delete cache;
+
+            TS_ASSERT(misses > 0);
+            TS_ASSERT(misses <= accesses);
+        }
+    }
+
+  public:
+    void setUp()
+    {
+        accesses = CacheBenchEnv("CACHE_BENCH_ACCESSES", CACHE_BENCH_DEFAULT_ACCESSES);
+        seed = CacheBenchEnv("CACHE_BENCH_SEED", CACHE_BENCH_DEFAULT_SEED);
+        footprintPct = CacheBenchEnv("CACHE_BENCH_FOOTPRINT", 200);
+        report = new CACHE_BENCH_REPORT_CLASS();
+    }
+
+    void tearDown()
+    {
+        delete report;
+    }
+
+    void testLRU()
+    {
+        Run<8, 64>();
+        Run<16, 1024>();
+    }
+};
+
+#endif // __CACHE_MESI_BENCH_H__
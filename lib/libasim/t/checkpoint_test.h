@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __CHECKPOINT_TEST_H__
+#define __CHECKPOINT_TEST_H__
+
+#include <unistd.h>
+#include <cxxtest/FTestSuite.h>
+
+#include "asim/syntax.h"
+#include "asim/module.h"
+#include "asim/port.h"
+#include "asim/clockserver.h"
+#include "asim/registry.h"
+#include "asim/state.h"
+#include "asim/checkpoint.h"
+
+using namespace std;
+
+
+// A module to serve as the top of the module hierarchy.  The last cycle
+// it was clocked is timing state of its own, saved through the module
+// checkpoint hooks.
+class ASIM_SYSTEM_CLASS  : public ASIM_MODULE_CLASS {
+    UINT64            last_cycle;            // last cycle executed
+    ASIM_CLOCK_SERVER server;                // clock server
+public:
+    void Clock(UINT64 cycle)                 // clock routine records last cycle executed
+    { last_cycle = cycle; }
+    ASIM_SYSTEM_CLASS(ASIM_CLOCK_SERVER cs)  // constructor registers for a clock callback
+    : ASIM_MODULE_CLASS(NULL, "system"), last_cycle(0), server(cs)
+    { RegisterClock("CLOCK"); }
+    void RunUntil(UINT64 end)                // run until the given clock cycle
+    { while (last_cycle < end) server->Clock(); }
+    UINT64 GetCycle()                        // return the current clock cycle
+    { return last_cycle; }
+
+    void SaveCheckpoint(ASIM_CHECKPOINT_WRITER ckpt)
+    { ckpt->WriteUINT64(last_cycle); }
+    void RestoreCheckpoint(ASIM_CHECKPOINT_READER ckpt)
+    { last_cycle = ckpt->ReadUINT64(); }
+} *asimSystem = NULL;
+
+
+// A module with stats and a pair of ports
+class X_MODULE_CLASS : public ASIM_MODULE_CLASS {
+  public:
+    X_MODULE_CLASS(ASIM_MODULE parent, const char *iname)
+      : ASIM_MODULE_CLASS(parent, iname),
+        uintStat(0),
+        doubleStat(0.0),
+        histoStat(4)
+    {
+        // Stats start suspended, collect them as the controller would
+        for (int i = 0; i < 4; i++) uintArray[i] = 0;
+        RegisterState(&uintStat, "Uintstat", "Uint stat")->Unsuspend();
+        RegisterState(uintArray, 4, "UintArraystat", "Uint array stat")->Unsuspend();
+        RegisterState(&doubleStat, "Doublestat", "Double stat")->Unsuspend();
+        RegisterState(&histoStat, "Histostat", "Histo stat")->Unsuspend();
+    }
+
+    UINT64 uintStat;
+    UINT64 uintArray[4];
+    double doubleStat;
+    HISTOGRAM_TEMPLATE<true> histoStat;
+
+    ReadPort<int> rdPort;
+    WritePort<int> wrPort;
+};
+
+
+class CheckpointTestSuite : public CxxTest::TestSuite
+{
+    ASIM_CLOCK_SERVER cs;
+    static bool first;     // the clock server is static, create its domains once
+
+    string FileName(const char *name)
+    {
+        ostringstream s;
+        s << "/tmp/checkpoint_test_" << getpid() << "_" << name;
+        return s.str();
+    }
+
+  public:
+    void setUp() {
+        cs = ASIM_CLOCKABLE_CLASS::GetClockServer();
+        if (first) {
+            first = false;
+            ASIM_SMP_CLASS::Init(1,1);
+            list<float> freqs; freqs.push_back(1.0);
+            cs->NewClockDomain("CLOCK", freqs);
+        }
+        asimSystem = new ASIM_SYSTEM_CLASS(cs);
+    }
+    void tearDown() {
+        cs->StopClockServer();
+        cs->UnregisterAll();
+        delete asimSystem;
+    }
+
+
+    // Values and sections read back as written, with and without compression
+    void testFile() {
+        for (int compress = 0; compress < 2; compress++) {
+            string name = FileName("file");
+
+            ASIM_CHECKPOINT_WRITER_CLASS w(name.c_str(), compress);
+            TS_ASSERT(w.IsOpen());
+            w.BeginSection("first");
+            w.WriteUINT64(0x0123456789abcdefULL);
+            w.WriteString("hello");
+            UINT64 mark = w.BeginRecord();
+            w.WriteDouble(2.5);
+            w.EndRecord(mark);
+            w.EndSection();
+            w.BeginSection("second");
+            for (UINT64 i = 0; i < 100000; i++) w.WriteUINT64(i);
+            w.EndSection();
+            TS_ASSERT(w.Close());
+
+            ASIM_CHECKPOINT_READER_CLASS r(name.c_str());
+            TS_ASSERT(r.IsOpen());
+            TS_ASSERT(! r.OpenSection("third"));
+            TS_ASSERT(r.OpenSection("second"));
+            bool inOrder = true;
+            for (UINT64 i = 0; i < 100000; i++) inOrder &= (r.ReadUINT64() == i);
+            TS_ASSERT(inOrder);
+            TS_ASSERT_EQUALS(r.Left(), 0U);
+            TS_ASSERT(r.OpenSection("first"));
+            TS_ASSERT_EQUALS(r.ReadUINT64(), 0x0123456789abcdefULL);
+            TS_ASSERT_EQUALS(r.ReadString(), "hello");
+            TS_ASSERT_EQUALS(r.ReadUINT64(), sizeof(double));
+            TS_ASSERT_EQUALS(r.ReadDouble(), 2.5);
+            TS_ASSERT_EQUALS(r.Left(), 0U);
+
+            unlink(name.c_str());
+        }
+    }
+
+
+    // Stats, port contents, clock cycles and module state are restored
+    void testRestore() {
+        X_MODULE_CLASS xm(asimSystem, "xm");
+        TS_ASSERT(xm.rdPort.InitConfig(&xm, "ckpt", 1, 2));
+        TS_ASSERT(xm.wrPort.InitConfig(&xm, "ckpt", 1, 2));
+        BasePort::ConnectAll();
+        cs->InitClockServer();
+
+        asimSystem->RunUntil(5);
+        xm.uintStat = 7;
+        xm.uintArray[2] = 9;
+        xm.doubleStat = 1.5;
+        xm.histoStat.AddEvent(3, 0, 11);
+        TS_ASSERT(xm.wrPort.Write(42, 5));
+
+        string name = FileName("restore");
+        TS_ASSERT(ASIM_CHECKPOINT_CLASS::Save(asimSystem, name.c_str()));
+
+        asimSystem->RunUntil(20);
+        xm.uintStat = 100;
+        xm.uintArray[2] = 100;
+        xm.doubleStat = 100.0;
+        xm.histoStat.AddEvent(1, 0, 100);
+        int data = 0;
+        xm.rdPort.Read(data, 6);
+        xm.rdPort.Read(data, 7);
+
+        TS_ASSERT(ASIM_CHECKPOINT_CLASS::Restore(asimSystem, name.c_str()));
+        unlink(name.c_str());
+
+        TS_ASSERT_EQUALS(asimSystem->GetCycle(), 5U);
+        TS_ASSERT_EQUALS(xm.uintStat, 7U);
+        TS_ASSERT_EQUALS(xm.uintArray[2], 9U);
+        TS_ASSERT_EQUALS(xm.doubleStat, 1.5);
+        TS_ASSERT_EQUALS(xm.histoStat.GetValue(3), 11U);
+        TS_ASSERT_EQUALS(xm.histoStat.GetValue(1), 0U);
+
+        // The clock server carries on from the saved cycle
+        cs->Clock();
+        TS_ASSERT_EQUALS(asimSystem->GetCycle(), 6U);
+
+        // The value in flight arrives when it was due
+        data = 0;
+        TS_ASSERT(! xm.rdPort.Read(data, 6));
+        TS_ASSERT(xm.rdPort.Read(data, 7));
+        TS_ASSERT_EQUALS(data, 42);
+    }
+};
+
+bool CheckpointTestSuite::first = true;
+
+#endif /* __CHECKPOINT_TEST_H__ */
@@ -379,6 +379,49 @@ class StatTestSuite : public CxxTest::TestSuite
     }
 
 
+    // Test a row_size that is not a power of two
+    void testRowSizeOdd() {
+        X_MODULE_CLASS sm (asimSystem, "stat_module"); 
+        
+        HISTOGRAM_TEMPLATE<true> hStat (3, 1, 3, true); // set row_size = 3
+        sm.RegisterState (&hStat, "Hstat", "Histo stat");
+
+        hStat.AddEventWideBins(2); 
+        hStat.AddEventWideBins(3);
+        hStat.AddEventWideBins(100);
+
+        TS_ASSERT_EQUALS (hStat.GetValue(0), 1U);
+        TS_ASSERT_EQUALS (hStat.GetValue(5), 1U);
+        TS_ASSERT_EQUALS (hStat.GetValue(8), 1U);
+    }
+
+
+    // Test the occupancy histogram of a resource
+    void testResourceOccupancy() {
+        X_MODULE_CLASS sm (asimSystem, "stat_module"); 
+        
+        RESOURCE_TEMPLATE<true> rStat (4);
+        sm.RegisterState (&rStat, "Rstat", "Resource stat");
+
+        // one entry for cycles 1-3, then two entries for cycles 4-9
+        rStat.AddRequest(1);
+        rStat.CurrentEntries(2, 1);
+        rStat.CurrentEntries(3, 1);
+        rStat.AddRequest(4);
+        for (UINT64 cycle = 5; cycle < 10; cycle++) {
+            rStat.CurrentEntries(cycle, 2);
+        }
+
+        TS_ASSERT_EQUALS (rStat.GetValue(0), 1U);
+        TS_ASSERT_EQUALS (rStat.GetValue(1), 3U);
+        TS_ASSERT_EQUALS (rStat.GetValue(2), 5U);
+
+        rStat.DeleteRequest(10);
+        TS_ASSERT_EQUALS (rStat.GetValue(2), 6U);
+        TS_ASSERT_EQUALS (rStat.GetValue(3), 0U);
+    }
+
+
     // Test whether the ClearStats function works
     void testClearStats() {
         X_MODULE_CLASS sm (asimSystem, "stat_module"); 
@@ -0,0 +1,106 @@
+/**************************************************************************
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dralBatchListener.h
+ * @brief optional listeners that receive the item events in blocks
+ */
+
+#ifndef _DRALBATCHLISTENER_H
+#define _DRALBATCHLISTENER_H
+
+#include "asim/dral_syntax.h"
+#include "asim/dralListener.h"
+#include "asim/dralListenerOld.h"
+
+/**
+  * @brief Block of item creation and item tag events.
+  *
+  * The events are stored as a structure of arrays. The tags set before the
+  * i-th new item are tagItems[newItemsPos[i-1] .. newItemsPos[i] - 1], so the
+  * original order of the events can be rebuilt. A block never spans a cycle
+  * nor any other kind of event.
+  */
+struct DRAL_ITEM_BATCH
+{
+    UINT32 numNewItems;         ///< Number of new items.
+    const UINT32 * newItems;    ///< Identifiers of the new items.
+    const UINT32 * newItemsPos; ///< Number of tags set before each new item.
+
+    UINT32 numTags;             ///< Number of single value item tags.
+    const UINT32 * tagItems;    ///< Item of each tag.
+    const UINT32 * tagIdxs;     ///< Tag index of each tag.
+    const UINT64 * tagValues;   ///< Value of each tag.
+};
+
+/**
+  * @brief Listener that also accepts blocks of item events.
+  *
+  * When the listener given to the dral client is of this class, the
+  * NewItem and SetItemTag callbacks of the binary traces are replaced
+  * by ItemBatch calls with the same events.
+  */
+class DRAL_BATCH_LISTENER_CLASS : public DRAL_LISTENER_CLASS
+{
+  public:
+
+    /**
+      * @brief Notifies a block of new items and single value item tags
+      * @param batch The events, in trace order
+      */
+    virtual void ItemBatch (const DRAL_ITEM_BATCH & batch)=0;
+};
+typedef DRAL_BATCH_LISTENER_CLASS * DRAL_BATCH_LISTENER; /**<Pointer type to
+                                                           * a DRAL_BATCH_LISTENER_CLASS
+                                                           */
+
+/**
+  * @brief Old listener that also accepts blocks of item events.
+  *
+  * The listener converter forwards the blocks to the old listeners of
+  * this class instead of splitting them in NewItem and SetItemTag calls.
+  */
+class DRAL_BATCH_LISTENER_OLD_CLASS : public DRAL_LISTENER_OLD_CLASS
+{
+  public:
+
+    /**
+      * @brief Notifies a block of new items and single value item tags
+      * @param batch The events, in trace order
+      * @param tag_names The tag names, indexed by tag index
+      */
+    virtual void ItemBatch (
+        const DRAL_ITEM_BATCH & batch, const char * const tag_names [])=0;
+};
+typedef DRAL_BATCH_LISTENER_OLD_CLASS * DRAL_BATCH_LISTENER_OLD; /**<Pointer type to
+                                                                   * a DRAL_BATCH_LISTENER_OLD_CLASS
+                                                                   */
+
+#endif /* _DRALBATCHLISTENER_H */
@@ -80,10 +80,12 @@ class DRAL_CLIENT_CLASS
      * @param file_descriptor The file descriptor
      * @param dral_listener The DRAL_LISTENER
      * @param buffer_size The buffer size in bytes
+     * @param decode_threads Number of threads that decompress the trace
+     *        ahead of the listener, or 0 to decompress on the caller's thread
      */
     DRAL_CLIENT_CLASS(
         int file_descriptor,  DRAL_LISTENER dral_listener,
-        UINT32 buffer_size = 4096);
+        UINT32 buffer_size = 4096, UINT32 decode_threads = 0);
 
     /**
      * @brief The destructor.
@@ -118,6 +120,20 @@ class DRAL_CLIENT_CLASS
      */
     inline INT32 ProcessNextEvent (bool blocking, UINT16 num_events);
 
+    /**
+     * @brief Jumps to a cycle of a trace with sync points
+     *
+     * The events processed next start at the last sync point at or before
+     * the cycle. The items alive at the sync point are given to the
+     * listener with NewItem before its events. The header of the trace
+     * (nodes, edges, clocks...) must be processed before seeking.
+     * @param cycle The cycle to jump to
+     * @param syncCycle If not NULL, it gets the cycle of the sync point
+     * @return false if the trace has no sync point at or before the cycle
+     * (then the read position does not change)
+     */
+    inline bool SeekCycle (UINT64 cycle, UINT64 * syncCycle = NULL);
+
   private:
 
     /**
@@ -164,6 +180,20 @@ DRAL_CLIENT_CLASS::ProcessNextEvent (
     }
 }
 
+bool
+DRAL_CLIENT_CLASS::SeekCycle (
+    UINT64 cycle, UINT64 * syncCycle)
+{
+    if (!error)
+    {
+        return implementation->SeekCycle(cycle,syncCycle);
+    }
+    else
+    {
+        return false;
+    }
+}
+
 INT64
 DRAL_CLIENT_CLASS::GetFileSize(void)
 {
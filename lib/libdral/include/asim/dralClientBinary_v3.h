@@ -38,6 +38,7 @@
 #define DRAL_CLIENT_BINARY_V3_H
 
 #include "asim/dralClientImplementation.h"
+#include "asim/dralBatchListener.h"
 #include "asim/dralClientDefines.h"     /* We need to include this file because
                                         there is the definition of the
                                         DRAL_VERSION command code */
@@ -77,7 +78,9 @@ enum DRAL3_COMMANDS
     DRAL3_SETCYCLETAG_STRING,
     DRAL3_SETCYCLETAG_SET,
     DRAL3_NEWTAG,
-    DRAL3_NEWSTRINGVALUE
+    DRAL3_NEWSTRINGVALUE,
+    DRAL3_SYNCPOINT,
+    DRAL3_SYNCINDEX
 } ;
 
 enum DRAL3_VALUE_SIZE
@@ -103,10 +106,16 @@ class DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS
 
     UINT16 ProcessNextEvent (bool blocking, UINT16 num_events);
 
+    bool SeekCycle (UINT64 cycle, UINT64 * sync_cycle);
+
   protected:
 
     bool EOS;
 
+    vector<DRAL_SYNC_ENTRY> syncIndex;
+    bool syncIndexRead; ///< The index at the end of the file has been read.
+    bool seeking;       ///< The next sync point is the seek target.
+
     UINT32 tags[256];
     UINT32 strings[65536];
 
@@ -114,6 +123,19 @@ class DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS
     INT32 last_node;
     INT32 last_edge;
 
+    /**
+     * Item block being filled when the listener accepts them, see
+     * DRAL_ITEM_BATCH. It is delivered before any other event.
+     */
+    DRAL_BATCH_LISTENER batchListener;
+    vector<UINT32> batchNewItems;
+    vector<UINT32> batchNewItemsPos;
+    vector<UINT32> batchTagItems;
+    vector<UINT32> batchTagIdxs;
+    vector<UINT64> batchTagValues;
+
+    void FlushBatch ();
+
     void * ReadBytes (UINT32 num_bytes);
     UINT64 getValue(DRAL3_VALUE_SIZE val_size);
     INT32 getDelta(DRAL3_VALUE_SIZE item_size);
@@ -150,6 +172,8 @@ class DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS
     bool SetCycleTagOther ();
     bool NewTag ();
     virtual bool NewStringValue ();
+    bool SyncPoint ();
+    bool SyncIndex ();
 };
 
 #endif /* DRAL_CLIENT_BINARY_V3_H */
@@ -64,6 +64,13 @@ class DRAL_CLIENT_IMPLEMENTATION_CLASS
     
     UINT64 GetNumBytesRead(void);
 
+    /*
+     * Continues reading at the last sync point not after cycle. Returns
+     * false if the trace has no such sync point. By default the
+     * implementations are not seekable.
+     */
+    virtual bool SeekCycle (UINT64 cycle, UINT64 * sync_cycle);
+
   protected:
 
     /*
@@ -38,6 +38,8 @@
 #ifndef DRAL_DEFINES_H
 #define DRAL_DEFINES_H
 
+#include "asim/dral_syntax.h"
+
 //Magic Numbers
 #ifndef ADF_MAGICNUM
 #define ADF_MAGICNUM 0xADF
@@ -47,5 +49,32 @@
 #define TAR_FILE_MAGICNUM ('T'+'A'+'R')
 #endif
 
+/*
+ * Sync points (see DRAL_SERVER_CLASS::SetSyncInterval).
+ * A trace with sync points ends with an index of them: a DRAL3_SYNCINDEX
+ * command followed by the entries and by a tail. The tail is always the
+ * last bytes of the file, so a client can find the index without reading
+ * the trace. In compressed traces the index goes after the last gzip
+ * member, where zlib ignores it.
+ */
+#ifndef DRAL_SYNC_MAGICNUM
+#define DRAL_SYNC_MAGICNUM 0x434e5953
+#endif
+
+struct DRAL_SYNC_ENTRY
+{
+    UINT64 cycle;        // cycle of the sync point
+    UINT64 fileOffset;   // file offset where its block starts
+    UINT64 streamOffset; // uncompressed trace bytes before the block
+};
+
+struct DRAL_SYNC_TAIL
+{
+    UINT64 indexOffset;  // file offset of the first entry
+    UINT64 streamSize;   // uncompressed trace bytes before the index
+    UINT32 numEntries;
+    UINT32 magic;        // DRAL_SYNC_MAGICNUM
+};
+
 #endif /* DRAL_DEFINES_H */
 
@@ -43,6 +43,7 @@ using namespace std;
 #include "asim/dral_syntax.h"
 #include "asim/dralListener.h"
 #include "asim/dralListenerOld.h"
+#include "asim/dralBatchListener.h"
 
 /**
   * @brief Class used to convert the new dral callbacks to the old ones.
@@ -50,8 +51,10 @@ using namespace std;
   * This class is used as a wrapper that converts the modified callbacks of
   * the dralListener to the old callbacks. Thanks to this class, the old
   * dral clients don't need to be changed (almost).
+  * The item blocks are forwarded as they are to the old listeners that
+  * accept them and split in single callbacks for the rest.
   */
-class DRAL_LISTENER_CONVERTER_CLASS : public DRAL_LISTENER_CLASS
+class DRAL_LISTENER_CONVERTER_CLASS : public DRAL_BATCH_LISTENER_CLASS
 {
   public:
 
@@ -527,8 +530,15 @@ class DRAL_LISTENER_CONVERTER_CLASS : public DRAL_LISTENER_CLASS
 
     /*@}*/ // End of the block: CallBacks for commands only found in DRAL 1.0
 
+    /**
+      * @brief Notifies a block of new items and single value item tags
+      * @param batch The events, in trace order
+      */
+    virtual void ItemBatch (const DRAL_ITEM_BATCH & batch);
+
   private:
     DRAL_LISTENER_OLD dralListener; ///< Pointer to the old listener to whom the callbacks are forwarded.
+    DRAL_BATCH_LISTENER_OLD batchListener; ///< The same listener if it accepts item blocks.
     vector<char *> tags;            ///< Array of the declared tags.
     vector<char *> strings;         ///< Array of the declared strings.
 };
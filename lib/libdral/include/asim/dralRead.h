@@ -41,7 +41,10 @@
 #include "asim/dral_syntax.h"
 #include <zlib.h>
 #include <pthread.h>
+#include <vector>
 #include "asim/dralListener.h"
+#include "asim/dralCommonDefines.h"
+#include "asim/dralReadAhead.h"
 
 /**
  * This class performs the buffered read to the dral client
@@ -53,11 +56,13 @@ class DRAL_BUFFERED_READ_CLASS
 
     /**
      * Constructor with the file descriptor, the dral listener (to comunicate
-     * errors) and the buffer size
+     * errors) and the buffer size. If decode_threads is not 0 and the file
+     * descriptor is seekable, the trace is inflated ahead of the reads by
+     * that many threads (see DRAL_READ_AHEAD_CLASS).
      */
     DRAL_BUFFERED_READ_CLASS (
         int file_descriptor, DRAL_LISTENER dralListener,
-        UINT32 buffer_size = 4096);
+        UINT32 buffer_size = 4096, UINT32 decode_threads = 0);
     
     ~DRAL_BUFFERED_READ_CLASS();
     
@@ -91,8 +96,27 @@ class DRAL_BUFFERED_READ_CLASS
      */
     UINT32 AvailableBytes(void);
 
+    /**
+     * Public method used to read the sync point index at the end of the
+     * file (without moving the read position). It returns false if the
+     * file has no index or if it can not be read.
+     */
+    bool ReadSyncIndex (std::vector<DRAL_SYNC_ENTRY> & index);
+
+    /**
+     * Public method used to continue reading at the block of a sync point.
+     * The buffered data is discarded. It returns false if the file
+     * descriptor is not seekable.
+     */
+    bool Seek (UINT64 file_offset, UINT64 stream_offset);
+
   private:
 
+    /**
+     * Private method that reads the tail of the sync point index.
+     */
+    bool ReadSyncTail (DRAL_SYNC_TAIL * tail);
+
     /**
      * Private method that performs the read form the file descriptor to the
      * buffer.
@@ -111,6 +135,8 @@ class DRAL_BUFFERED_READ_CLASS
     void * buffer;
     DRAL_LISTENER dralListener;
     bool errorFound;
+    DRAL_READ_AHEAD readAhead;
+    std::vector<DRAL_SYNC_ENTRY> syncIndex;
 
 };
 typedef DRAL_BUFFERED_READ_CLASS * DRAL_BUFFERED_READ; 
@@ -0,0 +1,133 @@
+/**************************************************************************
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dralReadAhead.h
+ * @brief decompresses dral traces ahead of the dral client
+ */
+
+#ifndef DRAL_READ_AHEAD_H
+#define DRAL_READ_AHEAD_H
+
+#include <pthread.h>
+#include <vector>
+#include <deque>
+#include <string>
+
+#include "asim/dral_syntax.h"
+#include "asim/dralCommonDefines.h"
+
+/**
+ * This class inflates a trace on its own threads, so that the dral client
+ * only has to parse it. The threads read the file with pread, so they do
+ * not move the file offset under the rest of the client.
+ *
+ * A trace is split in segments. Traces with a sync point index have one
+ * gzip member per sync point, and each of those is a segment that any
+ * thread can inflate on its own; a window of segments is inflated in
+ * parallel and handed out in file order. Other traces are one segment,
+ * inflated by a single thread while the client parses. Segments are
+ * passed in pieces, and each segment buffers a bounded number of them.
+ */
+class DRAL_READ_AHEAD_CLASS
+{
+  public:
+
+    /**
+     * Constructor with the file descriptor, the number of threads that
+     * inflate segments and the size of the pieces handed to the reader.
+     */
+    DRAL_READ_AHEAD_CLASS (int fd, UINT32 threads, UINT32 piece_size = 1 << 20);
+
+    ~DRAL_READ_AHEAD_CLASS ();
+
+    /**
+     * Starts inflating at a file offset where a gzip member or an
+     * uncompressed trace begins, splitting the trace at the blocks of
+     * the sync point index (which may be empty). Any previous read
+     * ahead is dropped.
+     */
+    void Start (UINT64 file_offset, const std::vector<DRAL_SYNC_ENTRY> & index);
+
+    /**
+     * Copies up to n inflated bytes into buf. It returns the number of
+     * bytes copied, which is less than n only at the end of the trace,
+     * or -1 if there was an error (see GetError).
+     */
+    INT64 Read (void * buf, UINT32 n);
+
+    const char * GetError (void) { return error.c_str(); }
+
+    /**
+     * Returns the number of inflating threads running in the process.
+     */
+    static UINT32 GetRunningThreads (void) { return runningThreads; }
+
+  private:
+
+    struct SEGMENT
+    {
+        UINT64 begin;               // file offset of the segment
+        UINT64 end;                 // file offset past the segment
+        std::deque<std::vector<char> *> pieces; // inflated, not yet read
+        bool done;                  // all the pieces have been queued
+        bool failed;                // the segment could not be inflated
+    };
+
+    static void * WorkerThread (void * arg);
+    void Work (void);
+    void Inflate (SEGMENT * seg);
+    bool Queue (SEGMENT * seg, std::vector<char> * piece);
+    void Stop (void);
+    void Fail (const char * msg);
+
+    int fd;
+    UINT32 numThreads;
+    UINT32 pieceSize;
+    UINT32 maxPieces;               // per segment
+
+    std::vector<pthread_t> threads;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;         // pieces queued or read, or stopping
+
+    std::vector<SEGMENT *> segments;
+    UINT32 nextSegment;             // next segment to give to a thread
+    UINT32 readSegment;             // segment the reader is in
+    std::vector<char> * readPiece;  // piece the reader is in
+    UINT32 readPos;                 // position in readPiece
+    bool stopping;
+
+    std::string error;
+
+    static volatile UINT32 runningThreads;
+};
+typedef DRAL_READ_AHEAD_CLASS * DRAL_READ_AHEAD;
+
+#endif /* DRAL_READ_AHEAD_H */
@@ -52,6 +52,7 @@
 
 #include "asim/dral_syntax.h"
 #include "asim/dralServerImplementation.h"
+#include "asim/dralServerRecorder.h"
 #include "asim/dralStorage.h"
 #include "asim/dralServerDefines.h"
 #include "asim/dralCommonDefines.h"
@@ -71,6 +72,30 @@ typedef map <UINT16, UINT64> Nodetagcache_tag_map;
 typedef map <string, Nodetagcache_tag_map*> Nodetagcache_map;
 
 
+/*
+ * Tag names and string values interned by the dral server. A model
+ * registers them once and then emits tag events by handle, which saves
+ * the length computation, the checks and the autocompress cache lookup
+ * that are done on every event when tags are named by string.
+ */
+struct DRAL_INTERNED_STRING
+{
+    char * str;                          // copy of the string, 0 terminated
+    UINT16 len;                          // length, including the terminating 0
+    Nodetagcache_tag_map * nodeTagCache; // autocompress cache of a tag name
+};
+
+struct DRAL_TAG_HANDLE
+{
+    DRAL_INTERNED_STRING * tag;
+};
+
+struct DRAL_STRING_HANDLE
+{
+    DRAL_INTERNED_STRING * str;
+};
+
+
 /*
  * liveItems typedefs
  */
@@ -169,6 +194,20 @@ class DRAL_SERVER_CLASS
       * command for the same slot, the second (redundant) command is dropped.
       */
     void setNoteTagAutocompress(bool value);
+
+    /**
+    * Sync points make a trace seekable. At the first cycle of every \p interval
+    * cycles the server starts a block that can be decoded without the previous
+    * ones: the incremental encoding state is reset, the compressed stream starts
+    * a new gzip member and the ids of the live items are written. When the file
+    * is closed an index of the blocks is appended, so clients can jump to a cycle
+    * (\see DRAL_CLIENT_CLASS::SeekCycle). Item tags and node contents set before
+    * a sync point are not repeated. Sync points need a seekable output and are
+    * only placed on cycles of the clock 0. Set it before creating any item.
+    * @brief Emits a sync point every \p interval cycles.
+    * @param interval Cycles between sync points (0 disables them).
+    */
+    void SetSyncInterval(UINT64 interval);
     
     /**
     * Every time that cycle command is called sets a new time stamp for the forthcoming of the commands.
@@ -1065,6 +1104,111 @@ class DRAL_SERVER_CLASS
     {
         SetCycleTag(tagName,nval,reinterpret_cast<UINT32 *>(value),persistent);
     }
+
+    /**
+    * Interns a tag name. Registering the same name again returns the same
+    * handle. Handles stay valid for the life of the dral server.
+    * @brief Get a handle to emit tag events without naming the tag.
+    * @param tagName String containing the name of the tag.
+    * @return The handle of the tag.
+    */
+    DRAL_TAG_HANDLE RegisterTag (const char tagName[]);
+
+    /**
+    * Interns a string tag value. Registering the same string again returns
+    * the same handle. Handles stay valid for the life of the dral server.
+    * @brief Get a handle to emit string tag values without copying them.
+    * @param str The string value.
+    * @return The handle of the string.
+    */
+    DRAL_STRING_HANDLE RegisterString (const char str[]);
+
+    /**
+    * Same as the SetItemTag with a tag name, for a registered tag.
+    * @brief Set a tag with a value to an item.
+    * @param itemId Unique item identifier.
+    * @param tag Handle returned by RegisterTag.
+    * @param value New/First value for the tag.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetItemTag (
+        UINT32 itemId, DRAL_TAG_HANDLE tag, UINT64 value, bool persistent=false);
+
+    /**
+    * Same as the SetItemTag with a tag name and a string, for a registered
+    * tag and string.
+    * @brief Set a tag with a string value to an item.
+    * @param itemId Unique item identifier.
+    * @param tag Handle returned by RegisterTag.
+    * @param str Handle returned by RegisterString.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetItemTag (
+        UINT32 itemId, DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str,
+        bool persistent=false);
+
+    /**
+    * Same as the SetItemTag with a tag name and a set of values, for a
+    * registered tag.
+    * @brief Set a tag with a set of values to an item.
+    * @param itemId Unique item identifier.
+    * @param tag Handle returned by RegisterTag.
+    * @param nval Number of values of the Tag.
+    * @param value Array holding \p nval values for the tag.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetItemTag (
+        UINT32 itemId, DRAL_TAG_HANDLE tag, UINT32 nval, UINT64 value[],
+        bool persistent=false);
+
+    /**
+    * Same as the SetCycleTag with a tag name, for a registered tag.
+    * @brief Set a tag with a value to a cycle.
+    * @param tag Handle returned by RegisterTag.
+    * @param value New/First value for the tag.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetCycleTag (DRAL_TAG_HANDLE tag, UINT64 value, bool persistent=false);
+
+    /**
+    * Same as the SetCycleTag with a tag name and a string, for a registered
+    * tag and string.
+    * @brief Set a tag with a string value to a cycle.
+    * @param tag Handle returned by RegisterTag.
+    * @param str Handle returned by RegisterString.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetCycleTag (
+        DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str, bool persistent=false);
+
+    /**
+    * Same as the SetNodeTag with a tag name, for a registered tag.
+    * @brief Set a tag with a value to a node.
+    * @param nodeId Node identifier.
+    * @param tag Handle returned by RegisterTag.
+    * @param value New/First value for the tag.
+    * @param level Number of levels of the node slot list.
+    * @param lst Node slot list.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetNodeTag(
+        UINT16 nodeId, DRAL_TAG_HANDLE tag, UINT64 value,
+        UINT16 level = 0, const UINT32 lst [] = NULL, bool persistent = false);
+
+    /**
+    * Same as the SetNodeTag with a tag name and a string, for a registered
+    * tag and string.
+    * @brief Set a tag with a string value to a node.
+    * @param nodeId Node identifier.
+    * @param tag Handle returned by RegisterTag.
+    * @param str Handle returned by RegisterString.
+    * @param level Number of levels of the node slot list.
+    * @param lst Node slot list.
+    * @param persistent Tells if this command should be remembered when the dral server is turned off.
+    */
+    void SetNodeTag(
+        UINT16 nodeId, DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str,
+        UINT16 level = 0, const UINT32 lst [] = NULL, bool persistent = false);
    
 
     /**
@@ -1189,6 +1333,49 @@ class DRAL_SERVER_CLASS
     */
     void StartActivity(UINT64 firstActivityCycle = 0);
 
+    /**
+    * Threaded simulators call this from each worker thread. While a thread
+    * has a recorder attached, the events it generates are appended to the
+    * recorder instead of being written, without taking any lock. Only the
+    * server state shared by all the threads is updated under a lock.
+    * Passing NULL detaches it.
+    * @brief Redirects the calling thread's events to a recorder.
+    * @param recorder Recorder for this thread, or NULL.
+    */
+    static void AttachRecorder(DRAL_SERVER_RECORDER recorder);
+
+    /**
+    * Threaded simulators call this before their worker threads start,
+    * with the number of threads that generate events (the workers plus
+    * the calling thread). From then on the server state shared by the
+    * threads is updated under a lock, and automatically assigned
+    * item ids are handed out in one lane per thread: thread i gets
+    * the ids i, i + threads, i + 2 * threads... past the last id given
+    * out so far. The ids a thread gets then do not depend on how the
+    * threads interleave.
+    * @brief Prepares the server for events from several threads.
+    * @param threads Number of threads, including the calling one.
+    */
+    static void SetThreads(UINT32 threads);
+
+    /**
+    * Selects the item id lane of the calling thread, from 0 to the
+    * number of threads minus one. Threads that never call it use lane 0.
+    * @brief Sets the item id lane of the calling thread.
+    * @param index Lane of the thread.
+    */
+    static void SetThreadIndex(UINT32 index);
+
+    /**
+    * Writes out the events held by a recorder, in the order they were
+    * generated. Threaded simulators replay the recorders of all the threads
+    * in a fixed order at their synchronization points, which keeps the trace
+    * deterministic. The recorder is not cleared.
+    * @brief Writes the events of a recorder.
+    * @param recorder Recorder to replay.
+    */
+    void ReplayRecorder(DRAL_SERVER_RECORDER recorder);
+
     /**
     * Method used to know the maximum bandwidth used in a single cycle for
     * all the edges
@@ -1288,6 +1475,15 @@ private:
     UINT32 ComputeNodePosition(UINT16 nodeId, UINT16 dim, UINT32 position[]);
     void AutoFlush(UINT64 n);
     void DumpLiveItemIds();
+    UINT32 LaneEnd();
+    DRAL_SERVER_IMPLEMENTATION Impl();
+    DRAL_INTERNED_STRING * Intern(map<string, DRAL_INTERNED_STRING *> & interned,
+        const char str[]);
+    void SetNodeTagValue(
+        UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+        Nodetagcache_tag_map ** cache, UINT64 value,
+        UINT16 level, const UINT32 list [], bool persistent);
+    void SyncPoint(UINT64 n);
     void UpdateEdgeMaxBandwidth();
 
     // iterate over the var-args list
@@ -1308,6 +1504,18 @@ private:
      * and incremented.
      */
     UINT32 item_id;
+
+    /*
+     * Next id of each thread lane (see SetThreads). Each lane is only
+     * written by its own thread, so it takes a cache line of its own.
+     */
+    struct ITEM_LANE
+    {
+        UINT32 next;
+        UINT32 pad[15];
+    };
+    vector<ITEM_LANE> lane_item_id;
+    UINT32 lane_epoch;                   /* SetThreads call the lanes were set up for */
     UINT16 node_id;
     UINT16 edge_id;
     UINT16 clock_id;
@@ -1316,6 +1524,12 @@ private:
     bool nodetagAutocompress;
     Nodetagcache_map nodetagcache;
 
+    /*
+     * Tag names and string values interned by RegisterTag and RegisterString
+     */
+    map<string, DRAL_INTERNED_STRING *> internedTags;
+    map<string, DRAL_INTERNED_STRING *> internedStrings;
+
     /*
      * AutoFlush implementation, Julio Gago @ BSSAD, June 2004.
      *
@@ -1373,6 +1587,14 @@ private:
      */
     liveItemsList liveItems;
 
+    /*
+     * Sync points: cycles between them, cycle of the next one and items
+     * alive at any moment (only tracked if sync points are enabled)
+     */
+    UINT64 syncInterval;
+    UINT64 nextSyncCycle;
+    liveItemsList syncItems;
+
     /*
      * A pointer to the implementation class
      */
@@ -28,9 +28,12 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vector>
+
 #include "asim/dralStringMapping.h"
 #include "asim/dralServerBinaryDefines.h"
 #include "asim/dralClientBinary_v3.h"
+#include "asim/dralCommonDefines.h"
 
 // Stats macros
 #ifdef DRAL_STATS
@@ -134,6 +137,10 @@ class DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS : public DRAL_SERVER_IMPLEMENTATIO
     
     void Version (void);
 
+    bool SyncPoint (UINT64 cycle, UINT32 n, const UINT32 item_id []);
+
+    void WriteSyncIndex (void);
+
   private:
     DRAL_STRING_MAPPING_CLASS tag_map;     ///< Mapping of tags.
     DRAL_STRING_MAPPING_CLASS str_val_map; ///< Mapping of strings values.
@@ -154,6 +161,8 @@ class DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS : public DRAL_SERVER_IMPLEMENTATIO
     UINT16 lastPhase;   ///< Phase of the lasat cycle command.
     UINT64 lastCycle;   ///< Cycle of the lasat cycle command.
 
+    vector<DRAL_SYNC_ENTRY> syncIndex; ///< Sync points of the current file.
+
     STATS
     (
         void clearMoveItems();
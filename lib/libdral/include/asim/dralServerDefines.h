@@ -39,7 +39,7 @@
 #define DRAL_SERVER_DEFINES_H
 
 #define DRAL_SERVER_VERSION_MAJOR 4    /**< Interface version */
-#define DRAL_SERVER_VERSION_MINOR 0    /**< Interface implementation version */
+#define DRAL_SERVER_VERSION_MINOR 1    /**< Interface implementation version */
 
 #include <iostream>
 using namespace std;
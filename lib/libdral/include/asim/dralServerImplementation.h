@@ -139,6 +139,17 @@ class DRAL_SERVER_IMPLEMENTATION_CLASS
      */
     virtual void Version (void)=0;
     
+    /*
+     * Public methods used to make the trace seekable. SyncPoint starts a
+     * block that can be decoded without the previous ones, and returns
+     * false if the implementation or the output can not do it.
+     * WriteSyncIndex appends the index of the blocks to the output.
+     * By default the implementations are not seekable.
+     */
+    virtual bool SyncPoint (UINT64 cycle, UINT32 n, const UINT32 item_id []);
+
+    virtual void WriteSyncIndex (void);
+
     /*
      * Public method used to flush the write buffer.
      * The buffer will be flushed when turning off the server and when
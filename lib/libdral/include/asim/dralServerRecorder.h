@@ -0,0 +1,184 @@
+/**************************************************************************
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dralServerRecorder.h
+ * @brief dral server implementation that records events in memory
+ */
+
+#ifndef __dralServerRecorder_h
+#define __dralServerRecorder_h
+
+#include <vector>
+
+#include "asim/dralServerImplementation.h"
+
+using namespace std;
+
+/*
+ * This class is derived from the dral server implementation class. It
+ * does not write anything: it appends every call to an in-memory log
+ * that can later be replayed, in order, into a real implementation.
+ * Threaded simulators give each worker thread its own recorder, so
+ * threads never contend for the trace file, and replay the recorders in
+ * a deterministic order at synchronization points.
+ */
+class DRAL_SERVER_RECORDER_CLASS : public DRAL_SERVER_IMPLEMENTATION_CLASS
+{
+
+  public:
+
+    DRAL_SERVER_RECORDER_CLASS();
+
+    ~DRAL_SERVER_RECORDER_CLASS();
+
+    /*
+     * Replays all the recorded calls into the given implementation.
+     * The log is left untouched.
+     */
+    void Replay (DRAL_SERVER_IMPLEMENTATION target) const;
+
+    /*
+     * Forgets all the recorded calls.
+     */
+    void Clear (void) { log.clear(); }
+
+    bool Empty (void) const { return log.empty(); }
+
+    UINT32 GetSize (void) const { return log.size(); }
+
+    void NewNode (UINT16 node_id, const char name[], UINT16 name_len,
+        UINT16 parent_id, UINT16 instance);
+
+    void NewEdge (
+        UINT16 edge_id, UINT16 source_node, UINT16 destination_node,
+        UINT32 bandwidth, UINT32 latency, const char name[], UINT16 name_len);
+
+    void SetNodeLayout(UINT16 node_id, UINT16 dimensions, const UINT32 capacity []);
+
+    void SetNodeTag(
+        UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+        UINT64 value, UINT16 level, const UINT32 list []);
+
+    void SetNodeTag(
+        UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+        UINT16 n, const UINT64 set [], UINT16 level, const UINT32 list []);
+
+    void SetNodeTag(
+        UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+        const char str [], UINT16 str_len, UINT16 level, const UINT32 list []);
+
+    void Cycle (UINT64 n);
+
+    void NewItem (UINT32 item_id);
+
+    void SetItemTag (
+        UINT32 item_id, const char tag_name[], UINT16 tag_name_len, UINT64 value);
+
+    void SetItemTag (
+        UINT32 item_id, const char tag_name[], UINT16 tag_name_len,
+        const char str[], UINT16 str_len);
+
+    void SetItemTag (
+        UINT32 item_id, const char tag_name[], UINT16 tag_name_len,
+        UINT32 nval, UINT64 value[]);
+
+    void MoveItems (UINT16 edge_id, UINT32 n, UINT32 item_id[], UINT32 position []);
+
+    void EnterNode (UINT16 node_id, UINT32 item_id, UINT16 dimensions, UINT32 position []);
+
+    void ExitNode (UINT16 node_id, UINT32 item_id, UINT16 dimensions, UINT32 position []);
+
+    void DeleteItem (UINT32 item_id);
+
+    void Comment (UINT32 magic_num, const char comment [], UINT32 length);
+
+    void CommentBin (UINT16 magic_num, const char comment [], UINT32 comment_len);
+
+    void SetCycleTag (const char tag_name[], UINT16 tag_name_len, UINT64 value);
+
+    void SetCycleTag (
+        const char tag_name[], UINT16 tag_name_len, const char str[], UINT16 str_len);
+
+    void SetCycleTag (
+        const char tag_name[], UINT16 tag_name_len, UINT32 nval, UINT64 value[]);
+
+    void SetNodeInputBandwidth (UINT16 nodeId, UINT32 bandwidth);
+
+    void SetNodeOutputBandwidth (UINT16 nodeId, UINT32 bandwidth);
+
+    void StartActivity (UINT64 firstActivityCycle);
+
+    void SetTagDescription (
+        const char tag [], UINT16 tag_len, const char description [], UINT16 desc_len);
+
+    void SetNodeClock (UINT16 nodeId, UINT16 clockId);
+
+    void NewClock (
+        UINT16 clockId, UINT64 freq, UINT16 skew, UINT16 divisions,
+        const char name [], UINT16 nameLen);
+
+    void Cycle (UINT16 clockId, UINT64 n, UINT16 phase);
+
+    void Version (void);
+
+  private:
+
+    enum RECORD_CODE
+    {
+        REC_NEWNODE, REC_NEWEDGE, REC_SETNODELAYOUT,
+        REC_SETNODETAG_VALUE, REC_SETNODETAG_SET, REC_SETNODETAG_STRING,
+        REC_CYCLE, REC_NEWITEM,
+        REC_SETITEMTAG_VALUE, REC_SETITEMTAG_STRING, REC_SETITEMTAG_SET,
+        REC_MOVEITEMS, REC_ENTERNODE, REC_EXITNODE, REC_DELETEITEM,
+        REC_COMMENT, REC_COMMENTBIN,
+        REC_SETCYCLETAG_VALUE, REC_SETCYCLETAG_STRING, REC_SETCYCLETAG_SET,
+        REC_SETNODEINPUTBW, REC_SETNODEOUTPUTBW, REC_STARTACTIVITY,
+        REC_SETTAGDESCRIPTION, REC_SETNODECLOCK, REC_NEWCLOCK, REC_CYCLE_CLOCK
+    };
+
+    template <typename T> void Put (T value)
+    {
+        const char * p = (const char *) &value;
+        log.insert(log.end(), p, p + sizeof(T));
+    }
+
+    void PutBytes (const void * data, UINT32 len)
+    {
+        Put<UINT32>(len);
+        const char * p = (const char *) data;
+        log.insert(log.end(), p, p + len);
+    }
+
+    vector<char> log;
+};
+typedef DRAL_SERVER_RECORDER_CLASS * DRAL_SERVER_RECORDER;
+
+#endif /* __dralServerRecorder_h */
@@ -44,6 +44,7 @@
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -60,6 +61,10 @@ using namespace std;
   * new index is stored and returned. As the user can specify the
   * maximum number of strings to remember, this mapping might kill
   * some entries. The policy implemented by now is LRU.
+  *
+  * The strings are kept in an open addressing hash table, and the LRU
+  * order is a list linked through the entries themselves, so looking up
+  * a string that is already mapped never allocates memory.
   */
 class DRAL_STRING_MAPPING_CLASS
 {
@@ -80,37 +85,54 @@ class DRAL_STRING_MAPPING_CLASS
       * @brief This function performs the mapping between the string
       *        and the index.
       * @param str The string to map to an integer.
-      * @param strlen The length of the string (including 0).
+      * @param strlen The number of bytes of str to look at. The string
+      *        needs no terminating 0 within them; if there is one, the
+      *        string ends there, so a length counting the 0 and one
+      *        not counting it map to the same index. No byte past
+      *        str[strlen - 1] is ever read.
       * @param index Pointer where store the mapping.
       * @return true if str isn't in the mapping, so a callback to add this
       *         string in the mapping is needed.
       */
     bool getMapping(const char * str, UINT16 strlen, UINT32 * index);
 
-  private:
     /**
-     * Structs used to implement the LRU policy using stl lists.
-     */
-    typedef list<string> LRUList;
-    typedef list<string>::iterator LRUListIterator;
+      * @brief Forgets all the strings, so the indexes are given again
+      *        from 0.
+      */
+    void reset();
 
+  private:
     /**
-     * Struct associated to each of the entries of the mapping. The LRU
-     * iterator is used to have direct access to the elements of the list,
-     * so when a string is requested, the entry can be moved directly
-     * to the end of the LRU without a linear search.
+     * Each entry owns a copy of its string. The entry of a string is
+     * also its mapping index, so when the LRU entry is recycled its
+     * index goes to the new string. The LRU list is linked through the
+     * prev and next fields, from the least to the most recently used.
      */
     struct StringMappingEntry
     {
-        LRUListIterator it; ///< Iterator to the LRU entry.
-        UINT32 index;       ///< Mapping between of the string.
+        char * str;   ///< Copy of the string (not 0 terminated).
+        UINT32 len;   ///< Length of the string.
+        UINT32 cap;   ///< Allocated size of str.
+        UINT32 hash;  ///< Hash of the string.
+        UINT32 prev;  ///< Previous entry in the LRU list.
+        UINT32 next;  ///< Next entry in the LRU list.
     };
 
+    static UINT32 hashString(const char * str, UINT32 len);
+
     /**
-     * Structs to implement the mapping using a stl hash map.
+     * Finds the bucket holding the entry of a string or, if the string
+     * is not mapped, the empty bucket where it should be inserted.
      */
-    typedef map<string, StringMappingEntry> StringMapping;
-    typedef map<string, StringMappingEntry>::iterator StringMappingIterator;
+    UINT32 findBucket(const char * str, UINT32 len, UINT32 hash) const;
+
+    void insertBucket(UINT32 entry);
+    void removeBucket(UINT32 entry);
+    void grow();
+
+    void lruUnlink(UINT32 entry);
+    void lruAppend(UINT32 entry);
 
     /**
      * For debug purpose.
@@ -119,8 +141,11 @@ class DRAL_STRING_MAPPING_CLASS
 
   private:
     UINT32 max_strs;       ///< Maximum number of strings.
-    LRUList lru;           ///< The LRU list.
-    StringMapping mapping; ///< The map between strings and integers.
+    vector<StringMappingEntry> entries; ///< The mapped strings, by index.
+    vector<UINT32> buckets; ///< Entry + 1 of each bucket, or 0 if empty.
+    UINT32 mask;           ///< Number of buckets - 1.
+    UINT32 lru_head;       ///< Least recently used entry.
+    UINT32 lru_tail;       ///< Most recently used entry.
     UINT32 commands;       ///< Internal statistics: number of new strings needed.
     UINT32 conflicts;      ///< Internal statistics: number of conflicts in the map.
 } ;
@@ -61,6 +61,25 @@ class DRAL_BUFFERED_WRITE_CLASS
     
     void Flush (void);
 
+    /*
+     * Ends the current compressed block, so a reader can start
+     * decompressing at the returned file offset. It returns -1 if the
+     * file descriptor is not seekable.
+     */
+    INT64 StartBlock (void);
+
+    /*
+     * Ends the compressed stream. The following writes go to the file
+     * uncompressed until the file descriptor is changed. It returns the
+     * file offset of the first of them or -1 if not seekable.
+     */
+    INT64 StartTrailer (void);
+
+    /*
+     * Number of (uncompressed) bytes written to the current file descriptor
+     */
+    UINT64 GetNumBytesWritten (void);
+
   private:
 
     UINT16 buf_size;  // the buffer size
@@ -84,7 +103,12 @@ class DRAL_BUFFERED_WRITE_CLASS
     gzFile file;
     FILE * uncompressed_file;
 
+    int fd;  // the file descriptor given by the user
+
+    UINT64 bytes_written;
+
     bool compress;
+    bool trailer;  // the compressed stream has been ended
 };
 typedef DRAL_BUFFERED_WRITE_CLASS * DRAL_BUFFERED_WRITE;
 
@@ -47,7 +47,7 @@ using namespace std;
  * will get data, the listener, and the read buffer size
  */
 DRAL_CLIENT_CLASS::DRAL_CLIENT_CLASS (
-    int fd, DRAL_LISTENER listener, UINT32 buffer_size)
+    int fd, DRAL_LISTENER listener, UINT32 buffer_size, UINT32 decode_threads)
 {
     UINT16 type;
     UINT16 ver;
@@ -55,7 +55,8 @@ DRAL_CLIENT_CLASS::DRAL_CLIENT_CLASS (
 
     error=false;
 
-    dralRead = new DRAL_BUFFERED_READ_CLASS (fd,listener,buffer_size);
+    dralRead = new DRAL_BUFFERED_READ_CLASS (
+        fd,listener,buffer_size,decode_threads);
     if (dralRead == NULL)
     {
         type=DRAL_ERROR;
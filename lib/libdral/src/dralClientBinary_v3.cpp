@@ -50,6 +50,11 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::DRAL_CLIENT_BINARY_3_IMPLEMENTATION_C
     last_node = 0;
     last_edge = 0;
     EOS = false;
+    syncIndexRead = false;
+    seeking = false;
+
+    // The item events are grouped in blocks if the listener wants them.
+    batchListener = dynamic_cast<DRAL_BATCH_LISTENER>(listener);
 }
 
 DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::~DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS()
@@ -71,6 +76,7 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ReadBytes (UINT32 n)
     b = dralRead->Read(n, &k);
     if(k == -1)
     {
+        FlushBatch();
         dralListener->Error("Error reading from the file descriptor");
         return NULL;
     }
@@ -222,6 +228,7 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ProcessNextEvent (
 
         if(EOS)
         {
+            FlushBatch();
             dralListener->EndSimulation();
             errorFound = true;
             break;
@@ -229,6 +236,14 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ProcessNextEvent (
 
         command = * (dralCommand *) buffer;
 
+        // Any event but the ones in the block delivers the block first.
+        if (command.command != DRAL3_NEWITEM &&
+            (command.command < DRAL3_SETITEMTAG_VALUE_8_BITS ||
+             command.command > DRAL3_SETITEMTAG_VALUE_32_BITS))
+        {
+            FlushBatch();
+        }
+
         /*char str[1024];
         sprintf(str, "Command is: %i", command.command);
         dralListener->Comment(0, str);*/
@@ -328,6 +343,12 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ProcessNextEvent (
           case DRAL3_NEWSTRINGVALUE:
             r=NewStringValue();
             break;
+          case DRAL3_SYNCPOINT:
+            r=SyncPoint();
+            break;
+          case DRAL3_SYNCINDEX:
+            r=SyncIndex();
+            break;
           default:
             r=Error();
             break;
@@ -335,6 +356,7 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ProcessNextEvent (
 
         if (!r)
         {
+            FlushBatch();
             dralListener->Error(
                 "Error reading the events file. If it is compressed, "
                 "it may have a CRC error");
@@ -343,9 +365,40 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::ProcessNextEvent (
             break;
         }
     }
+    FlushBatch();
     return n_events;
 }
 
+/**
+ * Delivers the pending item block, if any, to the batch listener.
+ */
+void
+DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::FlushBatch()
+{
+    if (batchNewItems.empty() && batchTagItems.empty())
+    {
+        return;
+    }
+
+    DRAL_ITEM_BATCH batch;
+
+    batch.numNewItems = batchNewItems.size();
+    batch.newItems = batch.numNewItems ? &batchNewItems[0] : NULL;
+    batch.newItemsPos = batch.numNewItems ? &batchNewItemsPos[0] : NULL;
+    batch.numTags = batchTagItems.size();
+    batch.tagItems = batch.numTags ? &batchTagItems[0] : NULL;
+    batch.tagIdxs = batch.numTags ? &batchTagIdxs[0] : NULL;
+    batch.tagValues = batch.numTags ? &batchTagValues[0] : NULL;
+
+    batchListener->ItemBatch(batch);
+
+    batchNewItems.clear();
+    batchNewItemsPos.clear();
+    batchTagItems.clear();
+    batchTagIdxs.clear();
+    batchTagValues.clear();
+}
+
 bool
 DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::Error()
 {
@@ -826,8 +879,16 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::NewItem(void * buffer)
         return false;
     }
 
-    dralListener->NewItem(last_item);
-    
+    if (batchListener != NULL)
+    {
+        batchNewItemsPos.push_back(batchTagItems.size());
+        batchNewItems.push_back(last_item);
+    }
+    else
+    {
+        dralListener->NewItem(last_item);
+    }
+
     return true;
 }
 
@@ -1055,7 +1116,16 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::SetItemTagValue(DRAL3_VALUE_SIZE item
         return false;
     }
 
-    dralListener->SetItemTag(last_item, tags[tag_idx], value);
+    if (batchListener != NULL)
+    {
+        batchTagItems.push_back(last_item);
+        batchTagIdxs.push_back(tags[tag_idx]);
+        batchTagValues.push_back(value);
+    }
+    else
+    {
+        dralListener->SetItemTag(last_item, tags[tag_idx], value);
+    }
 
     return true;
 }
@@ -1431,3 +1501,142 @@ DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::NewStringValue()
 
     return true;
 }
+
+/**
+ * Moves the read position to the last sync point at or before cycle. The
+ * sync point command found there gives the live items to the listener.
+ * Returns false if the trace has no index or all its sync points are after
+ * cycle (the read position is not changed).
+ */
+bool
+DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::SeekCycle(
+    UINT64 cycle, UINT64 * sync_cycle)
+{
+    if (errorFound)
+    {
+        return false;
+    }
+    if (!syncIndexRead)
+    {
+        dralRead->ReadSyncIndex(syncIndex);
+        syncIndexRead = true;
+    }
+
+    // First sync point after cycle.
+    UINT32 lo = 0;
+    UINT32 hi = syncIndex.size();
+    while (lo < hi)
+    {
+        UINT32 mid = (lo + hi) / 2;
+        if (syncIndex[mid].cycle <= cycle)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo == 0)
+    {
+        return false;
+    }
+
+    DRAL_SYNC_ENTRY & entry = syncIndex[lo - 1];
+    if (!dralRead->Seek(entry.fileOffset, entry.streamOffset))
+    {
+        return false;
+    }
+    last_item = 0;
+    last_node = 0;
+    last_edge = 0;
+    EOS = false;
+    seeking = true;
+    if (sync_cycle != NULL)
+    {
+        * sync_cycle = entry.cycle;
+    }
+    return true;
+}
+
+bool
+DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::SyncPoint()
+{
+    struct syncPointFormat
+    {
+        UINT64 commandCode  : 6;
+        UINT64 reserved     : 26;
+        UINT64 nitems       : 32;
+        UINT64 cycle;
+    } * commandSyncPoint;
+
+    commandSyncPoint = (syncPointFormat *) ((char *) ReadBytes(sizeof(syncPointFormat) - 1) - 1);
+
+    if(EOS)
+    {
+        return false;
+    }
+
+    UINT32 n = commandSyncPoint->nitems;
+
+    // The server starts again the incremental encoding.
+    last_item = 0;
+    last_node = 0;
+    last_edge = 0;
+
+    if (n == 0)
+    {
+        seeking = false;
+        return true;
+    }
+
+    UINT32 * items = (UINT32 *) ReadBytes(n * sizeof(UINT32));
+
+    if(EOS)
+    {
+        return false;
+    }
+
+    // The live items are already known unless we have jumped here.
+    if (seeking)
+    {
+        for (UINT32 i = 0; i < n; i++)
+        {
+            dralListener->NewItem(items[i]);
+        }
+        seeking = false;
+    }
+    return true;
+}
+
+bool
+DRAL_CLIENT_BINARY_3_IMPLEMENTATION_CLASS::SyncIndex()
+{
+    struct syncIndexFormat
+    {
+        UINT32 commandCode  : 6;
+        UINT32 reserved     : 26;
+        UINT32 nentries;
+    } * commandSyncIndex;
+
+    commandSyncIndex = (syncIndexFormat *) ((char *) ReadBytes(sizeof(syncIndexFormat) - 1) - 1);
+
+    if(EOS)
+    {
+        return false;
+    }
+
+    // Only found in uncompressed traces: it is skipped.
+    UINT32 n = commandSyncIndex->nentries;
+    for (UINT32 i = 0; i < n; i++)
+    {
+        ReadBytes(sizeof(DRAL_SYNC_ENTRY));
+        if(EOS)
+        {
+            return false;
+        }
+    }
+    ReadBytes(sizeof(DRAL_SYNC_TAIL));
+
+    return !EOS;
+}
@@ -68,6 +68,12 @@ DRAL_CLIENT_IMPLEMENTATION_CLASS::GetNumBytesRead(void)
     return dralRead->GetNumBytesRead();
 }
 
+bool
+DRAL_CLIENT_IMPLEMENTATION_CLASS::SeekCycle(UINT64, UINT64 *)
+{
+    return false;
+}
+
 UINT32
 DRAL_CLIENT_IMPLEMENTATION_CLASS::getTagIndex(const char * tag, UINT16 tag_len)
 {
@@ -45,6 +45,7 @@
 DRAL_LISTENER_CONVERTER_CLASS::DRAL_LISTENER_CONVERTER_CLASS(DRAL_LISTENER_OLD listener)
 {
     dralListener = listener;
+    batchListener = dynamic_cast<DRAL_BATCH_LISTENER_OLD>(listener);
 }
 
 DRAL_LISTENER_CONVERTER_CLASS::~DRAL_LISTENER_CONVERTER_CLASS()
@@ -329,3 +330,28 @@ DRAL_LISTENER_CONVERTER_CLASS::NewString(UINT32 string_idx, const char * str, IN
     strings.push_back((char *) malloc(str_len));
     memcpy(strings[string_idx], str, str_len);
 }
+
+void
+DRAL_LISTENER_CONVERTER_CLASS::ItemBatch(const DRAL_ITEM_BATCH & batch)
+{
+    if (batchListener != NULL)
+    {
+        batchListener->ItemBatch(batch, tags.empty() ? NULL : &tags[0]);
+        return;
+    }
+
+    // Replays the events in their original order.
+    UINT32 j = 0;
+    for(UINT32 i = 0; i <= batch.numNewItems; i++)
+    {
+        UINT32 end = (i < batch.numNewItems) ? batch.newItemsPos[i] : batch.numTags;
+        for(; j < end; j++)
+        {
+            dralListener->SetItemTag(batch.tagItems[j], tags[batch.tagIdxs[j]], batch.tagValues[j]);
+        }
+        if(i < batch.numNewItems)
+        {
+            dralListener->NewItem(batch.newItems[i]);
+        }
+    }
+}
@@ -46,13 +46,24 @@
 using namespace std;
 
 DRAL_BUFFERED_READ_CLASS::DRAL_BUFFERED_READ_CLASS (
-    int file_descriptor, DRAL_LISTENER dral_listener, UINT32 buffer_size)
+    int file_descriptor, DRAL_LISTENER dral_listener, UINT32 buffer_size,
+    UINT32 decode_threads)
 {
     fd=file_descriptor;
     numBytesRead=0;    
     bufferSize=buffer_size;
     dralListener=dral_listener;
     errorFound=false;
+    readAhead=NULL;
+
+    // The read ahead threads use pread, so the file must be seekable
+    off_t start = lseek(fd,0,SEEK_CUR);
+    if ((decode_threads != 0) && (start != -1))
+    {
+        ReadSyncIndex(syncIndex);
+        readAhead = new DRAL_READ_AHEAD_CLASS(fd,decode_threads);
+        readAhead->Start(start,syncIndex);
+    }
 
     if (bufferSize != 0)
     {
@@ -88,6 +99,8 @@ DRAL_BUFFERED_READ_CLASS::DRAL_BUFFERED_READ_CLASS (
 
 DRAL_BUFFERED_READ_CLASS::~DRAL_BUFFERED_READ_CLASS ()
 {
+    delete readAhead;
+
     if (buffer != NULL)
     {
         buffer = (void *) (((char *) buffer) - 1);
@@ -106,6 +119,16 @@ INT64 DRAL_BUFFERED_READ_CLASS::ReadFD(void * buf, UINT32 n)
     UINT32 i=0;
     INT64 r=0;
 
+    if (readAhead != NULL)
+    {
+        r=readAhead->Read(buf,n);
+        if (r == -1)
+        {
+            dralListener->Error(readAhead->GetError());
+        }
+        return r;
+    }
+
     while (r <= (n-i))
     {
         r=gzread(file,(char *)buf+i,n-i);
@@ -236,6 +259,14 @@ DRAL_BUFFERED_READ_CLASS::GetFileSize (void)
             }
         }
         
+        DRAL_SYNC_TAIL tail;
+        if (compressed && ReadSyncTail(&tail))
+        {
+            // The last gzip member only knows its own size
+            lseek(fd,current_byte,SEEK_SET);
+            return tail.streamSize;
+        }
+
         if (compressed)
         {
             if (lseek(fd,-4,SEEK_END) == -1)
@@ -293,3 +324,77 @@ UINT32 DRAL_BUFFERED_READ_CLASS::AvailableBytes (void)
 {
     return available;
 }
+
+bool
+DRAL_BUFFERED_READ_CLASS::ReadSyncTail (DRAL_SYNC_TAIL * tail)
+{
+    struct stat s;
+    if (fstat(fd,&s) || (s.st_size < (off_t) sizeof(*tail)))
+    {
+        return false;
+    }
+    if (pread(fd,tail,sizeof(*tail),s.st_size - sizeof(*tail)) != sizeof(*tail))
+    {
+        return false;
+    }
+    return (tail->magic == DRAL_SYNC_MAGICNUM);
+}
+
+bool
+DRAL_BUFFERED_READ_CLASS::ReadSyncIndex (std::vector<DRAL_SYNC_ENTRY> & index)
+{
+    DRAL_SYNC_TAIL tail;
+
+    index.clear();
+    if (!ReadSyncTail(&tail))
+    {
+        return false;
+    }
+
+    index.resize(tail.numEntries);
+    size_t size = tail.numEntries * sizeof(DRAL_SYNC_ENTRY);
+    if ((size == 0) ||
+        (pread(fd,&index[0],size,tail.indexOffset) != (ssize_t) size))
+    {
+        index.clear();
+        return false;
+    }
+    return true;
+}
+
+bool
+DRAL_BUFFERED_READ_CLASS::Seek (UINT64 file_offset, UINT64 stream_offset)
+{
+    if (errorFound)
+    {
+        return false;
+    }
+    if (readAhead != NULL)
+    {
+        readAhead->Start(file_offset,syncIndex);
+        available=0;
+        pos=0;
+        numBytesRead=stream_offset;
+        return true;
+    }
+    if (lseek(fd,file_offset,SEEK_SET) == -1)
+    {
+        dralListener->NonCriticalError(strerror(errno));
+        return false;
+    }
+
+    // Each sync point starts a gzip member, so zlib can begin there
+    gzclose(file);
+    file=gzdopen(dup(fd),"r");
+    if (file == NULL)
+    {
+        dralListener->Error(strerror(errno));
+        dralListener->EndSimulation();
+        errorFound=true;
+        return false;
+    }
+    available=0;
+    pos=0;
+    numBytesRead=stream_offset;
+    return true;
+}
@@ -0,0 +1,400 @@
+/**************************************************************************
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dralReadAhead.cpp
+ * @brief decompresses dral traces ahead of the dral client
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <zlib.h>
+
+#include "asim/dralReadAhead.h"
+
+using namespace std;
+
+volatile UINT32 DRAL_READ_AHEAD_CLASS::runningThreads = 0;
+
+DRAL_READ_AHEAD_CLASS::DRAL_READ_AHEAD_CLASS (
+    int file_descriptor, UINT32 threads, UINT32 piece_size)
+{
+    fd=file_descriptor;
+    numThreads=(threads == 0) ? 1 : threads;
+    pieceSize=piece_size;
+    maxPieces=4;
+    nextSegment=0;
+    readSegment=0;
+    readPiece=NULL;
+    readPos=0;
+    stopping=false;
+    pthread_mutex_init(&lock,NULL);
+    pthread_cond_init(&changed,NULL);
+}
+
+DRAL_READ_AHEAD_CLASS::~DRAL_READ_AHEAD_CLASS ()
+{
+    Stop();
+    pthread_cond_destroy(&changed);
+    pthread_mutex_destroy(&lock);
+}
+
+void
+DRAL_READ_AHEAD_CLASS::Start (
+    UINT64 file_offset, const vector<DRAL_SYNC_ENTRY> & index)
+{
+    Stop();
+
+    // One segment per sync point block at or after the offset
+    UINT64 begin=file_offset;
+    for (UINT32 i=0; i < index.size(); i++)
+    {
+        if (index[i].fileOffset > begin)
+        {
+            SEGMENT * seg = new SEGMENT;
+            seg->begin=begin;
+            seg->end=index[i].fileOffset;
+            seg->done=false;
+            seg->failed=false;
+            segments.push_back(seg);
+            begin=index[i].fileOffset;
+        }
+    }
+    SEGMENT * seg = new SEGMENT;
+    seg->begin=begin;
+    seg->end=(UINT64) -1;
+    seg->done=false;
+    seg->failed=false;
+    segments.push_back(seg);
+
+    UINT32 n = (numThreads < segments.size()) ? numThreads : segments.size();
+    threads.resize(n);
+    for (UINT32 i=0; i < n; i++)
+    {
+        pthread_create(&threads[i],NULL,WorkerThread,this);
+    }
+    __sync_fetch_and_add(&runningThreads,n);
+}
+
+void
+DRAL_READ_AHEAD_CLASS::Stop (void)
+{
+    pthread_mutex_lock(&lock);
+    stopping=true;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+
+    for (UINT32 i=0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i],NULL);
+    }
+    __sync_fetch_and_sub(&runningThreads,(UINT32) threads.size());
+    threads.clear();
+
+    for (UINT32 i=0; i < segments.size(); i++)
+    {
+        while (!segments[i]->pieces.empty())
+        {
+            delete segments[i]->pieces.front();
+            segments[i]->pieces.pop_front();
+        }
+        delete segments[i];
+    }
+    segments.clear();
+    delete readPiece;
+    readPiece=NULL;
+    readPos=0;
+    nextSegment=0;
+    readSegment=0;
+    stopping=false;
+}
+
+void *
+DRAL_READ_AHEAD_CLASS::WorkerThread (void * arg)
+{
+    ((DRAL_READ_AHEAD) arg)->Work();
+    return NULL;
+}
+
+/*
+ * Each thread takes the next segment, as long as it is inside the window
+ * of numThreads segments starting at the one being read.
+ */
+void
+DRAL_READ_AHEAD_CLASS::Work (void)
+{
+    pthread_mutex_lock(&lock);
+    while (true)
+    {
+        while (!stopping && (nextSegment < segments.size()) &&
+               (nextSegment >= readSegment + numThreads))
+        {
+            pthread_cond_wait(&changed,&lock);
+        }
+        if (stopping || (nextSegment >= segments.size()))
+        {
+            break;
+        }
+        SEGMENT * seg = segments[nextSegment++];
+        pthread_mutex_unlock(&lock);
+
+        Inflate(seg);
+
+        pthread_mutex_lock(&lock);
+        seg->done=true;
+        pthread_cond_broadcast(&changed);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+/*
+ * Hands a piece to the reader, waiting while the segment already has
+ * maxPieces waiting. Returns false if the read ahead is being stopped.
+ */
+bool
+DRAL_READ_AHEAD_CLASS::Queue (SEGMENT * seg, vector<char> * piece)
+{
+    pthread_mutex_lock(&lock);
+    while (!stopping && (seg->pieces.size() >= maxPieces))
+    {
+        pthread_cond_wait(&changed,&lock);
+    }
+    bool ok = !stopping;
+    if (ok)
+    {
+        seg->pieces.push_back(piece);
+        pthread_cond_broadcast(&changed);
+    }
+    pthread_mutex_unlock(&lock);
+    if (!ok)
+    {
+        delete piece;
+    }
+    return ok;
+}
+
+/*
+ * Inflates the gzip members of a segment, or copies it if the trace is
+ * not compressed. Like gzread, it stops at the first data that is not a
+ * gzip member, such as the sync point index.
+ */
+void
+DRAL_READ_AHEAD_CLASS::Inflate (SEGMENT * seg)
+{
+    const UINT32 in_size = 256 * 1024;
+    vector<char> in(in_size);
+    UINT64 pos=seg->begin;
+
+    unsigned char magic[2];
+    bool compressed = (pread(fd,magic,2,pos) == 2) &&
+                      (magic[0] == 0x1f) && (magic[1] == 0x8b);
+
+    z_stream z;
+    memset(&z,0,sizeof(z));
+    if (compressed && (inflateInit2(&z,15 + 16) != Z_OK))
+    {
+        Fail("Can not initialize zlib");
+        seg->failed=true;
+        return;
+    }
+
+    vector<char> * piece = new vector<char>(pieceSize);
+    UINT32 used=0;
+    bool ok=true;
+
+    while (ok)
+    {
+        UINT64 left = seg->end - pos;
+        UINT32 want = (left < in_size) ? left : in_size;
+
+        if (!compressed)
+        {
+            UINT32 room = pieceSize - used;
+            ssize_t r = pread(fd,&(*piece)[used],(want < room) ? want : room,pos);
+            if (r < 0)
+            {
+                Fail(strerror(errno));
+                ok=false;
+                break;
+            }
+            if (r == 0)
+            {
+                break;
+            }
+            pos+=r;
+            used+=r;
+        }
+        else
+        {
+            if (z.avail_in == 0)
+            {
+                ssize_t r = (want == 0) ? 0 : pread(fd,&in[0],want,pos);
+                if (r < 0)
+                {
+                    Fail(strerror(errno));
+                    ok=false;
+                    break;
+                }
+                if (r == 0)
+                {
+                    break;
+                }
+                pos+=r;
+                z.next_in=(Bytef *) &in[0];
+                z.avail_in=r;
+            }
+            z.next_out=(Bytef *) &(*piece)[used];
+            z.avail_out=pieceSize - used;
+            int ret = inflate(&z,Z_NO_FLUSH);
+            used=pieceSize - z.avail_out;
+            if (ret == Z_STREAM_END)
+            {
+                // Go on if another member follows in the segment
+                UINT64 next = pos - z.avail_in;
+                if ((next >= seg->end) ||
+                    (pread(fd,magic,2,next) != 2) ||
+                    (magic[0] != 0x1f) || (magic[1] != 0x8b))
+                {
+                    break;
+                }
+                inflateReset(&z);
+            }
+            else if ((ret != Z_OK) && (ret != Z_BUF_ERROR))
+            {
+                Fail(z.msg ? z.msg : "Corrupted compressed data");
+                ok=false;
+                break;
+            }
+        }
+
+        if (used == pieceSize)
+        {
+            ok=Queue(seg,piece);
+            piece=new vector<char>(pieceSize);
+            used=0;
+        }
+    }
+
+    if (compressed)
+    {
+        inflateEnd(&z);
+    }
+    if (ok && (used != 0))
+    {
+        piece->resize(used);
+        Queue(seg,piece);
+    }
+    else
+    {
+        delete piece;
+    }
+    if (!ok)
+    {
+        seg->failed=true;
+    }
+}
+
+void
+DRAL_READ_AHEAD_CLASS::Fail (const char * msg)
+{
+    pthread_mutex_lock(&lock);
+    if (error.empty())
+    {
+        error=msg;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+INT64
+DRAL_READ_AHEAD_CLASS::Read (void * buf, UINT32 n)
+{
+    UINT32 copied=0;
+
+    while (copied < n)
+    {
+        if (readPiece != NULL)
+        {
+            UINT32 take = readPiece->size() - readPos;
+            if (take > n - copied)
+            {
+                take = n - copied;
+            }
+            memcpy((char *) buf + copied,&(*readPiece)[readPos],take);
+            copied+=take;
+            readPos+=take;
+            if (readPos == readPiece->size())
+            {
+                delete readPiece;
+                readPiece=NULL;
+            }
+            continue;
+        }
+
+        // Get the next piece, moving on to the next segment if needed
+        pthread_mutex_lock(&lock);
+        while (readPiece == NULL)
+        {
+            if (readSegment >= segments.size())
+            {
+                break;
+            }
+            SEGMENT * seg = segments[readSegment];
+            if (!seg->pieces.empty())
+            {
+                readPiece=seg->pieces.front();
+                readPos=0;
+                seg->pieces.pop_front();
+                pthread_cond_broadcast(&changed);
+            }
+            else if (seg->failed && seg->done)
+            {
+                pthread_mutex_unlock(&lock);
+                return -1;
+            }
+            else if (seg->done)
+            {
+                readSegment++;
+                pthread_cond_broadcast(&changed);
+            }
+            else
+            {
+                pthread_cond_wait(&changed,&lock);
+            }
+        }
+        pthread_mutex_unlock(&lock);
+
+        if (readPiece == NULL)
+        {
+            break;  // end of the trace
+        }
+    }
+    return copied;
+}
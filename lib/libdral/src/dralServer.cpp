@@ -44,6 +44,7 @@
 #include <vector>
 #include <list>
 #include <string.h>
+#include <pthread.h>
 
 using namespace std;
 
@@ -51,6 +52,7 @@ using namespace std;
 #include "asim/dralServerImplementation.h"
 #include "asim/dralServerBinary.h"
 #include "asim/dralServerAscii.h"
+#include "asim/dralServerRecorder.h"
 #include "asim/dralDesc.h"
 
 // hack: not all platforms define O_LARGEFILE so
@@ -81,6 +83,50 @@ union VA_LIST_TYPE
 typedef VA_LIST_TYPE VA_LIST_T;
 
 
+/*
+ * Threaded simulators attach a recorder to each worker thread. The events
+ * of those threads go to their recorders without any lock. The server
+ * state shared by all threads (item id lanes, live items, stored
+ * commands, autoflush, bandwidth and node tag bookkeeping) and the
+ * events of threads without a recorder are updated under a lock. The
+ * lock is only taken once SetThreads() has been called, before any
+ * worker starts, so single-threaded runs never pay for it and no thread
+ * can start locking halfway through an update.
+ */
+static __thread DRAL_SERVER_RECORDER dralThreadRecorder = NULL;
+static __thread UINT32 dralThreadIndex = 0;
+static __thread UINT32 dralThreadLaneEpoch = 0;
+static volatile UINT32 dralThreads = 1;
+static volatile UINT32 dralLaneEpoch = 0;
+static pthread_mutex_t dralStateLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+class DRAL_STATE_GUARD
+{
+  public:
+    // 'shared' is false when the caller only writes events, which a
+    // thread with a recorder of its own does without the lock
+    DRAL_STATE_GUARD(bool shared = true)
+      : locked(dralThreads > 1 && (shared || dralThreadRecorder == NULL))
+    {
+        if (locked)
+        {
+            pthread_mutex_lock(&dralStateLock);
+        }
+    }
+
+    ~DRAL_STATE_GUARD()
+    {
+        if (locked)
+        {
+            pthread_mutex_unlock(&dralStateLock);
+        }
+    }
+
+  private:
+    bool locked;
+};
+
+
 /*
  * constructor with the name of the file that will be used
  * to write the events and the size of the write buffer
@@ -126,9 +172,12 @@ DRAL_SERVER_CLASS::Init(UINT16 buffer_size, bool avoid_rep, bool compression)
     buff_size=buffer_size;
     avoid_node_reps=avoid_rep;
     item_id=1; // itemId 0 is reserved (used as 'invalid' itemId value)
+    lane_epoch=0;
     node_id=0;
     edge_id=0;
     clock_id=0;
+    syncInterval=0;
+    nextSyncCycle=0;
 
     // FEDE: for convenience, make autocompress for node tags on by default
     nodetagAutocompress = true;
@@ -148,6 +197,10 @@ DRAL_SERVER_CLASS::Init(UINT16 buffer_size, bool avoid_rep, bool compression)
  */
 DRAL_SERVER_CLASS::~DRAL_SERVER_CLASS()
 {
+    if (!openedWithFileName || fileOpened)
+    {
+        implementation->WriteSyncIndex();
+    }
     delete implementation; // this will flush the buffer
     delete dralStorage; // this will free the memory
     if (openedWithFileName && fileOpened)
@@ -169,6 +222,17 @@ DRAL_SERVER_CLASS::~DRAL_SERVER_CLASS()
     {
         delete [] max_edge_bw;
     }
+    map<string, DRAL_INTERNED_STRING *>::iterator it;
+    for (it = internedTags.begin(); it != internedTags.end(); ++it)
+    {
+        free(it->second->str);
+        delete it->second;
+    }
+    for (it = internedStrings.begin(); it != internedStrings.end(); ++it)
+    {
+        free(it->second->str);
+        delete it->second;
+    }
 }
 
 
@@ -245,10 +309,12 @@ DRAL_SERVER_CLASS::ChangeFileName(const char * fileName)
     {
         if (fileOpened)
         {
+            implementation->WriteSyncIndex();
             close(file_descriptor);
         }
         fileOpened=false;
         file_name = fileName;
+        nextSyncCycle=0;
     }
     else
     {
@@ -264,6 +330,7 @@ DRAL_SERVER_CLASS::ChangeFileName(const char * fileName)
 void
 DRAL_SERVER_CLASS::Cycle (UINT64 n, bool persistent)
 {
+    DRAL_STATE_GUARD guard;
     DRAL_ASSERT(!(n >> 58),"Parameter n is too large");
 
     if(com_edge_bw)
@@ -275,7 +342,11 @@ DRAL_SERVER_CLASS::Cycle (UINT64 n, bool persistent)
     
     if (turnedOn)
     {
-        implementation->Cycle(n);
+        if (syncInterval && n >= nextSyncCycle)
+        {
+            SyncPoint(n);
+        }
+        Impl()->Cycle(n);
     }
     if (persistent)
     {
@@ -329,10 +400,15 @@ DRAL_SERVER_CLASS::AutoFlush(UINT64 n)
 void
 DRAL_SERVER_CLASS::NewItem (UINT32 itemId, bool persistent)
 {
+    DRAL_STATE_GUARD guard(syncInterval || !turnedOn || persistent);
     DRAL_ASSERT(itemId != 0, "Sorry, itemId 0 is reserved and cannot be used");
+    if (syncInterval)
+    {
+        syncItems.insert(itemId);
+    }
     if (turnedOn)
     {
-        implementation->NewItem(itemId);
+        Impl()->NewItem(itemId);
     }
     else if (!persistent)
     {
@@ -349,6 +425,54 @@ DRAL_SERVER_CLASS::NewItem (UINT32 itemId, bool persistent)
 UINT32
 DRAL_SERVER_CLASS::NewItem (bool persistent)
 {
+    if (dralThreads > 1)
+    {
+        // the first thread to hand out an id after SetThreads sets up
+        // the lanes, right after the ids handed out so far
+        if (dralThreadLaneEpoch != dralLaneEpoch)
+        {
+            DRAL_STATE_GUARD guard;
+            if (lane_epoch != dralLaneEpoch)
+            {
+                UINT32 first = LaneEnd();
+                if (first > UINT32_MAX - dralThreads)
+                {
+                    first = 1;
+                }
+                lane_item_id.resize(dralThreads);
+                for (UINT32 i = 0; i < dralThreads; i++)
+                {
+                    lane_item_id[i].next = first + i;
+                }
+                lane_epoch = dralLaneEpoch;
+            }
+            dralThreadLaneEpoch = dralLaneEpoch;
+        }
+
+        // only this thread uses its lane
+        UINT32 & next = lane_item_id[dralThreadIndex].next;
+        UINT32 id = next;
+        NewItem(id,persistent);
+        if (next >= UINT32_MAX - dralThreads)
+        {
+            cout<<"We have reached the limit here.."<<endl;
+            next = 1 + dralThreadIndex;
+        }
+        else
+        {
+            next += dralThreads;
+        }
+        return id;
+    }
+
+    // back to a single thread: go on past the ids of the lanes
+    if (lane_epoch)
+    {
+        item_id = LaneEnd();
+        lane_item_id.clear();
+        lane_epoch = 0;
+    }
+
     NewItem(item_id,persistent);
     item_id++;
     if (item_id == UINT32_MAX)
@@ -359,6 +483,20 @@ DRAL_SERVER_CLASS::NewItem (bool persistent)
     return (item_id-1);
 }
 
+/*
+ * First id past the ids handed out so far, in the lanes as well
+ */
+UINT32
+DRAL_SERVER_CLASS::LaneEnd()
+{
+    UINT32 end = item_id;
+    for (UINT32 i = 0; i < lane_item_id.size(); i++)
+    {
+        end = max(end, lane_item_id[i].next);
+    }
+    return end;
+}
+
 
 /*
  * set item tag single value variant
@@ -367,13 +505,14 @@ void
 DRAL_SERVER_CLASS::SetItemTag (
     UINT32 itemId, const char tag_name[], UINT64 value, bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
         "Parameter tag_name " << tag_name << " is too long");
     if (turnedOn)
     {
-        implementation->SetItemTag(itemId,tag_name,tag_name_len,value);
+        Impl()->SetItemTag(itemId,tag_name,tag_name_len,value);
     }
     if (persistent)
     {
@@ -391,6 +530,7 @@ void
 DRAL_SERVER_CLASS::SetItemTag (
     UINT32 itemId, const char tag_name[], const char str[], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     DRAL_ASSERT(str!=NULL,"No string provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
@@ -400,7 +540,7 @@ DRAL_SERVER_CLASS::SetItemTag (
     DRAL_ASSERT(str_len < 65536 && str_len != 0,"Wrong string length");
     if (turnedOn)
     {
-        implementation->SetItemTag(
+        Impl()->SetItemTag(
             itemId,tag_name,tag_name_len,str,str_len);
     }
     if (persistent)
@@ -420,6 +560,7 @@ DRAL_SERVER_CLASS::SetItemTag (
     UINT32 itemId, const char tag_name [],
     UINT32 nval, UINT64 value[], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
@@ -428,7 +569,7 @@ DRAL_SERVER_CLASS::SetItemTag (
         "The set size is not valid");
     if (turnedOn)
     {
-        implementation->SetItemTag(itemId,tag_name,tag_name_len,nval,value);
+        Impl()->SetItemTag(itemId,tag_name,tag_name_len,nval,value);
     }
     if (persistent)
     {
@@ -443,6 +584,7 @@ DRAL_SERVER_CLASS::MoveItems (
     UINT16 edgeId, UINT32 n, UINT32 itemId[],
     UINT32 position [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(com_edge_bw || persistent);
     DRAL_ASSERT(n<32,"Parameter n has to be fewer than 31");
     if(com_edge_bw)
     {
@@ -458,7 +600,7 @@ DRAL_SERVER_CLASS::MoveItems (
     }
     if (turnedOn && n!=0) // we do not want an error if n == 0, just ignore it
     {
-        implementation->MoveItems(edgeId,n,itemId,position);
+        Impl()->MoveItems(edgeId,n,itemId,position);
     }
     if (persistent && n!=0)
     {
@@ -473,6 +615,7 @@ DRAL_SERVER_CLASS::EnterNode (
     UINT16 nodeId, UINT32 itemId, UINT16 dim,
     UINT32 position [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(auto_flush[nodeId] || persistent);
     UINT32 final_position, oldItemId;
     enternode_data ed;
 
@@ -536,6 +679,7 @@ DRAL_SERVER_CLASS::ExitNode (
     UINT16 nodeId, UINT32 itemId, UINT16 dim,
     UINT32 position [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(auto_flush[nodeId] || persistent);
     UINT32 final_position, oldItemId;
 
     //
@@ -605,7 +749,7 @@ DRAL_SERVER_CLASS::DralEnterNode (
     DRAL_ASSERT(dim < 16, "Number of dimensions must be lower than 16");
     if (turnedOn)
     {
-        implementation->EnterNode(nodeId,itemId,dim,position);
+        Impl()->EnterNode(nodeId,itemId,dim,position);
     }
     if (persistent)
     {
@@ -625,7 +769,7 @@ DRAL_SERVER_CLASS::DralExitNode (
     DRAL_ASSERT(dim < 16, "Number of dimensions must be lower than 16");
     if (turnedOn)
     {
-        implementation->ExitNode(nodeId,itemId,dim,position);
+        Impl()->ExitNode(nodeId,itemId,dim,position);
     }
     if (persistent)
     {
@@ -638,9 +782,14 @@ DRAL_SERVER_CLASS::DralExitNode (
 void
 DRAL_SERVER_CLASS::DeleteItem (UINT32 itemId, bool persistent)
 {
+    DRAL_STATE_GUARD guard(syncInterval || !turnedOn || persistent);
+    if (syncInterval)
+    {
+        syncItems.erase(itemId);
+    }
     if (turnedOn)
     {
-        implementation->DeleteItem(itemId);
+        Impl()->DeleteItem(itemId);
     }
     else if (!persistent)
     {
@@ -803,12 +952,13 @@ void
 DRAL_SERVER_CLASS::Comment(
     UINT32 magic_num, const char comment [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     UINT32 comment_len = strlen(comment)+1;
     DRAL_ASSERT(comment!=NULL && comment_len<(UINT32_MAX) && comment_len != 0,
         "Comment == NULL or wrong comment length");
     if (turnedOn)
     {
-        implementation->Comment(magic_num,comment,comment_len);
+        Impl()->Comment(magic_num,comment,comment_len);
     }
     if (persistent)
     {
@@ -822,10 +972,11 @@ void
 DRAL_SERVER_CLASS::CommentBin(
     UINT16 magic_num, const char * contents, UINT32 length, bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(length != 0, "Binary content with length 0 bytes");
     if (turnedOn)
     {
-        implementation->CommentBin(magic_num,contents,length);
+        Impl()->CommentBin(magic_num,contents,length);
     }
     if (persistent)
     {
@@ -860,47 +1011,61 @@ DRAL_SERVER_CLASS::SetNodeTag(
     UINT16 node_id, const char tag_name [], UINT64 value,
     UINT16 level, const UINT32 list [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
         "Parameter tag_name " << tag_name << " is too long");
     DRAL_ASSERT(level < 16384, "Too many levels specified");
+    SetNodeTagValue(
+        node_id,tag_name,tag_name_len,NULL,value,level,list,persistent);
+}
 
-    Nodetagcache_tag_map* tgmap=NULL;
+/*
+ * set node tag single value variant. The autocompress cache of the tag
+ * is looked up by name unless the caller has it in *cache
+ */
+void
+DRAL_SERVER_CLASS::SetNodeTagValue(
+    UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+    Nodetagcache_tag_map ** cache, UINT64 value,
+    UINT16 level, const UINT32 list [], bool persistent)
+{
     bool doCmd=true;
 
     if (turnedOn)
     {
-        // check for compression oportunity
+        // check for compression oportunity; the caches are shared by
+        // all threads, so look up and update them in one go
         if (nodetagAutocompress && !level)
         {
-            tgmap=getNodeTagMap(tag_name);
-            Nodetagcache_tag_map::iterator tgit = tgmap->find(node_id);
-            if (tgit!=tgmap->end())
+            DRAL_STATE_GUARD shared;
+            Nodetagcache_tag_map* tgmap=NULL;
+            if (cache == NULL)
+            {
+                tgmap=getNodeTagMap(tag_name);
+            }
+            else
             {
-                //cerr << "cacheed value for node_id " << node_id << " tg " << tag_name << " value " << tgit->second << endl;
-                if (tgit->second == value) 
-                { 
-                    //cerr << "\t value matches, cmd ignored..."  << endl;
-                    doCmd=false;
+                if (*cache == NULL)
+                {
+                    *cache=getNodeTagMap(tag_name);
                 }
+                tgmap=*cache;
+            }
+            pair<UINT16,UINT64> nodeval(node_id,value);
+            pair<Nodetagcache_tag_map::iterator,bool> p = tgmap->insert(nodeval);
+            if (!p.second && p.first->second == value)
+            {
+                // value matches, cmd ignored
+                doCmd=false;
             }
+            p.first->second=value;
         }
 
         if (doCmd) 
         {
-            implementation->SetNodeTag(node_id,tag_name,tag_name_len,value,level,list);
-            
-            // update compression struct if needed
-            if (nodetagAutocompress && !level)
-            {
-                tgmap=getNodeTagMap(tag_name);
-                pair<UINT16,UINT64> nodeval(node_id,value);
-                pair<Nodetagcache_tag_map::iterator,bool> p = tgmap->insert(nodeval);
-                Nodetagcache_tag_map::iterator i = p.first;
-                i->second=value;
-                //cerr << "upd cache node_id " << node_id << " tg " << tag_name << " value " << value << endl;
-            }
+            Impl()->SetNodeTag(node_id,tag_name,tag_name_len,value,level,list);
         }
     }
     if (persistent && doCmd)
@@ -917,6 +1082,7 @@ DRAL_SERVER_CLASS::SetNodeTag(
     UINT16 node_id, const char tag_name [], const char str [],
     UINT16 level, const UINT32 list [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     DRAL_ASSERT(str!=NULL,"No string provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
@@ -926,7 +1092,7 @@ DRAL_SERVER_CLASS::SetNodeTag(
     DRAL_ASSERT(str_len < 65536 && str_len != 0,"Wrong string length");
     if (turnedOn)
     {
-        implementation->SetNodeTag(
+        Impl()->SetNodeTag(
             node_id,tag_name,tag_name_len,str,str_len,level,list);
     }
     if (persistent)
@@ -943,6 +1109,7 @@ DRAL_SERVER_CLASS::SetNodeTag(
     UINT16 node_id, const char tag_name [], UINT16 nval, const UINT64 set [],
     UINT16 level, const UINT32 list [], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
@@ -951,7 +1118,7 @@ DRAL_SERVER_CLASS::SetNodeTag(
         "The set size is not valid");
     if (turnedOn)
     {
-        implementation->SetNodeTag(
+        Impl()->SetNodeTag(
             node_id,tag_name,tag_name_len,nval,set,level,list);
     }
     if (persistent)
@@ -968,13 +1135,14 @@ void
 DRAL_SERVER_CLASS::SetCycleTag (
     const char tag_name[], UINT64 value, bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
         "Parameter tag_name " << tag_name << " is too long");
     if (turnedOn)
     {
-        implementation->SetCycleTag(tag_name,tag_name_len,value);
+        Impl()->SetCycleTag(tag_name,tag_name_len,value);
     }
     if (persistent)
     {
@@ -989,6 +1157,7 @@ void
 DRAL_SERVER_CLASS::SetCycleTag (
     const char tag_name[], const char str[], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     DRAL_ASSERT(str!=NULL,"No string provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
@@ -998,7 +1167,7 @@ DRAL_SERVER_CLASS::SetCycleTag (
     DRAL_ASSERT(str_len < 65536 && str_len != 0,"Wrong string length");
     if (turnedOn)
     {
-        implementation->SetCycleTag(tag_name,tag_name_len,str,str_len);
+        Impl()->SetCycleTag(tag_name,tag_name_len,str,str_len);
     }
     if (persistent)
     {
@@ -1014,6 +1183,7 @@ DRAL_SERVER_CLASS::SetCycleTag (
     const char tag_name [],
     UINT32 nval, UINT64 value[], bool persistent)
 {
+    DRAL_STATE_GUARD guard(persistent);
     DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
     UINT16 tag_name_len = strlen(tag_name)+1;
     DRAL_ASSERT(tag_name_len < 256 && tag_name_len != 0,
@@ -1022,7 +1192,7 @@ DRAL_SERVER_CLASS::SetCycleTag (
         "The set size is not valid");
     if (turnedOn)
     {
-        implementation->SetCycleTag(tag_name,tag_name_len,nval,value);
+        Impl()->SetCycleTag(tag_name,tag_name_len,nval,value);
     }
     if (persistent)
     {
@@ -1033,6 +1203,179 @@ DRAL_SERVER_CLASS::SetCycleTag (
 }
 
 
+DRAL_INTERNED_STRING *
+DRAL_SERVER_CLASS::Intern(
+    map<string, DRAL_INTERNED_STRING *> & interned, const char str[])
+{
+    DRAL_STATE_GUARD guard;
+    map<string, DRAL_INTERNED_STRING *>::iterator it = interned.find(str);
+    if (it != interned.end())
+    {
+        return it->second;
+    }
+    DRAL_INTERNED_STRING * result = new DRAL_INTERNED_STRING;
+    result->str = strdup(str);
+    result->len = strlen(str)+1;
+    result->nodeTagCache = NULL;
+    interned[str] = result;
+    return result;
+}
+
+DRAL_TAG_HANDLE
+DRAL_SERVER_CLASS::RegisterTag (const char tag_name[])
+{
+    DRAL_ASSERT(tag_name!=NULL,"No tag name provided");
+    UINT32 tag_name_len = strlen(tag_name)+1;
+    DRAL_ASSERT(tag_name_len < 256,
+        "Parameter tag_name " << tag_name << " is too long");
+    DRAL_TAG_HANDLE handle;
+    handle.tag = Intern(internedTags,tag_name);
+    return handle;
+}
+
+DRAL_STRING_HANDLE
+DRAL_SERVER_CLASS::RegisterString (const char str[])
+{
+    DRAL_ASSERT(str!=NULL,"No string provided");
+    UINT32 str_len = strlen(str)+1;
+    DRAL_ASSERT(str_len < 65536,"Wrong string length");
+    DRAL_STRING_HANDLE handle;
+    handle.str = Intern(internedStrings,str);
+    return handle;
+}
+
+/*
+ * The handle variants of the tag commands. The names and strings were
+ * checked when they were registered.
+ */
+void
+DRAL_SERVER_CLASS::SetItemTag (
+    UINT32 itemId, DRAL_TAG_HANDLE tag, UINT64 value, bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    if (turnedOn)
+    {
+        Impl()->SetItemTag(itemId,tag.tag->str,tag.tag->len,value);
+    }
+    if (persistent)
+    {
+        DRAL_SETITEMTAG_STORAGE sitsv =
+            new DRAL_SETITEMTAG_STORAGE_CLASS(itemId,tag.tag->str,value);
+        dralStorage->Store(sitsv,!turnedOn);
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SetItemTag (
+    UINT32 itemId, DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str,
+    bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    if (turnedOn)
+    {
+        Impl()->SetItemTag(
+            itemId,tag.tag->str,tag.tag->len,str.str->str,str.str->len);
+    }
+    if (persistent)
+    {
+        DRAL_SETITEMTAGSTRING_STORAGE sitstring =
+            new DRAL_SETITEMTAGSTRING_STORAGE_CLASS(
+                itemId,tag.tag->str,str.str->str);
+        dralStorage->Store(sitstring,!turnedOn);
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SetItemTag (
+    UINT32 itemId, DRAL_TAG_HANDLE tag, UINT32 nval, UINT64 value[],
+    bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    DRAL_ASSERT(nval<65536 && nval!=0 && value != NULL,
+        "The set size is not valid");
+    if (turnedOn)
+    {
+        Impl()->SetItemTag(itemId,tag.tag->str,tag.tag->len,nval,value);
+    }
+    if (persistent)
+    {
+        DRAL_SETITEMTAGSET_STORAGE sitset =
+            new DRAL_SETITEMTAGSET_STORAGE_CLASS(
+                itemId,tag.tag->str,nval,value);
+        dralStorage->Store(sitset,!turnedOn);
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SetCycleTag (
+    DRAL_TAG_HANDLE tag, UINT64 value, bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    if (turnedOn)
+    {
+        Impl()->SetCycleTag(tag.tag->str,tag.tag->len,value);
+    }
+    if (persistent)
+    {
+        DRAL_SETCYCLETAG_STORAGE sctsv =
+            new DRAL_SETCYCLETAG_STORAGE_CLASS(tag.tag->str,value);
+        dralStorage->Store(sctsv,!turnedOn);
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SetCycleTag (
+    DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str, bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    if (turnedOn)
+    {
+        Impl()->SetCycleTag(
+            tag.tag->str,tag.tag->len,str.str->str,str.str->len);
+    }
+    if (persistent)
+    {
+        DRAL_SETCYCLETAGSTRING_STORAGE sctstring =
+            new DRAL_SETCYCLETAGSTRING_STORAGE_CLASS(
+                tag.tag->str,str.str->str);
+        dralStorage->Store(sctstring,!turnedOn);
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SetNodeTag(
+    UINT16 node_id, DRAL_TAG_HANDLE tag, UINT64 value,
+    UINT16 level, const UINT32 list [], bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    DRAL_ASSERT(level < 16384, "Too many levels specified");
+    SetNodeTagValue(
+        node_id,tag.tag->str,tag.tag->len,&tag.tag->nodeTagCache,
+        value,level,list,persistent);
+}
+
+void
+DRAL_SERVER_CLASS::SetNodeTag(
+    UINT16 node_id, DRAL_TAG_HANDLE tag, DRAL_STRING_HANDLE str,
+    UINT16 level, const UINT32 list [], bool persistent)
+{
+    DRAL_STATE_GUARD guard(persistent);
+    if (turnedOn)
+    {
+        Impl()->SetNodeTag(
+            node_id,tag.tag->str,tag.tag->len,str.str->str,str.str->len,
+            level,list);
+    }
+    if (persistent)
+    {
+        DRAL_SETNODETAGSTRING_STORAGE sntstr =
+            new DRAL_SETNODETAGSTRING_STORAGE_CLASS (
+                node_id,tag.tag->str,str.str->str,level,list);
+        dralStorage->Store(sntstr,!turnedOn);
+    }
+}
+
+
 void
 DRAL_SERVER_CLASS::SwitchToDebug(int fd, bool compression)
 {
@@ -1171,6 +1514,7 @@ DRAL_SERVER_CLASS::NewClock(
 void
 DRAL_SERVER_CLASS::Cycle (UINT16 clockId, UINT64 n, UINT16 phase, bool persistent)
 {
+    DRAL_STATE_GUARD guard;
     DRAL_ASSERT(!(n >> 42),"Parameter n is too large");
  
     if(com_edge_bw)
@@ -1183,6 +1527,10 @@ DRAL_SERVER_CLASS::Cycle (UINT16 clockId, UINT64 n, UINT16 phase, bool persisten
     
     if (turnedOn)
     {
+        if (syncInterval && !clockId && n >= nextSyncCycle)
+        {
+            SyncPoint(n);
+        }
         implementation->Cycle(clockId,n,phase);
     }
     if (persistent)
@@ -1205,6 +1553,29 @@ DRAL_SERVER_CLASS::DumpLiveItemIds()
     liveItems.clear();
 }
 
+void
+DRAL_SERVER_CLASS::SetSyncInterval(UINT64 interval)
+{
+    syncInterval=interval;
+    if (!syncInterval)
+    {
+        syncItems.clear();
+    }
+}
+
+void
+DRAL_SERVER_CLASS::SyncPoint(UINT64 n)
+{
+    vector<UINT32> items(syncItems.begin(), syncItems.end());
+    if (!implementation->SyncPoint(n, items.size(), items.empty() ? NULL : &items[0]))
+    {
+        DRAL_WARNING("The dral output is not seekable, sync points disabled");
+        SetSyncInterval(0);
+        return;
+    }
+    nextSyncCycle = (n / syncInterval + 1) * syncInterval;
+}
+
 void
 DRAL_SERVER_CLASS::ComputeEdgeMaxBandwidth()
 {
@@ -1621,3 +1992,47 @@ DRAL_SERVER_CLASS::AddEventDesc(DRAL_EVENT_DESC_CLASS *event)
     // TODO: write me!
     return;
 }
+
+
+/*
+ * Events of the calling thread go to its recorder, if it has one
+ */
+DRAL_SERVER_IMPLEMENTATION
+DRAL_SERVER_CLASS::Impl()
+{
+    return dralThreadRecorder ? dralThreadRecorder : implementation;
+}
+
+void
+DRAL_SERVER_CLASS::AttachRecorder(DRAL_SERVER_RECORDER recorder)
+{
+    dralThreadRecorder = recorder;
+}
+
+void
+DRAL_SERVER_CLASS::SetThreads(UINT32 threads)
+{
+    DRAL_ASSERT(threads > 0, "At least one thread must generate the events");
+    pthread_mutex_lock(&dralStateLock);
+    dralThreads = threads;
+    // the item id lanes are set up again for the new threads
+    dralLaneEpoch++;
+    pthread_mutex_unlock(&dralStateLock);
+}
+
+void
+DRAL_SERVER_CLASS::SetThreadIndex(UINT32 index)
+{
+    DRAL_ASSERT(index < dralThreads, "Thread index out of range");
+    dralThreadIndex = index;
+}
+
+void
+DRAL_SERVER_CLASS::ReplayRecorder(DRAL_SERVER_RECORDER recorder)
+{
+    DRAL_STATE_GUARD guard;
+    if (turnedOn)
+    {
+        recorder->Replay(implementation);
+    }
+}
@@ -554,6 +554,86 @@ DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS::Version (void)
     )
 }
 
+bool
+DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS::SyncPoint (
+    UINT64 cycle, UINT32 n, const UINT32 item_id [])
+{
+    INT64 offset = dralWrite->StartBlock();
+    if (offset == -1)
+    {
+        return false;
+    }
+
+    DRAL_SYNC_ENTRY entry;
+    entry.cycle = cycle;
+    entry.fileOffset = offset;
+    entry.streamOffset = dralWrite->GetNumBytesWritten();
+    syncIndex.push_back(entry);
+
+    // Nothing written before the sync point is needed to decode the block.
+    last_item = 0;
+    last_node = 0;
+    last_edge = 0;
+    lastClockId = (UINT16) -1;
+    lastCycle = (UINT64) -1;
+    lastPhase = (UINT16) -1;
+    tag_map.reset();
+    str_val_map.reset();
+
+    struct syncPointFormat
+    {
+        UINT64 commandCode  : 6;
+        UINT64 reserved     : 26;
+        UINT64 nitems       : 32;
+        UINT64 cycle;
+    } command;
+
+    command.commandCode = DRAL3_SYNCPOINT;
+    command.reserved = 0;
+    command.nitems = n;
+    command.cycle = cycle;
+
+    dralWrite->Write(&command, sizeof(command));
+    dralWrite->Write(item_id, n * sizeof(UINT32));
+    return true;
+}
+
+void
+DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS::WriteSyncIndex (void)
+{
+    if (syncIndex.empty())
+    {
+        return;
+    }
+
+    struct syncIndexFormat
+    {
+        UINT32 commandCode  : 6;
+        UINT32 reserved     : 26;
+        UINT32 nentries;
+    } command;
+
+    command.commandCode = DRAL3_SYNCINDEX;
+    command.reserved = 0;
+    command.nentries = syncIndex.size();
+
+    DRAL_SYNC_TAIL tail;
+    tail.streamSize = dralWrite->GetNumBytesWritten();
+    tail.indexOffset = dralWrite->StartTrailer();
+    tail.numEntries = syncIndex.size();
+    tail.magic = DRAL_SYNC_MAGICNUM;
+
+    if (tail.indexOffset != (UINT64) -1)
+    {
+        tail.indexOffset += sizeof(command);
+        dralWrite->Write(&command, sizeof(command));
+        dralWrite->Write(&syncIndex[0], syncIndex.size() * sizeof(DRAL_SYNC_ENTRY));
+        dralWrite->Write(&tail, sizeof(tail));
+        dralWrite->Flush();
+    }
+    syncIndex.clear();
+}
+
 void
 DRAL_SERVER_BINARY_IMPLEMENTATION_CLASS::NewItem (
     UINT32 item_id)
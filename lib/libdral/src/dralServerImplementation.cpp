@@ -57,3 +57,15 @@ DRAL_SERVER_IMPLEMENTATION_CLASS::SetFileDescriptor (int fd)
 {
     dralWrite->SetFileDescriptor(fd);
 }
+
+bool
+DRAL_SERVER_IMPLEMENTATION_CLASS::SyncPoint (
+    UINT64, UINT32, const UINT32 [])
+{
+    return false;
+}
+
+void
+DRAL_SERVER_IMPLEMENTATION_CLASS::WriteSyncIndex (void)
+{
+}
@@ -0,0 +1,576 @@
+/**************************************************************************
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file dralServerRecorder.cpp
+ * @brief dral server implementation that records events in memory
+ */
+
+#include <string.h>
+
+#include "asim/dralServerRecorder.h"
+#include "asim/dralServerDefines.h"
+
+/*
+ * Cursor used to decode the log on replay. Arrays are copied out so that
+ * the target sees properly aligned data.
+ */
+class DRAL_RECORD_READER
+{
+  public:
+    DRAL_RECORD_READER(const vector<char> & log)
+        : p(log.empty() ? NULL : &log[0]), end(p + log.size())
+    {
+    }
+
+    bool Done (void) const { return p >= end; }
+
+    template <typename T> T Get (void)
+    {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    const char * GetBytes (UINT32 & len)
+    {
+        len = Get<UINT32>();
+        const char * data = p;
+        p += len;
+        return data;
+    }
+
+    template <typename T> T * GetArray (vector<T> & tmp)
+    {
+        UINT32 len;
+        const char * data = GetBytes(len);
+        tmp.resize(len / sizeof(T));
+        if (len == 0)
+        {
+            return NULL;
+        }
+        memcpy(&tmp[0], data, len);
+        return &tmp[0];
+    }
+
+  private:
+    const char * p;
+    const char * end;
+};
+
+
+DRAL_SERVER_RECORDER_CLASS::DRAL_SERVER_RECORDER_CLASS()
+    : DRAL_SERVER_IMPLEMENTATION_CLASS(0, false)
+{
+}
+
+DRAL_SERVER_RECORDER_CLASS::~DRAL_SERVER_RECORDER_CLASS()
+{
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::NewNode (
+    UINT16 node_id, const char name[], UINT16 name_len,
+    UINT16 parent_id, UINT16 instance)
+{
+    Put<UINT8>(REC_NEWNODE);
+    Put(node_id);
+    PutBytes(name, name_len);
+    Put(parent_id);
+    Put(instance);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::NewEdge (
+    UINT16 edge_id, UINT16 source_node, UINT16 destination_node,
+    UINT32 bandwidth, UINT32 latency, const char name[], UINT16 name_len)
+{
+    Put<UINT8>(REC_NEWEDGE);
+    Put(edge_id);
+    Put(source_node);
+    Put(destination_node);
+    Put(bandwidth);
+    Put(latency);
+    PutBytes(name, name_len);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeLayout (
+    UINT16 node_id, UINT16 dimensions, const UINT32 capacity [])
+{
+    Put<UINT8>(REC_SETNODELAYOUT);
+    Put(node_id);
+    PutBytes(capacity, dimensions * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeTag (
+    UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+    UINT64 value, UINT16 level, const UINT32 list [])
+{
+    Put<UINT8>(REC_SETNODETAG_VALUE);
+    Put(node_id);
+    PutBytes(tag_name, tag_name_len);
+    Put(value);
+    PutBytes(list, level * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeTag (
+    UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+    UINT16 n, const UINT64 set [], UINT16 level, const UINT32 list [])
+{
+    Put<UINT8>(REC_SETNODETAG_SET);
+    Put(node_id);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(set, n * sizeof(UINT64));
+    PutBytes(list, level * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeTag (
+    UINT16 node_id, const char tag_name [], UINT16 tag_name_len,
+    const char str [], UINT16 str_len, UINT16 level, const UINT32 list [])
+{
+    Put<UINT8>(REC_SETNODETAG_STRING);
+    Put(node_id);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(str, str_len);
+    PutBytes(list, level * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::Cycle (UINT64 n)
+{
+    Put<UINT8>(REC_CYCLE);
+    Put(n);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::NewItem (UINT32 item_id)
+{
+    Put<UINT8>(REC_NEWITEM);
+    Put(item_id);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetItemTag (
+    UINT32 item_id, const char tag_name[], UINT16 tag_name_len, UINT64 value)
+{
+    Put<UINT8>(REC_SETITEMTAG_VALUE);
+    Put(item_id);
+    PutBytes(tag_name, tag_name_len);
+    Put(value);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetItemTag (
+    UINT32 item_id, const char tag_name[], UINT16 tag_name_len,
+    const char str[], UINT16 str_len)
+{
+    Put<UINT8>(REC_SETITEMTAG_STRING);
+    Put(item_id);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(str, str_len);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetItemTag (
+    UINT32 item_id, const char tag_name[], UINT16 tag_name_len,
+    UINT32 nval, UINT64 value[])
+{
+    Put<UINT8>(REC_SETITEMTAG_SET);
+    Put(item_id);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(value, nval * sizeof(UINT64));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::MoveItems (
+    UINT16 edge_id, UINT32 n, UINT32 item_id[], UINT32 position [])
+{
+    Put<UINT8>(REC_MOVEITEMS);
+    Put(edge_id);
+    PutBytes(item_id, n * sizeof(UINT32));
+    PutBytes(position, position ? n * sizeof(UINT32) : 0);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::EnterNode (
+    UINT16 node_id, UINT32 item_id, UINT16 dimensions, UINT32 position [])
+{
+    Put<UINT8>(REC_ENTERNODE);
+    Put(node_id);
+    Put(item_id);
+    PutBytes(position, dimensions * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::ExitNode (
+    UINT16 node_id, UINT32 item_id, UINT16 dimensions, UINT32 position [])
+{
+    Put<UINT8>(REC_EXITNODE);
+    Put(node_id);
+    Put(item_id);
+    PutBytes(position, dimensions * sizeof(UINT32));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::DeleteItem (UINT32 item_id)
+{
+    Put<UINT8>(REC_DELETEITEM);
+    Put(item_id);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::Comment (
+    UINT32 magic_num, const char comment [], UINT32 length)
+{
+    Put<UINT8>(REC_COMMENT);
+    Put(magic_num);
+    PutBytes(comment, length);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::CommentBin (
+    UINT16 magic_num, const char comment [], UINT32 comment_len)
+{
+    Put<UINT8>(REC_COMMENTBIN);
+    Put(magic_num);
+    PutBytes(comment, comment_len);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetCycleTag (
+    const char tag_name[], UINT16 tag_name_len, UINT64 value)
+{
+    Put<UINT8>(REC_SETCYCLETAG_VALUE);
+    PutBytes(tag_name, tag_name_len);
+    Put(value);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetCycleTag (
+    const char tag_name[], UINT16 tag_name_len, const char str[], UINT16 str_len)
+{
+    Put<UINT8>(REC_SETCYCLETAG_STRING);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(str, str_len);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetCycleTag (
+    const char tag_name[], UINT16 tag_name_len, UINT32 nval, UINT64 value[])
+{
+    Put<UINT8>(REC_SETCYCLETAG_SET);
+    PutBytes(tag_name, tag_name_len);
+    PutBytes(value, nval * sizeof(UINT64));
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeInputBandwidth (UINT16 nodeId, UINT32 bandwidth)
+{
+    Put<UINT8>(REC_SETNODEINPUTBW);
+    Put(nodeId);
+    Put(bandwidth);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeOutputBandwidth (UINT16 nodeId, UINT32 bandwidth)
+{
+    Put<UINT8>(REC_SETNODEOUTPUTBW);
+    Put(nodeId);
+    Put(bandwidth);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::StartActivity (UINT64 firstActivityCycle)
+{
+    Put<UINT8>(REC_STARTACTIVITY);
+    Put(firstActivityCycle);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetTagDescription (
+    const char tag [], UINT16 tag_len, const char description [], UINT16 desc_len)
+{
+    Put<UINT8>(REC_SETTAGDESCRIPTION);
+    PutBytes(tag, tag_len);
+    PutBytes(description, desc_len);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::SetNodeClock (UINT16 nodeId, UINT16 clockId)
+{
+    Put<UINT8>(REC_SETNODECLOCK);
+    Put(nodeId);
+    Put(clockId);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::NewClock (
+    UINT16 clockId, UINT64 freq, UINT16 skew, UINT16 divisions,
+    const char name [], UINT16 nameLen)
+{
+    Put<UINT8>(REC_NEWCLOCK);
+    Put(clockId);
+    Put(freq);
+    Put(skew);
+    Put(divisions);
+    PutBytes(name, nameLen);
+}
+
+void
+DRAL_SERVER_RECORDER_CLASS::Cycle (UINT16 clockId, UINT64 n, UINT16 phase)
+{
+    Put<UINT8>(REC_CYCLE_CLOCK);
+    Put(clockId);
+    Put(n);
+    Put(phase);
+}
+
+/*
+ * The version is written by the real implementation, never recorded
+ */
+void
+DRAL_SERVER_RECORDER_CLASS::Version (void)
+{
+}
+
+
+void
+DRAL_SERVER_RECORDER_CLASS::Replay (DRAL_SERVER_IMPLEMENTATION target) const
+{
+    DRAL_RECORD_READER r(log);
+    vector<UINT32> lst;
+    vector<UINT32> pos;
+    vector<UINT64> set;
+    UINT32 len;
+    UINT32 len2;
+
+    while (!r.Done())
+    {
+        switch (r.Get<UINT8>())
+        {
+          case REC_NEWNODE:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            const char * name = r.GetBytes(len);
+            UINT16 parent_id = r.Get<UINT16>();
+            UINT16 instance = r.Get<UINT16>();
+            target->NewNode(node_id, name, len, parent_id, instance);
+            break;
+          }
+          case REC_NEWEDGE:
+          {
+            UINT16 edge_id = r.Get<UINT16>();
+            UINT16 source = r.Get<UINT16>();
+            UINT16 destination = r.Get<UINT16>();
+            UINT32 bandwidth = r.Get<UINT32>();
+            UINT32 latency = r.Get<UINT32>();
+            const char * name = r.GetBytes(len);
+            target->NewEdge(edge_id, source, destination, bandwidth, latency, name, len);
+            break;
+          }
+          case REC_SETNODELAYOUT:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            UINT32 * capacity = r.GetArray(lst);
+            target->SetNodeLayout(node_id, lst.size(), capacity);
+            break;
+          }
+          case REC_SETNODETAG_VALUE:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            const char * tag = r.GetBytes(len);
+            UINT64 value = r.Get<UINT64>();
+            UINT32 * l = r.GetArray(lst);
+            target->SetNodeTag(node_id, tag, len, value, lst.size(), l);
+            break;
+          }
+          case REC_SETNODETAG_SET:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            const char * tag = r.GetBytes(len);
+            UINT64 * s = r.GetArray(set);
+            UINT32 * l = r.GetArray(lst);
+            target->SetNodeTag(node_id, tag, len, set.size(), s, lst.size(), l);
+            break;
+          }
+          case REC_SETNODETAG_STRING:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            const char * tag = r.GetBytes(len);
+            const char * str = r.GetBytes(len2);
+            UINT32 * l = r.GetArray(lst);
+            target->SetNodeTag(node_id, tag, len, str, len2, lst.size(), l);
+            break;
+          }
+          case REC_CYCLE:
+            target->Cycle(r.Get<UINT64>());
+            break;
+          case REC_NEWITEM:
+            target->NewItem(r.Get<UINT32>());
+            break;
+          case REC_SETITEMTAG_VALUE:
+          {
+            UINT32 item_id = r.Get<UINT32>();
+            const char * tag = r.GetBytes(len);
+            target->SetItemTag(item_id, tag, len, r.Get<UINT64>());
+            break;
+          }
+          case REC_SETITEMTAG_STRING:
+          {
+            UINT32 item_id = r.Get<UINT32>();
+            const char * tag = r.GetBytes(len);
+            const char * str = r.GetBytes(len2);
+            target->SetItemTag(item_id, tag, len, str, len2);
+            break;
+          }
+          case REC_SETITEMTAG_SET:
+          {
+            UINT32 item_id = r.Get<UINT32>();
+            const char * tag = r.GetBytes(len);
+            UINT64 * s = r.GetArray(set);
+            target->SetItemTag(item_id, tag, len, set.size(), s);
+            break;
+          }
+          case REC_MOVEITEMS:
+          {
+            UINT16 edge_id = r.Get<UINT16>();
+            UINT32 * items = r.GetArray(lst);
+            UINT32 * p = r.GetArray(pos);
+            target->MoveItems(edge_id, lst.size(), items, p);
+            break;
+          }
+          case REC_ENTERNODE:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            UINT32 item_id = r.Get<UINT32>();
+            UINT32 * p = r.GetArray(pos);
+            target->EnterNode(node_id, item_id, pos.size(), p);
+            break;
+          }
+          case REC_EXITNODE:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            UINT32 item_id = r.Get<UINT32>();
+            UINT32 * p = r.GetArray(pos);
+            target->ExitNode(node_id, item_id, pos.size(), p);
+            break;
+          }
+          case REC_DELETEITEM:
+            target->DeleteItem(r.Get<UINT32>());
+            break;
+          case REC_COMMENT:
+          {
+            UINT32 magic = r.Get<UINT32>();
+            const char * comment = r.GetBytes(len);
+            target->Comment(magic, comment, len);
+            break;
+          }
+          case REC_COMMENTBIN:
+          {
+            UINT16 magic = r.Get<UINT16>();
+            const char * comment = r.GetBytes(len);
+            target->CommentBin(magic, comment, len);
+            break;
+          }
+          case REC_SETCYCLETAG_VALUE:
+          {
+            const char * tag = r.GetBytes(len);
+            target->SetCycleTag(tag, len, r.Get<UINT64>());
+            break;
+          }
+          case REC_SETCYCLETAG_STRING:
+          {
+            const char * tag = r.GetBytes(len);
+            const char * str = r.GetBytes(len2);
+            target->SetCycleTag(tag, len, str, len2);
+            break;
+          }
+          case REC_SETCYCLETAG_SET:
+          {
+            const char * tag = r.GetBytes(len);
+            UINT64 * s = r.GetArray(set);
+            target->SetCycleTag(tag, len, set.size(), s);
+            break;
+          }
+          case REC_SETNODEINPUTBW:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            target->SetNodeInputBandwidth(node_id, r.Get<UINT32>());
+            break;
+          }
+          case REC_SETNODEOUTPUTBW:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            target->SetNodeOutputBandwidth(node_id, r.Get<UINT32>());
+            break;
+          }
+          case REC_STARTACTIVITY:
+            target->StartActivity(r.Get<UINT64>());
+            break;
+          case REC_SETTAGDESCRIPTION:
+          {
+            const char * tag = r.GetBytes(len);
+            const char * desc = r.GetBytes(len2);
+            target->SetTagDescription(tag, len, desc, len2);
+            break;
+          }
+          case REC_SETNODECLOCK:
+          {
+            UINT16 node_id = r.Get<UINT16>();
+            target->SetNodeClock(node_id, r.Get<UINT16>());
+            break;
+          }
+          case REC_NEWCLOCK:
+          {
+            UINT16 clock_id = r.Get<UINT16>();
+            UINT64 freq = r.Get<UINT64>();
+            UINT16 skew = r.Get<UINT16>();
+            UINT16 divisions = r.Get<UINT16>();
+            const char * name = r.GetBytes(len);
+            target->NewClock(clock_id, freq, skew, divisions, name, len);
+            break;
+          }
+          case REC_CYCLE_CLOCK:
+          {
+            UINT16 clock_id = r.Get<UINT16>();
+            UINT64 n = r.Get<UINT64>();
+            target->Cycle(clock_id, n, r.Get<UINT16>());
+            break;
+          }
+          default:
+            DRAL_ASSERT(false, "Corrupt DRAL event recording");
+        }
+    }
+}
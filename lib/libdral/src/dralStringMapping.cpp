@@ -35,112 +35,258 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <assert.h>
 
 #include "asim/dralStringMapping.h"
 
+#define NO_ENTRY 0xFFFFFFFF
+
 DRAL_STRING_MAPPING_CLASS::DRAL_STRING_MAPPING_CLASS(UINT32 size)
 {
     assert(size > 0);
     max_strs = size;
+    buckets.resize(16, 0);
+    mask = buckets.size() - 1;
+    lru_head = NO_ENTRY;
+    lru_tail = NO_ENTRY;
     commands = 0;
     conflicts = 0;
 }
 
 DRAL_STRING_MAPPING_CLASS::~DRAL_STRING_MAPPING_CLASS()
 {
+    for(UINT32 i = 0; i < entries.size(); i++)
+    {
+        free(entries[i].str);
+    }
 }
 
-bool
-DRAL_STRING_MAPPING_CLASS::getMapping(const char * str, UINT16 strlen, UINT32 * index)
+/*
+ * FNV-1a.
+ */
+UINT32
+DRAL_STRING_MAPPING_CLASS::hashString(const char * str, UINT32 len)
 {
-    StringMappingIterator it_map;
-
-    // Internal statistic update.
-    commands++;
-
-    // Tries to find the string in the mapping.
-    it_map = mapping.find(str);
-
-    if(it_map == mapping.end())
+    UINT32 hash = 2166136261U;
+    for(UINT32 i = 0; i < len; i++)
     {
-        UINT32 new_index;         ///< Index that will be used.
-        StringMappingEntry entry; ///< New entry of the mapping.
+        hash = (hash ^ (UINT8) str[i]) * 16777619U;
+    }
+    return hash;
+}
 
-        // If not found, checks if we've space in the mapping.
-        if(mapping.size() == max_strs)
+UINT32
+DRAL_STRING_MAPPING_CLASS::findBucket(const char * str, UINT32 len, UINT32 hash) const
+{
+    UINT32 b = hash & mask;
+    while(buckets[b] != 0)
+    {
+        const StringMappingEntry & entry = entries[buckets[b] - 1];
+        if((entry.hash == hash) && (entry.len == len) && (memcmp(entry.str, str, len) == 0))
         {
-            LRUListIterator it_lru;
-            StringMappingIterator it_map2;
-
-            // Internal statistic update.
-            conflicts++;
+            break;
+        }
+        b = (b + 1) & mask;
+    }
+    return b;
+}
 
-            // Gets the entry to remove.
-            it_lru = lru.begin();
-            it_map2 = mapping.find(* it_lru);
+void
+DRAL_STRING_MAPPING_CLASS::insertBucket(UINT32 entry)
+{
+    UINT32 b = entries[entry].hash & mask;
+    while(buckets[b] != 0)
+    {
+        b = (b + 1) & mask;
+    }
+    buckets[b] = entry + 1;
+}
 
-            // Recycles the index.
-            new_index = it_map2->second.index;
+/*
+ * Removes an entry from the table, shifting back the entries that
+ * follow it in its probe sequence so that no tombstones are needed.
+ */
+void
+DRAL_STRING_MAPPING_CLASS::removeBucket(UINT32 entry)
+{
+    UINT32 i = entries[entry].hash & mask;
+    while(buckets[i] != entry + 1)
+    {
+        i = (i + 1) & mask;
+    }
 
-            // Removes it from the mapping.
-            mapping.erase(it_map2);
-            lru.pop_front();
+    UINT32 j = i;
+    while(true)
+    {
+        j = (j + 1) & mask;
+        if(buckets[j] == 0)
+        {
+            break;
         }
-        else
+        UINT32 k = entries[buckets[j] - 1].hash & mask;
+        bool stays = (i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j));
+        if(!stays)
         {
-            // The index set is equal to the size of the mapping.
-            new_index = mapping.size();
+            buckets[i] = buckets[j];
+            i = j;
         }
+    }
+    buckets[i] = 0;
+}
 
-        // Adds the new entry in the lru and the mapping.
-        lru.push_back(str);
-        entry.index = new_index;
-        entry.it = --lru.end();
+/*
+ * Doubles the number of buckets and rehashes all the entries.
+ */
+void
+DRAL_STRING_MAPPING_CLASS::grow()
+{
+    buckets.assign(buckets.size() * 2, 0);
+    mask = buckets.size() - 1;
+    for(UINT32 i = 0; i < entries.size(); i++)
+    {
+        insertBucket(i);
+    }
+}
 
-        mapping[str] = entry;
-        * index = new_index;
+void
+DRAL_STRING_MAPPING_CLASS::lruUnlink(UINT32 entry)
+{
+    StringMappingEntry & e = entries[entry];
+    if(e.prev == NO_ENTRY)
+    {
+        lru_head = e.next;
+    }
+    else
+    {
+        entries[e.prev].next = e.next;
+    }
+    if(e.next == NO_ENTRY)
+    {
+        lru_tail = e.prev;
+    }
+    else
+    {
+        entries[e.next].prev = e.prev;
+    }
+}
 
-        return true;
+void
+DRAL_STRING_MAPPING_CLASS::lruAppend(UINT32 entry)
+{
+    StringMappingEntry & e = entries[entry];
+    e.prev = lru_tail;
+    e.next = NO_ENTRY;
+    if(lru_tail == NO_ENTRY)
+    {
+        lru_head = entry;
     }
     else
+    {
+        entries[lru_tail].next = entry;
+    }
+    lru_tail = entry;
+}
+
+bool
+DRAL_STRING_MAPPING_CLASS::getMapping(const char * str, UINT16 strlen, UINT32 * index)
+{
+    // Internal statistic update.
+    commands++;
+
+    // The key ends at the first 0 within the strlen bytes, if any.
+    const char * end = (const char *) memchr(str, '\0', strlen);
+    UINT32 len = (end != NULL) ? (UINT32) (end - str) : strlen;
+
+    // Tries to find the string in the mapping.
+    UINT32 hash = hashString(str, len);
+    UINT32 b = findBucket(str, len, hash);
+
+    if(buckets[b] != 0)
     {
         // If found, just sets the index and returns that no new callback is needed and also
         // updates the lru state.
-        lru.erase(it_map->second.it);
-        lru.push_back(it_map->first);
-        it_map->second.it = --lru.end();
-        * index = it_map->second.index;
+        UINT32 entry = buckets[b] - 1;
+        if(entry != lru_tail)
+        {
+            lruUnlink(entry);
+            lruAppend(entry);
+        }
+        * index = entry;
         return false;
     }
-}
 
-void
-DRAL_STRING_MAPPING_CLASS::dump()
-{
-    StringMappingIterator it;
-    const char ** temp;
+    UINT32 new_index; ///< Index that will be used.
 
-    temp = (const char **) malloc(max_strs * sizeof(const char *));
+    // If not found, checks if we've space in the mapping.
+    if(entries.size() == max_strs)
+    {
+        // Internal statistic update.
+        conflicts++;
 
-    cout << "Dumping string map:" << endl;
+        // Recycles the index of the least recently used entry.
+        new_index = lru_head;
+        lruUnlink(new_index);
+        removeBucket(new_index);
+    }
+    else
+    {
+        // The index set is equal to the size of the mapping.
+        new_index = entries.size();
+        StringMappingEntry entry;
+        entry.str = NULL;
+        entry.cap = 0;
+        entries.push_back(entry);
+    }
+
+    // Stores the string and adds the entry to the table and the lru.
+    StringMappingEntry & entry = entries[new_index];
+    if(entry.cap < len)
+    {
+        free(entry.str);
+        entry.cap = (len < 32) ? 32 : len;
+        entry.str = (char *) malloc(entry.cap);
+    }
+    memcpy(entry.str, str, len);
+    entry.len = len;
+    entry.hash = hash;
 
-    for(UINT32 i = 0; i < max_strs; i++)
+    if(entries.size() * 2 > buckets.size())
+    {
+        grow();
+    }
+    else
     {
-        temp[i] = NULL;
+        insertBucket(new_index);
     }
+    lruAppend(new_index);
+
+    * index = new_index;
+    return true;
+}
 
-    for(it = mapping.begin(); it != mapping.end(); it++)
+void
+DRAL_STRING_MAPPING_CLASS::reset()
+{
+    for(UINT32 i = 0; i < entries.size(); i++)
     {
-        temp[it->second.index] = it->first.c_str();
+        free(entries[i].str);
     }
+    entries.clear();
+    buckets.assign(buckets.size(), 0);
+    lru_head = NO_ENTRY;
+    lru_tail = NO_ENTRY;
+}
 
-    for(UINT32 i = 0; i < max_strs; i++)
+void
+DRAL_STRING_MAPPING_CLASS::dump()
+{
+    cout << "Dumping string map:" << endl;
+
+    for(UINT32 i = 0; i < entries.size(); i++)
     {
-        cout << "\tEntry " << i << " is: " << temp[i] << endl;
+        cout << "\tEntry " << i << " is: " << string(entries[i].str, entries[i].len) << endl;
     }
     cout << endl;
-
-    free(temp);
 }
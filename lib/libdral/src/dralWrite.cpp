@@ -64,17 +64,20 @@ DRAL_BUFFERED_WRITE_CLASS::DRAL_BUFFERED_WRITE_CLASS (
     memset((void *)zeros,0,8);
     file = NULL;
     uncompressed_file = NULL;
+    fd = -1;
+    bytes_written = 0;
     compress = compression;
+    trailer = false;
 }
 
 DRAL_BUFFERED_WRITE_CLASS::~DRAL_BUFFERED_WRITE_CLASS ()
 {
-    if (compress && (file != NULL))
+    if (file != NULL)
     {
         gzclose(file);
     }
 
-    if (!compress && (uncompressed_file != NULL))
+    if (uncompressed_file != NULL)
     {
         fclose(uncompressed_file);
     }
@@ -85,23 +88,29 @@ DRAL_BUFFERED_WRITE_CLASS::~DRAL_BUFFERED_WRITE_CLASS ()
     }
 }
 
-void DRAL_BUFFERED_WRITE_CLASS::SetFileDescriptor (int fd)
+void DRAL_BUFFERED_WRITE_CLASS::SetFileDescriptor (int new_fd)
 {
+    if (file != NULL)
+    {
+        gzclose(file);
+        file = NULL;
+    }
+    if (uncompressed_file != NULL)
+    {
+        fclose(uncompressed_file);
+        uncompressed_file = NULL;
+    }
+    fd = new_fd;
+    bytes_written = 0;
+    trailer = false;
+
     if (compress)
     {
-        if (file != NULL)
-        {
-            gzclose(file);
-        }
         file = gzdopen(dup(fd),"wb");
         DRAL_ASSERT(file!=NULL, "Error opening the file descriptor");
     }
     else
     {
-        if (uncompressed_file != NULL)
-        {
-            fclose(uncompressed_file);
-        }
         uncompressed_file = fdopen(dup(fd),"wb");
         DRAL_ASSERT(uncompressed_file!=NULL,
             "Error opening the file descriptor");
@@ -115,6 +124,7 @@ void DRAL_BUFFERED_WRITE_CLASS::Write (const void * buf, UINT32 n)
         /* Zlib produce errors if one tries to write 0 bytes */
         return;
     }
+    bytes_written+=n;
     if (buffered)
     {
         if (available >= n)
@@ -147,7 +157,7 @@ void DRAL_BUFFERED_WRITE_CLASS::Write (const void * buf, UINT32 n)
 void DRAL_BUFFERED_WRITE_CLASS::WriteFD (const void * buf, UINT32 n)
 {
     INT32 k;
-    if (compress)
+    if (compress && !trailer)
     {
         DRAL_ASSERT(file!=NULL,"The file descriptor has not been set");
         k=gzwrite(file,(void *)buf,n);
@@ -175,3 +185,51 @@ void DRAL_BUFFERED_WRITE_CLASS::Flush (void)
         pos=0;
     }
 }
+
+INT64 DRAL_BUFFERED_WRITE_CLASS::StartBlock (void)
+{
+    Flush();
+    if (compress && !trailer)
+    {
+        DRAL_ASSERT(file!=NULL,"The file descriptor has not been set");
+
+        // A new gzip member: zlib reads the concatenation as one stream
+        gzclose(file);
+        file = gzdopen(dup(fd),"wb");
+        DRAL_ASSERT(file!=NULL, "Error opening the file descriptor");
+    }
+    else
+    {
+        DRAL_ASSERT(
+            uncompressed_file!=NULL,"The file descriptor has not been set");
+        fflush(uncompressed_file);
+    }
+    return lseek(fd,0,SEEK_CUR);
+}
+
+INT64 DRAL_BUFFERED_WRITE_CLASS::StartTrailer (void)
+{
+    Flush();
+    if (compress && !trailer)
+    {
+        DRAL_ASSERT(file!=NULL,"The file descriptor has not been set");
+        gzclose(file);
+        file = NULL;
+        uncompressed_file = fdopen(dup(fd),"wb");
+        DRAL_ASSERT(uncompressed_file!=NULL,
+            "Error opening the file descriptor");
+        trailer = true;
+    }
+    else
+    {
+        DRAL_ASSERT(
+            uncompressed_file!=NULL,"The file descriptor has not been set");
+        fflush(uncompressed_file);
+    }
+    return lseek(fd,0,SEEK_CUR);
+}
+
+UINT64 DRAL_BUFFERED_WRITE_CLASS::GetNumBytesWritten (void)
+{
+    return bytes_written;
+}
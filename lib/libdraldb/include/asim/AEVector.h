@@ -69,6 +69,21 @@ template<class T> class AEVectorNode
             index = idx;
             array = new T[sz];
             Q_ASSERT(array!=NULL);
+            owned = true;
+        }
+
+        /**
+         * Creator of this class. Uses the sz objects of data, that
+         * are not freed by the node.
+         *
+         * @return new object.
+         */
+        AEVectorNode(int sz, int idx, T* data)
+        {
+            size = sz;
+            index = idx;
+            array = data;
+            owned = false;
         }
 
         /**
@@ -78,13 +93,17 @@ template<class T> class AEVectorNode
          */
        ~AEVectorNode()
         {
-            delete [] array;
+            if (owned)
+            {
+                delete [] array;
+            }
         }
 
     public:
         int size; // Size of the node (in objects).
         int index; // Index of the node.
         T*  array; // Array sotring all the objects.
+        bool owned; // The array was allocated by the node.
 };
 
 template<class T, int SEGMENTSIZE, int MAXSEGMENTS> class AEVector
@@ -288,6 +307,69 @@ template<class T, int SEGMENTSIZE, int MAXSEGMENTS> class AEVector
             reset();
         }
 
+        /**
+         * Uses data as the segment number segment instead of
+         * allocating it. data must hold getSegmentSize() objects and
+         * must be valid until the segment is released, it is never
+         * freed by the vector.
+         *
+         * @return void.
+         */
+        inline void mapSegment(int segment, T* data)
+        {
+            Q_ASSERT(segment<MAXSEGMENTS);
+            if (segvector[segment]!=NULL)
+            {
+                delete segvector[segment];
+                --numSegments;
+            }
+            segvector[segment] = new AEVectorNode<T>(m2SegmentSize,segment,data);
+            Q_ASSERT(segvector[segment] != NULL);
+            ++numSegments;
+        }
+
+        /**
+         * Releases all the segments set with mapSegment. Their
+         * positions are allocated again if they are accessed.
+         *
+         * @return void.
+         */
+        inline void releaseMappedSegments()
+        {
+            for (int i=0;i<MAXSEGMENTS;i++)
+            {
+                if ((segvector[i]!=NULL) && !segvector[i]->owned)
+                {
+                    delete segvector[i];
+                    segvector[i]=NULL;
+                    --numSegments;
+                }
+            }
+        }
+
+        /**
+         * Returns the objects of the segment number segment.
+         *
+         * @return the segment or NULL if it is not allocated.
+         */
+        inline T* getSegment(int segment) const
+        {
+            Q_ASSERT(segment<MAXSEGMENTS);
+            return (segvector[segment]==NULL) ? NULL : segvector[segment]->array;
+        }
+
+        /**
+         * Returns if the segment number segment was allocated by
+         * the vector, not set with mapSegment.
+         *
+         * @return true if the segment is allocated and owned.
+         */
+        inline bool isOwnedSegment(int segment) const
+        {
+            Q_ASSERT(segment<MAXSEGMENTS);
+            return (segvector[segment]!=NULL) && segvector[segment]->owned;
+        }
+
         /**
          * Resets the index fields of the class.
          *
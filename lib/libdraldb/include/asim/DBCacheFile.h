@@ -0,0 +1,202 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DRALDB_DBCACHEFILE_H
+#define _DRALDB_DBCACHEFILE_H
+
+#include <stdio.h>
+#include <qstring.h>
+
+#include "asim/draldb_syntax.h"
+
+/** @def Format version of the cache files. Bump it when any saved structure changes. */
+#define DBCACHE_FORMAT_VERSION 2
+
+/** @def Alignment of the blocks inside the cache file. */
+#define DBCACHE_ALIGN 8
+
+/**
+  * @brief
+  * File holding a fully built database that can be mapped in memory.
+  *
+  * @description
+  * The file is a sequence of blocks aligned to DBCACHE_ALIGN bytes.
+  * The writer appends blocks to a temporary file that is renamed
+  * when everything was written, so a partial cache is never seen.
+  * The reader maps the whole file with a private mapping and walks
+  * it with a cursor. mapBlock returns pointers inside the mapping,
+  * so the big vectors of the database can use the file pages
+  * directly: they are shared between all the processes that map
+  * the same cache and are only copied if written. The pointers are
+  * valid until close is called. Any out of bounds access turns the
+  * file into an error state, that is checked with ok.
+  *
+  * The same format is used for the spill file of the pager. A spill
+  * file is created with createSpill, is unlinked as soon as it is
+  * created and can be read while it is being written: seek loads a
+  * range of the file in a buffer and places the cursor there, and
+  * mapRange maps a page aligned range written before.
+  *
+  * @version 0.1
+  */
+class DBCacheFile
+{
+    public:
+        DBCacheFile();
+        ~DBCacheFile();
+
+        bool create(QString filename);
+        bool commit();
+        bool open(QString filename);
+        bool createSpill(QString dirname);
+        void close();
+
+        inline bool ok() const;
+        inline bool isMapped() const;
+        inline INT64 getSize() const;
+
+        // ---- Writing methods
+        void writeBlock(const void * data, INT64 size);
+        inline void writeINT32(INT32 value);
+        inline void writeUINT64(UINT64 value);
+        void writeString(QString str);
+        void padTo(INT64 boundary);
+
+        // ---- Reading methods
+        const void * mapBlock(INT64 size);
+        bool readBlock(void * data, INT64 size);
+        inline INT32 readINT32();
+        inline UINT64 readUINT64();
+        QString readString();
+
+        // ---- Spill file methods
+        bool seek(INT64 offset, INT64 length);
+        void * mapRange(INT64 offset, INT64 length);
+        static void unmapRange(void * addr, INT64 length);
+
+    private:
+        QString fileName; // Final name of the file being written.
+        QString tmpName;  // Temporary name of the file being written.
+        FILE * out;       // Stream used when writing.
+        char * base;      // Start of the mapping when reading.
+        INT64 size;       // Size of the file.
+        INT64 pos;        // Cursor inside the file.
+        INT64 limit;      // End of the readable bytes after base.
+        bool error;       // An operation failed.
+        int spillFd;      // Descriptor of the spill file, -1 if not a spill file.
+        char * buffer;    // Buffer filled by seek.
+        INT64 bufferSize; // Allocated bytes of buffer.
+};
+
+/**
+ * Returns if all the operations done since the file was opened or
+ * created were successful.
+ *
+ * @return true if no error happened.
+ */
+bool
+DBCacheFile::ok() const
+{
+    return !error;
+}
+
+/**
+ * Returns if the file is mapped for reading.
+ *
+ * @return true if mapped.
+ */
+bool
+DBCacheFile::isMapped() const
+{
+    return (base != NULL) && (spillFd < 0);
+}
+
+/**
+ * Returns the size of the file (the bytes written so far when
+ * the file is being created).
+ *
+ * @return the size.
+ */
+INT64
+DBCacheFile::getSize() const
+{
+    return size;
+}
+
+/**
+ * Appends an integer to the file.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::writeINT32(INT32 value)
+{
+    writeBlock(&value, sizeof(value));
+}
+
+/**
+ * Appends a 64 bit integer to the file.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::writeUINT64(UINT64 value)
+{
+    writeBlock(&value, sizeof(value));
+}
+
+/**
+ * Reads an integer. Returns zero if the end of file is reached.
+ *
+ * @return the integer.
+ */
+INT32
+DBCacheFile::readINT32()
+{
+    INT32 value = 0;
+    readBlock(&value, sizeof(value));
+    return value;
+}
+
+/**
+ * Reads a 64 bit integer. Returns zero if the end of file is
+ * reached.
+ *
+ * @return the integer.
+ */
+UINT64
+DBCacheFile::readUINT64()
+{
+    UINT64 value = 0;
+    readBlock(&value, sizeof(value));
+    return value;
+}
+
+#endif
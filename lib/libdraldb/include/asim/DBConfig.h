@@ -35,6 +35,8 @@
 
 #include <stdio.h>
 
+#include <qstring.h>
+
 #ifndef NULL
 #define NULL 0
 #endif
@@ -64,8 +66,13 @@ class DBConfig
         inline bool getTagBackPropagate() ;
         inline bool getGUIEnabled() ;
         inline bool getCompressMutable() ;
+        inline bool getTagValueIndex() ;
+        inline bool getUseCache() ;
         inline INT32  getItemMaxAge() ;
         inline INT32  getMaxIFI() ;
+        inline UINT32 getDecodeThreads() ;
+        inline UINT32 getPagingBudget() ;
+        inline QString getSpillDir() ;
 
         inline void setAutoPurge(bool value) ;
         inline void setIncrementalPurge(bool value) ;
@@ -73,8 +80,13 @@ class DBConfig
         inline void setTagBackPropagate(bool value) ;
         inline void setGUIEnabled(bool value) ;
         inline void setCompressMutable(bool value) ;
+        inline void setTagValueIndex(bool value) ;
+        inline void setUseCache(bool value) ;
         inline void setItemMaxAge(INT32  value) ;
         inline void setMaxIFI(INT32  value) ;
+        inline void setDecodeThreads(UINT32 value) ;
+        inline void setPagingBudget(UINT32 value) ;
+        inline void setSpillDir(QString value) ;
 
 		void reset();
 		
@@ -89,8 +101,13 @@ class DBConfig
         bool maxIFIEnabled;
         bool tagBackPropagate; // Propagate tag values back.
         bool compressMutable; // Compress mutable tags in the ItemTagHeap struct.
+        bool tagValueIndex; // Build the tag-value index used by the item searches.
+        bool useCache; // Load and save the processed traces from cache files.
         INT32  itemMaxAge; // Maximum cycles an item can be alive.
         INT32  maxIFI;
+        UINT32 decodeThreads; // Threads that decompress the trace ahead of the client.
+        UINT32 pagingBudget; // Megabytes of closed track chunks kept in memory, 0 disables the paging.
+        QString spillDir; // Directory of the spill file, the temporary directory if empty.
 
     private:
        static DBConfig* _myInstance; // Instance of the class.
@@ -162,6 +179,61 @@ DBConfig::getCompressMutable()
     return compressMutable;
 }
 
+/**
+ * Returns the tagValueIndex value.
+ *
+ * @return tagValueIndex.
+ */
+bool
+DBConfig::getTagValueIndex()
+{
+    return tagValueIndex;
+}
+
+/**
+ * Returns the useCache value.
+ *
+ * @return useCache.
+ */
+bool
+DBConfig::getUseCache()
+{
+    return useCache;
+}
+
+/**
+ * Returns the decodeThreads value.
+ *
+ * @return decodeThreads.
+ */
+UINT32
+DBConfig::getDecodeThreads()
+{
+    return decodeThreads;
+}
+
+/**
+ * Returns the pagingBudget value.
+ *
+ * @return pagingBudget.
+ */
+UINT32
+DBConfig::getPagingBudget()
+{
+    return pagingBudget;
+}
+
+/**
+ * Returns the spillDir value.
+ *
+ * @return spillDir.
+ */
+QString
+DBConfig::getSpillDir()
+{
+    return spillDir;
+}
+
 /**
  * Returns the itemMaxAge value.
  *
@@ -250,6 +322,28 @@ DBConfig::setCompressMutable(bool value)
     compressMutable = value;
 }
 
+/**
+ * Sets the tagValueIndex value.
+ *
+ * @return void.
+ */
+void
+DBConfig::setTagValueIndex(bool value)
+{
+    tagValueIndex = value;
+}
+
+/**
+ * Sets the useCache value.
+ *
+ * @return void.
+ */
+void
+DBConfig::setUseCache(bool value)
+{
+    useCache = value;
+}
+
 /**
  * Sets the itemMaxAge value.
  *
@@ -272,4 +366,37 @@ DBConfig::setMaxIFI(INT32  value)
     maxIFI = value;
 }
 
+/**
+ * Sets the decodeThreads value.
+ *
+ * @return void.
+ */
+void
+DBConfig::setDecodeThreads(UINT32 value)
+{
+    decodeThreads = value;
+}
+
+/**
+ * Sets the pagingBudget value.
+ *
+ * @return void.
+ */
+void
+DBConfig::setPagingBudget(UINT32 value)
+{
+    pagingBudget = value;
+}
+
+/**
+ * Sets the spillDir value.
+ *
+ * @return void.
+ */
+void
+DBConfig::setSpillDir(QString value)
+{
+    spillDir = value;
+}
+
 #endif
@@ -41,6 +41,7 @@
 
 // Dreams Library (client)
 #include <asim/dralListenerOld.h>
+#include <asim/dralBatchListener.h>
 
 #include "asim/draldb_syntax.h"
 #include "asim/DRALTag.h"
@@ -50,6 +51,7 @@
 #include "asim/DBConfig.h"
 #include "asim/TagDescVector.h"
 #include "asim/ItemTagHeap.h"
+#include "asim/TagValueIndex.h"
 #include "asim/DBGraph.h"
 #include "asim/StrTable.h"
 #include "asim/DBListenerDef.h"
@@ -68,7 +70,7 @@ extern const bool db_listener_debug_on;
   * @date started at 2002-07-15
   * @version 0.1
   */
-class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLASS
+class DBListener : public AMemObj, public StatObj, public DRAL_BATCH_LISTENER_OLD_CLASS
 {
     public:
         static DBListener* getInstance ();
@@ -276,6 +278,12 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
         void SetNodeOutputBandwidth(UINT16, UINT32);
         void SetTagDescription(const char [], const char []);
 
+        /**
+          * Adds the new items and the single value tags of the block
+          * in their trace order.
+          */
+        void ItemBatch(const DRAL_ITEM_BATCH & batch, const char * const tag_names []);
+
         void SetNodeClock(UINT16, UINT16) {}
         void NewClock(UINT16, UINT64, UINT16, const char []) {}
         void NewClock(UINT16, UINT64, UINT16, UINT16, const char []) {}
@@ -301,6 +309,13 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
         inline bool getLastProcessedEventOk();
 
         inline INT32 getFirstEffectiveCycle();
+        inline INT32 getCurrentCycle();
+
+        /**
+          * Starts the activity at the sync point the trace has jumped to.
+          */
+        void seekCycle(INT32 cycle);
+
         /**
           * Convenience function ...
           */
@@ -314,9 +329,16 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
 
         // Conf Methods
         void  trackItemTags(bool value);
+        inline bool getTrackItemTags();
 
         // exern listeners
         void attachDralListener(DRAL_LISTENER_OLD object);
+        inline bool hasExternListeners();
+        inline INT32 getNumLiveItems();
+
+        // cache files
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
 
         void setTrackedEdges (INT32 value);
         void addTrackedEdges (UINT16 edgeid);
@@ -334,12 +356,27 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
         /**
           * Function description
           */
-        inline void tagDiscriminatorAdder(INT32 itemid, LSetTagListNode* node);
+        inline void tagDiscriminatorAdder(INT32 itemid, INT32 itemEntry, LSetTagListNode* node);
+
+        /**
+          * Adds to the tag heap the single values kept in the tag block.
+          */
+        inline void flushTagBlock(INT32 itemid);
+
+        /**
+          * Keeps a single value tag of a live item.
+          */
+        inline void addTagSingleValue(LNewItemListNode* newItemNode, INT32 tagid, UINT64 value);
+
+        /**
+          * Logs a tag set on an unknown item.
+          */
+        void tagOnUnknownItem(UINT32 item_id);
 
         /**
           * Function description
           */
-        bool mutableTagDiscriminatorAdder(INT32 itemid, NewTagList* list, LSetTagListNode* node);
+        bool mutableTagDiscriminatorAdder(INT32 itemid, INT32 itemEntry, NewTagList* list, LSetTagListNode* node);
 
         /**
           * Function description
@@ -379,6 +416,7 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
         TagDescVector*  tgdescvec;
         StrTable*       strtbl;
         ItemTagHeap*    itHeap;
+        TagValueIndex*  tvIndex;
         TrackHeap*      trHeap;
         DBConfig*       conf;
         DBGraph*        dbGraph;
@@ -396,6 +434,14 @@ class DBListener : public AMemObj, public StatObj, public DRAL_LISTENER_OLD_CLAS
         INT32  edgeTrackIdVector[65536];
         INT32  _itemidxinid;
 
+        // tag ids of the trace tag indexes of the item blocks
+        FValueVector<INT32> tagIdxToTagId;
+
+        // single value tags added to the tag heap at once
+        FValueVector<UINT16> tagBlockIds;
+        FValueVector<UINT64> tagBlockValues;
+        FValueVector<UINT32> tagBlockCycles;
+
     private:
        static DBListener*  _myInstance;
        static UINT64       _itemCnt;
@@ -437,6 +483,18 @@ bool
 DBListener::getLastProcessedEventOk()
 { return lastProcessedEventOk; }
 
+bool
+DBListener::getTrackItemTags()
+{ return doTrackItemTags; }
+
+bool
+DBListener::hasExternListeners()
+{ return !externClients->isEmpty(); }
+
+INT32
+DBListener::getNumLiveItems()
+{ return itemList->count(); }
+
 bool
 DBListener::trackWarningDumped(INT32 track_id)
 {
@@ -467,7 +525,7 @@ DBListener::addItemWarned(UINT32 itemid)
 }
 
 void
-DBListener::tagDiscriminatorAdder(INT32 itemid, LSetTagListNode* node)
+DBListener::tagDiscriminatorAdder(INT32 itemid, INT32 itemEntry, LSetTagListNode* node)
 {
     if (db_listener_debug_on)
     {
@@ -482,6 +540,10 @@ DBListener::tagDiscriminatorAdder(INT32 itemid, LSetTagListNode* node)
         INT32 stridx = strtbl->addString(node->str);
         if (db_listener_debug_on) {printf("\t\t (string): %s; Index=%d\n",node->str.toLatin1().constData(),stridx);fflush(stdout);}
         itHeap->newTag(itemid, node->tagid, (UINT64) stridx, node->cycle);
+        if (conf->getTagValueIndex())
+        {
+            tvIndex->addValue(node->tagid, (UINT64) stridx, itemEntry);
+        }
     }
     // Set of values
     else if (node->isSOV)
@@ -493,10 +555,43 @@ DBListener::tagDiscriminatorAdder(INT32 itemid, LSetTagListNode* node)
     else
     {
         itHeap->newTag(itemid, node->tagid, node->data.value, node->cycle);
+        if (conf->getTagValueIndex())
+        {
+            tvIndex->addValue(node->tagid, node->data.value, itemEntry);
+        }
         if (db_listener_debug_on) {printf("\t\t (svalue) %d; Index=%d\n",(int)(node->data.value),retidx);fflush(stdout);}
     }
 }
 
+void
+DBListener::flushTagBlock(INT32 itemid)
+{
+    if (tagBlockIds.size() > 0)
+    {
+        itHeap->newTags(itemid, tagBlockIds.size(), tagBlockIds.begin(),
+                        tagBlockValues.begin(), tagBlockCycles.begin());
+        tagBlockIds.reset();
+        tagBlockValues.reset();
+        tagBlockCycles.reset();
+    }
+}
+
+void
+DBListener::addTagSingleValue(LNewItemListNode* newItemNode, INT32 tagid, UINT64 value)
+{
+    LSetTagListNode* node = new LSetTagListNode(currentCycle, tagid, value);
+    LSetTagListNode* matchingNode=NULL;
+    Q_ASSERT(node!=NULL);
+    bool mutant = hasTag(newItemNode->getMyTags(),tagid,currentCycle,&matchingNode);
+    newItemNode->getMyTags()->append(node);
+    if (mutant)
+    {
+        Q_ASSERT(matchingNode!=NULL);
+        matchingNode->isMutable=1;
+        node->isMutable=1;
+    }
+}
+
 bool
 DBListener::reachedEOS()
 { return eoSimulation; }
@@ -562,5 +657,9 @@ INT32
 DBListener::getFirstEffectiveCycle()
 { return firstEffectiveCycle;}
 
+INT32
+DBListener::getCurrentCycle()
+{ return currentCycle;}
+
 #endif
 
@@ -0,0 +1,248 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DRALDB_DBPAGER_H
+#define _DRALDB_DBPAGER_H
+
+#include <qstring.h>
+
+#include "asim/draldb_syntax.h"
+#include "asim/AMemObj.h"
+#include "asim/StatObj.h"
+#include "asim/DBCacheFile.h"
+#include "asim/fvaluevector.h"
+
+/** @def Smallest tag vector that is worth paging out. */
+#define DBPAGER_MIN_CHUNK_SIZE 256
+
+class TagVec;
+class TagIdVecNode;
+class DBConfig;
+class LogMgr;
+
+/**
+  * @brief
+  * Entry of the pager for a closed cycle chunk.
+  *
+  * @description
+  * Links a tag vector with the tag id vector and the chunk that
+  * hold it. offset and length locate the copy of the vector in the
+  * spill file, offset is -1 when the copy is missing or outdated.
+  */
+class DBPage
+{
+    public:
+        TagIdVecNode * owner; // Node that holds the vector.
+        INT32 chunk;          // Cycle chunk of the vector.
+        TagVec * vec;         // The vector.
+        INT64 size;           // Bytes used by the vector.
+        INT64 offset;         // Position of the copy in the spill file.
+        INT64 length;         // Length of the copy in the spill file.
+        DBPage * prev;        // More recently used page.
+        DBPage * next;        // Less recently used page.
+};
+
+/**
+  * @typedef DBSpillMapping
+  * @brief
+  * Range of the spill file mapped in memory.
+  */
+typedef struct
+{
+    void * addr;  // Start of the mapping.
+    INT64 length; // Length of the mapping.
+} DBSpillMapping;
+
+/**
+  * @brief
+  * Keeps the memory used by the database under a budget.
+  *
+  * @description
+  * The cycle chunks of the tracks that the trace will not write
+  * anymore are kept in a LRU list. When they use more memory than
+  * the paging budget of DBConfig, the least recently used ones are
+  * stored in a spill file and replaced by a TagVecPaged, that is
+  * read back from the file the next time the chunk is accessed.
+  * Failing to read it back is fatal, because the values of the chunk
+  * are nowhere else. A chunk that was not modified since it was read is not written
+  * again. The closed segments of the item tag heap are moved to the
+  * spill file and mapped from there, so the kernel can drop and
+  * reload their pages when memory is needed. The spill file is
+  * removed from its directory as soon as it is created, so it
+  * disappears with the process.
+  *
+  * @version 0.1
+  */
+class DBPager : public AMemObj, public StatObj
+{
+    public:
+        // ---- AMemObj Interface methods
+        virtual INT64 getObjSize() const;
+        virtual QString getUsageDescription() const;
+        // ---- StatObj Interface methods
+        QString getStats() const;
+        // -----------------------------------------------
+
+    public:
+        static DBPager* getInstance();
+        static void destroy();
+
+    public:
+        inline bool isEnabled() const;
+        inline void touchChunk(DBPage * page);
+        inline void dirtyChunk(DBPage * page);
+
+        void addChunk(TagIdVecNode * owner, INT32 chunk, TagVec * vec, INT64 offset=-1, INT64 length=0);
+        void forgetChunk(DBPage * page);
+        DBCacheFile * readChunk(INT64 offset, INT64 length);
+        void * spillSegment(const void * data, INT64 size);
+
+        void reset();
+
+    protected:
+        DBPager();
+        virtual ~DBPager();
+
+        inline void unlink(DBPage * page);
+        inline void pushFront(DBPage * page);
+        bool openSpill();
+        void evict(DBPage * page);
+
+    private:
+        DBPage * mru;         // Most recently used page.
+        DBPage * lru;         // Least recently used page.
+        INT64 budget;         // Bytes of chunks kept in memory, 0 if disabled.
+        INT64 residentBytes;  // Bytes used by the chunks of the list.
+        INT32 numPages;       // Chunks in the list.
+        DBCacheFile * spill;  // The spill file.
+        bool spillOpened;     // The spill file was created.
+        bool spillFailed;     // The spill file could not be used.
+        FValueVector<DBSpillMapping> mappings; // Segments mapped from the spill file.
+
+        // Statistics.
+        INT64 pageOuts;       // Chunks evicted.
+        INT64 pageWrites;     // Chunks written to the spill file.
+        INT64 pageIns;        // Chunks read back.
+        INT64 spilledBytes;   // Bytes of heap segments moved to the spill file.
+
+        DBConfig * conf;
+        LogMgr * myLogMgr;
+
+    private:
+        static DBPager* _myInstance;
+};
+
+/**
+ * Returns if the paging is enabled.
+ *
+ * @return true if enabled.
+ */
+bool
+DBPager::isEnabled() const
+{
+    return (budget > 0) && !spillFailed;
+}
+
+/**
+ * Removes page from the LRU list.
+ *
+ * @return void.
+ */
+void
+DBPager::unlink(DBPage * page)
+{
+    if (page->prev != NULL)
+    {
+        page->prev->next = page->next;
+    }
+    else
+    {
+        mru = page->next;
+    }
+    if (page->next != NULL)
+    {
+        page->next->prev = page->prev;
+    }
+    else
+    {
+        lru = page->prev;
+    }
+}
+
+/**
+ * Inserts page as the most recently used one.
+ *
+ * @return void.
+ */
+void
+DBPager::pushFront(DBPage * page)
+{
+    page->prev = NULL;
+    page->next = mru;
+    if (mru != NULL)
+    {
+        mru->prev = page;
+    }
+    else
+    {
+        lru = page;
+    }
+    mru = page;
+}
+
+/**
+ * Marks the chunk of page as the most recently used one.
+ *
+ * @return void.
+ */
+void
+DBPager::touchChunk(DBPage * page)
+{
+    if (page != mru)
+    {
+        unlink(page);
+        pushFront(page);
+    }
+}
+
+/**
+ * Marks the chunk of page as used and modified, so its copy in the
+ * spill file is outdated.
+ *
+ * @return void.
+ */
+void
+DBPager::dirtyChunk(DBPage * page)
+{
+    page->offset = -1;
+    touchChunk(page);
+}
+
+#endif
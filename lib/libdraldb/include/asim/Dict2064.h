@@ -38,6 +38,7 @@
 
 #include "asim/draldb_syntax.h"
 #include "asim/Hash6431.h"
+#include "asim/DBCacheFile.h"
 
 #define DICT2064_MAXDICT 128
 #define DICT2064_MAXKEY  1048575
@@ -76,6 +77,7 @@ class Dict2064Node
             nextKey=0;
             dict=NULL;
             cycle=-1;
+            owned=true;
         };
 
         /**
@@ -85,16 +87,31 @@ class Dict2064Node
          */
         ~Dict2064Node()
         {
-            if (dict!=NULL)
+            clear();
+        };
+
+        /**
+         * Frees the dictionary array if it was allocated by the node.
+         *
+         * @return void.
+         */
+        void clear()
+        {
+            if ((dict!=NULL) && owned)
             {
                 delete [] dict;
             }
+            nextKey=0;
+            dict=NULL;
+            cycle=-1;
+            owned=true;
         };
 
     protected:
         INT32   cycle; // First cycle 
         UINT64* dict; // Holds the values of this dictinary.
         INT32   nextKey; // Next entry in the dict array.
+        bool    owned; // The dict array was allocated by the node (it can be mapped from a cache file).
 
     friend class Dict2064;
 };
@@ -111,6 +128,10 @@ class Dict2064
         inline UINT64 getValueByDict  (INT32 key, INT32 dictNum);
 
         INT32  getNumDictionaries();
+        void   reset();
+
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
 
     protected:
         Dict2064();
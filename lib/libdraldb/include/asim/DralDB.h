@@ -62,6 +62,8 @@
 #include "asim/PrimeList.h"
 #include "asim/ZipObject.h"
 #include "asim/fvaluevector.h"
+#include "asim/DBCacheFile.h"
+#include "asim/DBPager.h"
 
 /**
   * @brief
@@ -98,6 +100,10 @@ class DralDB
         inline INT32 processEvents(INT32 commands);
         bool  loadDRLHeader();
         bool  processAllEvents();
+        bool  seekDRLCycle(INT32 cycle);
+        bool  processCycleWindow(INT32 first, INT32 last);
+        INT32 loadDRLCache();
+        bool  saveDRLCache();
         inline bool reachedEOS();
         inline INT32 getFirstEffectiveCycle();
         // -------------------------------------------------------------------
@@ -157,10 +163,12 @@ class DralDB
 
         /**
           * Look for a given value in a given context (tag) starting from a given point.
+          * The handler points to the tag of the first item that has the value at the
+          * given cycle, or is invalid if no item has it. The tag-value index is used
+          * if it was enabled before processing the trace.
           * @param target_tagid the tag id we are looking for
           * @param target_value the tag value we are looking for
-          * @param staring_point vector entry where to start the scanning
-          * @return vector position or -1 if <tag-value> not found
+          * @param staring_point item entry where to start the scanning
           */
         inline void lookForIntegerValue(ItemHandler * handler, UINT16 target_tagid,
             UINT64 target_value, UINT32 cycle, INT32 starting_point = 0);
@@ -189,6 +197,11 @@ class DralDB
         inline int  getItemMaxAge() ;
         inline int  getMaxIFI() ;
         inline bool getCompressMutable() ;
+        inline bool getTagValueIndex() ;
+        inline bool getUseCache() ;
+        inline UINT32 getDecodeThreads() ;
+        inline UINT32 getPagingBudget() ;
+        inline QString getSpillDir() ;
 
         inline void setAutoPurge(bool value) ;
         inline void setIncrementalPurge(bool value) ;
@@ -198,6 +211,11 @@ class DralDB
         inline void setItemMaxAge(int  value) ;
         inline void setMaxIFI(int  value) ;
         inline void setCompressMutable(bool value);
+        inline void setTagValueIndex(bool value);
+        inline void setUseCache(bool value);
+        inline void setDecodeThreads(UINT32 value);
+        inline void setPagingBudget(UINT32 value);
+        inline void setSpillDir(QString value);
         // -------------------------------------------------------------------
         // -- Tag Descriptor (low level) Methods
         // -------------------------------------------------------------------
@@ -251,6 +269,12 @@ class DralDB
         DRAL_CLIENT    dralClient; // Client of the database.
         DRAL_LISTENER_CONVERTER converter; // Converts the new callbacks to the old ones.
         INT32          numTrackedEdges; // Number of edges that are being tracked.
+        Dict2064*      dict; // Dictionary of tag values.
+        DBPager*       pager; // Pager of the closed chunks.
+        DBCacheFile*   cacheFile; // Cache file mapped by the database.
+
+    private:
+        bool getCacheKey(UINT64 * key);
 
     private:
         static DralDB* _myInstance; // Instance of DralDB.
@@ -921,6 +945,61 @@ DralDB::getCompressMutable()
     return dbConfig->getCompressMutable();
 }
 
+/**
+ * Returns the tagValueIndex value.
+ *
+ * @return tagValueIndex.
+ */
+bool
+DralDB::getTagValueIndex()
+{
+    return dbConfig->getTagValueIndex();
+}
+
+/**
+ * Returns the useCache value.
+ *
+ * @return useCache.
+ */
+bool
+DralDB::getUseCache()
+{
+    return dbConfig->getUseCache();
+}
+
+/**
+ * Returns the decodeThreads value.
+ *
+ * @return decodeThreads.
+ */
+UINT32
+DralDB::getDecodeThreads()
+{
+    return dbConfig->getDecodeThreads();
+}
+
+/**
+ * Returns the pagingBudget value.
+ *
+ * @return pagingBudget.
+ */
+UINT32
+DralDB::getPagingBudget()
+{
+    return dbConfig->getPagingBudget();
+}
+
+/**
+ * Returns the spillDir value.
+ *
+ * @return spillDir.
+ */
+QString
+DralDB::getSpillDir()
+{
+    return dbConfig->getSpillDir();
+}
+
 /**
  * Sets the autoPurge value.
  *
@@ -987,6 +1066,71 @@ DralDB::setCompressMutable(bool value)
     dbConfig->setCompressMutable(value);
 }
 
+/**
+ * Sets the tagValueIndex value. Must be set before the trace is
+ * processed, otherwise the searches will keep scanning the items.
+ *
+ * @return void.
+ */
+void
+DralDB::setTagValueIndex(bool value)
+{
+    dbConfig->setTagValueIndex(value);
+}
+
+/**
+ * Sets the useCache value. When set, processAllEvents loads the
+ * database from the cache file of the trace if it matches the trace
+ * and the configuration, and saves it otherwise.
+ *
+ * @return void.
+ */
+void
+DralDB::setUseCache(bool value)
+{
+    dbConfig->setUseCache(value);
+}
+
+/**
+ * Sets the decodeThreads value. When it is not zero, the trace opened
+ * next is decompressed by that many threads ahead of the dral client,
+ * in parallel between the sync points of the trace if it has them.
+ *
+ * @return void.
+ */
+void
+DralDB::setDecodeThreads(UINT32 value)
+{
+    dbConfig->setDecodeThreads(value);
+}
+
+/**
+ * Sets the pagingBudget value. When it is not zero, the closed cycle
+ * chunks of the tracks of the trace opened next are kept under that
+ * many megabytes: the least recently used ones are moved to a spill
+ * file and read back when accessed. The filled segments of the item
+ * tag heap are moved to the spill file too.
+ *
+ * @return void.
+ */
+void
+DralDB::setPagingBudget(UINT32 value)
+{
+    dbConfig->setPagingBudget(value);
+}
+
+/**
+ * Sets the directory where the spill file is created. The temporary
+ * directory is used if it is empty.
+ *
+ * @return void.
+ */
+void
+DralDB::setSpillDir(QString value)
+{
+    dbConfig->setSpillDir(value);
+}
+
 /**
  * Sets the itemMaxAge value.
  *
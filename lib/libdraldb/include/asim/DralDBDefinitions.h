@@ -58,6 +58,19 @@
 #define CYCLE_OFFSET_BITS 12
 #define CYCLE_OFFSET_MASK 0x00000FFFU
 
+// -------------------------------------------------
+// Cache file definitions
+// -------------------------------------------------
+/** @def suffix added to the trace name to get its cache file */
+#define DRALDB_CACHE_SUFFIX ".dbc"
+
+/** @def first and last words of a cache file */
+#define DRALDB_CACHE_MAGIC 0x4348434142444c44ULL
+#define DRALDB_CACHE_END   0x444e454342444c44ULL
+
+/** @def words of the key that must match to use a cache file */
+#define DRALDB_CACHE_KEY_WORDS 10
+
 // -------------------------------------------------
 // DBGraph definitions
 // -------------------------------------------------
@@ -76,8 +89,6 @@
 #define DEFAULT_DBGE_SIZE 99991
 
 
-#define CACHED_ITEMIDS 10000
-
 // -------------------------------------------------
 // Global definitions
 // -------------------------------------------------
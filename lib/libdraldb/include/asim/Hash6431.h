@@ -92,6 +92,7 @@ class Hash6431
 
         inline INT32 find(UINT64 key);
         inline void  insert(UINT64 key, INT32 value);
+        inline void  update(UINT64 key, INT32 value);
 
         void clear();
     private:
@@ -163,4 +164,31 @@ Hash6431::insert(UINT64 key, INT32 value)
     current->value = value;
 }
 
+/**
+ * Sets the value associated to the key. If the key is already in
+ * the hash its value is overwritten, otherwise the key is inserted.
+ *
+ * @return void.
+ */
+void
+Hash6431::update(UINT64 key, INT32 value)
+{
+    UINT64 bk = key % buckets;
+    Hash6431Node* current = &(bvector[bk]);
+    if (current->used)
+    {
+        // Looks for the key in the collision list.
+        while (current!=NULL)
+        {
+            if (current->key == key)
+            {
+                current->value = value;
+                return;
+            }
+            current = current->next;
+        }
+    }
+    insert(key, value);
+}
+
 #endif
@@ -101,6 +101,7 @@ class ItemHandler
         inline bool operator==(const ItemHandler & comp);
 
         inline INT32 uniqueIndex();
+        inline INT32 getItemEntry();
 
     protected:
         inline ItemHandler(INT32 itemId);
@@ -459,4 +460,17 @@ ItemHandler::uniqueIndex()
     }
 }
 
+/**
+ * Returns the item vector entry of the item pointed by the
+ * handler. Can be used as starting point of the value searches.
+ *
+ * @return the item entry.
+ */
+INT32
+ItemHandler::getItemEntry()
+{
+    Q_ASSERT(valid_item);
+    return itemIdx;
+}
+
 #endif
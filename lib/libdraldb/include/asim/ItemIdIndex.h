@@ -0,0 +1,165 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DRALDB_ITEMIDINDEX_H
+#define _DRALDB_ITEMIDINDEX_H
+
+#include <qglobal.h>
+
+#include "asim/draldb_syntax.h"
+#include "asim/Hash6431.h"
+
+/** @def Number of item ids mapped by each dense chunk (log2). */
+#define ITEMIDX_CHUNK_BITS 16
+#define ITEMIDX_CHUNK_SIZE (1 << ITEMIDX_CHUNK_BITS)
+#define ITEMIDX_CHUNK_MASK (ITEMIDX_CHUNK_SIZE - 1)
+#define ITEMIDX_NUM_CHUNKS (1 << (32 - ITEMIDX_CHUNK_BITS))
+
+/** @def Ids of an isolated chunk kept in the hash before it becomes dense. */
+#define ITEMIDX_PROMOTE_CNT 1024
+
+/** @def Buckets of the sparse fallback hash. */
+#define ITEMIDX_SPARSE_BUCKETS 4001
+
+/**
+  * @brief
+  * Maps DRAL item ids to their entry in the ItemTagHeap item vector.
+  *
+  * @description
+  * Item ids are mostly allocated in increasing order, so the id
+  * space is split in chunks of ITEMIDX_CHUNK_SIZE ids that are
+  * direct mapped arrays of item vector positions. A chunk is
+  * allocated when it is the first one used or when it follows the
+  * dense chunk that received the last id. Ids that fall in isolated
+  * chunks are stored in a hash until their chunk receives
+  * ITEMIDX_PROMOTE_CNT ids, then the chunk is allocated too. The
+  * ids that were already in the hash are still found there, so no
+  * rehashing is needed.
+  *
+  * @version 0.1
+  */
+class ItemIdIndex
+{
+    public:
+        ItemIdIndex();
+        ~ItemIdIndex();
+
+        inline INT32 find(INT32 itemId) const;
+        inline void insert(INT32 itemId, INT32 itemIdx);
+
+        void clear();
+
+        INT64 getObjSize() const;
+        inline INT32 getNumDenseChunks() const;
+
+    private:
+        void allocateChunk(UINT32 chunk);
+
+    private:
+        INT32 * dense[ITEMIDX_NUM_CHUNKS];      // Direct mapped chunks (NULL if not allocated).
+        UINT16 sparseCnt[ITEMIDX_NUM_CHUNKS];   // Ids of each chunk stored in the hash (saturated).
+        Hash6431 * sparse;                      // Fallback for ids of isolated chunks.
+        INT32 lastChunk;                        // Dense chunk of the last inserted id.
+        INT32 numDenseChunks;                   // Number of allocated chunks.
+};
+
+/**
+ * Returns the item vector position of itemId or -1 if the item
+ * id has never been inserted.
+ *
+ * @return the position of the item.
+ */
+INT32
+ItemIdIndex::find(INT32 itemId) const
+{
+    UINT32 key = (UINT32) itemId;
+    UINT32 chunk = key >> ITEMIDX_CHUNK_BITS;
+
+    if (dense[chunk] != NULL)
+    {
+        INT32 idx = dense[chunk][key & ITEMIDX_CHUNK_MASK];
+        if ((idx >= 0) || (sparseCnt[chunk] == 0))
+        {
+            return idx;
+        }
+    }
+    else if (sparseCnt[chunk] == 0)
+    {
+        return -1;
+    }
+    return sparse->find(key);
+}
+
+/**
+ * Maps itemId to the item vector position itemIdx. If the id was
+ * already mapped the new position replaces the old one.
+ *
+ * @return void.
+ */
+void
+ItemIdIndex::insert(INT32 itemId, INT32 itemIdx)
+{
+    UINT32 key = (UINT32) itemId;
+    UINT32 chunk = key >> ITEMIDX_CHUNK_BITS;
+
+    if (dense[chunk] == NULL)
+    {
+        if ((numDenseChunks == 0) ||
+            ((INT32) chunk == lastChunk + 1) ||
+            (sparseCnt[chunk] >= ITEMIDX_PROMOTE_CNT))
+        {
+            allocateChunk(chunk);
+        }
+        else
+        {
+            sparse->update(key, itemIdx);
+            if (sparseCnt[chunk] < ITEMIDX_PROMOTE_CNT)
+            {
+                sparseCnt[chunk]++;
+            }
+            return;
+        }
+    }
+    dense[chunk][key & ITEMIDX_CHUNK_MASK] = itemIdx;
+    lastChunk = chunk;
+}
+
+/**
+ * Returns the number of direct mapped chunks allocated.
+ *
+ * @return the number of chunks.
+ */
+INT32
+ItemIdIndex::getNumDenseChunks() const
+{
+    return numDenseChunks;
+}
+
+#endif
@@ -34,7 +34,7 @@
 // Qt Library
 #include <q3valuelist.h>
 #include <qregexp.h>
-#include <q3intcache.h>
+#include <qbitarray.h>
 
 #include "asim/draldb_syntax.h"
 #include "asim/DralDBDefinitions.h"
@@ -44,9 +44,12 @@
 #include "asim/ItemTagDef.h"
 #include "asim/TagDescVector.h"
 #include "asim/AEVector.h"
+#include "asim/ItemIdIndex.h"
+#include "asim/TagValueIndex.h"
 #include "asim/Dict2064.h"
 #include "asim/DBConfig.h"
 #include "asim/LogMgr.h"
+#include "asim/DBCacheFile.h"
 
 //extern bool debug_on;
 
@@ -91,6 +94,7 @@ class ItemTagHeap : public AMemObj, public StatObj
 
         void newTag(INT32 item_id, UINT16 tag_id, UINT64 value, UINT32 cycle);
         void newTag(INT32 item_id, UINT16 tag_id, SOVList * list, UINT32 cycle);
+        void newTags(INT32 item_id, UINT32 n, const UINT16 tag_ids[], const UINT64 values[], const UINT32 cycles[]);
 
         // -----------------------------------------------
         // Consult Methods
@@ -104,8 +108,7 @@ class ItemTagHeap : public AMemObj, public StatObj
           * Look for a given value in a given context (tag) starting from a given point.
           * @param target_tagid the tag id we are looking for
           * @param target_value the tag value we are looking for
-          * @param staring_point vector entry where to start the scanning
-          * @return vector position or -1 if <tag-value> not found
+          * @param start_item item vector entry where to start the scanning
           */
         void lookForIntegerValue(ItemHandler * handler, UINT16 target_tagid,
             UINT64 target_value, UINT32 cycle, INT32 start_item);
@@ -118,6 +121,10 @@ class ItemTagHeap : public AMemObj, public StatObj
             QRegExp target_value, UINT32 cycle, INT32 start_item);
 
         void reset();
+        void spillSegments();
+
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
 
         inline INT32 getNumItems();
         inline void setDralVersion(UINT16 value);
@@ -172,6 +179,9 @@ class ItemTagHeap : public AMemObj, public StatObj
 
         bool getMutableTagValue(ItemHandler * handler, UINT32 cycle, UINT64 * result, UINT64 * when, bool backpropagate);
 
+        bool getItemEntryTag(ItemHandler * handler, INT32 item, UINT16 target_tagid, UINT32 cycle, UINT64 * value);
+        void lookForStrIds(ItemHandler * handler, UINT16 target_tagid, const QBitArray & strIds, UINT32 cycle, INT32 start_item);
+
         TagHeapNode * allocateNewSlot(ItemHandler * handler);
         TagHeapNode * shiftSlot(ItemHandler * handler);
         void resetTagState(ItemHandler * handler);
@@ -184,7 +194,8 @@ class ItemTagHeap : public AMemObj, public StatObj
         UINT16 canonicalItemId;          // Value of tag id that represents an ITEMID tag.
         ItemHeapVector * itemVector;     // Vector of item entries.
         TagHeapVector * tagVector;       // Vector of tag chunks.
-        Q3IntCache<UINT32> * lookUpCache; // Cache to fasten up the item searches.
+        ItemIdIndex * itemIndex;         // Maps item ids to item vector entries.
+        TagValueIndex * tvIndex;         // Maps tag-value pairs to item vector entries.
         TagDescVector * tdv;             // Pointer to the tag descriptor vector.
         Dict2064 * dict;                 // Pointer to a dictionary.
         DBConfig * conf;                 // Pointer to the database configuration state.
@@ -196,7 +207,7 @@ class ItemTagHeap : public AMemObj, public StatObj
 
 /**
  * This function inserts the itemId in the heap. The mapping
- * between the position and itemId is inserted in the lookUpCache
+ * between the position and itemId is inserted in the itemIndex
  * too.
  *
  * @return void.
@@ -215,8 +226,8 @@ ItemTagHeap::newItemBlock(INT32 itemId)
     (* itemVector)[nextItemVectorEntry].itemId = itemId;
     itemVector->ref(nextItemVectorEntry).first_chunk = 0;
 
-    // Inserts the mapping to the cache.
-    lookUpCache->insert((long) itemId, new UINT32(nextItemVectorEntry));
+    // Inserts the mapping to the index.
+    itemIndex->insert(itemId, nextItemVectorEntry);
     // Occupies the position.
     return nextItemVectorEntry++;
 }
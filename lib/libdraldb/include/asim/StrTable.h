@@ -44,6 +44,7 @@
 #include "asim/AMemObj.h"
 #include "asim/DralDBDefinitions.h"
 #include "asim/StatObj.h"
+#include "asim/DBCacheFile.h"
 
 /**
   * @brief
@@ -79,17 +80,20 @@ class StrTable : public AMemObj, public StatObj
         inline INT32 addString(QString);
         inline QString getString(INT32);
         inline bool hasString(QString);
+        inline INT32 lookForStr(QString);
+        inline INT32 getNumStrings();
 
         void reset();
         void resize(INT32 newsize);
 
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
     protected:
         StrTable(INT32 sz);
         virtual ~StrTable();
         void init(INT32 sz);
 
-        inline INT32 lookForStr(QString);
-
     private:
         Q3Dict<INT32>*      strhash; // Hash from string to int.
         Q3IntDict<QString>* idxhash; // Hash from int to string.
@@ -177,4 +181,16 @@ StrTable::hasString(QString str)
     return (lookForStr(str)>=0);
 }
 
+/**
+ * Returns the number of strings of the table. The strings are
+ * mapped to the indexes from 0 to this number minus one.
+ *
+ * @return the number of strings.
+ */
+INT32
+StrTable::getNumStrings()
+{
+    return nextIdx;
+}
+
 #endif
@@ -45,6 +45,7 @@
 #include "asim/DralDBDefinitions.h"
 #include "asim/StrTable.h"
 #include "asim/DBItoa.h"
+#include "asim/DBCacheFile.h"
 
 typedef struct
 {
@@ -97,6 +98,9 @@ class TagDescVector : public AMemObj, public StatObj
         Q3StrList getKnownTags();
         void resize(INT32 sz);
 
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
         inline QString getFormatedTagValue(UINT16 tagId, UINT64 value);
 
     protected:
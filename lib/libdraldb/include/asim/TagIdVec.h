@@ -40,6 +40,8 @@
 #include "asim/TagVecDictionary.h"
 #include "asim/TagVecDictionaryNF.h"
 #include "asim/TagVecItemIdx.h"
+#include "asim/TagVecPaged.h"
+#include "asim/DBPager.h"
 
 #define TAGIDVECNODE_AEPAGESIZE 32
 #define TAGIDVECNODE_AENUMPAGES 8
@@ -90,6 +92,9 @@ class TagIdVecNode : public ZipObject
 
         inline bool hasData();
         inline void checkCycleChunk(INT32 cycleChunk);
+        inline void checkCyclePage(INT32 cycleChunk);
+        inline TagVec* getChunk(INT32 cycleChunk);
+        void pageOut(INT32 cycleChunk, INT64 offset, INT64 length);
 
         void dumpTagIdVector();
 
@@ -97,6 +102,9 @@ class TagIdVecNode : public ZipObject
         inline void decPendingCnt(INT32 cycle);
         void setWriteEnabled(bool);
 
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
     protected:
         TagCycleVector* cycleVec; // Pointer to the tag vectors with values.
         INT32 lastCycle; // Last cycle with contens.
@@ -107,8 +115,16 @@ class TagIdVecNode : public ZipObject
 
         // optimization flags...
 
+    protected:
+        inline TagVec* newChunk(INT32 cycleChunk);
+        void pageIn(INT32 cycleChunk);
+
+    private:
+        static TagVec* loadTagVec(DBCacheFile * cache);
+
     private:
         static StrTable* strtbl; // Pointer to the string table.
+        static DBPager* pager; // Pointer to the pager.
 };
 
 /** @typedef TagIdVector
@@ -130,6 +146,10 @@ TagIdVecNode::TagIdVecNode()
     {
         strtbl = StrTable::getInstance();
     }
+    if (pager==NULL)
+    {
+        pager = DBPager::getInstance();
+    }
     firstCycle = 2147483647;
     lastCycle  = -1;
     isFwd      =  0;
@@ -210,15 +230,15 @@ TagIdVecNode::addTagValue(INT32 cycle, SOVList* value)
 }
 
 /**
- * Checks that a cycle chunk is allocated. First looks if the
- * array has been allocated. Then looks if the chunk is allocated.
- * In negative case is allocated and all the pointers are set to
- * NULL. Finally allocates the correct type of tag vector.
+ * Checks that the page of the cycle chunk is allocated. First looks
+ * if the array has been allocated. Then looks if the page of the
+ * chunk is allocated. In negative case is allocated and all the
+ * pointers are set to NULL.
  *
  * @return void.
  */
 void
-TagIdVecNode::checkCycleChunk(INT32 cycleChunk)
+TagIdVecNode::checkCyclePage(INT32 cycleChunk)
 {
     // first time we use this tagId?
     if (cycleVec==NULL)
@@ -243,27 +263,87 @@ TagIdVecNode::checkCycleChunk(INT32 cycleChunk)
             (*cycleVec)[aepageElem0+i]=NULL;
         }
     }
+}
+
+/**
+ * Checks that a cycle chunk is allocated. First checks its page
+ * and then allocates the correct type of tag vector. A chunk that
+ * was paged out is read back, and the pager is told that the chunk
+ * is going to be modified.
+ *
+ * @return void.
+ */
+void
+TagIdVecNode::checkCycleChunk(INT32 cycleChunk)
+{
+    checkCyclePage(cycleChunk);
 
-    if ((*cycleVec)[cycleChunk]==NULL)
+    TagVec* vec = (*cycleVec)[cycleChunk];
+    if (vec==NULL)
     {
-        // get some TagVec implementation,
-        if (useDictionary)
+        (*cycleVec)[cycleChunk] = newChunk(cycleChunk);
+    }
+    else if ((vec->getPage()!=NULL) || vec->isPaged())
+    {
+        vec = getChunk(cycleChunk);
+        if (vec->getPage()!=NULL)
         {
-            if (isFwd)
-            {
-                (*cycleVec)[cycleChunk] = new TagVecDictionary(cycleChunk*CYCLE_CHUNK_SIZE);
-            }
-            else
-            {
-                (*cycleVec)[cycleChunk] = new TagVecDictionaryNF(cycleChunk*CYCLE_CHUNK_SIZE);
-            }
+            pager->dirtyChunk(vec->getPage());
+        }
+    }
+}
+
+/**
+ * Allocates an empty tag vector of the correct type for the chunk
+ * cycleChunk.
+ *
+ * @return the new vector.
+ */
+TagVec*
+TagIdVecNode::newChunk(INT32 cycleChunk)
+{
+    // get some TagVec implementation,
+    if (useDictionary)
+    {
+        if (isFwd)
+        {
+            return new TagVecDictionary(cycleChunk*CYCLE_CHUNK_SIZE);
         }
         else
         {
-            // by now only itemidx-like slot do not use dictionary so:
-            (*cycleVec)[cycleChunk] = new TagVecItemIdx(cycleChunk*CYCLE_CHUNK_SIZE);
+            return new TagVecDictionaryNF(cycleChunk*CYCLE_CHUNK_SIZE);
+        }
+    }
+    else
+    {
+        // by now only itemidx-like slot do not use dictionary so:
+        return new TagVecItemIdx(cycleChunk*CYCLE_CHUNK_SIZE);
+    }
+}
+
+/**
+ * Returns the tag vector of the chunk cycleChunk, that must have an
+ * allocated page. If the chunk was paged out is read back.
+ *
+ * @return the vector, NULL if the chunk has no vector.
+ */
+TagVec*
+TagIdVecNode::getChunk(INT32 cycleChunk)
+{
+    TagVec* vec = (*cycleVec)[cycleChunk];
+    if (vec!=NULL)
+    {
+        if (vec->isPaged())
+        {
+            pageIn(cycleChunk);
+            vec = (*cycleVec)[cycleChunk];
+        }
+        else if (vec->getPage()!=NULL)
+        {
+            pager->touchChunk(vec->getPage());
         }
     }
+    return vec;
 }
 
 /**
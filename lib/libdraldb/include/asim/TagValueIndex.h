@@ -0,0 +1,275 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DRALDB_TAGVALUEINDEX_H
+#define _DRALDB_TAGVALUEINDEX_H
+
+#include <qstring.h>
+
+#include "asim/draldb_syntax.h"
+#include "asim/AMemObj.h"
+#include "asim/StatObj.h"
+#include "asim/DBCacheFile.h"
+
+/** @def Initial number of buckets of the index (power of two). */
+#define TAGVALUEIDX_INIT_BUCKETS 4096
+
+/** @def Initial number of entries of each item list. */
+#define TAGVALUEIDX_INIT_LIST 4
+
+/**
+  * @brief
+  * Bucket of the tag-value index hash.
+  */
+struct TagValueBucket
+{
+    UINT64 value; // Value of the tag (string table index for strings).
+    INT32  list;  // Item list of the pair or -1 if the bucket is free.
+    UINT16 tagId; // Tag id of the pair.
+};
+
+/**
+  * @brief
+  * Item vector entries of the items that had a given tag-value.
+  */
+struct TagValueList
+{
+    INT32 * items;    // Item vector entries in increasing order.
+    INT32   count;    // Used entries.
+    INT32   capacity; // Allocated entries.
+};
+
+/**
+  * @brief
+  * Inverted index from (tag id, value) pairs to items.
+  *
+  * @description
+  * The DBListener feeds this class with the single value and
+  * string tags of each item when the item is moved to the
+  * ItemTagHeap, so the items are inserted in increasing item
+  * vector order and each list stays sorted without any extra work.
+  * String tags are indexed by their string table index. Mutable
+  * tags are inserted once per different value, so the index
+  * answers which items ever had a value: the searches must still
+  * check the value at the requested cycle. Sets of values are not
+  * indexed.
+  *
+  * @version 0.1
+  */
+class TagValueIndex : public AMemObj, public StatObj
+{
+    public:
+        // ---- AMemObj Interface methods
+        virtual INT64 getObjSize() const;
+        virtual QString getUsageDescription() const;
+        // ---- StatObj Interface methods
+        QString getStats() const;
+        // -----------------------------------------------
+
+    public:
+        static TagValueIndex* getInstance();
+        static void destroy();
+
+    public:
+        inline void newItem(INT32 itemIdx);
+        inline void addValue(UINT16 tagId, UINT64 value, INT32 itemIdx);
+
+        inline bool covers(INT32 vectorItems) const;
+        inline INT32 findList(UINT16 tagId, UINT64 value) const;
+        inline INT32 getListSize(INT32 list) const;
+        inline INT32 getListItem(INT32 list, INT32 pos) const;
+        INT32 lowerBound(INT32 list, INT32 itemIdx) const;
+
+        void reset();
+
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
+    protected:
+        // this a singleton class so protect constructors
+        TagValueIndex();
+        virtual ~TagValueIndex();
+
+        inline UINT32 hash(UINT16 tagId, UINT64 value) const;
+        INT32 newList(UINT16 tagId, UINT64 value, UINT32 bucket);
+        void growList(TagValueList * list);
+        void rehash();
+        void freeAll();
+
+    private:
+        TagValueBucket * buckets; // Open addressing hash of pairs.
+        UINT32 mask;              // Number of buckets minus one.
+        TagValueList * lists;     // Item lists of the pairs.
+        INT32 numLists;           // Used item lists (and buckets).
+        INT32 capLists;           // Allocated item lists.
+        INT64 numEntries;         // Total entries of all the lists.
+        INT32 firstItem;          // First item vector entry indexed.
+        INT32 lastItem;           // Last item vector entry indexed.
+        INT32 numItems;           // Item vector entries indexed.
+
+    private:
+        static TagValueIndex* _myInstance; // Pointer to the singleton instance.
+};
+
+/**
+ * Records that the item stored in the item vector entry itemIdx
+ * has been indexed, even if it has no indexable tags.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::newItem(INT32 itemIdx)
+{
+    if (firstItem < 0)
+    {
+        firstItem = itemIdx;
+    }
+    if (itemIdx != lastItem)
+    {
+        numItems++;
+    }
+    lastItem = itemIdx;
+}
+
+/**
+ * Adds the item vector entry itemIdx to the list of the pair
+ * tagId-value. The items must be added in increasing order.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::addValue(UINT16 tagId, UINT64 value, INT32 itemIdx)
+{
+    UINT32 b = hash(tagId, value);
+    INT32 l;
+
+    // Linear probing until the pair or a free bucket is found.
+    while ((buckets[b].list >= 0) &&
+           ((buckets[b].value != value) || (buckets[b].tagId != tagId)))
+    {
+        b = (b + 1) & mask;
+    }
+
+    l = buckets[b].list;
+    if (l < 0)
+    {
+        l = newList(tagId, value, b);
+    }
+
+    TagValueList * list = &lists[l];
+
+    // Mutable tags can repeat the same value in the same item.
+    if ((list->count > 0) && (list->items[list->count - 1] == itemIdx))
+    {
+        return;
+    }
+    Q_ASSERT((list->count == 0) || (list->items[list->count - 1] < itemIdx));
+
+    if (list->count == list->capacity)
+    {
+        growList(list);
+    }
+    list->items[list->count++] = itemIdx;
+    numEntries++;
+}
+
+/**
+ * Checks if all the entries of the item vector, from 0 to
+ * vectorItems - 1, have been indexed. The entries arrive in
+ * increasing order, so the range is complete when as many entries
+ * as it spans were indexed. When the index was enabled in the
+ * middle of a trace, or disabled for a while, it can't be used and
+ * the searches fall back to a scan.
+ *
+ * @return true if the index has all the items.
+ */
+bool
+TagValueIndex::covers(INT32 vectorItems) const
+{
+    return (firstItem == 0) && (lastItem == vectorItems - 1) && (numItems == vectorItems);
+}
+
+/**
+ * Looks for the item list of the pair tagId-value.
+ *
+ * @return the list or -1 if no item had that value.
+ */
+INT32
+TagValueIndex::findList(UINT16 tagId, UINT64 value) const
+{
+    UINT32 b = hash(tagId, value);
+
+    while (buckets[b].list >= 0)
+    {
+        if ((buckets[b].value == value) && (buckets[b].tagId == tagId))
+        {
+            return buckets[b].list;
+        }
+        b = (b + 1) & mask;
+    }
+    return -1;
+}
+
+/**
+ * Returns the number of items of the list.
+ *
+ * @return the size of the list.
+ */
+INT32
+TagValueIndex::getListSize(INT32 list) const
+{
+    return lists[list].count;
+}
+
+/**
+ * Returns the item vector entry stored in the position pos of
+ * the list.
+ *
+ * @return the item vector entry.
+ */
+INT32
+TagValueIndex::getListItem(INT32 list, INT32 pos) const
+{
+    return lists[list].items[pos];
+}
+
+/**
+ * Hashes the pair tagId-value to a bucket.
+ *
+ * @return the bucket.
+ */
+UINT32
+TagValueIndex::hash(UINT16 tagId, UINT64 value) const
+{
+    UINT64 h = (value ^ ((UINT64) tagId << 48)) * 0x9E3779B97F4A7C15ULL;
+    return ((UINT32) (h >> 32)) & mask;
+}
+
+#endif
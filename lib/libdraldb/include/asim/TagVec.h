@@ -38,6 +38,8 @@
 #include "asim/draldb_syntax.h"
 #include "asim/DRALTag.h"
 #include "asim/ZipObject.h"
+#include "asim/DBCacheFile.h"
+#include "asim/DBPager.h"
 
 /**
   * @brief
@@ -63,13 +65,15 @@ typedef enum
     TVEType_DICTIONARY,             // for node tags
     TVEType_DENSE_DICTIONARY,
     TVEType_DICTIONARY_NF,          // for cycle tags
-    TVEType_DENSE_DICTIONARY_NF
+    TVEType_DENSE_DICTIONARY_NF,
+    TVEType_PAGED                   // chunk stored in the spill file
 } TagVecEncodingType;
 
 class TagVec : public ZipObject
 {
     public:
-        inline TagVec(){ we=true; pendingCnt=0; }
+        inline TagVec(){ we=true; paged=false; pendingCnt=0; page=NULL; }
+        inline virtual ~TagVec();
 
         virtual bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle) = 0;
         virtual bool getTagValue(INT32 cycle, SOVList** value, UINT32* atcycle) = 0;
@@ -80,17 +84,43 @@ class TagVec : public ZipObject
 
         virtual void dumpCycleVector() = 0;
         virtual TagVecEncodingType getType() = 0;
+        virtual void saveCache(DBCacheFile * cache) = 0;
+        virtual INT64 getMemSize() = 0;
 
         inline virtual bool isWriteEnabled();
         inline virtual void setWriteEnabled(bool);
         inline virtual void incPendingCnt();
         inline virtual void decPendingCnt();
+        inline bool hasPendingItems();
+        inline bool isPaged();
+
+        inline DBPage * getPage();
+        inline void setPage(DBPage * value);
+
+   protected:
+        inline void saveState(DBCacheFile * cache);
+        inline void loadState(DBCacheFile * cache);
 
    protected:
         bool  we;
+        bool  paged; // The vector is a TagVecPaged.
         INT32 pendingCnt;
+        DBPage * page; // Entry of the pager, NULL if the vector can't be paged out.
 };
 
+/**
+ * Destructor of this class. Removes the vector from the pager.
+ *
+ * @return destroys the object.
+ */
+TagVec::~TagVec()
+{
+    if (page!=NULL)
+    {
+        DBPager::getInstance()->forgetChunk(page);
+    }
+}
+
 /**
  * Returns the value of the we flag.
  *
@@ -142,4 +172,72 @@ TagVec::decPendingCnt()
     }
 }
 
+/**
+ * Returns if items that are still alive were set in the vector.
+ *
+ * @return true if the pending counter is not zero.
+ */
+bool
+TagVec::hasPendingItems()
+{
+    return (pendingCnt!=0);
+}
+
+/**
+ * Returns if the vector is stored in the spill file.
+ *
+ * @return true if the vector is a TagVecPaged.
+ */
+bool
+TagVec::isPaged()
+{
+    return paged;
+}
+
+/**
+ * Returns the entry of the pager that holds the vector.
+ *
+ * @return the page or NULL.
+ */
+DBPage *
+TagVec::getPage()
+{
+    return page;
+}
+
+/**
+ * Sets the entry of the pager that holds the vector.
+ *
+ * @return void.
+ */
+void
+TagVec::setPage(DBPage * value)
+{
+    page = value;
+}
+
+/**
+ * Stores the write enable state in the cache.
+ *
+ * @return void.
+ */
+void
+TagVec::saveState(DBCacheFile * cache)
+{
+    cache->writeINT32(we);
+    cache->writeINT32(pendingCnt);
+}
+
+/**
+ * Restores the write enable state stored with saveState.
+ *
+ * @return void.
+ */
+void
+TagVec::loadState(DBCacheFile * cache)
+{
+    we = (cache->readINT32() != 0);
+    pendingCnt = cache->readINT32();
+}
+
 #endif
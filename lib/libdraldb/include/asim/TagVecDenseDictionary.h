@@ -55,6 +55,7 @@ class TagVecDenseDictionary : public TagVec
 {
     public:
         TagVecDenseDictionary(TagVecDictionary* original);
+        TagVecDenseDictionary(DBCacheFile * cache);
         virtual ~TagVecDenseDictionary();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
@@ -66,6 +67,8 @@ class TagVecDenseDictionary : public TagVec
 
         inline ZipObject* compressYourSelf(INT32 cycle, bool last=false);
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         void dumpCycleVector();
 
@@ -126,6 +129,17 @@ TagVecDenseDictionary::getType()
     return TVEType_DENSE_DICTIONARY;
 }
 
+/**
+ * Returns the bytes used by the vector and its entries.
+ *
+ * @return the size.
+ */
+INT64
+TagVecDenseDictionary::getMemSize()
+{
+    return sizeof(TagVecDenseDictionary) + (INT64) nextEntry * sizeof(TagVecDictionaryNode);
+}
+
 /**
  * Gets the value of this tag in the cycle cycle.
  *
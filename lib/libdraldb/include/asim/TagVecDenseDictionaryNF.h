@@ -55,12 +55,15 @@ class TagVecDenseDictionaryNF : public TagVec
 {
     public:
         TagVecDenseDictionaryNF(TagVecDictionaryNF* original);
+        TagVecDenseDictionaryNF(DBCacheFile * cache);
         virtual ~TagVecDenseDictionaryNF();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
         inline bool getTagValue(INT32 cycle, SOVList** value, UINT32* atcycle);
 
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         inline bool addTagValue(INT32 cycle, UINT64   value);
         inline bool addTagValue(INT32 cycle, QString  value);
@@ -127,6 +130,17 @@ TagVecDenseDictionaryNF::getType()
     return TVEType_DENSE_DICTIONARY_NF;
 }
 
+/**
+ * Returns the bytes used by the vector and its entries.
+ *
+ * @return the size.
+ */
+INT64
+TagVecDenseDictionaryNF::getMemSize()
+{
+    return sizeof(TagVecDenseDictionaryNF) + (INT64) nextEntry * sizeof(TagVecDictionaryNode);
+}
+
 /**
  * Gets the value of this tag in the cycle cycle.
  *
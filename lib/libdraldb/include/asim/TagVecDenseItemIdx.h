@@ -75,6 +75,7 @@ class TagVecDenseItemIdx : public TagVec
 {
     public:
         TagVecDenseItemIdx(TagVecItemIdx* source);
+        TagVecDenseItemIdx(DBCacheFile * cache);
         virtual ~TagVecDenseItemIdx();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
@@ -86,6 +87,8 @@ class TagVecDenseItemIdx : public TagVec
 
         void dumpCycleVector();
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         ZipObject* compressYourSelf(INT32 cycle, bool last=false);
 
@@ -139,6 +142,17 @@ TagVecDenseItemIdx::getType()
     return TVEType_DENSE_ITEMIDX;
 }
 
+/**
+ * Returns the bytes used by the vector and its entries.
+ *
+ * @return the size.
+ */
+INT64
+TagVecDenseItemIdx::getMemSize()
+{
+    return sizeof(TagVecDenseItemIdx) + (INT64) nextEntry * sizeof(TagVecDenseItemIdxNode);
+}
+
 /**
  * Gets the value (item id) in the cycle cycle.
  *
@@ -74,6 +74,7 @@ class TagVecDenseShortItemIdx : public TagVec
 {
     public:
         TagVecDenseShortItemIdx(TagVecItemIdx* source);
+        TagVecDenseShortItemIdx(DBCacheFile * cache);
         virtual ~TagVecDenseShortItemIdx();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
@@ -85,6 +86,8 @@ class TagVecDenseShortItemIdx : public TagVec
 
         void dumpCycleVector();
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         ZipObject* compressYourSelf(INT32 cycle, bool last=false);
 
@@ -138,6 +141,17 @@ TagVecDenseShortItemIdx::getType()
     return TVEType_DENSE_ITEMIDX;
 }
 
+/**
+ * Returns the bytes used by the vector and its entries.
+ *
+ * @return the size.
+ */
+INT64
+TagVecDenseShortItemIdx::getMemSize()
+{
+    return sizeof(TagVecDenseShortItemIdx) + (INT64) nextEntry * sizeof(TagVecDenseShortItemIdxNode);
+}
+
 /**
  * Gets the value (item id) in the cycle cycle.
  *
@@ -70,6 +70,7 @@ class TagVecDictionary : public TagVec
 {
     public:
         TagVecDictionary(INT32 bcycle);
+        TagVecDictionary(DBCacheFile * cache);
         virtual ~TagVecDictionary();
 
         inline  bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
@@ -81,6 +82,8 @@ class TagVecDictionary : public TagVec
 
         void dumpCycleVector();
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         ZipObject* compressYourSelf(INT32 cycle, bool last=false);
 
@@ -176,6 +179,17 @@ TagVecDictionary::getType()
     return TVEType_DICTIONARY;
 }
 
+/**
+ * Returns the bytes used by the vector.
+ *
+ * @return the size.
+ */
+INT64
+TagVecDictionary::getMemSize()
+{
+    return sizeof(TagVecDictionary);
+}
+
 /**
  * Gets the value of this tag in the cycle cycle.
  *
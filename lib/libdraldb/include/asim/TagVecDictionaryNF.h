@@ -58,6 +58,7 @@ class TagVecDictionaryNF : public TagVecDictionary
 {
     public:
         TagVecDictionaryNF(INT32 bcycle);
+        TagVecDictionaryNF(DBCacheFile * cache);
         virtual ~TagVecDictionaryNF();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
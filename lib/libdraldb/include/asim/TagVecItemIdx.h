@@ -77,6 +77,7 @@ class TagVecItemIdx : public TagVec
 {
     public:
         TagVecItemIdx(INT32 bcycle);
+        TagVecItemIdx(DBCacheFile * cache);
         virtual ~TagVecItemIdx();
 
         inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
@@ -88,6 +89,8 @@ class TagVecItemIdx : public TagVec
 
         void dumpCycleVector();
         inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        void saveCache(DBCacheFile * cache);
 
         ZipObject* compressYourSelf(INT32 cycle, bool last=false);
 
@@ -149,6 +152,17 @@ TagVecItemIdx::getType()
     return TVEType_ITEMIDX;
 }
 
+/**
+ * Returns the bytes used by the vector.
+ *
+ * @return the size.
+ */
+INT64
+TagVecItemIdx::getMemSize()
+{
+    return sizeof(TagVecItemIdx);
+}
+
 /**
  * Gets the value of this tag in the cycle cycle.
  *
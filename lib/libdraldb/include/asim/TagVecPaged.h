@@ -0,0 +1,225 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DRALDB_TAGVECPAGED_H
+#define _DRALDB_TAGVECPAGED_H
+
+#include "asim/TagVec.h"
+
+/**
+  * @brief
+  * Placeholder of a cycle chunk stored in the spill file.
+  *
+  * @description
+  * The pager replaces the tag vectors that it pages out with this
+  * class, that just remembers where the vector was stored. The
+  * owner of the chunk reads the vector back before any access, so
+  * none of the tag vector methods can be called on this class.
+  *
+  * @version 0.1
+  */
+class TagVecPaged : public TagVec
+{
+    public:
+        inline TagVecPaged(INT64 offset, INT64 length);
+
+        inline bool getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle);
+        inline bool getTagValue(INT32 cycle, SOVList** value, UINT32* atcycle);
+
+        inline bool addTagValue(INT32 cycle, UINT64   value);
+        inline bool addTagValue(INT32 cycle, QString  value);
+        inline bool addTagValue(INT32 cycle, SOVList* value);
+
+        inline void dumpCycleVector();
+        inline TagVecEncodingType getType();
+        inline INT64 getMemSize();
+        inline void saveCache(DBCacheFile * cache);
+
+        inline ZipObject* compressYourSelf(INT32 cycle, bool last=false);
+
+        inline INT64 getOffset();
+        inline INT64 getLength();
+
+    protected:
+        INT64 offset; // Position of the vector in the spill file.
+        INT64 length; // Length of the vector in the spill file.
+};
+
+/**
+ * Creator of this class. Holds the position of the vector.
+ *
+ * @return new object.
+ */
+TagVecPaged::TagVecPaged(INT64 _offset, INT64 _length)
+{
+    offset = _offset;
+    length = _length;
+    we = false;
+    paged = true;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return false.
+ */
+bool
+TagVecPaged::getTagValue(INT32 cycle, UINT64* value, UINT32* atcycle)
+{
+    Q_ASSERT(false);
+    return false;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return false.
+ */
+bool
+TagVecPaged::getTagValue(INT32 cycle, SOVList** value, UINT32* atcycle)
+{
+    Q_ASSERT(false);
+    return false;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return false.
+ */
+bool
+TagVecPaged::addTagValue(INT32 cycle, UINT64 value)
+{
+    Q_ASSERT(false);
+    return false;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return false.
+ */
+bool
+TagVecPaged::addTagValue(INT32 cycle, QString value)
+{
+    Q_ASSERT(false);
+    return false;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return false.
+ */
+bool
+TagVecPaged::addTagValue(INT32 cycle, SOVList* value)
+{
+    Q_ASSERT(false);
+    return false;
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return void.
+ */
+void
+TagVecPaged::dumpCycleVector()
+{
+    Q_ASSERT(false);
+}
+
+/**
+ * Returns the type of vector.
+ *
+ * @return the type.
+ */
+TagVecEncodingType
+TagVecPaged::getType()
+{
+    return TVEType_PAGED;
+}
+
+/**
+ * Returns the bytes used by the placeholder.
+ *
+ * @return the size.
+ */
+INT64
+TagVecPaged::getMemSize()
+{
+    return sizeof(TagVecPaged);
+}
+
+/**
+ * Can't be called, the vector must be read back first.
+ *
+ * @return void.
+ */
+void
+TagVecPaged::saveCache(DBCacheFile * cache)
+{
+    Q_ASSERT(false);
+}
+
+/**
+ * The vector is already closed, nothing to compress.
+ *
+ * @return the object itself.
+ */
+ZipObject*
+TagVecPaged::compressYourSelf(INT32 cycle, bool last)
+{
+    return this;
+}
+
+/**
+ * Returns the position of the vector in the spill file.
+ *
+ * @return the offset.
+ */
+INT64
+TagVecPaged::getOffset()
+{
+    return offset;
+}
+
+/**
+ * Returns the length of the vector in the spill file.
+ *
+ * @return the length.
+ */
+INT64
+TagVecPaged::getLength()
+{
+    return length;
+}
+
+#endif
@@ -43,6 +43,7 @@
 #include "asim/ZipObject.h"
 #include "asim/TagDescVector.h"
 #include "asim/ItemHandler.h"
+#include "asim/DBListenerDef.h"
 
 /**
   * @brief
@@ -98,6 +99,7 @@ class TrackHeap : public AMemObj, public StatObj, public ZipObject
         inline bool addTagValue(INT32 trackId, UINT16 tagId,INT32 cycle, UINT64   value);
         inline bool addTagValue(INT32 trackId, UINT16 tagId,INT32 cycle, QString  value);
         inline bool addTagValue(INT32 trackId, UINT16 tagId,INT32 cycle, SOVList* value);
+        inline bool addTagValues(UINT16 tagId, UINT64 value, EENodeList* list);
 
         // -- MoveItem Consult Methods
         inline void getMoveItem(ItemHandler * handler, UINT16 edgeid,INT32 cycle,UINT16 pos=0);
@@ -114,6 +116,11 @@ class TrackHeap : public AMemObj, public StatObj, public ZipObject
 
 		void reset();
         void dumpTrackHeap();
+
+        UINT64 getTrackFingerprint();
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
 		void dumpRegression();
 
         inline void setFirstEffectiveCycle(INT32 value);
@@ -364,6 +371,24 @@ TrackHeap::addTagValue(INT32 trackId, UINT16 tagId,INT32 cycle, SOVList* value)
     return false;
 }
 
+/**
+ * Adds the same value in the tag tagId of all the tracks and cycles
+ * of the enter/exit node list.
+ *
+ * @return true if all the values are added.
+ */
+bool
+TrackHeap::addTagValues(UINT16 tagId, UINT64 value, EENodeList* list)
+{
+    bool ok = true;
+    for (EENodeList::iterator it = list->begin(); it != list->end(); ++it)
+    {
+        Q_ASSERT(it->track_id<nextTrackID);
+        ok = trackIDVector[it->track_id].addTagValue(tagId,(INT32)it->cycle-firstEffectiveCycle,value) && ok;
+    }
+    return ok;
+}
+
 // -------------------------------------------------------------------
 // -- MoveItem Consult Methods
 // -------------------------------------------------------------------
@@ -82,6 +82,10 @@ class TrackIDNode : public ZipObject
         void dumpTrackId();
         void dumpRegression();
 
+        UINT64 getFingerprint(UINT64 hash);
+        void saveCache(DBCacheFile * cache);
+        bool loadCache(DBCacheFile * cache);
+
     protected:
         void dumpTrackId_MoveItem();
         void dumpTrackId_NodeTag();
@@ -0,0 +1,392 @@
+// ==================================================
+//Copyright (C) 2003-2006 Intel Corporation
+//
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+//
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+/**
+  * @file DBCacheFile.cpp
+  */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "asim/DBCacheFile.h"
+
+/**
+ * Creator of this class. The file is neither created nor opened.
+ *
+ * @return new object.
+ */
+DBCacheFile::DBCacheFile()
+{
+    out = NULL;
+    base = NULL;
+    size = 0;
+    pos = 0;
+    limit = 0;
+    error = false;
+    spillFd = -1;
+    buffer = NULL;
+    bufferSize = 0;
+}
+
+/**
+ * Destructor of this class. Unmaps the file or discards the
+ * temporary file if it was not committed.
+ *
+ * @return destroys the object.
+ */
+DBCacheFile::~DBCacheFile()
+{
+    close();
+}
+
+/**
+ * Creates a temporary file next to filename where the blocks are
+ * appended. The file is renamed to filename by commit.
+ *
+ * @return true if the file could be created.
+ */
+bool
+DBCacheFile::create(QString filename)
+{
+    close();
+    fileName = filename;
+    tmpName = filename + "." + QString::number((long) getpid()) + ".tmp";
+    out = fopen(tmpName.toLatin1().constData(), "wb");
+    error = (out == NULL);
+    return !error;
+}
+
+/**
+ * Flushes the written blocks and gives its final name to the file.
+ * The file is discarded if any write failed.
+ *
+ * @return true if the cache was stored.
+ */
+bool
+DBCacheFile::commit()
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    if (fclose(out) != 0)
+    {
+        error = true;
+    }
+    out = NULL;
+    if (!error)
+    {
+        error = (rename(tmpName.toLatin1().constData(), fileName.toLatin1().constData()) != 0);
+    }
+    if (error)
+    {
+        unlink(tmpName.toLatin1().constData());
+    }
+    return !error;
+}
+
+/**
+ * Maps the whole file filename. The mapping is private and
+ * writable so the users of the mapped blocks can modify them
+ * without changing the file.
+ *
+ * @return true if the file could be mapped.
+ */
+bool
+DBCacheFile::open(QString filename)
+{
+    close();
+    int fd = ::open(filename.toLatin1().constData(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void * addr = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+
+    fileName = filename;
+    base = (char *) addr;
+    size = st.st_size;
+    pos = 0;
+    limit = size;
+    error = false;
+    return true;
+}
+
+/**
+ * Creates a spill file in the directory dirname. The file is
+ * removed from the directory right away, so it disappears when
+ * it is closed or the process dies.
+ *
+ * @return true if the file could be created.
+ */
+bool
+DBCacheFile::createSpill(QString dirname)
+{
+    close();
+    char * name = strdup((dirname + "/draldb.spill.XXXXXX").toLatin1().constData());
+    int fd = mkstemp(name);
+    if (fd >= 0)
+    {
+        unlink(name);
+    }
+    free(name);
+    if (fd < 0)
+    {
+        return false;
+    }
+    out = fdopen(fd, "w+b");
+    if (out == NULL)
+    {
+        ::close(fd);
+        return false;
+    }
+    spillFd = fd;
+    return true;
+}
+
+/**
+ * Unmaps the file. If the file was being created and was not
+ * committed the temporary file is removed.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::close()
+{
+    if (spillFd >= 0)
+    {
+        // The spill file was already unlinked.
+        fclose(out);
+        out = NULL;
+        spillFd = -1;
+        free(buffer);
+        buffer = NULL;
+        bufferSize = 0;
+        base = NULL;
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+        out = NULL;
+        unlink(tmpName.toLatin1().constData());
+    }
+    if (base != NULL)
+    {
+        munmap(base, (size_t) size);
+        base = NULL;
+    }
+    size = 0;
+    pos = 0;
+    limit = 0;
+    error = false;
+}
+
+/**
+ * Appends size bytes to the file. Zeros are added to keep the next
+ * block aligned.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::writeBlock(const void * data, INT64 bsize)
+{
+    static const char zeros[DBCACHE_ALIGN] = { 0 };
+
+    if ((out == NULL) || error)
+    {
+        error = true;
+        return;
+    }
+
+    INT64 pad = (DBCACHE_ALIGN - (bsize % DBCACHE_ALIGN)) % DBCACHE_ALIGN;
+    if ((bsize > 0) && (fwrite(data, 1, (size_t) bsize, out) != (size_t) bsize))
+    {
+        error = true;
+    }
+    if ((pad > 0) && (fwrite(zeros, 1, (size_t) pad, out) != (size_t) pad))
+    {
+        error = true;
+    }
+    size += bsize + pad;
+}
+
+/**
+ * Appends zeros to the file until its size is a multiple of
+ * boundary.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::padTo(INT64 boundary)
+{
+    static const char zeros[DBCACHE_ALIGN] = { 0 };
+
+    while (!error && (size % boundary))
+    {
+        writeBlock(zeros, DBCACHE_ALIGN);
+    }
+}
+
+/**
+ * Appends a string to the file, stored as its length and its UTF-8
+ * characters.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::writeString(QString str)
+{
+    QByteArray utf = str.toUtf8();
+    writeINT32(utf.length());
+    writeBlock(utf.constData(), utf.length());
+}
+
+/**
+ * Returns a pointer to the next size bytes of the mapping and moves
+ * the cursor after them.
+ *
+ * @return the block or NULL if the end of file is reached.
+ */
+const void *
+DBCacheFile::mapBlock(INT64 bsize)
+{
+    INT64 pad = (DBCACHE_ALIGN - (bsize % DBCACHE_ALIGN)) % DBCACHE_ALIGN;
+    if ((base == NULL) || error || (bsize < 0) || (pos + bsize + pad > limit))
+    {
+        error = true;
+        return NULL;
+    }
+    const void * result = base + pos;
+    pos += bsize + pad;
+    return result;
+}
+
+/**
+ * Copies the next size bytes of the mapping to data.
+ *
+ * @return true if the bytes were available.
+ */
+bool
+DBCacheFile::readBlock(void * data, INT64 bsize)
+{
+    const void * block = mapBlock(bsize);
+    if (block == NULL)
+    {
+        return false;
+    }
+    memcpy(data, block, (size_t) bsize);
+    return true;
+}
+
+/**
+ * Reads a string stored with writeString.
+ *
+ * @return the string or a null string if the end of file is reached.
+ */
+QString
+DBCacheFile::readString()
+{
+    INT32 len = readINT32();
+    const char * utf = (const char *) mapBlock(len);
+    if (utf == NULL)
+    {
+        return QString::null;
+    }
+    return QString::fromUtf8(utf, len);
+}
+
+/**
+ * Loads length bytes of the spill file starting at offset and
+ * places the cursor at their beginning. The blocks read after the
+ * seek are valid until the next seek.
+ *
+ * @return true if the bytes could be read.
+ */
+bool
+DBCacheFile::seek(INT64 offset, INT64 length)
+{
+    if ((spillFd < 0) || error || (offset < 0) || (length < 0) || (offset + length > size) || (fflush(out) != 0))
+    {
+        return false;
+    }
+    if (length > bufferSize)
+    {
+        char * nbuffer = (char *) realloc(buffer, (size_t) length);
+        if (nbuffer == NULL)
+        {
+            return false;
+        }
+        buffer = nbuffer;
+        bufferSize = length;
+    }
+    if (pread(spillFd, buffer, (size_t) length, (off_t) offset) != (ssize_t) length)
+    {
+        return false;
+    }
+    base = buffer;
+    pos = 0;
+    limit = length;
+    return true;
+}
+
+/**
+ * Maps length bytes of the spill file starting at offset, that must
+ * be aligned to the page size. The mapping is private and writable
+ * like the one of open and must be released with unmapRange.
+ *
+ * @return the mapping or NULL if it failed.
+ */
+void *
+DBCacheFile::mapRange(INT64 offset, INT64 length)
+{
+    if ((spillFd < 0) || (offset + length > size) || (fflush(out) != 0))
+    {
+        return NULL;
+    }
+    void * addr = mmap(NULL, (size_t) length, PROT_READ | PROT_WRITE, MAP_PRIVATE, spillFd, (off_t) offset);
+    return (addr == MAP_FAILED) ? NULL : addr;
+}
+
+/**
+ * Releases a mapping obtained with mapRange.
+ *
+ * @return void.
+ */
+void
+DBCacheFile::unmapRange(void * addr, INT64 length)
+{
+    munmap(addr, (size_t) length);
+}
@@ -88,10 +88,15 @@ DBConfig::reset()
 {
     autoPurge=true;
     compressMutable=true;
+    tagValueIndex=false;
+    useCache=false;
     incrementalPurge=false;
     maxIFIEnabled=false;
     tagBackPropagate=false;
     guiEnabled=false;
     itemMaxAge=0;
     maxIFI=0;
+    decodeThreads=0;
+    pagingBudget=0;
+    spillDir="";
 }
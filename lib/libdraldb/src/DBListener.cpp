@@ -89,6 +89,7 @@ DBListener::DBListener()
     tgdescvec = TagDescVector::getInstance();
     strtbl    = StrTable::getInstance();
     itHeap    = ItemTagHeap::getInstance();
+    tvIndex   = TagValueIndex::getInstance();
     conf      = DBConfig::getInstance();
     dbGraph   = DBGraph::getInstance();
     trHeap    = TrackHeap::getInstance();
@@ -146,6 +147,7 @@ DBListener::Cycle (UINT64 n)
     if (!(dcnt%CYCLE_CHUNK_SIZE))
     {
         trHeap = (TrackHeap*) (trHeap->compressYourSelf(currentCycle));
+        itHeap->spillSegments();
     }
 
     // check for item list size
@@ -213,6 +215,13 @@ DBListener::StartActivity(UINT64 _firstEffectiveCycle)
     _itemidxinid = tgdescvec->getItemIdxIn_TagId();
 }
 
+void
+DBListener::seekCycle(INT32 cycle)
+{
+    StartActivity(cycle);
+    currentCycle = cycle;
+}
+
 void
 DBListener::NewItem (UINT32 item_id)
 {
@@ -237,7 +246,6 @@ DBListener::SetTagSingleValue (UINT32 item_id, const char* tag_name,UINT64 value
 
     //printf ("SetTagSingleValue called on item_id=%u,tgname=%s,value=%llu\n",item_id,tag_name,value);fflush(stdout);
 
-    bool mutant=false;
     INT32 tagid;
     QString qtag_name(tag_name);
 
@@ -248,29 +256,11 @@ DBListener::SetTagSingleValue (UINT32 item_id, const char* tag_name,UINT64 value
         tagid = tgdescvec->tryToAlloc(qtag_name.trimmed(),TagIntegerValue);
         //printf("tagname=%s, tgid=%d\n",qtag_name.latin1(),tagid);
         Q_ASSERT(tagid>=0);
-
-        LSetTagListNode* node = new LSetTagListNode(currentCycle, tagid, value);
-        LSetTagListNode* matchingNode=NULL;
-        Q_ASSERT(node!=NULL);
-        mutant = hasTag(newItemNode->getMyTags(),tagid,currentCycle,&matchingNode);
-        newItemNode->getMyTags()->append(node);
-        if (mutant)
-        {
-            Q_ASSERT(matchingNode!=NULL);
-        	matchingNode->isMutable=1;
-        	node->isMutable=1;
-        }
+        addTagSingleValue(newItemNode, tagid, value);
     }
     else
     {
-        if (!itemWarningDumped(item_id) && itemWarnHash->count()<MAX_ITEMID_WARNS)
-        {
-            QString err ("DralDB Warning: DRAL incoherence detected, setting a tag after item deletion or before creation on ITEMID ");
-            err = err + QString::number(item_id,10);
-            myLogMgr->addLog(err);
-            hasNonCriticalErros=true;
-            addItemWarned(item_id);
-        }
+        tagOnUnknownItem(item_id);
     }
     // stats
     ++DBListener::_accTags;
@@ -279,6 +269,84 @@ DBListener::SetTagSingleValue (UINT32 item_id, const char* tag_name,UINT64 value
     DBLISTENER_DISPATCH_LISTENERS(listener->SetTagSingleValue(item_id,tag_name,value,time_span);)
 }
 
+void
+DBListener::tagOnUnknownItem(UINT32 item_id)
+{
+    if (!itemWarningDumped(item_id) && itemWarnHash->count()<MAX_ITEMID_WARNS)
+    {
+        QString err ("DralDB Warning: DRAL incoherence detected, setting a tag after item deletion or before creation on ITEMID ");
+        err = err + QString::number(item_id,10);
+        myLogMgr->addLog(err);
+        hasNonCriticalErros=true;
+        addItemWarned(item_id);
+    }
+}
+
+/**
+ * Same than calling SetTagSingleValue and NewItem for each event of
+ * the block, but the tag names are resolved once per trace and the
+ * item is only looked up when it changes.
+ *
+ * @return void.
+ */
+void
+DBListener::ItemBatch(const DRAL_ITEM_BATCH & batch, const char * const tag_names [])
+{
+    UINT32 j = 0;
+    for (UINT32 i = 0; i <= batch.numNewItems; i++)
+    {
+        // tags set before the i-th new item
+        UINT32 end = (i < batch.numNewItems) ? batch.newItemsPos[i] : batch.numTags;
+        if (!doTrackItemTags)
+        {
+            j = end;
+        }
+
+        LNewItemListNode* newItemNode = NULL;
+        UINT32 last_item = 0;
+        for (; j < end; j++)
+        {
+            UINT32 item_id = batch.tagItems[j];
+            UINT32 tag_idx = batch.tagIdxs[j];
+
+            if ((newItemNode == NULL) || (item_id != last_item))
+            {
+                newItemNode = itemList->find((long)item_id);
+                last_item = item_id;
+            }
+            if (newItemNode!=NULL)
+            {
+                while (tagIdxToTagId.size() <= tag_idx)
+                {
+                    tagIdxToTagId.append(-1);
+                }
+                INT32 tagid = tagIdxToTagId[tag_idx];
+                if (tagid < 0)
+                {
+                    tagid = tgdescvec->tryToAlloc(QString(tag_names[tag_idx]).trimmed(),TagIntegerValue);
+                    Q_ASSERT(tagid>=0);
+                    tagIdxToTagId[tag_idx] = tagid;
+                }
+                addTagSingleValue(newItemNode, tagid, batch.tagValues[j]);
+            }
+            else
+            {
+                tagOnUnknownItem(item_id);
+            }
+            // stats
+            ++DBListener::_accTags;
+
+            // extern listeners
+            DBLISTENER_DISPATCH_LISTENERS(listener->SetTagSingleValue(item_id,tag_names[tag_idx],batch.tagValues[j],0);)
+        }
+
+        if (i < batch.numNewItems)
+        {
+            NewItem(batch.newItems[i]);
+        }
+    }
+}
+
 
 void
 DBListener::SetTagString (UINT32 item_id, const char* tag_name, const char* str, UBYTE time_span)
@@ -562,6 +630,7 @@ DBListener::Do_EndSimulation()
 
     // last compression step
     trHeap = (TrackHeap*) (trHeap->compressYourSelf(currentCycle,true));
+    itHeap->spillSegments();
 
     // just to debugg
     //ColDescriptor::dumpStats();
@@ -915,6 +984,11 @@ DBListener::computeDeleteItem (UINT32 item_id)
         return false;
     }
 
+    if (conf->getTagValueIndex())
+    {
+        tvIndex->newItem(itemEntryPoint);
+    }
+
     // now check for ALL the related tags:
     if (newItemNode->hasTags())
     {
@@ -934,12 +1008,35 @@ DBListener::computeDeleteItem (UINT32 item_id)
             }
 
             if (tgnode->isMutable )
-            { tagok = tagok && mutableTagDiscriminatorAdder(item_id,tgl,tgnode); }
+            {
+                flushTagBlock(item_id);
+                tagok = tagok && mutableTagDiscriminatorAdder(item_id,itemEntryPoint,tgl,tgnode);
+            }
+            else if (tgnode->isSOV)
+            {
+                flushTagBlock(item_id);
+                tagDiscriminatorAdder(item_id,itemEntryPoint,tgnode);
+            }
             else
-            { tagDiscriminatorAdder(item_id,tgnode); }
+            {
+                // single values go to the heap together
+                UINT64 value = tgnode->data.value;
+                if (tgnode->isString)
+                {
+                    value = (UINT64) strtbl->addString(tgnode->str);
+                }
+                if (conf->getTagValueIndex())
+                {
+                    tvIndex->addValue(tgnode->tagid, value, itemEntryPoint);
+                }
+                tagBlockIds.append(tgnode->tagid);
+                tagBlockValues.append(value);
+                tagBlockCycles.append(tgnode->cycle);
+            }
 
             ++i;
         }
+        flushTagBlock(item_id);
         if (!tagok)
         {
             // tagDiscAdder produce an error... leave!
@@ -952,35 +1049,20 @@ DBListener::computeDeleteItem (UINT32 item_id)
     // now check all the enter node commands
     if (newItemNode->hasEnterNodes())
     {
-        EENodeList* mlst = newItemNode->getMyEnterNodes();
-        LEENodeListNode minode;
-        EENodeList::iterator movit;
-        for ( movit = mlst->begin(); movit != mlst->end(); ++movit )
-        {
-            minode = *movit;
-            // TODO: Should it be the item_id instead of itemEntryPoint??
-            bool ok = trHeap->addTagValue(minode.track_id,tagItemIdxInId,
-                      minode.cycle,(UINT64)itemEntryPoint);
+        // TODO: Should it be the item_id instead of itemEntryPoint??
+        bool ok = trHeap->addTagValues(tagItemIdxInId,(UINT64)itemEntryPoint,
+                  newItemNode->getMyEnterNodes());
 
-            lastProcessedEventOk = lastProcessedEventOk && ok;
-        }
+        lastProcessedEventOk = lastProcessedEventOk && ok;
         if (!lastProcessedEventOk) return false;
     }
     // now check all the exit node commands
     if (newItemNode->hasExitNodes())
     {
-        EENodeList* mlst = newItemNode->getMyExitNodes();
-        LEENodeListNode minode;
-        EENodeList::iterator movit;
-        for ( movit = mlst->begin(); movit != mlst->end(); ++movit )
-        {
-            minode = *movit;
-
-            bool ok = trHeap->addTagValue(minode.track_id,tagItemIdxInId,
-                      minode.cycle,(UINT64)itemEntryPoint);
+        bool ok = trHeap->addTagValues(tagItemIdxInId,(UINT64)itemEntryPoint,
+                  newItemNode->getMyExitNodes());
 
-            lastProcessedEventOk = lastProcessedEventOk && ok;
-        }
+        lastProcessedEventOk = lastProcessedEventOk && ok;
         if (!lastProcessedEventOk) return false;
     }
     // finally check all the moveitem commands
@@ -1023,7 +1105,7 @@ DBListener::computeDeleteItem (UINT32 item_id)
 }
 
 bool
-DBListener::mutableTagDiscriminatorAdder(INT32 itemid, NewTagList* list, LSetTagListNode* node)
+DBListener::mutableTagDiscriminatorAdder(INT32 itemid, INT32 itemEntry, NewTagList* list, LSetTagListNode* node)
 {
     if (db_listener_debug_on)
     {
@@ -1054,6 +1136,10 @@ DBListener::mutableTagDiscriminatorAdder(INT32 itemid, NewTagList* list, LSetTag
     // get the first entry
     //if (db_listener_debug_on) printf(">> first value (%d) on cycle=%d\n",(int)(node->value),(int)(node->cycle));fflush(stdout);    // mark current tag as used
     itHeap->newTag(itemid, node->tagid, node->data.value, (UINT32)(node->cycle));
+    if (conf->getTagValueIndex())
+    {
+        tvIndex->addValue(node->tagid, node->data.value, itemEntry);
+    }
 
     node->used = 1;
 
@@ -1080,6 +1166,10 @@ DBListener::mutableTagDiscriminatorAdder(INT32 itemid, NewTagList* list, LSetTag
                 printf(">> adding another value (%d) on cycle=%d\n",(int)(it_node->data.value),(int)(it_node->cycle));fflush(stdout);
             }
             itHeap->newTag(itemid, it_node->tagid, it_node->data.value,(UINT32)(it_node->cycle));
+            if (conf->getTagValueIndex())
+            {
+                tvIndex->addValue(it_node->tagid, it_node->data.value, itemEntry);
+            }
             it_node->used = 1;
         }
     }
@@ -1111,6 +1201,7 @@ DBListener::reset()
     if (itemList!=NULL)  itemList->clear();
     if (trackWarnHash!=NULL) trackWarnHash->clear();
     if (itemWarnHash!=NULL) itemWarnHash->clear();
+    tagIdxToTagId.reset();
 
     // clear track id on edges
     bzero((char*)edgeTrackIdVector,sizeof(edgeTrackIdVector));
@@ -1122,6 +1213,59 @@ void
 DBListener::trackItemTags(bool value)
 {doTrackItemTags=value;}
 
+/**
+ * Stores the state reached at the end of the trace and the
+ * statistics in the cache.
+ *
+ * @return void.
+ */
+void
+DBListener::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(currentTraceVersion);
+    cache->writeINT32(currentCycle);
+    cache->writeINT32(firstEffectiveCycle);
+    cache->writeINT32(eoSimulation);
+    cache->writeINT32(hasNonCriticalErros);
+    cache->writeUINT64(_itemCnt);
+    cache->writeUINT64(_dumyCnt);
+    cache->writeUINT64(_accLiveCycles);
+    cache->writeUINT64(_accMoveItems);
+    cache->writeUINT64(_accTags);
+    cache->writeUINT64(_accItems);
+    cache->writeUINT64(_cyclesCnt);
+}
+
+/**
+ * Restores the state stored with saveCache, as if the whole trace
+ * had been processed.
+ *
+ * @return true if the state could be read.
+ */
+bool
+DBListener::loadCache(DBCacheFile * cache)
+{
+    currentTraceVersion = (INT16) cache->readINT32();
+    currentCycle = cache->readINT32();
+    firstEffectiveCycle = cache->readINT32();
+    eoSimulation = (cache->readINT32()!=0);
+    hasNonCriticalErros = (cache->readINT32()!=0);
+    _itemCnt = cache->readUINT64();
+    _dumyCnt = cache->readUINT64();
+    _accLiveCycles = cache->readUINT64();
+    _accMoveItems = cache->readUINT64();
+    _accTags = cache->readUINT64();
+    _accItems = cache->readUINT64();
+    _cyclesCnt = cache->readUINT64();
+
+    lastProcessedEventOk = true;
+    processingDralHeader = false;
+    firstCycle = false;
+    if (itemList!=NULL) itemList->clear();
+    tagIdxToTagId.reset();
+    return cache->ok();
+}
+
 void
 DBListener::flush()
 {
@@ -0,0 +1,339 @@
+// ==================================================
+//Copyright (C) 2003-2006 Intel Corporation
+//
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+//
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+/**
+  * @file DBPager.cpp
+  */
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "asim/DBPager.h"
+#include "asim/DBConfig.h"
+#include "asim/LogMgr.h"
+#include "asim/TagVec.h"
+#include "asim/TagIdVec.h"
+
+/**
+ * The instance is NULL at the beginning.
+ */
+DBPager* DBPager::_myInstance = NULL;
+
+/**
+ * Returns the instance of the class. The first time this function
+ * is called is when the instance is created. The other times just
+ * returns the pointer.
+ *
+ * @return the instance of the class.
+ */
+DBPager*
+DBPager::getInstance()
+{
+    if (_myInstance==NULL)
+    {
+        _myInstance = new DBPager();
+    }
+    Q_ASSERT(_myInstance!=NULL);
+    return _myInstance;
+}
+
+/**
+ * Destroys the unique instance of the class. The instance is
+ * destroyed if it was previously created.
+ *
+ * @return void.
+ */
+void
+DBPager::destroy()
+{
+    if (_myInstance!=NULL)
+    {
+        delete _myInstance;
+        _myInstance = NULL;
+    }
+}
+
+/**
+ * Creator of this class. Gets the static instances and resets the
+ * pager.
+ *
+ * @return new object.
+ */
+DBPager::DBPager()
+{
+    conf = DBConfig::getInstance();
+    myLogMgr = LogMgr::getInstance();
+    spill = new DBCacheFile();
+    mru = NULL;
+    lru = NULL;
+    reset();
+}
+
+/**
+ * Destructor of this class. Releases the spill file.
+ *
+ * @return destroys the object.
+ */
+DBPager::~DBPager()
+{
+    reset();
+    delete spill;
+}
+
+/**
+ * Forgets all the chunks, unmaps the heap segments and closes the
+ * spill file. The budget is read again from the configuration. The
+ * heaps must not use the mapped segments anymore when this is
+ * called.
+ *
+ * @return void.
+ */
+void
+DBPager::reset()
+{
+    while (mru!=NULL)
+    {
+        DBPage * page = mru;
+        mru = page->next;
+        page->vec->setPage(NULL);
+        delete page;
+    }
+    lru = NULL;
+    residentBytes = 0;
+    numPages = 0;
+
+    for (UINT32 i=0;i<mappings.size();i++)
+    {
+        DBCacheFile::unmapRange(mappings[i].addr,mappings[i].length);
+    }
+    mappings.reset();
+    spill->close();
+    spillOpened = false;
+    spillFailed = false;
+
+    pageOuts = 0;
+    pageWrites = 0;
+    pageIns = 0;
+    spilledBytes = 0;
+    budget = (INT64) conf->getPagingBudget() * 1024 * 1024;
+}
+
+/**
+ * Creates the spill file the first time it is needed. The file is
+ * placed in the spill directory of the configuration, or in the
+ * temporary directory if none was given. If it cannot be created
+ * the paging is disabled.
+ *
+ * @return true if the spill file can be used.
+ */
+bool
+DBPager::openSpill()
+{
+    if (!spillOpened)
+    {
+        spillOpened = true;
+        QString dir = conf->getSpillDir();
+        if (dir.isEmpty())
+        {
+            const char * tmpdir = getenv("TMPDIR");
+            dir = ((tmpdir!=NULL) && (*tmpdir!='\0')) ? QString(tmpdir) : QString("/tmp");
+        }
+        if (!spill->createSpill(dir))
+        {
+            spillFailed = true;
+            myLogMgr->addLog("DralDB Error: unable to create a spill file in "+dir+". Paging disabled.");
+        }
+    }
+    return !spillFailed;
+}
+
+/**
+ * Adds the chunk chunk of owner, that holds vec, to the list of
+ * chunks that can be paged out. offset and length locate the copy
+ * of vec in the spill file when the vector was just read from it.
+ * The least recently used chunks are paged out while the budget
+ * is exceeded.
+ *
+ * @return void.
+ */
+void
+DBPager::addChunk(TagIdVecNode * owner, INT32 chunk, TagVec * vec, INT64 offset, INT64 length)
+{
+    Q_ASSERT(vec->getPage()==NULL);
+    DBPage * page = new DBPage;
+    page->owner = owner;
+    page->chunk = chunk;
+    page->vec = vec;
+    page->size = vec->getMemSize();
+    page->offset = offset;
+    page->length = length;
+    pushFront(page);
+    vec->setPage(page);
+    residentBytes += page->size;
+    ++numPages;
+
+    while (isEnabled() && (residentBytes>budget) && (lru!=page))
+    {
+        evict(lru);
+    }
+}
+
+/**
+ * Removes page from the list. Called when its vector is deleted.
+ *
+ * @return void.
+ */
+void
+DBPager::forgetChunk(DBPage * page)
+{
+    unlink(page);
+    residentBytes -= page->size;
+    --numPages;
+    delete page;
+}
+
+/**
+ * Writes the vector of page to the spill file if the file has no
+ * updated copy and asks its owner to replace it with a paged
+ * vector. The owner deletes the vector, and page with it.
+ *
+ * @return void.
+ */
+void
+DBPager::evict(DBPage * page)
+{
+    if (page->offset<0)
+    {
+        if (!openSpill())
+        {
+            return;
+        }
+        INT64 offset = spill->getSize();
+        spill->writeINT32((INT32) page->vec->getType());
+        page->vec->saveCache(spill);
+        if (!spill->ok())
+        {
+            spillFailed = true;
+            myLogMgr->addLog("DralDB Error: unable to write the spill file. Paging disabled.");
+            return;
+        }
+        page->offset = offset;
+        page->length = spill->getSize() - offset;
+        ++pageWrites;
+    }
+    ++pageOuts;
+    page->owner->pageOut(page->chunk,page->offset,page->length);
+}
+
+/**
+ * Places the cursor of the spill file at the copy of a chunk, so
+ * the vector can be created again from it.
+ *
+ * @return the spill file or NULL if the chunk could not be read.
+ */
+DBCacheFile *
+DBPager::readChunk(INT64 offset, INT64 length)
+{
+    if (!spill->seek(offset,length))
+    {
+        myLogMgr->addLog("DralDB Error: unable to read a chunk from the spill file.");
+        return NULL;
+    }
+    ++pageIns;
+    return spill;
+}
+
+/**
+ * Copies size bytes of a heap segment to the spill file and maps
+ * them back in memory. The mapping is released by reset.
+ *
+ * @return the mapped copy or NULL if the segment cannot be spilled.
+ */
+void *
+DBPager::spillSegment(const void * data, INT64 size)
+{
+    if (!isEnabled() || !openSpill())
+    {
+        return NULL;
+    }
+    spill->padTo(getpagesize());
+    INT64 offset = spill->getSize();
+    spill->writeBlock(data,size);
+    if (!spill->ok())
+    {
+        spillFailed = true;
+        myLogMgr->addLog("DralDB Error: unable to write the spill file. Paging disabled.");
+        return NULL;
+    }
+    void * addr = spill->mapRange(offset,size);
+    if (addr!=NULL)
+    {
+        DBSpillMapping mapping;
+        mapping.addr = addr;
+        mapping.length = size;
+        mappings.append(mapping);
+        spilledBytes += size;
+    }
+    return addr;
+}
+
+/**
+ * Returns the size of the pager structures. The paged vectors are
+ * accounted by the tracks.
+ *
+ * @return the object size.
+ */
+INT64
+DBPager::getObjSize() const
+{
+    INT64 result = sizeof(DBPager);
+    result += (INT64) numPages * sizeof(DBPage);
+    result += (INT64) mappings.capacity() * sizeof(DBSpillMapping);
+    return result;
+}
+
+/**
+ * Returns a description of the pager.
+ *
+ * @return the description.
+ */
+QString
+DBPager::getUsageDescription() const
+{
+    QString result = "";
+    result += "\t\tPaging Budget:\t\t"+QString::number(budget)+"\n";
+    result += "\t\tResident Chunk Bytes:\t"+QString::number(residentBytes)+"\n";
+    result += "\t\tResident Chunks:\t"+QString::number(numPages)+"\n";
+    result += "\t\tPage Outs:\t\t"+QString::number(pageOuts)+"\n";
+    result += "\t\tPage Writes:\t\t"+QString::number(pageWrites)+"\n";
+    result += "\t\tPage Ins:\t\t"+QString::number(pageIns)+"\n";
+    result += "\t\tSpilled Heap Bytes:\t"+QString::number(spilledBytes)+"\n";
+    result += "\t\tSpill File Size:\t"+QString::number(spill->getSize())+"\n";
+    return result;
+}
+
+/**
+ * Bypasses the call to getUsageDescription.
+ *
+ * @return the object stats.
+ */
+QString
+DBPager::getStats() const
+{
+    return getUsageDescription();
+}
@@ -20,6 +20,8 @@
   * @file Dict2064.cpp
   */
 
+#include <string.h>
+
 #include "asim/Dict2064.h"
 
 /**
@@ -83,6 +85,98 @@ Dict2064::~Dict2064()
     delete currentDict;
 }
 
+/**
+ * Frees all the dictionaries and allocs the first one again.
+ *
+ * @return void.
+ */
+void
+Dict2064::reset()
+{
+    for (INT32 i=0;i<nextDict;i++)
+    {
+        dicvec[i].clear();
+    }
+    nextDict=0;
+    allocNewDict(0);
+}
+
+/**
+ * Stores the used keys of all the dictionaries in the cache.
+ *
+ * @return void.
+ */
+void
+Dict2064::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(nextDict);
+    for (INT32 i=0;i<nextDict;i++)
+    {
+        cache->writeINT32(dicvec[i].cycle);
+        cache->writeINT32(dicvec[i].nextKey);
+        cache->writeBlock(dicvec[i].dict,(INT64) dicvec[i].nextKey*sizeof(UINT64));
+    }
+}
+
+/**
+ * Replaces the dictionaries with the ones stored in the cache. The
+ * full dictionaries use the pages of the cache directly. The last
+ * one is copied because new keys can still be added to it, and its
+ * values are inserted in the look-up hash. If false is returned
+ * the dictionary must be reset before using it again.
+ *
+ * @return true if the dictionaries could be read.
+ */
+bool
+Dict2064::loadCache(DBCacheFile * cache)
+{
+    INT32 num = cache->readINT32();
+    if ((num<=0) || (num>DICT2064_MAXDICT))
+    {
+        return false;
+    }
+
+    for (INT32 i=0;i<nextDict;i++)
+    {
+        dicvec[i].clear();
+    }
+    currentDict->clear();
+
+    for (nextDict=0;nextDict<num;nextDict++)
+    {
+        Dict2064Node* node = &dicvec[nextDict];
+        node->cycle = cache->readINT32();
+        node->nextKey = cache->readINT32();
+        UINT64* data = NULL;
+        if ((node->nextKey>=0) && (node->nextKey<=DICT2064_MAXKEY+1))
+        {
+            data = (UINT64*) cache->mapBlock((INT64) node->nextKey*sizeof(UINT64));
+        }
+        if (data==NULL)
+        {
+            // The caller must reset the dictionary.
+            node->clear();
+            return false;
+        }
+        if (nextDict<num-1)
+        {
+            node->dict = data;
+            node->owned = false;
+        }
+        else
+        {
+            node->dict = new UINT64[DICT2064_MAXKEY+1];
+            Q_ASSERT(node->dict != NULL);
+            memcpy(node->dict,data,node->nextKey*sizeof(UINT64));
+            for (INT32 key=0;key<node->nextKey;key++)
+            {
+                currentDict->insert(data[key],key);
+            }
+        }
+    }
+    return true;
+}
+
 /**
  * Just returns the number of dictionarues used.
  *
@@ -20,6 +20,9 @@
   * @file  DralDB.cpp
   */
 
+#include <string.h>
+#include <sys/stat.h>
+
 #include "asim/DralDB.h"
 
 #define DRALDB_PROCESS_STEP 4096
@@ -78,6 +81,9 @@ DralDB::DralDB()
     dbGraph       = DBGraph::getInstance();
     logMgr        = LogMgr::getInstance();
     strtable      = StrTable::getInstance();
+    dict          = Dict2064::getInstance();
+    pager         = DBPager::getInstance();
+    cacheFile     = new DBCacheFile();
     eventFile     = NULL;
     dralClient    = NULL;
     converter     = NULL;
@@ -96,6 +102,7 @@ DralDB::~DralDB()
     {
         delete converter;
     }
+    delete cacheFile;
 }
 
 // -------------------------------------------------------------------
@@ -151,7 +158,8 @@ DralDB::openDRLFile(QString filename)
     }
 
     converter = new DRAL_LISTENER_CONVERTER_CLASS(dblistener);
-    dralClient = new DRAL_CLIENT_CLASS(fd, converter, 1024 * 64);
+    dralClient = new DRAL_CLIENT_CLASS(fd, converter, 1024 * 64,
+                                       dbConfig->getDecodeThreads());
     return (dralClient!=NULL);
 }
 
@@ -186,10 +194,15 @@ DralDB::reset()
     dblistener->reset();
     trackHeap->reset();
     itemTagHeap->reset();
+    // The heaps don't use the spilled chunks and segments anymore.
+    pager->reset();
 	tagDescVector->reset();
 	dbGraph->reset();
 	strtable->reset();
-	
+    dict->reset();
+
+    // Nothing points to the cache pages after the resets.
+    cacheFile->close();
     numTrackedEdges = 0;
 }
 
@@ -227,6 +240,16 @@ DralDB::processAllEvents()
     // prepare listener
     dblistener->setTrackedEdges(numTrackedEdges);
     dblistener->propagateFirstCycle();
+
+    if (dbConfig->getUseCache())
+    {
+        INT32 loaded = loadDRLCache();
+        if (loaded!=0)
+        {
+            return (loaded>0);
+        }
+    }
+
     INT32 cmds=1;
     bool ok = true;
     while ((cmds>0) && ok )
@@ -234,7 +257,199 @@ DralDB::processAllEvents()
         cmds = dralClient->ProcessNextEvent(true,DRALDB_PROCESS_STEP);
         ok = dblistener->getLastProcessedEventOk();
     }
-    return (ok && (cmds==0));
+
+    bool result = (ok && (cmds==0));
+    if (result && dbConfig->getUseCache())
+    {
+        saveDRLCache();
+    }
+    return result;
+}
+
+/**
+ * Jumps to the last sync point of the trace at or before cycle, so
+ * the events processed next start there. The header of the trace
+ * must have been loaded and the tracks requested.
+ *
+ * @return false if the trace has no sync point to jump to.
+ */
+bool
+DralDB::seekDRLCycle(INT32 cycle)
+{
+    UINT64 syncCycle;
+    if (!dralClient->SeekCycle((UINT64) cycle, &syncCycle))
+    {
+        return false;
+    }
+
+    dblistener->setTrackedEdges(numTrackedEdges);
+    dblistener->seekCycle((INT32) syncCycle);
+    dblistener->propagateFirstCycle();
+    if (logMgr!=NULL)
+    {
+        logMgr->addLog("Jumped to the sync point at cycle "+QString::number((INT32) syncCycle));
+    }
+    return true;
+}
+
+/**
+ * Process the events between two cycles. If the trace has sync
+ * points the events before first are skipped, otherwise they are
+ * processed too. Some events after last may be processed. The
+ * database is never saved to the cache file.
+ *
+ * @return true if the events were loaded correctly.
+ */
+bool
+DralDB::processCycleWindow(INT32 first, INT32 last)
+{
+    if (!seekDRLCycle(first))
+    {
+        dblistener->setTrackedEdges(numTrackedEdges);
+        dblistener->propagateFirstCycle();
+    }
+
+    INT32 cmds=1;
+    bool ok = true;
+    while ((cmds>0) && ok && (dblistener->getCurrentCycle()<=last))
+    {
+        cmds = dralClient->ProcessNextEvent(true,DRALDB_PROCESS_STEP);
+        ok = dblistener->getLastProcessedEventOk();
+    }
+    return ok && (cmds>=0);
+}
+
+/**
+ * Fills key with the values that a cache file must match to be
+ * used with the open trace: the format and layout of the file, the
+ * size and modification time of the trace, the configuration that
+ * changes the stored data and the requested tracks.
+ *
+ * @return false if the trace file can not be examined.
+ */
+bool
+DralDB::getCacheKey(UINT64 * key)
+{
+    struct stat st;
+    if ((eventFile==NULL) || (stat(eventFile->fileName().toLatin1().constData(),&st)!=0))
+    {
+        return false;
+    }
+
+    UINT32 probe = 1;
+    UINT64 layout = (UINT64) sizeof(TagHeapChunk)
+                  | ((UINT64) sizeof(ItemHeapNode) << 8)
+                  | ((UINT64) sizeof(TagVecDictionaryNode) << 16)
+                  | ((UINT64) sizeof(TagValueBucket) << 24)
+                  | ((UINT64) sizeof(void *) << 32)
+                  | ((UINT64) *((UINT8 *) &probe) << 40);
+
+    UINT64 config = (UINT64) dblistener->getTrackItemTags()
+                  | ((UINT64) dbConfig->getCompressMutable() << 1)
+                  | ((UINT64) dbConfig->getAutoPurge() << 2)
+                  | ((UINT64) dbConfig->getIncrementalPurge() << 3)
+                  | ((UINT64) dbConfig->getMaxIFIEnabled() << 4)
+                  | ((UINT64) dbConfig->getTagValueIndex() << 5);
+
+    key[0] = DRALDB_CACHE_MAGIC;
+    key[1] = DBCACHE_FORMAT_VERSION;
+    key[2] = layout;
+    key[3] = (UINT64) st.st_size;
+    key[4] = (UINT64) st.st_mtime;
+    key[5] = config;
+    key[6] = (UINT64) dbConfig->getItemMaxAge();
+    key[7] = (UINT64) dbConfig->getMaxIFI();
+    key[8] = trackHeap->getTrackFingerprint();
+    key[9] = (UINT64) dblistener->getFirstEffectiveCycle();
+    return true;
+}
+
+/**
+ * Loads the database of the open trace from its cache file. The
+ * header of the trace must have been loaded and the tracks must
+ * have been requested, so the cache is only used if it was built
+ * with the same ones. The big vectors of the database use the pages
+ * of the file directly.
+ *
+ * @return 1 if the database was loaded, 0 if there's no usable
+ * cache (the database is not modified) and -1 if the cache is
+ * corrupted (the database is reset and the trace must be opened
+ * again).
+ */
+INT32
+DralDB::loadDRLCache()
+{
+    UINT64 key[DRALDB_CACHE_KEY_WORDS];
+    UINT64 ckey[DRALDB_CACHE_KEY_WORDS];
+
+    if (dblistener->hasExternListeners() || !getCacheKey(key))
+    {
+        return 0;
+    }
+    if (!cacheFile->open(eventFile->fileName() + DRALDB_CACHE_SUFFIX))
+    {
+        return 0;
+    }
+    if (!cacheFile->readBlock(ckey,sizeof(ckey)) || (memcmp(key,ckey,sizeof(key))!=0))
+    {
+        cacheFile->close();
+        return 0;
+    }
+
+    bool ok = strtable->loadCache(cacheFile) &&
+              tagDescVector->loadCache(cacheFile) &&
+              dict->loadCache(cacheFile) &&
+              trackHeap->loadCache(cacheFile) &&
+              itemTagHeap->loadCache(cacheFile) &&
+              dblistener->loadCache(cacheFile) &&
+              (cacheFile->readUINT64()==DRALDB_CACHE_END);
+    if (!ok)
+    {
+        logMgr->addLog("Corrupted cache file: " + eventFile->fileName() + DRALDB_CACHE_SUFFIX);
+        reset();
+        return -1;
+    }
+
+    logMgr->addLog("Database loaded from cache file: " + eventFile->fileName() + DRALDB_CACHE_SUFFIX);
+    return 1;
+}
+
+/**
+ * Saves the database of the fully processed trace to its cache
+ * file. Nothing is saved if other listeners are attached, because
+ * they would not get any event when the cache is loaded, or if some
+ * item is still alive.
+ *
+ * @return true if the cache file was written.
+ */
+bool
+DralDB::saveDRLCache()
+{
+    UINT64 key[DRALDB_CACHE_KEY_WORDS];
+
+    dblistener->flush();
+    if (dblistener->hasExternListeners() || (dblistener->getNumLiveItems()>0) ||
+        cacheFile->isMapped() || !getCacheKey(key))
+    {
+        return false;
+    }
+
+    DBCacheFile cache;
+    if (!cache.create(eventFile->fileName() + DRALDB_CACHE_SUFFIX))
+    {
+        logMgr->addLog("Unable to create cache file: " + eventFile->fileName() + DRALDB_CACHE_SUFFIX);
+        return false;
+    }
+
+    cache.writeBlock(key,sizeof(key));
+    strtable->saveCache(&cache);
+    tagDescVector->saveCache(&cache);
+    dict->saveCache(&cache);
+    trackHeap->saveCache(&cache);
+    itemTagHeap->saveCache(&cache);
+    dblistener->saveCache(&cache);
+    cache.writeUINT64(DRALDB_CACHE_END);
+    return cache.commit();
 }
 
 // -------------------------------------------------------------------
@@ -0,0 +1,112 @@
+/* 
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+  * @file ItemIdIndex.cpp
+  */
+
+#include <string.h>
+
+#include "asim/ItemIdIndex.h"
+
+/**
+ * Creator of this class. No chunk is allocated until the first
+ * item id is inserted.
+ *
+ * @return new object.
+ */
+ItemIdIndex::ItemIdIndex()
+{
+    sparse = new Hash6431(ITEMIDX_SPARSE_BUCKETS);
+    Q_ASSERT(sparse != NULL);
+    bzero((char *) dense, sizeof(dense));
+    numDenseChunks = 0;
+    clear();
+}
+
+/**
+ * Destructor of this class. Frees the chunks and the hash.
+ *
+ * @return destroys the object.
+ */
+ItemIdIndex::~ItemIdIndex()
+{
+    clear();
+    delete sparse;
+}
+
+/**
+ * Removes all the mappings.
+ *
+ * @return void.
+ */
+void
+ItemIdIndex::clear()
+{
+    for (INT32 i = 0; (i < ITEMIDX_NUM_CHUNKS) && (numDenseChunks > 0); i++)
+    {
+        if (dense[i] != NULL)
+        {
+            delete [] dense[i];
+            dense[i] = NULL;
+            numDenseChunks--;
+        }
+    }
+    bzero((char *) sparseCnt, sizeof(sparseCnt));
+    sparse->clear();
+    lastChunk = -1;
+}
+
+/**
+ * Allocates the chunk and marks all its ids as not mapped.
+ *
+ * @return void.
+ */
+void
+ItemIdIndex::allocateChunk(UINT32 chunk)
+{
+    dense[chunk] = new INT32[ITEMIDX_CHUNK_SIZE];
+    Q_ASSERT(dense[chunk] != NULL);
+    memset(dense[chunk], 0xff, ITEMIDX_CHUNK_SIZE * sizeof(INT32));
+    numDenseChunks++;
+}
+
+/**
+ * Returns the memory used by the index.
+ *
+ * @return the size in bytes.
+ */
+INT64
+ItemIdIndex::getObjSize() const
+{
+    return sizeof(ItemIdIndex) +
+           (INT64) numDenseChunks * ITEMIDX_CHUNK_SIZE * sizeof(INT32) +
+           ITEMIDX_SPARSE_BUCKETS * sizeof(Hash6431Node);
+}
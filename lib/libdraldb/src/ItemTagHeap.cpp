@@ -25,6 +25,93 @@
 #include "asim/StrTable.h"
 #include "asim/PrimeList.h"
 #include "asim/ItemHandler.h"
+#include "asim/DBPager.h"
+
+/**
+ * Stores the segments of vector used by the first numEntries
+ * positions. Whole segments are stored so they can be mapped back.
+ *
+ * @return void.
+ */
+template<class T, int SEGMENTSIZE, int MAXSEGMENTS>
+static void
+saveVectorCache(DBCacheFile * cache, AEVector<T, SEGMENTSIZE, MAXSEGMENTS> * vector, INT32 numEntries)
+{
+    INT32 segSize = vector->getSegmentSize();
+    INT32 numSegs = (numEntries + segSize - 1) / segSize;
+
+    cache->writeINT32(numSegs);
+    for (INT32 i = 0; i < numSegs; i++)
+    {
+        T * segment = vector->getSegment(i);
+        cache->writeINT32(segment != NULL);
+        if (segment != NULL)
+        {
+            cache->writeBlock(segment, (INT64) segSize * sizeof(T));
+        }
+    }
+}
+
+/**
+ * Maps the segments stored with saveVectorCache into vector. The
+ * segments point to the cache pages.
+ *
+ * @return true if the segments could be mapped.
+ */
+template<class T, int SEGMENTSIZE, int MAXSEGMENTS>
+static bool
+loadVectorCache(DBCacheFile * cache, AEVector<T, SEGMENTSIZE, MAXSEGMENTS> * vector)
+{
+    INT32 segSize = vector->getSegmentSize();
+    INT32 numSegs = cache->readINT32();
+
+    if ((numSegs < 0) || (numSegs > MAXSEGMENTS))
+    {
+        return false;
+    }
+    for (INT32 i = 0; i < numSegs; i++)
+    {
+        if (cache->readINT32())
+        {
+            T * segment = (T *) cache->mapBlock((INT64) segSize * sizeof(T));
+            if (segment == NULL)
+            {
+                return false;
+            }
+            vector->mapSegment(i, segment);
+        }
+    }
+    return cache->ok();
+}
+
+/**
+ * Moves to the spill file the segments of vector that are before
+ * the one where the entry numEntries goes. These segments are not
+ * written anymore, so they are mapped from the spill file and the
+ * kernel can drop and reload their pages when memory is needed.
+ *
+ * @return void.
+ */
+template<class T, int SEGMENTSIZE, int MAXSEGMENTS>
+static void
+spillVectorSegments(DBPager * pager, AEVector<T, SEGMENTSIZE, MAXSEGMENTS> * vector, INT32 numEntries)
+{
+    INT32 segSize = vector->getSegmentSize();
+    INT32 numSegs = numEntries / segSize;
+
+    for (INT32 i = 0; i < numSegs; i++)
+    {
+        if (vector->isOwnedSegment(i))
+        {
+            T * segment = (T *) pager->spillSegment(vector->getSegment(i), (INT64) segSize * sizeof(T));
+            if (segment == NULL)
+            {
+                return;
+            }
+            vector->mapSegment(i, segment);
+        }
+    }
+}
 
 /**
  * The instance is NULL at the beginning.
@@ -81,9 +168,9 @@ ItemTagHeap::ItemTagHeap()
     dict = Dict2064::getInstance();
     conf = DBConfig::getInstance();
 
-    // the lookup cache
-    lookUpCache = new Q3IntCache<UINT32>(CACHED_ITEMIDS,PrimeList::nearPrime(CACHED_ITEMIDS));
-    lookUpCache->setAutoDelete(true);
+    // the item id to item entry index
+    itemIndex = new ItemIdIndex();
+    tvIndex = TagValueIndex::getInstance();
 
     reset();
 }
@@ -97,7 +184,7 @@ ItemTagHeap::~ItemTagHeap()
 {
     delete itemVector;
     delete tagVector;
-    delete lookUpCache;
+    delete itemIndex;
 }
 
 /**
@@ -111,6 +198,78 @@ ItemTagHeap::reset()
     firstEffectiveCycle = -99999;
     nextItemVectorEntry = 0;
     nextTagVectorEntry = 1;
+    itemVector->releaseMappedSegments();
+    tagVector->releaseMappedSegments();
+    itemIndex->clear();
+    tvIndex->reset();
+}
+
+/**
+ * Moves the filled segments of the item and tag vectors to the
+ * spill file of the pager. Does nothing if the paging is disabled.
+ *
+ * @return void.
+ */
+void
+ItemTagHeap::spillSegments()
+{
+    DBPager * pager = DBPager::getInstance();
+    if (!pager->isEnabled())
+    {
+        return;
+    }
+    spillVectorSegments(pager, itemVector, nextItemVectorEntry);
+    spillVectorSegments(pager, tagVector, nextTagVectorEntry);
+}
+
+/**
+ * Stores the items and their tags in the cache. The tag-value index
+ * is stored too, the item id index is rebuilt when loaded.
+ *
+ * @return void.
+ */
+void
+ItemTagHeap::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(firstEffectiveCycle);
+    cache->writeINT32(nextItemVectorEntry);
+    cache->writeINT32(nextTagVectorEntry);
+    saveVectorCache(cache, itemVector, nextItemVectorEntry);
+    saveVectorCache(cache, tagVector, nextTagVectorEntry);
+    tvIndex->saveCache(cache);
+}
+
+/**
+ * Replaces the content of the heap with the one stored in the
+ * cache. The item and tag vectors use the cache pages, they are
+ * released in the next reset.
+ *
+ * @return true if the heap could be read.
+ */
+bool
+ItemTagHeap::loadCache(DBCacheFile * cache)
+{
+    reset();
+    firstEffectiveCycle = cache->readINT32();
+    nextItemVectorEntry = cache->readINT32();
+    nextTagVectorEntry = cache->readINT32();
+    if ((nextItemVectorEntry < 0) || (nextItemVectorEntry > MAX_ITEM_ENTRIES) || (nextTagVectorEntry < 1))
+    {
+        return false;
+    }
+    if (!loadVectorCache(cache, itemVector) || !loadVectorCache(cache, tagVector))
+    {
+        return false;
+    }
+    for (INT32 i = 0; i < nextItemVectorEntry; i++)
+    {
+        if (!itemVector->hasElement(i))
+        {
+            return false;
+        }
+        itemIndex->insert(itemVector->at(i).itemId, i);
+    }
+    return tvIndex->loadCache(cache);
 }
 
 /**
@@ -143,6 +302,68 @@ ItemTagHeap::newTag(INT32 item_id, UINT16 tag_id, SOVList * list, UINT32 cycle)
     }
 }
 
+/**
+ * Inserts n single values to the item item_id. Is the same than calling
+ * newTag for each value, but the item is looked up only once and the
+ * slots are just appended when all the tags are new for the item.
+ *
+ * @return void.
+ */
+void
+ItemTagHeap::newTags(INT32 item_id, UINT32 n, const UINT16 tag_ids[], const UINT64 values[], const UINT32 cycles[])
+{
+    ItemHandler handler;    ///< Used to store the new tags.
+    TagHeapNode * tag_node; ///< Pointer used to store the values.
+    bool repeated;          ///< A tag has more than one value.
+    UINT32 i;
+    UINT32 j;
+
+    // Gets a handler for the item.
+    lookForItemId(&handler, item_id);
+
+    Q_ASSERT(handler.isValidItemHandler());
+
+    // Looks for tags already set or repeated inside the block.
+    repeated = false;
+    while(!repeated && skipToNextTag(&handler))
+    {
+        UINT16 tag_id = tagVector->ref(handler.chunkIdx).content[handler.tagIdx].tagId;
+        for(i = 0; (i < n) && !repeated; i++)
+        {
+            repeated = (tag_ids[i] == tag_id);
+        }
+    }
+    for(i = 1; (i < n) && !repeated; i++)
+    {
+        for(j = 0; (j < i) && !repeated; j++)
+        {
+            repeated = (tag_ids[i] == tag_ids[j]);
+        }
+    }
+
+    if(repeated)
+    {
+        // Mutable tags: each value must find its place.
+        for(i = 0; i < n; i++)
+        {
+            newTag(item_id, tag_ids[i], values[i], cycles[i]);
+        }
+        return;
+    }
+
+    for(i = 0; i < n; i++)
+    {
+        Q_ASSERT(tag_ids[i] != canonicalItemId);
+
+        tag_node = allocateNewSlot(&handler);
+        tag_node->dkey = dict->getKeyFor(values[i], cycles[i] - firstEffectiveCycle);
+        tag_node->cycle = cycles[i] - firstEffectiveCycle;
+        tag_node->tagId = tag_ids[i];
+        tag_node->isSOV = 0;
+        tag_node->isMutable = 0;
+    }
+}
+
 /**
  * Inserts a new value for the tag tag_id to the item item_id.
  *
@@ -402,39 +623,16 @@ ItemTagHeap::rewindToFirstTagValue(ItemHandler * handler)
 bool
 ItemTagHeap::lookForItemId(ItemHandler * handler, INT32 itemid)
 {
-    UINT32 * pt; ///< Used to know the cache hit.
-    INT32 i;     ///< Used to make the linear search.
+    INT32 i; ///< Position of the item in the item vector.
 
-    // TODO : direct mapping??
-    // Tries to find the mapping in the lookup cache.
-    pt = lookUpCache->find((long) itemid);
-    if(pt != NULL)
-    {
-        handler->itemIdx = * pt;
-    }
-    else
+    i = itemIndex->find(itemid);
+    if(i < 0)
     {
-        // If unlucky perform a search.
-        i = 0;
-        // Runs through all the item vector until finds the item.
-        while(i < nextItemVectorEntry && itemVector->ref(i).itemId != itemid)
-        {
-            i++;
-        }
-
-        // Looks if found.
-        if(i == nextItemVectorEntry)
-        {
-            // We haven't found it, so we return an invalid handler.
-            handler->invalid();
-            return false;
-        }
-        else
-        {
-            lookUpCache->insert((long) itemid, new UINT32(i));
-            handler->itemIdx = i;
-        }
+        // We haven't found it, so we return an invalid handler.
+        handler->invalid();
+        return false;
     }
+    handler->itemIdx = i;
     handler->valid_item = true;
     resetTagState(handler);
     return true;
@@ -838,189 +1036,206 @@ ItemTagHeap::isMutable(ItemHandler * handler)
 }
 
 /**
- * Finds where the target_tagid has the value target_value.
+ * Points the handler to the item stored in the item vector entry
+ * item and gets the value of the tag target_tagid at cycle. The
+ * handler is left pointing to the tag.
+ *
+ * @return true if the item has a value for the tag at cycle.
+ */
+bool
+ItemTagHeap::getItemEntryTag(ItemHandler * handler, INT32 item, UINT16 target_tagid, UINT32 cycle, UINT64 * value)
+{
+    TagValueType tgvtype; ///< Unused type of the tag.
+    INT16 tgbase;         ///< Unused base of the tag.
+    UINT64 tgwhen;        ///< Unused cycle when the value was set.
+
+    handler->itemIdx = item;
+    handler->valid_item = true;
+    return getTagById(handler, target_tagid, value, &tgvtype, &tgbase, &tgwhen, cycle, true);
+}
+
+/**
+ * Finds the first item from the item vector entry start_item
+ * where the target_tagid has the value target_value at cycle. If
+ * the tag-value index has all the items only the items that had
+ * the value at some point are checked, otherwise all the items
+ * are scanned. The handler points to the tag of the found item or
+ * is invalid if no item matches.
  *
  * @return void.
  */
 void
 ItemTagHeap::lookForIntegerValue(ItemHandler * handler, UINT16 target_tagid, UINT64 target_value, UINT32 cycle, INT32 start_item)
 {
-    // TODO
-    Q_ASSERT(false);
-/*    INT32 pos = starting_point;
-    INT32 itemIdPos = -1;
-    UINT16 tagId;
-    UINT16 itemId_TagId = TagDescVector::getItemId_TagId();
-
-    INT16  tgbase;
-    TagValueType tgvtype;
-    UINT64 tgvalue;
-    UINT64 tgwhen;
-
-    bool fnd = false;
-    while ( (!fnd) && (pos<nextEntry) )
-    {
-        tagId = aetagvector->at(pos).tagId;
-        if (tagId==itemId_TagId)
-        {
-            itemIdPos=pos;
-        }
-        if (tagId==target_tagid)
+    UINT64 value; ///< Value of the tag in the checked item.
+
+    start_item = qMax(start_item, 0);
+
+    // The ITEMID is not stored as a tag, use the item id index.
+    if(target_tagid == canonicalItemId)
+    {
+        INT32 item = itemIndex->find((INT32) target_value);
+        if((item >= start_item) && getItemEntryTag(handler, item, target_tagid, cycle, &value))
         {
-            bool ok = getTag(pos,&tgvalue,&tgvtype,&tgbase,&tgwhen,cycle);
-            fnd = ok && (tgvalue == target_value);
+            return;
         }
-        ++pos;
     }
-
-    INT32 result;
-    if (fnd)
+    else if(tvIndex->covers(nextItemVectorEntry))
     {
-        result = (itemIdPos);
-        *tgPos = pos-1;
+        INT32 list = tvIndex->findList(target_tagid, target_value);
+        if(list >= 0)
+        {
+            // The list has the items that had the value at any cycle.
+            for(INT32 pos = tvIndex->lowerBound(list, start_item); pos < tvIndex->getListSize(list); pos++)
+            {
+                if(getItemEntryTag(handler, tvIndex->getListItem(list, pos), target_tagid, cycle, &value) && (value == target_value))
+                {
+                    return;
+                }
+            }
+        }
     }
     else
     {
-        result = -1;
+        for(INT32 item = start_item; item < nextItemVectorEntry; item++)
+        {
+            if(getItemEntryTag(handler, item, target_tagid, cycle, &value) && (value == target_value))
+            {
+                return;
+            }
+        }
     }
-    return (result);*/
+
+    // Not found.
+    handler->invalid();
 }
 
 /**
- * Finds where the target_tagid has the value target_value.
+ * Finds the first item from the item vector entry start_item
+ * where the string tag target_tagid has one of the string table
+ * indexes set in strIds at cycle. With the tag-value index, the
+ * list of each matching string is checked and the lowest item is
+ * kept. The handler points to the tag of the found item or is
+ * invalid if no item matches.
  *
- * @return the item_id of the item that matched the value.
+ * @return void.
  */
 void
-ItemTagHeap::lookForStrValue(ItemHandler * handler, UINT16 target_tagid, QString target_value, bool csensitive, bool exactMatch, UINT32 cycle, INT32 start_item)
+ItemTagHeap::lookForStrIds(ItemHandler * handler, UINT16 target_tagid, const QBitArray & strIds, UINT32 cycle, INT32 start_item)
 {
-    // TODO
-    Q_ASSERT(false);
-/*    if (starting_point<0)
-    {
-        return (-1);
-    }
+    UINT64 value; ///< Value of the tag in the checked item.
 
-    StrTable* strtbl = StrTable::getInstance();
+    start_item = qMax(start_item, 0);
 
-    INT32 pos = starting_point;
-    INT32 itemIdPos = -1;
-    UINT16 tagId;
-    UINT16 itemId_TagId = TagDescVector::getItemId_TagId();
-
-    INT16  tgbase;
-    TagValueType tgvtype;
-    UINT64 tgvalue;
-    UINT64 tgwhen;
-
-    if (!csensitive)
+    if(tvIndex->covers(nextItemVectorEntry))
     {
-        target_value = target_value.upper();
-    }
+        INT32 best = nextItemVectorEntry; ///< Lowest matching item.
+        INT32 bestStr = -1;               ///< String of the lowest matching item.
 
-    bool fnd = false;
-    while ( (!fnd) && (pos<nextEntry) )
-    {
-        tagId = aetagvector->at(pos).tagId;
-        if (tagId==itemId_TagId)
-        {
-            itemIdPos=pos;
-        }
-        if (tagId==target_tagid)
+        for(INT32 str = 0; str < strIds.size(); str++)
         {
-            bool ok = getTag(pos,&tgvalue,&tgvtype,&tgbase,&tgwhen,cycle);
-            QString fvalue = strtbl->getString((INT32)tgvalue);
-            if (ok && (fvalue!=QString::null))
+            if(!strIds.testBit(str))
             {
-                if (exactMatch)
-                {
-                    if (!csensitive)
-                    {
-                        fvalue = fvalue.upper();
-                    }
-                    fnd = (fvalue==target_value);
-                }
-                else
+                continue;
+            }
+            INT32 list = tvIndex->findList(target_tagid, (UINT64) str);
+            if(list < 0)
+            {
+                continue;
+            }
+            for(INT32 pos = tvIndex->lowerBound(list, start_item); (pos < tvIndex->getListSize(list)) && (tvIndex->getListItem(list, pos) < best); pos++)
+            {
+                if(getItemEntryTag(handler, tvIndex->getListItem(list, pos), target_tagid, cycle, &value) && (value == (UINT64) str))
                 {
-                    fnd = (fvalue.contains(target_value,csensitive)>0);
+                    best = tvIndex->getListItem(list, pos);
+                    bestStr = str;
+                    break;
                 }
             }
         }
-        ++pos;
-    }
 
-    INT32 result;
-    if (fnd)
-    {
-        result = itemIdPos;
-        *tgPos = pos-1;
+        // Points again the handler to the best match.
+        if((bestStr >= 0) && getItemEntryTag(handler, best, target_tagid, cycle, &value))
+        {
+            return;
+        }
     }
     else
     {
-        result = -1;
+        for(INT32 item = start_item; item < nextItemVectorEntry; item++)
+        {
+            if(getItemEntryTag(handler, item, target_tagid, cycle, &value) && (value < (UINT64) strIds.size()) && strIds.testBit((INT32) value))
+            {
+                return;
+            }
+        }
     }
-    return (result);*/
+
+    // Not found.
+    handler->invalid();
 }
 
 /**
- * Finds where the target_tagid matches the regular expression
- * target_value.
+ * Finds where the target_tagid has the value target_value. The
+ * strings of the string table are matched once and then the items
+ * are searched by string index.
  *
- * @return the item_id of the item that matched the value.
+ * @return void.
  */
 void
-ItemTagHeap::lookForStrValue(ItemHandler * handler, UINT16 target_tagid, QRegExp target_value, UINT32 cycle, INT32 start_item)
+ItemTagHeap::lookForStrValue(ItemHandler * handler, UINT16 target_tagid, QString target_value, bool csensitive, bool exactMatch, UINT32 cycle, INT32 start_item)
 {
-    // TODO
-    Q_ASSERT(false);
-/*    if (starting_point<0)
+    StrTable * strtbl = StrTable::getInstance();
+
+    // A single string can match, search it as an integer.
+    if(exactMatch && csensitive)
     {
-        return (-1);
+        INT32 str = strtbl->lookForStr(target_value);
+        if(str < 0)
+        {
+            handler->invalid();
+            return;
+        }
+        lookForIntegerValue(handler, target_tagid, (UINT64) str, cycle, start_item);
+        return;
     }
 
-    StrTable* strtbl = StrTable::getInstance();
-    UINT16 itemId_TagId = TagDescVector::getItemId_TagId();
-
-    INT32 pos = starting_point;
-    INT32 itemIdPos = -1;
-    UINT16 tagId;
-
-    INT16  tgbase;
-    TagValueType tgvtype;
-    UINT64 tgvalue;
-    UINT64 tgwhen;
+    Qt::CaseSensitivity cs = csensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    QBitArray strIds(strtbl->getNumStrings());
 
-    bool fnd = false;
-    while ( (!fnd) && (pos<nextEntry) )
+    for(INT32 str = 0; str < strIds.size(); str++)
     {
-        tagId = aetagvector->at(pos).tagId;
-        if (tagId==itemId_TagId)
+        QString fvalue = strtbl->getString(str);
+        if(exactMatch)
         {
-            itemIdPos=pos;
+            strIds.setBit(str, fvalue.compare(target_value, cs) == 0);
         }
-        if (tagId==target_tagid)
+        else
         {
-            bool ok = getTag(pos,&tgvalue,&tgvtype,&tgbase,&tgwhen,cycle);
-            QString fvalue = strtbl->getString((INT32)tgvalue);
-            if (ok && (fvalue!=QString::null))
-            {
-                fnd = (fvalue.contains(target_value)>0);
-            }
+            strIds.setBit(str, fvalue.contains(target_value, cs));
         }
-        ++pos;
     }
+    lookForStrIds(handler, target_tagid, strIds, cycle, start_item);
+}
 
-    INT32 result;
-    if (fnd)
-    {
-        result = itemIdPos;
-        *tgPos = pos-1;
-    }
-    else
+/**
+ * Finds where the target_tagid matches the regular expression
+ * target_value. The strings of the string table are matched once
+ * and then the items are searched by string index.
+ *
+ * @return void.
+ */
+void
+ItemTagHeap::lookForStrValue(ItemHandler * handler, UINT16 target_tagid, QRegExp target_value, UINT32 cycle, INT32 start_item)
+{
+    StrTable * strtbl = StrTable::getInstance();
+    QBitArray strIds(strtbl->getNumStrings());
+
+    for(INT32 str = 0; str < strIds.size(); str++)
     {
-        result = -1;
+        strIds.setBit(str, strtbl->getString(str).contains(target_value));
     }
-    return (result);*/
+    lookForStrIds(handler, target_tagid, strIds, cycle, start_item);
 }
 
 
@@ -1241,7 +1456,8 @@ ItemTagHeap::getObjSize() const
 {
     INT64 alloc;
     alloc = itemVector->getNumSegments() * itemVector->getSegmentSize() * sizeof(ItemHeapNode);
-    alloc = tagVector->getNumSegments() * tagVector->getSegmentSize() * sizeof(TagHeapChunk);
+    alloc += tagVector->getNumSegments() * tagVector->getSegmentSize() * sizeof(TagHeapChunk);
+    alloc += itemIndex->getObjSize();
     return sizeof(ItemTagHeap) + alloc;
 }
 
@@ -1258,6 +1474,7 @@ ItemTagHeap::getUsageDescription() const
     result += "\tItem Entries per Segment:\t" + QString::number(itemVector->getSegmentSize()) + "\n";
     result += "\tAllocated Tags:\t" + QString::number(tagVector->getNumSegments()) + "\n";
     result += "\tTag Entries per Segment:\t" + QString::number(tagVector->getSegmentSize()) + "\n";
+    result += "\tItem Id Index Chunks:\t" + QString::number(itemIndex->getNumDenseChunks()) + "\n";
     return result;
 }
 
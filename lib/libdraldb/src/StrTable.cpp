@@ -152,6 +152,46 @@ StrTable::reset()
     idxhash->clear();
 }
 
+/**
+ * Stores all the strings in the cache, in index order.
+ *
+ * @return void.
+ */
+void
+StrTable::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(nextIdx);
+    for (INT32 i=0;i<nextIdx;i++)
+    {
+        cache->writeString(getString(i));
+    }
+}
+
+/**
+ * Replaces the content of the table with the strings stored in the
+ * cache. The strings get the same indexes they had when saved.
+ *
+ * @return true if the strings could be read.
+ */
+bool
+StrTable::loadCache(DBCacheFile * cache)
+{
+    INT32 num = cache->readINT32();
+    if (num<0)
+    {
+        return false;
+    }
+    reset();
+    for (INT32 i=0;(i<num) && cache->ok();i++)
+    {
+        if (addString(cache->readString())!=i)
+        {
+            return false;
+        }
+    }
+    return cache->ok();
+}
+
 /**
  * Computes the total size of the object to know the memory used.
  *
@@ -202,6 +202,74 @@ TagDescVector::reset()
     Q_ASSERT(itemIdxIn_TagId==2);
 }
 
+/**
+ * Stores all the tag descriptors and long descriptions in the cache.
+ *
+ * @return void.
+ */
+void
+TagDescVector::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(nextIdx);
+    for (INT32 i=0;i<nextIdx;i++)
+    {
+        cache->writeString(getTagDescription(i));
+        cache->writeINT32((INT32) getTagValueType(i));
+        cache->writeINT32((INT32) getTagValueBase(i));
+    }
+
+    cache->writeINT32(longHash->count());
+    Q3DictIterator<QString> it( *longHash );
+    for( ; it.current(); ++it )
+    {
+        cache->writeString(it.currentKey());
+        cache->writeString(*it.current());
+    }
+}
+
+/**
+ * Replaces the tag descriptors with the ones stored in the cache.
+ * The tags get the same ids they had when saved.
+ *
+ * @return true if the descriptors could be read.
+ */
+bool
+TagDescVector::loadCache(DBCacheFile * cache)
+{
+    INT32 num = cache->readINT32();
+    if (num<3)
+    {
+        return false;
+    }
+    reset();
+    for (INT32 i=0;(i<num) && cache->ok();i++)
+    {
+        QString desc = cache->readString();
+        TagValueType type = (TagValueType) cache->readINT32();
+        INT16 base = (INT16) cache->readINT32();
+        if (i<nextIdx)
+        {
+            // The special tags are added by reset.
+            if (desc!=getTagDescription(i))
+            {
+                return false;
+            }
+        }
+        else if (addTagDescription(desc,type,base)!=i)
+        {
+            return false;
+        }
+    }
+
+    INT32 numLong = cache->readINT32();
+    for (INT32 i=0;(i<numLong) && cache->ok();i++)
+    {
+        QString tgName = cache->readString();
+        setTagLongDesc(tgName,cache->readString());
+    }
+    return cache->ok();
+}
+
 /**
  * Returns a list of the known tags in the vector.
  *
@@ -21,11 +21,16 @@
   */
 
 #include "asim/TagIdVec.h"
+#include "asim/TagVecDenseItemIdx.h"
+#include "asim/TagVecDenseShortItemIdx.h"
+#include "asim/TagVecDenseDictionary.h"
+#include "asim/TagVecDenseDictionaryNF.h"
 
 /**
  * The static variables are set to NULL.
  */
 StrTable* TagIdVecNode::strtbl = NULL;
+DBPager* TagIdVecNode::pager = NULL;
 
 /**
  * Gets the tag value in the cycle cycle.
@@ -58,7 +63,7 @@ TagIdVecNode::getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle)
     }
     INT32 cycleChunk = cycle >> CYCLE_OFFSET_BITS;
     //printf (">> TagIdVecNode::getTagValue: patched cycle=%d, chunk=%d\n",cycle,cycleChunk);
-    bool hit = (*cycleVec)[cycleChunk]->getTagValue(cycle,value,atcycle);
+    bool hit = getChunk(cycleChunk)->getTagValue(cycle,value,atcycle);
     if (hit)
     {
         //printf (">> TagIdVecNode::getTagValue: first try hit!\n");
@@ -78,7 +83,7 @@ TagIdVecNode::getTagValue(INT32 cycle, UINT64*  value, UINT32* atcycle)
     INT32 minChunk = firstCycle >> CYCLE_OFFSET_BITS;
     while (!hit && (cycleChunk>=minChunk))
     {
-        hit = (*cycleVec)[cycleChunk--]->getTagValue(cycle,value,atcycle);
+        hit = getChunk(cycleChunk--)->getTagValue(cycle,value,atcycle);
     }
 
     /*
@@ -124,7 +129,7 @@ TagIdVecNode::dumpTagIdVector()
     {
         if (cycleVec->hasElement(i) && ((*cycleVec)[i]!=NULL))
         {
-           (*cycleVec)[i]->dumpCycleVector();
+           getChunk(i)->dumpCycleVector();
         }
     }
 }
@@ -149,13 +154,20 @@ TagIdVecNode::setWriteEnabled(bool value)
     {
         if (cycleVec->hasElement(i) && ((*cycleVec)[i]!=NULL))
         {
-           (*cycleVec)[i]->setWriteEnabled(value);
+           TagVec* vec = getChunk(i);
+           vec->setWriteEnabled(value);
+           if (vec->getPage()!=NULL)
+           {
+               pager->dirtyChunk(vec->getPage());
+           }
         }
     }
 }
 
 /**
-  * Compresses the vector.
+  * Compresses the vector. When the paging is enabled the chunks
+  * before the one of cycle (all of them if last is set) are given
+  * to the pager once they have no pending items.
   *
   * @return the compressed vector.
   */
@@ -190,7 +202,163 @@ TagIdVecNode::compressYourSelf(INT32 cycle, bool last)
                 delete (*cycleVec)[i];
                 (*cycleVec)[i] = newvec;
             }
+            if (pager->isEnabled() && ((i<lastChunk) || last) &&
+                (newvec->getPage()==NULL) && !newvec->isPaged() &&
+                !newvec->hasPendingItems() && (newvec->getMemSize()>=DBPAGER_MIN_CHUNK_SIZE))
+            {
+                pager->addChunk(this,i,newvec);
+            }
         }
     }
     return this;
 }
+
+/**
+ * Replaces the vector of the chunk cycleChunk with a placeholder
+ * that remembers where it was stored in the spill file. Called by
+ * the pager.
+ *
+ * @return void.
+ */
+void
+TagIdVecNode::pageOut(INT32 cycleChunk, INT64 offset, INT64 length)
+{
+    TagVec* vec = (*cycleVec)[cycleChunk];
+    (*cycleVec)[cycleChunk] = new TagVecPaged(offset,length);
+    delete vec;
+}
+
+/**
+ * Reads back the vector of the chunk cycleChunk from the spill file
+ * and gives it again to the pager. The tag values of the chunk only
+ * live in the spill file, so if it can't be read the database is lost
+ * and the process is aborted.
+ *
+ * @return void.
+ */
+void
+TagIdVecNode::pageIn(INT32 cycleChunk)
+{
+    TagVecPaged* paged = (TagVecPaged*) (*cycleVec)[cycleChunk];
+    DBCacheFile* cache = pager->readChunk(paged->getOffset(),paged->getLength());
+    TagVec* vec = (cache!=NULL) ? loadTagVec(cache) : NULL;
+    if (vec==NULL)
+    {
+        qFatal("DralDB Error: unable to page in chunk %d from the spill file.",cycleChunk);
+    }
+    (*cycleVec)[cycleChunk] = vec;
+    pager->addChunk(this,cycleChunk,vec,paged->getOffset(),paged->getLength());
+    delete paged;
+}
+
+/**
+ * Stores the state and all the tag vectors in the cache. Each
+ * vector is preceded by its chunk and its encoding type.
+ *
+ * @return void.
+ */
+void
+TagIdVecNode::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(firstCycle);
+    cache->writeINT32(lastCycle);
+    cache->writeINT32(isFwd);
+    cache->writeINT32(useDictionary);
+    if (cycleVec!=NULL)
+    {
+        for (int i=0;i<TAGIDVECNODE_MAXCHUNKS;i++)
+        {
+            if (cycleVec->hasElement(i) && (cycleVec->at(i)!=NULL))
+            {
+                TagVec* vec = getChunk(i);
+                cache->writeINT32(i);
+                cache->writeINT32((INT32) vec->getType());
+                vec->saveCache(cache);
+            }
+        }
+    }
+    cache->writeINT32(-1);
+}
+
+/**
+ * Replaces the state and the tag vectors with the ones stored in
+ * the cache.
+ *
+ * @return true if the vectors could be read.
+ */
+bool
+TagIdVecNode::loadCache(DBCacheFile * cache)
+{
+    if (cycleVec!=NULL)
+    {
+        for (int i=0;i<TAGIDVECNODE_MAXCHUNKS;i++)
+        {
+            if (cycleVec->hasElement(i) && (cycleVec->at(i)!=NULL))
+            {
+                delete cycleVec->at(i);
+            }
+        }
+        delete cycleVec;
+        cycleVec = NULL;
+    }
+
+    firstCycle = cache->readINT32();
+    lastCycle = cache->readINT32();
+    isFwd = (cache->readINT32()!=0);
+    useDictionary = (cache->readINT32()!=0);
+
+    INT32 chunk = cache->readINT32();
+    while ((chunk>=0) && cache->ok())
+    {
+        if (chunk>=TAGIDVECNODE_MAXCHUNKS)
+        {
+            return false;
+        }
+        TagVec* vec = loadTagVec(cache);
+        if (vec==NULL)
+        {
+            return false;
+        }
+        checkCyclePage(chunk);
+        (*cycleVec)[chunk] = vec;
+        chunk = cache->readINT32();
+    }
+    return cache->ok();
+}
+
+/**
+ * Reads the encoding type of a tag vector and creates the vector
+ * of this type from the cache.
+ *
+ * @return the new vector or NULL if the type is unknown.
+ */
+TagVec*
+TagIdVecNode::loadTagVec(DBCacheFile * cache)
+{
+    switch ((TagVecEncodingType) cache->readINT32())
+    {
+        case TVEType_ITEMIDX:
+            return new TagVecItemIdx(cache);
+
+        case TVEType_DENSE_ITEMIDX:
+            return new TagVecDenseItemIdx(cache);
+
+        case TVEType_DENSE_SHORT_ITEMIDX:
+            return new TagVecDenseShortItemIdx(cache);
+
+        case TVEType_DICTIONARY:
+            return new TagVecDictionary(cache);
+
+        case TVEType_DENSE_DICTIONARY:
+            return new TagVecDenseDictionary(cache);
+
+        case TVEType_DICTIONARY_NF:
+            return new TagVecDictionaryNF(cache);
+
+        case TVEType_DENSE_DICTIONARY_NF:
+            return new TagVecDenseDictionaryNF(cache);
+
+        default:
+            return NULL;
+    }
+}
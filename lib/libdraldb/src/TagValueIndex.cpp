@@ -0,0 +1,376 @@
+// ==================================================
+//Copyright (C) 2003-2006 Intel Corporation
+//
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+//
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+/**
+  * @file TagValueIndex.cpp
+  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "asim/TagValueIndex.h"
+
+/**
+ * The instance is NULL at the beginning.
+ */
+TagValueIndex* TagValueIndex::_myInstance = NULL;
+
+/**
+ * Returns the instance of the class. The first time this function
+ * is called is when the instance is created. The other times just
+ * returns the pointer.
+ *
+ * @return the instance of the class.
+ */
+TagValueIndex*
+TagValueIndex::getInstance()
+{
+    if (_myInstance==NULL)
+    {
+        _myInstance = new TagValueIndex();
+    }
+
+    Q_ASSERT(_myInstance!=NULL);
+    return _myInstance;
+}
+
+/**
+ * Destroys the unique instance of the class. The instance is
+ * destroyed if it was previously created.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::destroy()
+{
+    if (_myInstance!=NULL)
+    {
+        delete _myInstance;
+        _myInstance = NULL;
+    }
+}
+
+/**
+ * Creator of this class. Allocates an empty index.
+ *
+ * @return new object.
+ */
+TagValueIndex::TagValueIndex()
+{
+    buckets = NULL;
+    lists = NULL;
+    reset();
+}
+
+/**
+ * Destructor of this class. Frees all the lists.
+ *
+ * @return destroys the object.
+ */
+TagValueIndex::~TagValueIndex()
+{
+    freeAll();
+}
+
+/**
+ * Removes all the pairs and items of the index.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::reset()
+{
+    freeAll();
+
+    mask = TAGVALUEIDX_INIT_BUCKETS - 1;
+    buckets = new TagValueBucket[TAGVALUEIDX_INIT_BUCKETS];
+    Q_ASSERT(buckets != NULL);
+    for (UINT32 i = 0; i <= mask; i++)
+    {
+        buckets[i].list = -1;
+    }
+
+    capLists = TAGVALUEIDX_INIT_BUCKETS / 2;
+    lists = (TagValueList *) malloc(capLists * sizeof(TagValueList));
+    Q_ASSERT(lists != NULL);
+    numLists = 0;
+    numEntries = 0;
+    firstItem = -1;
+    lastItem = -1;
+    numItems = 0;
+}
+
+/**
+ * Frees the buckets and the lists.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::freeAll()
+{
+    if (lists != NULL)
+    {
+        for (INT32 i = 0; i < numLists; i++)
+        {
+            free(lists[i].items);
+        }
+        free(lists);
+        lists = NULL;
+    }
+    if (buckets != NULL)
+    {
+        delete [] buckets;
+        buckets = NULL;
+    }
+}
+
+/**
+ * Creates the item list of the pair tagId-value and stores it in
+ * the free bucket. The hash is doubled when it gets half full, in
+ * that case the bucket is recomputed.
+ *
+ * @return the new list.
+ */
+INT32
+TagValueIndex::newList(UINT16 tagId, UINT64 value, UINT32 bucket)
+{
+    if ((UINT32) (numLists + 1) * 2 > mask + 1)
+    {
+        rehash();
+        bucket = hash(tagId, value);
+        while (buckets[bucket].list >= 0)
+        {
+            bucket = (bucket + 1) & mask;
+        }
+    }
+    if (numLists == capLists)
+    {
+        capLists *= 2;
+        lists = (TagValueList *) realloc(lists, capLists * sizeof(TagValueList));
+        Q_ASSERT(lists != NULL);
+    }
+
+    TagValueList * list = &lists[numLists];
+    list->items = (INT32 *) malloc(TAGVALUEIDX_INIT_LIST * sizeof(INT32));
+    Q_ASSERT(list->items != NULL);
+    list->count = 0;
+    list->capacity = TAGVALUEIDX_INIT_LIST;
+
+    buckets[bucket].value = value;
+    buckets[bucket].tagId = tagId;
+    buckets[bucket].list = numLists;
+    return numLists++;
+}
+
+/**
+ * Doubles the capacity of the list.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::growList(TagValueList * list)
+{
+    list->capacity *= 2;
+    list->items = (INT32 *) realloc(list->items, list->capacity * sizeof(INT32));
+    Q_ASSERT(list->items != NULL);
+}
+
+/**
+ * Doubles the number of buckets and reinserts all the pairs.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::rehash()
+{
+    TagValueBucket * old = buckets;
+    UINT32 oldSize = mask + 1;
+
+    mask = (oldSize * 2) - 1;
+    buckets = new TagValueBucket[oldSize * 2];
+    Q_ASSERT(buckets != NULL);
+    for (UINT32 i = 0; i <= mask; i++)
+    {
+        buckets[i].list = -1;
+    }
+
+    for (UINT32 i = 0; i < oldSize; i++)
+    {
+        if (old[i].list >= 0)
+        {
+            UINT32 b = hash(old[i].tagId, old[i].value);
+            while (buckets[b].list >= 0)
+            {
+                b = (b + 1) & mask;
+            }
+            buckets[b] = old[i];
+        }
+    }
+    delete [] old;
+}
+
+/**
+ * Looks for the first position of the list with an item vector
+ * entry equal or bigger than itemIdx.
+ *
+ * @return the position or the list size if there's none.
+ */
+INT32
+TagValueIndex::lowerBound(INT32 list, INT32 itemIdx) const
+{
+    const INT32 * items = lists[list].items;
+    INT32 lo = 0;
+    INT32 hi = lists[list].count;
+
+    while (lo < hi)
+    {
+        INT32 mid = (lo + hi) / 2;
+        if (items[mid] < itemIdx)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Stores the buckets and the item lists in the cache.
+ *
+ * @return void.
+ */
+void
+TagValueIndex::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32((INT32) mask);
+    cache->writeINT32(firstItem);
+    cache->writeINT32(lastItem);
+    cache->writeINT32(numItems);
+    cache->writeBlock(buckets, (INT64) (mask + 1) * sizeof(TagValueBucket));
+    cache->writeINT32(numLists);
+    for (INT32 i = 0; i < numLists; i++)
+    {
+        cache->writeINT32(lists[i].count);
+        cache->writeBlock(lists[i].items, (INT64) lists[i].count * sizeof(INT32));
+    }
+}
+
+/**
+ * Replaces the content of the index with the one stored in the
+ * cache. Everything is copied because the lists can still grow.
+ *
+ * @return true if the index could be read.
+ */
+bool
+TagValueIndex::loadCache(DBCacheFile * cache)
+{
+    UINT32 cmask = (UINT32) cache->readINT32();
+    INT32 cfirst = cache->readINT32();
+    INT32 clast = cache->readINT32();
+    INT32 cnum = cache->readINT32();
+    if ((cmask & (cmask + 1)) != 0)
+    {
+        return false;
+    }
+    const void * cbuckets = cache->mapBlock((INT64) (cmask + 1) * sizeof(TagValueBucket));
+    INT32 num = cache->readINT32();
+    if ((cbuckets == NULL) || (num < 0) || ((UINT32) num > cmask))
+    {
+        return false;
+    }
+
+    reset();
+    delete [] buckets;
+    mask = cmask;
+    buckets = new TagValueBucket[mask + 1];
+    Q_ASSERT(buckets != NULL);
+    memcpy(buckets, cbuckets, (mask + 1) * sizeof(TagValueBucket));
+    firstItem = cfirst;
+    lastItem = clast;
+    numItems = cnum;
+
+    capLists = qMax(num, capLists);
+    lists = (TagValueList *) realloc(lists, capLists * sizeof(TagValueList));
+    Q_ASSERT(lists != NULL);
+    for (numLists = 0; numLists < num; numLists++)
+    {
+        INT32 count = cache->readINT32();
+        const void * items = cache->mapBlock((INT64) count * sizeof(INT32));
+        if ((count < 0) || (items == NULL))
+        {
+            return false;
+        }
+        TagValueList * list = &lists[numLists];
+        list->count = count;
+        list->capacity = qMax(count, TAGVALUEIDX_INIT_LIST);
+        list->items = (INT32 *) malloc(list->capacity * sizeof(INT32));
+        Q_ASSERT(list->items != NULL);
+        memcpy(list->items, items, count * sizeof(INT32));
+        numEntries += count;
+    }
+    return true;
+}
+
+/**
+ * Returns the memory used by the index.
+ *
+ * @return the size in bytes.
+ */
+INT64
+TagValueIndex::getObjSize() const
+{
+    INT64 result = sizeof(TagValueIndex);
+
+    result += (INT64) (mask + 1) * sizeof(TagValueBucket);
+    result += (INT64) capLists * sizeof(TagValueList);
+    for (INT32 i = 0; i < numLists; i++)
+    {
+        result += (INT64) lists[i].capacity * sizeof(INT32);
+    }
+    return result;
+}
+
+/**
+ * Returns a description of the index.
+ *
+ * @return the description.
+ */
+QString
+TagValueIndex::getUsageDescription() const
+{
+    QString result = "";
+
+    result += "\t\tReserved Hash Buckets:\t"+QString::number(mask + 1)+"\n";
+    result += "\t\tTag-Value Pairs:\t"+QString::number(numLists)+"\n";
+    result += "\t\tIndexed Entries:\t"+QString::number((long) numEntries)+"\n";
+    return (result);
+}
+
+/**
+ * Bypasses the call to getUsageDescription.
+ *
+ * @return the object stats.
+ */
+QString
+TagValueIndex::getStats() const
+{
+    return getUsageDescription();
+}
@@ -20,6 +20,8 @@
   * @file TagVecDenseDictionaryNF.cpp
   */
 
+#include <string.h>
+
 #include "asim/TagVecDenseDictionaryNF.h"
 
 /**
@@ -66,6 +68,50 @@ TagVecDenseDictionaryNF::~TagVecDenseDictionaryNF()
     delete [] valvec;
 }
 
+/**
+ * Creator of this class. Reads the entries from the cache.
+ *
+ * @return new object.
+ */
+TagVecDenseDictionaryNF::TagVecDenseDictionaryNF(DBCacheFile * cache)
+{
+    if (dict==NULL)
+    {
+        dict = Dict2064::getInstance();
+    }
+    if (strtbl==NULL)
+    {
+        strtbl = StrTable::getInstance();
+    }
+    loadState(cache);
+    baseCycle = cache->readINT32();
+    nextEntry = cache->readINT32();
+    const void * entries = cache->mapBlock((INT64) nextEntry*sizeof(TagVecDictionaryNode));
+    if ((nextEntry<0) || (entries==NULL))
+    {
+        nextEntry = 0;
+    }
+    valvec = new TagVecDictionaryNode[nextEntry];
+    if (nextEntry>0)
+    {
+        memcpy(valvec,entries,nextEntry*sizeof(TagVecDictionaryNode));
+    }
+}
+
+/**
+ * Stores the entries in the cache.
+ *
+ * @return void.
+ */
+void
+TagVecDenseDictionaryNF::saveCache(DBCacheFile * cache)
+{
+    saveState(cache);
+    cache->writeINT32(baseCycle);
+    cache->writeINT32(nextEntry);
+    cache->writeBlock(valvec,(INT64) nextEntry*sizeof(TagVecDictionaryNode));
+}
+
 /**
   * Dumps the content of the vector.
   *
@@ -20,6 +20,8 @@
   * @file TagVecDenseShortItemIdx.cpp
   */
 
+#include <string.h>
+
 #include "asim/TagVecDenseShortItemIdx.h"
 
 /**
@@ -64,6 +66,42 @@ TagVecDenseShortItemIdx::~TagVecDenseShortItemIdx()
     delete [] valvec;
 }
 
+/**
+ * Creator of this class. Reads the entries from the cache.
+ *
+ * @return new object.
+ */
+TagVecDenseShortItemIdx::TagVecDenseShortItemIdx(DBCacheFile * cache)
+{
+    loadState(cache);
+    baseCycle = cache->readINT32();
+    nextEntry = cache->readINT32();
+    const void * entries = cache->mapBlock((INT64) nextEntry*sizeof(TagVecDenseShortItemIdxNode));
+    if ((nextEntry<0) || (entries==NULL))
+    {
+        nextEntry = 0;
+    }
+    valvec = new TagVecDenseShortItemIdxNode[nextEntry];
+    if (nextEntry>0)
+    {
+        memcpy(valvec,entries,nextEntry*sizeof(TagVecDenseShortItemIdxNode));
+    }
+}
+
+/**
+ * Stores the entries in the cache.
+ *
+ * @return void.
+ */
+void
+TagVecDenseShortItemIdx::saveCache(DBCacheFile * cache)
+{
+    saveState(cache);
+    cache->writeINT32(baseCycle);
+    cache->writeINT32(nextEntry);
+    cache->writeBlock(valvec,(INT64) nextEntry*sizeof(TagVecDenseShortItemIdxNode));
+}
+
 /**
   * Object already compressed.
   *
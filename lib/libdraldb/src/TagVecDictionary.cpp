@@ -57,6 +57,45 @@ TagVecDictionary::~TagVecDictionary()
 {
 }
 
+/**
+ * Creator of this class. Reads the entries from the cache.
+ *
+ * @return new object.
+ */
+TagVecDictionary::TagVecDictionary(DBCacheFile * cache)
+{
+    if (dict==NULL)
+    {
+        dict = Dict2064::getInstance();
+    }
+    if (strtbl==NULL)
+    {
+        strtbl = StrTable::getInstance();
+    }
+    loadState(cache);
+    baseCycle = cache->readINT32();
+    nextEntry = cache->readINT32();
+    if ((nextEntry<0) || (nextEntry>CYCLE_CHUNK_SIZE) ||
+        !cache->readBlock(valvec,(INT64) nextEntry*sizeof(TagVecDictionaryNode)))
+    {
+        nextEntry = 0;
+    }
+}
+
+/**
+ * Stores the entries in the cache.
+ *
+ * @return void.
+ */
+void
+TagVecDictionary::saveCache(DBCacheFile * cache)
+{
+    saveState(cache);
+    cache->writeINT32(baseCycle);
+    cache->writeINT32(nextEntry);
+    cache->writeBlock(valvec,(INT64) nextEntry*sizeof(TagVecDictionaryNode));
+}
+
 /**
   * Compresses the vector to a dense vector.
   *
@@ -41,6 +41,15 @@ TagVecDictionaryNF::~TagVecDictionaryNF()
 {
 }
 
+/**
+ * Creator of this class. Reads the entries from the cache.
+ *
+ * @return new object.
+ */
+TagVecDictionaryNF::TagVecDictionaryNF(DBCacheFile * cache) : TagVecDictionary(cache)
+{
+}
+
 /**
   * Compresses the vector to a dense vector.
   *
@@ -46,6 +46,34 @@ TagVecItemIdx::~TagVecItemIdx()
 {
 }
 
+/**
+ * Creator of this class. Reads the vector from the cache.
+ *
+ * @return new object.
+ */
+TagVecItemIdx::TagVecItemIdx(DBCacheFile * cache)
+{
+    loadState(cache);
+    baseCycle = cache->readINT32();
+    if (!cache->readBlock(valvec,sizeof(valvec)))
+    {
+        bzero((char *)valvec,sizeof(valvec));
+    }
+}
+
+/**
+ * Stores the vector in the cache.
+ *
+ * @return void.
+ */
+void
+TagVecItemIdx::saveCache(DBCacheFile * cache)
+{
+    saveState(cache);
+    cache->writeINT32(baseCycle);
+    cache->writeBlock(valvec,sizeof(valvec));
+}
+
 /**
   * Compresses the vector to a dense vector.
   *
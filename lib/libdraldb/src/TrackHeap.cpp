@@ -331,6 +331,66 @@ TrackHeap::reset()
     }
 }
 
+/**
+ * Computes a value that identifies the requested tracks. The tracks
+ * are requested in a deterministic order, so the same requests get
+ * the same value.
+ *
+ * @return the fingerprint of the tracks.
+ */
+UINT64
+TrackHeap::getTrackFingerprint()
+{
+    UINT64 hash = 14695981039346656037ULL;
+
+    hash = (hash ^ (UINT64) nextTrackID) * 1099511628211ULL;
+    for (INT32 i=0;i<nextTrackID;i++)
+    {
+        hash = trackIDVector[i].getFingerprint(hash);
+    }
+    return hash;
+}
+
+/**
+ * Stores the tag values of all the tracks in the cache.
+ *
+ * @return void.
+ */
+void
+TrackHeap::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(firstEffectiveCycle);
+    cache->writeINT32(nextTrackID);
+    for (INT32 i=0;i<nextTrackID;i++)
+    {
+        trackIDVector[i].saveCache(cache);
+    }
+}
+
+/**
+ * Replaces the tag values of the tracks with the ones stored in the
+ * cache. The same tracks must have been requested before.
+ *
+ * @return true if the values could be read.
+ */
+bool
+TrackHeap::loadCache(DBCacheFile * cache)
+{
+    firstEffectiveCycle = cache->readINT32();
+    if (cache->readINT32()!=nextTrackID)
+    {
+        return false;
+    }
+    for (INT32 i=0;i<nextTrackID;i++)
+    {
+        if (!trackIDVector[i].loadCache(cache))
+        {
+            return false;
+        }
+    }
+    return cache->ok();
+}
+
 /**
  * Dumps the content of the track heap.
  *
@@ -44,6 +44,81 @@ TrackIDNode::~TrackIDNode()
     tgIdVector.clear();
 }
 
+/**
+ * Mixes the type and the specification of the track into hash. Two
+ * tracks get the same value if they track the same element.
+ *
+ * @return the new hash value.
+ */
+UINT64
+TrackIDNode::getFingerprint(UINT64 hash)
+{
+    // FNV-1a over the words that identify the track.
+    const UINT64 prime = 1099511628211ULL;
+
+    hash = (hash ^ (UINT64) type) * prime;
+    hash = (hash ^ (UINT64) trackSpec.node_edge_id) * prime;
+    if ((type != TRACKIDTYPE_MOVEITEM) && (type != TRACKIDTYPE_CYCLETAG))
+    {
+        hash = (hash ^ (UINT64) trackSpec.slot.specDimensions) * prime;
+        for (UINT16 i = 0; i < trackSpec.slot.specDimensions; i++)
+        {
+            hash = (hash ^ (UINT64) trackSpec.slot.dimVec[i]) * prime;
+        }
+    }
+    return hash;
+}
+
+/**
+ * Stores the values of all the tracked tags in the cache.
+ *
+ * @return void.
+ */
+void
+TrackIDNode::saveCache(DBCacheFile * cache)
+{
+    cache->writeINT32(minTgId);
+    cache->writeINT32(maxTgId);
+    for (INT32 i = minTgId; i <= maxTgId; i++)
+    {
+        if (tgIdVector.hasElement(i) && tgIdVector[i].hasData())
+        {
+            cache->writeINT32(i);
+            tgIdVector[i].saveCache(cache);
+        }
+    }
+    cache->writeINT32(-1);
+}
+
+/**
+ * Replaces the values of the tracked tags with the ones stored in
+ * the cache. The type of tracking is set when the track is
+ * requested, so it is not changed.
+ *
+ * @return true if the values could be read.
+ */
+bool
+TrackIDNode::loadCache(DBCacheFile * cache)
+{
+    minTgId = cache->readINT32();
+    maxTgId = cache->readINT32();
+    if (maxTgId >= TAGDESCVEC_SIZE)
+    {
+        return false;
+    }
+
+    INT32 tagId = cache->readINT32();
+    while ((tagId >= 0) && cache->ok())
+    {
+        if ((tagId < minTgId) || (tagId > maxTgId) || !tgIdVector[tagId].loadCache(cache))
+        {
+            return false;
+        }
+        tagId = cache->readINT32();
+    }
+    return cache->ok();
+}
+
 /**
  * Sets the type of tracking to move item. Tracks the edge edge_id.
  *
@@ -73,6 +73,11 @@ CONTROLLER_CLASS::CONTROLLER_CLASS() {
     pmStopped     = true;
     pmExiting     = false;
     pmInitialized = false;
+    sampleJobs     = sysconf(_SC_NPROCESSORS_ONLN) > 0 ?
+                     sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    samplesRunning = 0;
+    samplesStarted = 0;
+    sampleChild    = false;
 }
 
 CONTROLLER_CLASS::~CONTROLLER_CLASS() {
@@ -1354,6 +1359,60 @@ CONTROLLER_CLASS::ParseOneEvent (INT32 argc, char *argv[], INT32 &i)
                                                  0,
                                                  argv[++i]);
         }
+        //--------------------------------------------------------------------
+        // binary checkpoints of the timing state
+        //--------------------------------------------------------------------
+        // -ckptc <n>       save a checkpoint every <n> cycles
+        //
+        else if ((strcmp(argv[i], "-ckptc") == 0) && (argc > (i+1))) 
+        {
+            theController.CMD_SaveCheckpoint(ACTION_CYCLE_PERIOD, atoi_general(argv[++i]));
+        }
+        //
+        // -ckpti <n>       save a checkpoint every <n> instructions
+        //
+        else if ((strcmp(argv[i], "-ckpti") == 0) && (argc > (i+1)))
+        {
+            theController.CMD_SaveCheckpoint(ACTION_INST_PERIOD, atoi_general(argv[++i]));
+        }
+        //
+        // -ckptrestore <filename>  restore the timing state from checkpoint
+        //                          'filename' before the performance model starts
+        //
+        else if ((strcmp(argv[i], "-ckptrestore") == 0) && (argc > (i+1))) 
+        {
+            theController.CMD_RestoreCheckpoint(ACTION_NOW, 0, argv[++i]);
+        }
+        //--------------------------------------------------------------------
+        // sampling
+        //--------------------------------------------------------------------
+        // -samplec <n> <w>  every <n> cycles fork a child that simulates the
+        //                   next <w> cycles from clean stats and writes them
+        //                   to a stats file of its own
+        //
+        else if ((strcmp(argv[i], "-samplec") == 0) && (argc > (i+2))) 
+        {
+            UINT64 n = atoi_general(argv[++i]);
+            UINT64 w = atoi_general(argv[++i]);
+            theController.CMD_Sample(ACTION_CYCLE_PERIOD, n, w);
+        }
+        //
+        // -samplei <n> <w>  the same every <n> instructions for <w> instructions
+        //
+        else if ((strcmp(argv[i], "-samplei") == 0) && (argc > (i+2))) 
+        {
+            UINT64 n = atoi_general(argv[++i]);
+            UINT64 w = atoi_general(argv[++i]);
+            theController.CMD_Sample(ACTION_INST_PERIOD, n, w);
+        }
+        //
+        // -samplejobs <n>   at most <n> sample children at once
+        //                   (default: the number of host cpus)
+        //
+        else if ((strcmp(argv[i], "-samplejobs") == 0) && (argc > (i+1))) 
+        {
+            sampleJobs = atoi_general(argv[++i]);
+        }
         // -vsm <n>       start Vtune Thread Profiler after <n> macro instructions
         //
         else if ((strcmp(argv[i], "-vsm") == 0) && (argc > (i+1))) 
@@ -1490,6 +1549,14 @@ CONTROLLER_CLASS::Usage (char *exec, FILE *file)
        << "\n"
        << "\t-restore <filename>\t\t\tRestore functional state from <filename>\n"
        << "\n"
+       << "\t-ckptc <n>\t\t\tSave a checkpoint every <n> cycles\n"
+       << "\t-ckpti <n>\t\t\tSave a checkpoint every <n> instructions\n"
+       << "\t-ckptrestore <filename>\t\tRestore a checkpoint from <filename>\n"
+       << "\n"
+       << "\t-samplec <n> <w>\t\tEvery <n> cycles fork a child simulating a <w> cycle sample\n"
+       << "\t-samplei <n> <w>\t\tEvery <n> instructions fork a child simulating a <w> instruction sample\n"
+       << "\t-samplejobs <n>\t\t\tRun at most <n> sample children at once\n"
+       << "\n"
        << "\t-param <name>=<value>\tdefine dynamic parameter <name> = <value>\n"
        << "\t-listparams\t\tlist all registered dynamic parameters\n"
        << "\t-listmasks\t\tlist the possible mask strings\n"
@@ -649,6 +649,48 @@ CONTROLLER_BASE_EXTERNAL_FUNCTION(
     // Dummy function
 }
 
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_SaveCheckpoint,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n),
+  (                  trigger,        n)
+)
+/*
+ * Create an action to save a checkpoint.
+ */
+{
+    ASIM_XMSG("CMD_SaveCheckpoint...");
+    
+    // Dummy function
+}
+
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_RestoreCheckpoint,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName),
+  (                  trigger,        n,             fileName)
+)
+/*
+ * Create an action to restore a checkpoint.
+ */
+{
+    ASIM_XMSG("CMD_RestoreCheckpoint...");
+    
+    // Dummy function
+}
+
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_Sample,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window),
+  (                  trigger,        n,        window)
+)
+/*
+ * Create an action to fork detailed sample windows.
+ */
+{
+    ASIM_XMSG("CMD_Sample...");
+    
+    // Dummy function
+}
+
 
 /**********************************************************************/
 
@@ -196,6 +196,21 @@ extern void CMD_SaveFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =
  */
 extern void CMD_RestoreFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0, char *fileName ="dummy_restore");
 
+/*
+ * Save a binary checkpoint of the full timing state
+ */
+extern void CMD_SaveCheckpoint (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
+
+/*
+ * Restore the timing state from a binary checkpoint
+ */
+extern void CMD_RestoreCheckpoint (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName);
+
+/*
+ * Fork a child that simulates a detailed sample window
+ */
+extern void CMD_Sample (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window);
+
 
 /********************************************************************
  *
@@ -1208,6 +1223,9 @@ class CONTROLLER_CLASS {
     
     void CMD_SaveFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
     void CMD_RestoreFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0, char *fileName ="dummy_restore");
+    void CMD_SaveCheckpoint (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
+    void CMD_RestoreCheckpoint (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName);
+    void CMD_Sample (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window);
     
     void CMD_StartThreadProfiler (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
     void CMD_StopThreadProfiler (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
@@ -1246,6 +1264,7 @@ class CONTROLLER_CLASS {
   friend class CMD_START_CLASS;
   friend class CMD_STOP_CLASS;
   friend class CMD_EXIT_CLASS;
+  friend class CMD_SAMPLE_CLASS;
     // True if the performance model is stopped. When stopped time doesn't
     // advance, so no actions are performance.
     volatile bool pmStopped;
@@ -1254,6 +1273,13 @@ class CONTROLLER_CLASS {
     volatile bool pmExiting;
     // True if the performance model has been initialized.
     bool pmInitialized;
+
+    // Sampling: the most sample children alive at once, the number
+    // alive and started, and whether this process is a sample child.
+    UINT32 sampleJobs;
+    UINT32 samplesRunning;
+    UINT32 samplesStarted;
+    bool sampleChild;
 };
 
 // Parse action time for an SSC mark event, to be used instead of atoi_generic
@@ -26,12 +26,21 @@
 // generic
 #include <iostream>
 #include <sstream>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 // ASIM core
 #include "asim/syntax.h"
 #include "asim/mesg.h"
 #include "asim/trace.h"
 #include "asim/profile.h"
+#include "asim/checkpoint.h"
+#include "asim/smp.h"
+#include "asim/host_profiler.h"
+#include "asim/dralReadAhead.h"
 
 // ASIM public modules
 #include "asim/provides/instfeeder_interface.h"
@@ -649,6 +658,80 @@ CONTROLLER_BASE_EXTERNAL_FUNCTION(
     asimSystem->SYS_Break();       
 }
 
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_SaveCheckpoint,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n),
+  (                  trigger,        n)
+)
+/*
+ * Create an action to save a checkpoint.
+ */
+{
+    ASIM_XMSG("CMD_SaveCheckpoint...");
+
+    ctrlWorkList->Add(new CMD_SAVECHECKPOINT_CLASS(trigger, n)); 
+    asimSystem->SYS_Break();       
+}
+
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_RestoreCheckpoint,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName),
+  (                  trigger,        n,             fileName)
+)
+/*
+ * Create an action to restore a checkpoint.
+ */
+{
+    ASIM_XMSG("CMD_RestoreCheckpoint...");
+
+    ctrlWorkList->Add(new CMD_RESTORECHECKPOINT_CLASS(trigger, n, fileName)); 
+    asimSystem->SYS_Break();       
+}
+
+CONTROLLER_BASE_EXTERNAL_FUNCTION( 
+  void, CMD_Sample,
+  (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window),
+  (                  trigger,        n,        window)
+)
+/*
+ * Create an action to fork detailed sample windows.
+ */
+{
+    ASIM_XMSG("CMD_Sample...");
+
+    ctrlWorkList->Add(new CMD_SAMPLE_CLASS(trigger, n, window)); 
+    asimSystem->SYS_Break();       
+}
+
+void
+CONTROLLER_CLASS::SampleWait (UINT32 maxRunning)
+/*
+ * Reap sample children until no more than 'maxRunning' are alive.
+ */
+{
+    while (samplesRunning > maxRunning)
+    {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ASIMWARNING("Lost track of sample processes: " << strerror(errno) << endl);
+            samplesRunning = 0;
+            break;
+        }
+
+        samplesRunning--;
+        if (! WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+        {
+            ASIMWARNING("Sample process " << pid << " failed" << endl);
+        }
+    }
+}
+
 
 /**********************************************************************/
 
@@ -808,6 +891,9 @@ CONTROLLER_BASE_EXTERNAL_FUNCTION(
     
     ASIM_XMSG("CMD_SchedulerLoop exiting ... calling AWB_Exit");
 
+    // Wait for the sample windows still running
+    SampleWait(0);
+
     //Stop the threads
     asimSystem->SYS_StopPThreads();
 
@@ -1062,6 +1148,166 @@ CMD_RESTOREFUNCSTATE_CLASS::CmdAction (void)
     }
 }
 
+void
+CMD_SAVECHECKPOINT_CLASS::CmdAction (void)
+{
+    // The parent saves the periodic checkpoints, a sample window would
+    // only write them again under the same names
+    if (theController.sampleChild)
+    {
+        return;
+    }
+
+    ostringstream checkpointFileName;
+
+    UINT64 currentInst = 0;
+    for (UINT32 i = 0; i < asimSystem->NumCpus(); i++)
+    {
+       currentInst += asimSystem->SYS_CommittedInsts(i); 
+    }
+
+    checkpointFileName << "cycle_"  << asimSystem->SYS_Cycle()
+                       << "_nano_"  << asimSystem->SYS_Nanosecond()
+                       << "_insts_" << currentInst
+                       << ".ckpt";
+
+    ASIM_XMSG("CMD_SAVECHECKPOINT saving checkpoint: " 
+              << checkpointFileName.str());
+    cout << "Saving checkpoint " << checkpointFileName.str() << endl;
+
+    if (! ASIM_CHECKPOINT_CLASS::Save(asimSystem, checkpointFileName.str().c_str()))
+    {
+        ASIMWARNING("Failed to save checkpoint "
+                    << checkpointFileName.str() << endl);
+    }
+}
+
+void
+CMD_SAMPLE_CLASS::CmdAction (void)
+{
+    // A sample window does not sample again
+    if (theController.sampleChild)
+    {
+        return;
+    }
+
+    // The strip chart writer is the one helper thread that can simply
+    // be stopped; the parent starts it again on its next dump
+    ASIM_REGISTRY_CLASS::strip.PrepareFork();
+
+    // fork() only copies the calling thread, and the child would share
+    // the profiling timer and its output with the parent
+    if (ASIM_SMP_CLASS::GetTotalRunningThreads() > 1 ||
+        ASIM_SMP_CLASS::GetRunningHelperThreads() > 0 ||
+        DRAL_READ_AHEAD_CLASS::GetRunningThreads() > 0)
+    {
+        ASIMWARNING("Sampling needs a single threaded model, sample skipped" << endl);
+        return;
+    }
+    if (ASIM_HOST_PROFILER_CLASS::IsRunning())
+    {
+        ASIMWARNING("Sampling can't run with the host profiler, sample skipped" << endl);
+        return;
+    }
+    // The DRAL server writes the events file even while events are
+    // off, and a child can't close its copy without writing to it
+    if (runWithEventsOn)
+    {
+        ASIMWARNING("Sampling can't run with DRAL events, sample skipped" << endl);
+        return;
+    }
+
+    UINT64 currentInst = 0;
+    for (UINT32 i = 0; i < asimSystem->NumCpus(); i++)
+    {
+       currentInst += asimSystem->SYS_CommittedInsts(i); 
+    }
+
+    // Bound the number of windows simulating at once, and so the memory
+    // their copies of the model take
+    theController.SampleWait(theController.sampleJobs > 0 ?
+                             theController.sampleJobs - 1 : 0);
+
+    UINT32 sample = theController.samplesStarted++;
+
+    // Don't have the child flush output buffered by the parent again
+    fflush(stdout);
+    fflush(stderr);
+    cout.flush();
+    cerr.flush();
+    TRACEABLE_CLASS::PrepareFork();
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        ASIMWARNING("Unable to fork sample " << sample << ": "
+                    << strerror(errno) << endl);
+        return;
+    }
+    if (pid > 0)
+    {
+        ASIM_XMSG("CMD_SAMPLE forked sample " << sample << " as process " << pid);
+        theController.samplesRunning++;
+        return;
+    }
+
+    //
+    // In the child: measure the window from clean stats, write them to a
+    // file of its own and exit at the end of the window.  The strip
+    // charts and the traces stay with the parent.
+
+    theController.sampleChild = true;
+    theController.samplesRunning = 0;
+    ASIM_REGISTRY_CLASS::strip.ForkedChild();
+    TRACEABLE_CLASS::ForkedChild();
+    traceOn = false;
+
+    ostringstream statsFileName;
+    if (theController.StatsFileName)
+    {
+        statsFileName << theController.StatsFileName << ".sample" << sample;
+    }
+    else
+    {
+        statsFileName << "sample_" << sample
+                      << "_cycle_" << asimSystem->SYS_Cycle()
+                      << "_insts_" << currentInst
+                      << ".stats";
+    }
+    delete [] theController.StatsFileName;
+    theController.StatsFileName = new char[statsFileName.str().size() + 1];
+    strcpy(theController.StatsFileName, statsFileName.str().c_str());
+
+    cout << "Sample " << sample << " started at cycle " << asimSystem->SYS_Cycle()
+         << ", instruction " << currentInst
+         << ", stats to " << statsFileName.str() << endl;
+
+    asimSystem->ClearModuleStats();
+    IFEEDER_BASE_CLASS::ClearAllFeederStats();
+
+    if (Trigger() == ACTION_CYCLE_PERIOD || Trigger() == ACTION_CYCLE_ONCE)
+    {
+        theController.CMD_Exit(ACTION_CYCLE_ONCE, asimSystem->SYS_Cycle() + window);
+    }
+    else
+    {
+        theController.CMD_Exit(ACTION_INST_ONCE, currentInst + window);
+    }
+}
+
+void
+CMD_RESTORECHECKPOINT_CLASS::CmdAction (void)
+{
+    ASIM_XMSG("CMD_RESTORECHECKPOINT restoring checkpoint "
+              << checkpointFileName);
+    cout << "Restoring checkpoint " << checkpointFileName << endl;
+
+    if (! ASIM_CHECKPOINT_CLASS::Restore(asimSystem, checkpointFileName.c_str()))
+    {
+        ASIMERROR("Failed to restore checkpoint " << checkpointFileName << endl);
+    }
+}
+
 /*******************************************************************
  *
  *
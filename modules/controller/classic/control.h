@@ -205,6 +205,21 @@ extern void CMD_SaveFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =
  */
 extern void CMD_RestoreFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0, const char *fileName ="dummy_restore");
 
+/*
+ * Save a binary checkpoint of the full timing state
+ */
+extern void CMD_SaveCheckpoint (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
+
+/*
+ * Restore the timing state from a binary checkpoint
+ */
+extern void CMD_RestoreCheckpoint (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName);
+
+/*
+ * Fork a child that simulates a detailed sample window
+ */
+extern void CMD_Sample (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window);
+
 
 /********************************************************************
  *
@@ -1041,6 +1056,60 @@ class CMD_RESTOREFUNCSTATE_CLASS : public CMD_WORKITEM_CLASS
         void CmdAction (void);
 };
 
+/*
+ * CMD_SAVECHECKPOINT
+ *
+ * Save a binary checkpoint of the full timing state
+ */
+typedef class CMD_SAVECHECKPOINT_CLASS *CMD_SAVECHECKPOINT;
+class CMD_SAVECHECKPOINT_CLASS : public CMD_WORKITEM_CLASS
+{
+    public:
+        CMD_SAVECHECKPOINT_CLASS (CMD_ACTIONTRIGGER t, UINT64 c) :
+            CMD_WORKITEM_CLASS("SAVECHECKPOINT", t, c) { }
+
+        void CmdAction (void);
+};
+
+/*
+ * CMD_RESTORECHECKPOINT
+ *
+ * Restore the timing state from a binary checkpoint
+ */
+typedef class CMD_RESTORECHECKPOINT_CLASS *CMD_RESTORECHECKPOINT;
+class CMD_RESTORECHECKPOINT_CLASS : public CMD_WORKITEM_CLASS
+{
+    private:
+        string checkpointFileName;
+
+    public:
+        CMD_RESTORECHECKPOINT_CLASS (CMD_ACTIONTRIGGER t, UINT64 c, const char *fileName) :
+            CMD_WORKITEM_CLASS("RESTORECHECKPOINT", t, c),
+            checkpointFileName(fileName) { }
+
+        void CmdAction (void);
+};
+
+/*
+ * CMD_SAMPLE
+ *
+ * Fork a copy-on-write child of the warmed model that simulates the
+ * next 'window' cycles or instructions, depending on the trigger, and
+ * writes its own stats.  The parent carries on.
+ */
+typedef class CMD_SAMPLE_CLASS *CMD_SAMPLE;
+class CMD_SAMPLE_CLASS : public CMD_WORKITEM_CLASS
+{
+    private:
+        UINT64 window;
+
+    public:
+        CMD_SAMPLE_CLASS (CMD_ACTIONTRIGGER t, UINT64 c, UINT64 w) :
+            CMD_WORKITEM_CLASS("SAMPLE", t, c), window(w) { }
+
+        void CmdAction (void);
+};
+
 /*******************************************************************/
 
 
@@ -1232,6 +1301,9 @@ class CONTROLLER_CLASS {
     
     void CMD_SaveFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
     void CMD_RestoreFuncState (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0, const char *fileName ="dummy_restore");
+    void CMD_SaveCheckpoint (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
+    void CMD_RestoreCheckpoint (CMD_ACTIONTRIGGER trigger, UINT64 n, const char *fileName);
+    void CMD_Sample (CMD_ACTIONTRIGGER trigger, UINT64 n, UINT64 window);
     
     void CMD_StartThreadProfiler (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
     void CMD_StopThreadProfiler (CMD_ACTIONTRIGGER trigger =ACTION_NOW, UINT64 n =0);
@@ -1270,6 +1342,7 @@ class CONTROLLER_CLASS {
   friend class CMD_START_CLASS;
   friend class CMD_STOP_CLASS;
   friend class CMD_EXIT_CLASS;
+  friend class CMD_SAMPLE_CLASS;
     // True if the performance model is stopped. When stopped time doesn't
     // advance, so no actions are performance.
     volatile bool pmStopped;
@@ -1278,6 +1351,15 @@ class CONTROLLER_CLASS {
     volatile bool pmExiting;
     // True if the performance model has been initialized.
     bool pmInitialized;
+
+    // Sampling: the most sample children alive at once, the number
+    // alive and started, and whether this process is a sample child.
+    UINT32 sampleJobs;
+    UINT32 samplesRunning;
+    UINT32 samplesStarted;
+    bool sampleChild;
+    // Wait until at most 'maxRunning' sample children are alive.
+    void SampleWait (UINT32 maxRunning);
 };
 
 // Parse action time for an SSC mark event, to be used instead of atoi_generic
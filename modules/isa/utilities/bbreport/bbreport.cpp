@@ -22,6 +22,9 @@
  * @brief Basic Block Reporter
  */
 
+// generic (C++/STL)
+#include <algorithm>
+
 // ASIM core
 #include "asim/mesg.h"
 #include "asim/trace.h"
@@ -30,17 +33,47 @@
 #include "asim/provides/util_bbreport.h"
 
 BBREPORT_CLASS::BBREPORT_CLASS(void)
+    : instrTable(1024, 0),
+      instrMask(1024 - 1),
+      lastInstr(0)
 {
 }
 
 BBREPORT_CLASS::~BBREPORT_CLASS(void)
 {
-    map<IADDR_CLASS, BB_INSTR_CLASS *>::iterator i_iter;
-    for (i_iter = instrTable.begin(); i_iter != instrTable.end(); i_iter++)
+}
+
+UINT32
+BBREPORT_CLASS::Hash(const IADDR_CLASS & addr)
+{
+    UINT64 key = (addr.GetBundleAddr() << 2) ^ addr.GetSyllableIndex();
+    return UINT32((key * UINT64(0x9e3779b97f4a7c15)) >> 32);
+}
+
+//
+// Return the slot holding addr, or the free slot where it belongs.
+//
+UINT32
+BBREPORT_CLASS::FindSlot(const IADDR_CLASS & addr)
+{
+    UINT32 slot = Hash(addr) & instrMask;
+    while (instrTable[slot] != 0 &&
+           ! (instrPool[instrTable[slot] - 1].addr == addr))
+    {
+        slot = (slot + 1) & instrMask;
+    }
+    return slot;
+}
+
+void
+BBREPORT_CLASS::Grow(void)
+{
+    instrTable.assign(instrTable.size() * 2, 0);
+    instrMask = instrTable.size() - 1;
+    for (UINT32 i = 0; i < instrPool.size(); i++)
     {
-        delete i_iter->second;
+        instrTable[FindSlot(instrPool[i].addr)] = i + 1;
     }
-    instrTable.clear();
 }
 
 void
@@ -51,6 +84,15 @@ BBREPORT_CLASS::Print(ostream & os)
     UINT64 total_count = 0;
     UINT64 total_delay = 0;
 
+    // instructions sorted by IP
+    vector<BB_INSTR_CLASS *> sorted;
+    sorted.reserve(instrPool.size());
+    for (UINT32 i = 0; i < instrPool.size(); i++)
+    {
+        sorted.push_back(&instrPool[i]);
+    }
+    sort(sorted.begin(), sorted.end(), AddrLess);
+
     // basic blocks sorted by retire delay
     multimap<UINT64, BB_BLOCK_CLASS *> blockTable;
 
@@ -59,39 +101,36 @@ BBREPORT_CLASS::Print(ostream & os)
     cur_block->count = 0;
     cur_block->delay = 0;
 
-    // walk through map (already sorted) and create blocks
-    map<IADDR_CLASS, BB_INSTR_CLASS *>::iterator i_iter;
-    for (i_iter = instrTable.begin(); i_iter != instrTable.end(); i_iter++)
+    // walk through sorted instructions and create blocks
+    for (UINT64 i = 0; i < sorted.size(); i++)
     {
+        BB_INSTR_CLASS * instr = sorted[i];
+
         if (cur_block->size == 0)
         {
             total_blocks++;
-            cur_block->addr = i_iter->second->addr;
+            cur_block->addr = instr->addr;
+            cur_block->first = i;
         }
 
         cur_block->size++;
-        cur_block->count += i_iter->second->count;
-        cur_block->delay += i_iter->second->delay;
+        cur_block->count += instr->count;
+        cur_block->delay += instr->delay;
 
         total_size++;
-        total_count += i_iter->second->count;
-        total_delay += i_iter->second->delay;
+        total_count += instr->count;
+        total_delay += instr->delay;
 
         bool terminate = false;
-        if (i_iter->second->breakout == true)
+        if (instr->breakout == true)
         {
             terminate = true;
         }
-        if (++i_iter != instrTable.end())
+        if (i + 1 < sorted.size() && sorted[i + 1]->breakin == true)
         {
-            if (i_iter->second->breakin == true)
-            {
-                terminate = true;
-            }
+            terminate = true;
         }
 
-        --i_iter;
-
         if (terminate == true)
         {
             blockTable.insert(pair<UINT64, BB_BLOCK_CLASS *>(cur_block->delay, cur_block));
@@ -102,6 +141,7 @@ BBREPORT_CLASS::Print(ostream & os)
             cur_block->delay = 0;
         }
     }
+    delete cur_block;
 
     // walk backwards through map (already sorted) and print blocks
     os << endl;
@@ -121,16 +161,19 @@ BBREPORT_CLASS::Print(ostream & os)
                << " Size: " << b_iter->second->size
                << " Delay: " << b_iter->second->delay
                << " (" << fmt("5.2f", ((double) 100.0 * b_iter->second->delay / total_delay)) << "%)" << endl;
+
+            // a block never spans a gap, since the instruction after a
+            // gap was always entered by a split and so starts a new block
             IADDR_CLASS addr = b_iter->second->addr;
             for (UINT64 i = 0; i < b_iter->second->size; i++)
             {
-                i_iter = instrTable.find(addr);
-                ASSERTX(i_iter != instrTable.end());
+                BB_INSTR_CLASS * instr = sorted[b_iter->second->first + i];
+                ASSERTX(instr->addr == addr);
 
                 os << "  [" << addr << "] "
-                   << fmt("-50", i_iter->second->name)
-                   << " count " << fmt("6", i_iter->second->count)
-                   << " delay " << fmt("6", i_iter->second->delay) << endl;
+                   << fmt("-50", instr->name)
+                   << " count " << fmt("6", instr->count)
+                   << " delay " << fmt("6", instr->delay) << endl;
 
                 addr = addr.Next();
             }
@@ -143,44 +186,52 @@ BBREPORT_CLASS::Print(ostream & os)
 }
 
 void
-BBREPORT_CLASS::Commit(const IADDR_CLASS & addr, const string name, UINT64 delay)
+BBREPORT_CLASS::Commit(const IADDR_CLASS & addr, const string & name, UINT64 delay)
 {
     TRACE(Trace_Sys, cout << "BBREPORT::Commit" << endl);
     TRACE(Trace_Sys, cout << "\tInstruction: Addr " << addr << endl);
 
     bool split = (addr != lastAddr.Next());
 
-    map<IADDR_CLASS, BB_INSTR_CLASS *>::iterator iter = instrTable.find(addr);
+    UINT32 slot = FindSlot(addr);
+    BB_INSTR_CLASS * cur_instr;
 
-    if (iter != instrTable.end())
+    if (instrTable[slot] != 0)
     {
         TRACE(Trace_Sys, cout << "\tAddr match found, updating" << endl);
-        iter->second->count += 1;
-        iter->second->delay += delay;
+        cur_instr = &instrPool[instrTable[slot] - 1];
+        cur_instr->count += 1;
+        cur_instr->delay += delay;
     }
     else
     {
         TRACE(Trace_Sys, cout << "\tCreating new instance" << endl);
-        BB_INSTR_CLASS * cur_instr = new BB_INSTR_CLASS;
+        instrPool.push_back(BB_INSTR_CLASS());
+        instrTable[slot] = instrPool.size();
+
+        cur_instr = &instrPool.back();
         cur_instr->addr = addr;
-        cur_instr->name = name;
+        cur_instr->name = instrNames.insert(name).first->c_str();
         cur_instr->count = 1;
         cur_instr->delay = delay;
         cur_instr->breakin = false;
         cur_instr->breakout = false;
 
-        iter = instrTable.insert(pair<IADDR_CLASS, BB_INSTR_CLASS *>(cur_instr->addr, cur_instr)).first;
+        if (instrPool.size() * 2 > instrTable.size())
+        {
+            Grow();
+        }
     }
 
     if (split == true)
     {
-        iter->second->breakin = true;
+        cur_instr->breakin = true;
 
-        iter = instrTable.find(lastAddr);
-        if (iter != instrTable.end())
+        if (lastInstr != 0)
         {
-            iter->second->breakout = true;
+            instrPool[lastInstr - 1].breakout = true;
         }
     }
     lastAddr = addr;
+    lastInstr = (cur_instr - &instrPool[0]) + 1;
 }
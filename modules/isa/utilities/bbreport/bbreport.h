@@ -27,6 +27,9 @@
 
 // generic (C++/STL)
 #include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 // ASIM core
 #include "asim/syntax.h"
@@ -41,12 +44,12 @@ class BBREPORT_CLASS
     // info about current block
     IADDR_CLASS lastAddr;
 
-    // hash table for instructions
+    // one entry per static instruction
     class BB_INSTR_CLASS
     {
       public:
         IADDR_CLASS addr;
-        string name;
+        const char * name;      // interned, owned by instrNames
         UINT64 count;
         UINT64 delay;
 
@@ -54,14 +57,37 @@ class BBREPORT_CLASS
         bool breakout;
     };
 
-    // sorted by IP
-    map<IADDR_CLASS, BB_INSTR_CLASS *> instrTable;
+    // open addressing (linear probing) table of indices into instrPool,
+    // kept at most half full; 0 marks a free slot, otherwise index + 1
+    vector<UINT32> instrTable;
+    UINT32 instrMask;
+
+    // instructions in the order they were first seen
+    vector<BB_INSTR_CLASS> instrPool;
+
+    // instrPool index + 1 of lastAddr (0 before the first commit), so a
+    // split does not need a second lookup
+    UINT32 lastInstr;
+
+    // opcode names are shared by all instructions with the same opcode
+    set<string> instrNames;
+
+    static UINT32 Hash(const IADDR_CLASS & addr);
+    UINT32 FindSlot(const IADDR_CLASS & addr);
+    void Grow(void);
+
+    // orders instrPool entries by address for Print
+    static bool AddrLess(const BB_INSTR_CLASS * a, const BB_INSTR_CLASS * b)
+    {
+        return a->addr < b->addr;
+    }
 
     // hash table for basic blocks
     class BB_BLOCK_CLASS
     {
       public:
         IADDR_CLASS addr;
+        UINT64 first;       // index of the first instruction in Print's order
         UINT64 size;
         UINT64 count;
         UINT64 delay;
@@ -73,7 +99,7 @@ class BBREPORT_CLASS
     ~BBREPORT_CLASS();
 
     void Print(ostream & os);
-    void Commit(const IADDR_CLASS & addr, const string name, UINT64 delay);
+    void Commit(const IADDR_CLASS & addr, const string & name, UINT64 delay);
 
 };
 
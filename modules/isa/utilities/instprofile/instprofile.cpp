@@ -20,6 +20,8 @@
 // Author:  Srilatha Manne
 //
 
+#include <algorithm>
+
 #include "asim/provides/inst_stats.h"
 
 static UID_GEN32 numInst = 0;
@@ -42,27 +44,6 @@ const char* PERINST_COUNTER_STRING[] =
 // PERINST_ENTRY
 //
 
-/**************************
- * Constructor
- **************************/
-
-
-PERINST_ENTRY_CLASS::PERINST_ENTRY_CLASS(const char* des_str, UINT64 a) :
-    addr(a), 
-    commHist(LAST_COUNTER),
-    noncommHist(LAST_COUNTER)
-{
-
-    strncpy (des, des_str, 99);
-    
-    //
-    // Initialize row names.  We will register the stats at the end because
-    // that's the only time we'll have a ASIM_REGISTRY object with which to
-    // register the stats. 
-    commHist.RowNames(PERINST_COUNTER_STRING);
-    noncommHist.RowNames(PERINST_COUNTER_STRING);
-}
-
 /**************************
  * Stats Registration
  **************************/
@@ -70,6 +51,15 @@ PERINST_ENTRY_CLASS::PERINST_ENTRY_CLASS(const char* des_str, UINT64 a) :
 void
 PERINST_ENTRY_CLASS::RegisterEntry(ASIM_REGISTRY reg)
 {
+    //
+    // The histograms are only needed for the final stats, so they are
+    // built here rather than for every entry up front.  The registry
+    // keeps pointers to them, so they are never freed.
+    HISTOGRAM_TEMPLATE<1> *commHist = new HISTOGRAM_TEMPLATE<1>(LAST_COUNTER);
+    HISTOGRAM_TEMPLATE<1> *noncommHist = new HISTOGRAM_TEMPLATE<1>(LAST_COUNTER);
+    commHist->RowNames(PERINST_COUNTER_STRING);
+    noncommHist->RowNames(PERINST_COUNTER_STRING);
+
     // Register stats
     // Convert the address to a string. 
     ostringstream os1, os2;
@@ -90,160 +80,86 @@ PERINST_ENTRY_CLASS::RegisterEntry(ASIM_REGISTRY reg)
 
 //    cout << "Address: " << os.str() << endl;
 
-    reg->RegisterState(&commHist, os1.str().c_str(), des);
-    reg->RegisterState(&noncommHist, os2.str().c_str(), des);
+    reg->RegisterState(commHist, os1.str().c_str(), des);
+    reg->RegisterState(noncommHist, os2.str().c_str(), des);
 
     // Update the histogram with the correct data.  
     for (UINT32 i = 0; i < LAST_COUNTER; i++)
     {
-        commHist.AddEvent(i, 0, commInst.Get((PERINST_COUNTER)i));
-        noncommHist.AddEvent(i, 0, noncommInst.Get((PERINST_COUNTER)i));
+        commHist->AddEvent(i, 0, commInst.Get((PERINST_COUNTER)i));
+        noncommHist->AddEvent(i, 0, noncommInst.Get((PERINST_COUNTER)i));
     }
 }
 
+
 //
-// PERINST_PAGE
+// PERINST_CACHE
 //
 
 /**************************
  * Destructor
  **************************/
-PERINST_PAGE_CLASS::~PERINST_PAGE_CLASS()
+
+PERINST_CACHE_CLASS::~PERINST_CACHE_CLASS()
 {
-/*
-    for (UINT32 i = 0; i < ENTRIES_PER_PAGE; i++) 
+    for (UINT32 i = 0; i < pages.size(); i++)
     {
-        if (page[i] != NULL)
-        {
-            delete page[i];
-        }
+        delete [] pages[i];
     }
-*/
+    pages.clear();
 }
 
-
 /**************************
- * Update information for an instruction. 
+ * Allocate an entry for an instruction seen for the first time
  **************************/
 
-void 
-PERINST_PAGE_CLASS::UpdateInst(const UINT64 addr, 
-                               const char *inst_name, 
-                               const PERINST_STATS_CLASS &ifs, 
-                               bool commit) 
+PERINST_ENTRY
+PERINST_CACHE_CLASS::NewEntry(UINT64 addr, const char *name)
 {
-    UINT64 offset = addr - pageAddr;
-
-//    cout << "Updating instruction, Addr: " << addr << ", offset: " << offset << endl;
-    
-    ASSERTX(offset < ENTRIES_PER_PAGE);
-    if (page[offset] == NULL) 
+    UINT32 n = numInst++;
+    if (n > MAX_NUM_INSTS) 
     {
-        //
-        // Null pointer, which means first time inst is seen.
-        page[offset] = new PERINST_ENTRY_CLASS(inst_name, addr);
-        UINT32 n = numInst++;
-        if (n > MAX_NUM_INSTS) 
-        {
-            VERIFY(false, "Exceeding maximum number of static inst: 100000\n");
-        }
+        VERIFY(false, "Exceeding maximum number of static inst: 100000\n");
     }
-    //
-    // Update 
-    ASSERTX(page[offset]->GetAddr() == addr);
-        
-    page[offset]->UpdateInst(ifs, commit);
-}
 
-/**************************
- * Register stats for a page
- **************************/
-//
-// Register a page of stats. 
-void
-PERINST_PAGE_CLASS::RegisterPage(ASIM_REGISTRY reg)
-{
-    for (UINT32 i = 0; i < ENTRIES_PER_PAGE; i++) 
+    UINT32 offset = numEntries % ENTRIES_PER_PAGE;
+    if (offset == 0)
     {
-        if (page[i] != NULL)
-        {
-//            cout << "Registering page" << endl;
-            page[i]->RegisterEntry(reg);
-        }
+        pages.push_back(new PERINST_ENTRY_CLASS[ENTRIES_PER_PAGE]);
     }
-}
-
-
-
-//
-// PERINST_CACHE
-//
-
-/**************************
- * Destructor
- **************************/
-
-PERINST_CACHE_CLASS::~PERINST_CACHE_CLASS()
-{
-    STAT_CACHE::iterator i = statCache.begin();
-    STAT_CACHE::iterator prev;
+    numEntries++;
 
-    while (i != statCache.end())
-    {
-        delete (*i).second;
-        prev = i;
-        ++i;
-        statCache.erase(prev);
-    }
+    //
+    // Descriptions are cut at 99 characters, as they always have been.
+    PERINST_ENTRY entry = &pages.back()[offset];
+    entry->Init(names.insert(string(name, strnlen(name, 99))).first->c_str(),
+                addr);
+    return entry;
 }
 
 /**************************
- * Update stats 
+ * Double the hash table
  **************************/
 
 void
-PERINST_CACHE_CLASS::UpdateStats(UINT64 addr,
-                                 const char* name, 
-                                 const PERINST_STATS_CLASS& ifs, 
-                                 bool commit)
+PERINST_CACHE_CLASS::Grow()
 {
+    vector<SLOT> old(table.size() * 2);
+    old.swap(table);
+    tableMask = table.size() - 1;
 
-    PERINST_PAGE page;
-    
-    //
-    // Update per-inst stats.
-    //
-    if (lastPage && 
-        (addr & (~((1 << LOG2_ENTRIES_PER_PAGE) - 1)))==lastPage->PageAddr()) 
-    {
-//            cout << "Using lastpage" << endl;
-        page = lastPage;
-    }
-    else 
+    for (UINT32 j = 0; j < old.size(); j++)
     {
-        STAT_CACHE::iterator i = statCache.find((addr >> LOG2_ENTRIES_PER_PAGE));
-        if (i != statCache.end()) {
-            page = (*i).second;
-            lastPage = page;
-//                cout << "Finding page in stat cache" << endl;
-        }
-        else 
+        if (old[j].entry != NULL)
         {
-            //
-            // Page doesn't currently exist. 
-            //
-            UINT64 page_addr = addr & (~((1 << LOG2_ENTRIES_PER_PAGE) - 1));
-            page = new PERINST_PAGE_CLASS(page_addr);
-//                cout << "Creating new page" << endl;
-            //
-            // Place new page into cache
-            //
-            statCache[(addr >> LOG2_ENTRIES_PER_PAGE)] = page;
-            lastPage = page;
-        }
+            UINT32 i = Hash(old[j].addr) & tableMask;
+            while (table[i].entry != NULL)
+            {
+                i = (i + 1) & tableMask;
+            }
+            table[i] = old[j];
         }
-    // Update stats per address
-    page->UpdateInst(addr, name, ifs, commit);
+    }
 }
 
 /**************************
@@ -252,12 +168,18 @@ PERINST_CACHE_CLASS::UpdateStats(UINT64 addr,
 void
 PERINST_CACHE_CLASS::RegisterPerinstStats(ASIM_REGISTRY reg)
 {
-    STAT_CACHE::iterator i = statCache.begin();
-    while (i != statCache.end())
+    //
+    // Register in address order, as the stats have always been dumped.
+    vector<PERINST_ENTRY> sorted;
+    sorted.reserve(numEntries);
+    for (UINT32 i = 0; i < numEntries; i++)
+    {
+        sorted.push_back(&pages[i / ENTRIES_PER_PAGE][i % ENTRIES_PER_PAGE]);
+    }
+    sort(sorted.begin(), sorted.end(), AddrLess);
+
+    for (UINT32 i = 0; i < sorted.size(); i++)
     {
-//            cout << "Registering page: " << i << endl;
-        (*i).second->RegisterPage(reg);
-        ++i;
+        sorted[i]->RegisterEntry(reg);
     }
 }
-    
@@ -25,7 +25,9 @@
 
 #include <stdio.h>
 #include <memory.h>
-#include <map>
+#include <set>
+#include <string>
+#include <vector>
 #include "asim/registry.h"
 #include "asim/atomic.h"
 #include "asim/restricted/perinst_stats.h"
@@ -40,19 +42,13 @@
    inst profile.  Hence be careful when you use this profiling 
    algorithm. 
 
-   The number of maximum static instructions the data structure can
-   handle is 
-   
-   MAX_RECORDING_POINTS * (24 bytes/recording_point) * ENTRIES_PER_PAGE *
-           MAX_NUM_PAGES
-   
-   Note that there will be an assertion failure if the number of pages exceeds
-   781 even if each page has not reached the 2048 maximum number of inst. 
+   The number of static instructions is limited by MAX_NUM_INSTS.
+   Entries are allocated ENTRIES_PER_PAGE at a time and found through
+   an open addressing hash table keyed by instruction address.
    
 */
 
 typedef class PERINST_ENTRY_CLASS* PERINST_ENTRY;
-typedef class PERINST_PAGE_CLASS* PERINST_PAGE;
 typedef class PERINST_CACHE_CLASS* PERINST_CACHE;
 //
 // Data structure for each static inst. or instset the program encounters.  
@@ -67,19 +63,18 @@ class PERINST_ENTRY_CLASS {
     // Unique address of instruction we're storing
     UINT64 addr;
 
-    // Description of instruction 
-    char des[100];
+    // Description of instruction, interned by PERINST_CACHE_CLASS
+    const char *des;
 
-    // Histograms used to print out final information
-    HISTOGRAM_TEMPLATE<1> commHist;
-    HISTOGRAM_TEMPLATE<1> noncommHist;
-  
   public:
     //
     // NULL constructor.
     PERINST_ENTRY_CLASS();
-    PERINST_ENTRY_CLASS (const char *name, UINT64 addr);
     ~PERINST_ENTRY_CLASS();
+
+    //
+    // Set up an entry taken from the pool. 
+    void Init(const char *name, UINT64 addr);
     
     // 
     // Do we have any events currently? 
@@ -90,7 +85,7 @@ class PERINST_ENTRY_CLASS {
     void UpdateInst(const PERINST_STATS_CLASS& ifs, bool commit); 
 
     // 
-    // Register the histogram for this instruction. 
+    // Build and register the histograms for this instruction. 
     void RegisterEntry(ASIM_REGISTRY reg);
 
     // Accessors
@@ -102,7 +97,8 @@ class PERINST_ENTRY_CLASS {
 //
 inline 
 PERINST_ENTRY_CLASS::PERINST_ENTRY_CLASS() :
-    addr(0)
+    addr(0),
+    des("")
 {}
 
 inline 
@@ -110,6 +106,13 @@ PERINST_ENTRY_CLASS::~PERINST_ENTRY_CLASS()
 {
 }
 
+inline void
+PERINST_ENTRY_CLASS::Init(const char *name, UINT64 a)
+{
+    des = name;
+    addr = a;
+}
+
 //
 // Method returns info stating whether this instruction has any stats. 
 //
@@ -148,60 +151,45 @@ PERINST_ENTRY_CLASS::GetAddr()
 {
     return addr;
 }
-    
-// Data structure for one page of instructions. 
-class PERINST_PAGE_CLASS
+
+
+/*
+ * Class perinst_cache_class contains all perinst stats for the program.
+ * Entries live in pages of ENTRIES_PER_PAGE that are never moved, and an
+ * open addressing table (linear probing, at most half full) maps each
+ * instruction address to its entry.  Nothing is kept in address order
+ * until the stats are registered.
+ */
+class PERINST_CACHE_CLASS
 {
   private:
-    PERINST_ENTRY page[ENTRIES_PER_PAGE];
-    UINT64 pageAddr;
-    
-  public:
-    
-    PERINST_PAGE_CLASS(UINT64 a);
-    ~PERINST_PAGE_CLASS();
+    PERINST_ENTRY lastEntry;
 
-    // Accessors
-    UINT64 PageAddr();
+    // Hash table slot; a NULL entry marks a free slot.
+    struct SLOT
+    {
+        UINT64 addr;
+        PERINST_ENTRY entry;
+    };
+    vector<SLOT> table;
+    UINT32 tableMask;
 
-    // Modifiers
-    void UpdateInst(const UINT64 addr, const char* inst_name, 
-                    const PERINST_STATS_CLASS& ifs, 
-                    bool commit);
-    void RegisterPage(ASIM_REGISTRY reg);
+    // Entry pool.  Only the last page has free entries.
+    vector<PERINST_ENTRY> pages;
+    UINT32 numEntries;
 
-};
+    // Instruction descriptions, shared by all entries of the same type
+    set<string> names;
 
-inline
-PERINST_PAGE_CLASS::PERINST_PAGE_CLASS(UINT64 a) : pageAddr(a) 
-{
-    for (UINT32 i = 0; i < ENTRIES_PER_PAGE; i++) 
+    static UINT32 Hash(UINT64 addr);
+    PERINST_ENTRY NewEntry(UINT64 addr, const char *name);
+    void Grow();
+
+    // Orders entries by address for registration
+    static bool AddrLess(PERINST_ENTRY a, PERINST_ENTRY b)
     {
-        page[i] = NULL;
+        return a->GetAddr() < b->GetAddr();
     }
-}
-
-inline UINT64
-PERINST_PAGE_CLASS::PageAddr() 
-{ 
-    return pageAddr; 
-}
-
-
-/*
- * Class perinst_cache_class contains all perinst stats for the program. It
- * contains a map whose entries are pages. Each page contains a number of
- * static instructions.
- */
-class PERINST_CACHE_CLASS
-{
-  private:
-    PERINST_PAGE lastPage;
-  
-    // This map contains all stats accumulated per static
-    // instruction.
-    typedef map<UINT64, PERINST_PAGE> STAT_CACHE;
-    STAT_CACHE statCache;
 
  public:
     PERINST_CACHE_CLASS();
@@ -216,9 +204,56 @@ class PERINST_CACHE_CLASS
 
 
 inline
-PERINST_CACHE_CLASS::PERINST_CACHE_CLASS() : lastPage(NULL)
+PERINST_CACHE_CLASS::PERINST_CACHE_CLASS() :
+    lastEntry(NULL),
+    table(1024),
+    tableMask(1024 - 1),
+    numEntries(0)
 {
     ASSERT(ENABLE_INST_PROFILE <= 2, "Legal values are 0, 1, and 2");
 }
 
+inline UINT32
+PERINST_CACHE_CLASS::Hash(UINT64 addr)
+{
+    return UINT32((addr * UINT64(0x9e3779b97f4a7c15)) >> 32);
+}
+
+//
+// Update per-inst stats.  Consecutive updates often come from the same
+// instruction, so lastEntry is checked before probing the table.
+//
+inline void
+PERINST_CACHE_CLASS::UpdateStats(UINT64 addr,
+                                 const char* name, 
+                                 const PERINST_STATS_CLASS& ifs, 
+                                 bool commit)
+{
+    PERINST_ENTRY entry = lastEntry;
+
+    if (entry == NULL || entry->GetAddr() != addr)
+    {
+        UINT32 i = Hash(addr) & tableMask;
+        while (table[i].entry != NULL && table[i].addr != addr)
+        {
+            i = (i + 1) & tableMask;
+        }
+
+        entry = table[i].entry;
+        if (entry == NULL)
+        {
+            entry = NewEntry(addr, name);
+            table[i].addr = addr;
+            table[i].entry = entry;
+            if (numEntries * 2 > table.size())
+            {
+                Grow();
+            }
+        }
+        lastEntry = entry;
+    }
+
+    entry->UpdateInst(ifs, commit);
+}
+
 #endif // _INST_PROFILE_
@@ -462,12 +462,55 @@ ASIM_APE_CLASS::SYS_UnhookAllThreads()
   return true;
 }
 
+/*
+ * Run 'tpu' for up to 'cycles' cycles starting at 'cycle', fetching
+ * one instruction per cycle.  'budget' is the number of instructions
+ * that may still be committed; the run ends early when it is used up
+ * or when the stop marker has been committed.  Return the number of
+ * cycles run, and set 'active' if the tpu was active in any of them.
+ */
+UINT64
+ASIM_APE_CLASS::runTPU (
+    TPU tpu,
+    UINT64 cycle,
+    UINT64 cycles,
+    UINT64 & budget,
+    UINT64 stopMarker,
+    bool & active)
+{
+  for (UINT64 c = cycle; c < cycle + cycles; c++) {
+    tpu->Clock();
+    if (tpu->isFree() || tpu->isStalled()) continue;
+    active = true;
+
+    ASIM_INST instr = tpu->fetchAndExecute(c);
+
+    if (my_driver->NextInstruction(instr, c)) {
+      UINT32 n = tpu->commit(c);
+      SYS_CommittedInsts(0) += n;
+      budget = (n < budget) ? budget - n : 0;
+      if (!budget || SYS_CommittedMarkers() >= stopMarker) {
+        return c - cycle + 1;
+      }
+    }
+  }
+  return cycles;
+}
+
 /*
  * Pass control to the performance model until cycle 'stopCycle' or until
  * committed instruction 'stopInst' or until commiting
  * marker 'commitWatchMarker'.
  * Return false if execution is stopped (via SYS_Break()) before we reach
  * 'stopCycle', 'stopInst' or 'commitWatchMarker'.
+ *
+ * With APE_BATCH_SIZE > 1 and a single tpu, the tpu runs a whole batch
+ * of cycles, and the stop conditions, the driver clock and the Tarati
+ * server are only looked at between batches.  A batch is cut short when
+ * the instruction limit is reached or the stop marker commits, and the
+ * clock only advances that far.  With several tpus a batch is a single
+ * cycle: a tpu that ran ahead could not be taken back when a later one
+ * reaches the stop.
  */
 bool
 ASIM_APE_CLASS::SYS_Execute (
@@ -478,12 +521,12 @@ ASIM_APE_CLASS::SYS_Execute (
     UINT64 stopPacket)
 {
   UINT32 i;
-  ASIM_INST instr;
-  UINT32 committed_insts = 0;
   UINT64 idle_count = MAX_IDLE_CYCLES;
   UINT64 startMarker = SYS_CommittedMarkers(); 
   UINT64 stopMarker = startMarker + 1; 
     // Note: could generalize this ^ for committing N markers rather than 1
+  const UINT64 batch = APE_BATCH_SIZE ? APE_BATCH_SIZE : 1;
+  UINT64 cycles = 1;
 
   /* at least one tpu must be active each cycle */
   /* (this will change when delayed stall is implemented) */
@@ -508,28 +551,36 @@ ASIM_APE_CLASS::SYS_Execute (
     if (is_any_tpu_active) {
       idle_count = MAX_IDLE_CYCLES;
     } else {
-      idle_count--;
+      idle_count = (cycles < idle_count) ? idle_count - cycles : 0;
     }
     ASSERTX(idle_count);
 
+    /* each tpu fetches at most one instruction per cycle, so no batch
+     * needs to be longer than what is left to commit */
+    UINT64 budget = stopInst - SYS_GlobalCommittedInsts();
+    UINT32 tpus = 0;
+    for (i=0;i<NUM_HWCS_PER_CPU;i++) {
+        if (my_tpu[i] != NULL) tpus++;
+    }
+    cycles = (tpus > 1) ? 1 : batch;
+    cycles = MIN(cycles, stopCycle - SYS_Cycle());
+    cycles = MIN(cycles, budget);
+    cycles = MIN(cycles, stopMacroInst - SYS_GlobalCommittedMacroInsts());
+
+    /* a single cycle is always run to its end by every tpu */
     is_any_tpu_active = false;
     for (i=0;i<NUM_HWCS_PER_CPU;i++) {
         if (my_tpu[i] != NULL)
         {
-            my_tpu[i]->Clock();
-            if (my_tpu[i]->isFree() || my_tpu[i]->isStalled()) continue;
-            is_any_tpu_active = true;
-
-            instr = my_tpu[i]->fetchAndExecute(SYS_Cycle());
-
-            if (my_driver->NextInstruction(instr,SYS_Cycle())) {
-                SYS_CommittedInsts(0) += my_tpu[i]->commit(SYS_Cycle());
-            }
+            cycles = runTPU(my_tpu[i], SYS_Cycle(), cycles,
+                            budget, stopMarker, is_any_tpu_active);
         } 
     }
-    my_driver->Clock(SYS_Cycle());
-    statCycles++;
-    SYS_Cycle()++;
+    for (UINT64 c = 0; c < cycles; c++) {
+        my_driver->Clock(SYS_Cycle());
+        statCycles++;
+        SYS_Cycle()++;
+    }
 
     // check for work in Tarati server
     asimTaratiSystem->Work();
@@ -194,6 +194,10 @@ class ASIM_APE_CLASS
     TPU my_tpu[NUM_HWCS_PER_CPU];                                                                
     DRIVER my_driver;
 
+    /* run one tpu for up to 'cycles' cycles, see SYS_Execute */
+    UINT64 runTPU(TPU tpu, UINT64 cycle, UINT64 cycles,
+                  UINT64 & budget, UINT64 stopMarker, bool & active);
+
   public:
     ASIM_APE_CLASS (const char *n);
                                                                   
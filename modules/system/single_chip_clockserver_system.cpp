@@ -69,7 +69,7 @@ ASIM_COMMON_SYSTEM_CLASS::ASIM_COMMON_SYSTEM_CLASS(
     // We obtain the system wide clock server and set the clocking random seed
     clock = ASIM_CLOCKABLE_CLASS::GetClockServer();
     clock -> SetRandomClockingSeed(RANDOM_CLOCKING_SEED);
-    clock -> SetDumpProfile(DUMP_CLOCKING_PROFILE);
+    clock -> SetDumpProfile(DUMP_CLOCKING_PROFILE, CLOCKING_PROFILE_HZ);
     clock -> SetThreadedClocking  ( THREADED_CLOCKING == 1       ,
                                     CLOCKSERVER_THREAD_LOOKAHEAD ,
                                     CLOCKSERVER_THREAD_DELAY     );
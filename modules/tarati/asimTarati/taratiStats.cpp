@@ -22,7 +22,11 @@
  * @brief ASIM Tarati Service: Stats
  */
 
+
 // generic
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
 
 // ASIM local modules
 #include "taratiStats.h"
@@ -45,14 +49,22 @@ Stats::Stats(
 {
     // setup knowledge about PM
     pmSystem = system;
-    pmState = NULL;
 
-    // create a linked list of all state of the PM
+    // collect all state of the PM; its position is its handle.  The list
+    // is in reverse iteration order, like the linked list it replaced, so
+    // Find still returns the last state registered under a name.
     STATE_ITERATOR_CLASS iter(system, true);
     ASIM_STATE state;
     while ((state = iter.Next()) != NULL) {
-        pmState = new ASIM_STATELINK_CLASS(state, pmState, false);
+        pmState.push_back(state);
     }
+    reverse(pmState.begin(), pmState.end());
+    nameIndex = new Index(pmState, &ASIM_STATE_CLASS::Name);
+    pathIndex = new Index(pmState, &ASIM_STATE_CLASS::Path);
+
+    // the server publishes the first snapshot when its thread starts
+    published = NULL;
+    current = NULL;
 
     // instantiate and register methods
     method.states = new States(this);
@@ -61,6 +73,7 @@ Stats::Stats(
     method.name = new Name(this);
     method.desc = new Desc(this);
     method.value = new Value(this);
+    method.query = new Query(this);
 }
 
 /**
@@ -76,16 +89,100 @@ Stats::~Stats()
     delete method.name;
     delete method.desc;
     delete method.value;
+    delete method.query;
 
     // forget what we know about PM
     pmSystem = NULL;
 
     // delete allocated memory
-    while (pmState) {
-        ASIM_STATELINK nextState = pmState->next;
-        delete pmState;
-        pmState = nextState;
+    delete nameIndex;
+    delete pathIndex;
+    pmState.clear();
+    delete published;
+    delete current;
+}
+
+/**
+ * Map a handle passed in by the client back to its state.
+ */
+ASIM_STATE
+Stats::HandleToState(
+    XmlRpcValue & handle)
+{
+    if (handle.getType() != XmlRpcValue::TypeInt) {
+        throw XmlRpcException("state handle must be an int");
+    }
+    int h = handle;
+    if (h < 0 || h >= (int) pmState.size()) {
+        throw XmlRpcException("invalid state handle");
+    }
+    return pmState[h];
+}
+
+//----------------------------------------------------------------------------
+// Index
+//----------------------------------------------------------------------------
+/**
+ * Build the index over all 'states', keyed by the string 'key' returns.
+ */
+Stats::Index::Index(
+    const vector<ASIM_STATE> & states,
+    KeyFunc key)
+  : states(states),
+    key(key)
+{
+    // at least twice as many buckets as states, power of two
+    UINT32 buckets = 16;
+    while (buckets < 2 * states.size()) {
+        buckets *= 2;
+    }
+    bucket.assign(buckets, -1);
+    next.assign(states.size(), -1);
+
+    // insert back to front, so each chain is in handle order
+    for (INT32 h = states.size() - 1; h >= 0; h--) {
+        UINT32 b = Hash((states[h]->*key)()) & (buckets - 1);
+        next[h] = bucket[b];
+        bucket[b] = h;
+    }
+}
+
+/**
+ * Case insensitive FNV-1a hash of 'k'.
+ */
+UINT32
+Stats::Index::Hash(
+    const char * k)
+{
+    UINT32 hash = 2166136261U;
+    for ( ; *k; k++) {
+        hash = (hash ^ (UINT8) tolower(*k)) * 16777619U;
+    }
+    return hash;
+}
+
+INT32
+Stats::Index::First(
+    const char * k) const
+{
+    INT32 h = bucket[Hash(k) & (bucket.size() - 1)];
+    if (h >= 0 && strcasecmp((states[h]->*key)(), k) != 0) {
+        h = Next(h, k);
     }
+    return h;
+}
+
+INT32
+Stats::Index::Next(
+    INT32 handle,
+    const char * k) const
+{
+    for (INT32 h = next[handle]; h >= 0; h = next[h]) {
+        if (strcasecmp((states[h]->*key)(), k) == 0) {
+            return h;
+        }
+    }
+    return -1;
 }
 
 //----------------------------------------------------------------------------
@@ -108,25 +205,20 @@ Stats::States::execute(
         if (params.size() != 1) {
             throw XmlRpcException("wrong number of arguments in method call");
         }
-        path = ((string) params[0]).c_str();
+        path = ((string &) params[0]).c_str();
     }
 
-    ASIM_STATELINK scan = stats->pmState;
-    while (scan != NULL) {
-        ASIM_STATE state = scan->state;
-
-        if ((path == NULL) ||
-            (strcasecmp(state->Path(), path) == 0))
+    if (path == NULL) {
+        for (INT32 h = 0; h < (INT32) stats->pmState.size(); h++) {
+            result[results++] = h;
+        }
+    } else {
+        // If 'path' equals 'state's path, then return 'state's handle.
+        for (INT32 h = stats->pathIndex->First(path); h >= 0;
+             h = stats->pathIndex->Next(h, path))
         {
-            // If 'path' equals 'state's path, then return 'state's descriptor.
-            result[results] = (int) state;
-            // result[results]["path"] = state->Path();
-            // result[results]["name"] = state->Name();
-            // result[results]["desc"] = state->Description();
-            results++;
+            result[results++] = h;
         }
-
-        scan = scan->next;
     }
 }
 
@@ -144,24 +236,17 @@ Stats::Find::execute(
     {
         throw XmlRpcException("wrong number of arguments in method call");
     }
-    name = ((string) params[0]).c_str();
-
-    ASIM_STATELINK scan = stats->pmState;
-    while (scan != NULL) {
-        ASIM_STATE state = scan->state;
-
-        if (strcasecmp(state->Name(), name) == 0) {
-            result[0] = (int) state;
-            return;
-        }
+    name = ((string &) params[0]).c_str();
 
-        scan = scan->next;
+    INT32 h = stats->nameIndex->First(name);
+    if (h >= 0) {
+        result[0] = h;
     }
 }
 
 static inline
-ASIM_STATE
-ParamToState (
+XmlRpcValue &
+SingleParam (
     XmlRpcValue & params)
 {
     // get params
@@ -171,7 +256,7 @@ ParamToState (
         throw XmlRpcException("wrong number of arguments in method call");
     }
     
-    return (ASIM_STATE) ((int) params[0]);
+    return params[0];
 }
 
 //----- Path -----
@@ -180,7 +265,7 @@ Stats::Path::execute(
     XmlRpcValue & params,
     XmlRpcValue & result)
 {
-    result = ParamToState(params)->Path();
+    result = stats->HandleToState(SingleParam(params))->Path();
 }
 
 //----- Name -----
@@ -189,7 +274,7 @@ Stats::Name::execute(
     XmlRpcValue & params,
     XmlRpcValue & result)
 {
-    result = ParamToState(params)->Name();
+    result = stats->HandleToState(SingleParam(params))->Name();
 }
 
 //----- Desc -----
@@ -198,45 +283,326 @@ Stats::Desc::execute(
     XmlRpcValue & params,
     XmlRpcValue & result)
 {
-    result = ParamToState(params)->Description();
+    result = stats->HandleToState(SingleParam(params))->Description();
 }
 
 //----- Value -----
+/**
+ * Read back the values in a packed state record.
+ */
+class Unpacker
+{
+  private:
+    const XmlRpcValue::BinaryData & in;
+    size_t pos;
+
+  public:
+    Unpacker(const XmlRpcValue::BinaryData & _in)
+      : in(_in),
+        pos(0)
+    {};
+
+    void Read(void * data, size_t size)
+    {
+        ASSERTX(pos + size <= in.size());
+        memcpy(data, &in[pos], size);
+        pos += size;
+    }
+    UINT32 ReadUINT32(void) { UINT32 v; Read(&v, sizeof(v)); return v; }
+    UINT64 ReadUINT64(void) { UINT64 v; Read(&v, sizeof(v)); return v; }
+    double ReadDouble(void) { double v; Read(&v, sizeof(v)); return v; }
+
+    /// XML-RPC has no 64-bit int: counts that don't fit an int are doubles
+    XmlRpcValue ReadCount(void)
+    {
+        UINT64 v = ReadUINT64();
+        if (v <= (UINT64) INT_MAX) {
+            return XmlRpcValue((int) v);
+        }
+        return XmlRpcValue((double) v);
+    }
+};
+
+/**
+ * Unpack a histogram into 'result' as an array of rows, up to the last
+ * row holding data.
+ */
+static void
+HistToValue (
+    Unpacker & in,
+    XmlRpcValue & result)
+{
+    in.ReadUINT32(); // rows
+    UINT32 cols = in.ReadUINT32();
+    UINT32 count = in.ReadUINT32();
+
+    result.setSize(0);
+    UINT32 next = 0;
+    for (UINT32 i = 0; i < count; i++) {
+        // fill in the empty rows left out of the record
+        UINT32 row = in.ReadUINT32();
+        for ( ; next < row; next++) {
+            for (UINT32 c = 0; c < cols; c++) {
+                result[next][c] = 0;
+            }
+        }
+        for (UINT32 c = 0; c < cols; c++) {
+            result[row][c] = in.ReadCount();
+        }
+        next = row + 1;
+    }
+}
+
 void
 Stats::Value::execute(
     XmlRpcValue & params,
     XmlRpcValue & result)
 {
-    ASIM_STATE state = ParamToState(params);
+    XmlRpcValue & param = SingleParam(params);
+    stats->HandleToState(param);
+    INT32 handle = (int) param;
+    const Snapshot * snapshot = stats->Reading();
+
+    XmlRpcValue::BinaryData live;
+    if (snapshot == NULL) {
+        stats->PackState(live, handle);
+    }
+    Unpacker in(snapshot ? snapshot->record[handle] : live);
+
+    in.ReadUINT32(); // handle
+    UINT32 type = in.ReadUINT32();
 
     // bluntly copied from awb.cpp:PmStateValue()
-    if (state != NULL) {
-        // Iterate through 'state's values, appending them to the result list
-        switch (state->Type()) {
-          case STATE_UINT:
-            for (UINT32 i = 0; i < state->Size(); i++) {
-                result[i] = (int) state->IntValue(i);
+    // Iterate through 'state's values, appending them to the result list
+    switch (type) {
+      case STATE_UINT:
+        {
+            UINT32 size = in.ReadUINT32();
+            for (UINT32 i = 0; i < size; i++) {
+                result[i] = in.ReadCount();
             }
-            break;
-          case STATE_FP:
-            for (UINT32 i = 0; i < state->Size(); i++) {
-                result[i] = state->FpValue(i);
+        }
+        break;
+      case STATE_FP:
+        {
+            UINT32 size = in.ReadUINT32();
+            for (UINT32 i = 0; i < size; i++) {
+                result[i] = in.ReadDouble();
             }
-          case STATE_HISTOGRAM:
-            result = "state type STATE_HISTOGRAM not supported";
-            break;
-          case STATE_RESOURCE:
-            result = "state type STATE_RESOURCE not supported";
-            break;
-          case STATE_THREE_DIM_HISTOGRAM:
-            result = "state type STATE_THREE_DIM_HISTOGRAM not supported";
-            break;
-          default:
-            ostringstream os;
-            os << "unknown state type " << state->Type();
-            result = os.str();
         }
+        break;
+      case STATE_STRING:
+        {
+            string value(in.ReadUINT32(), ' ');
+            if ( ! value.empty()) {
+                in.Read(&value[0], value.size());
+            }
+            result = value;
+        }
+        break;
+      case STATE_HISTOGRAM:
+      case STATE_RESOURCE:
+        HistToValue(in, result);
+        break;
+      case STATE_THREE_DIM_HISTOGRAM:
+        {
+            UINT32 count = in.ReadUINT32();
+            result.setSize(count);
+            for (UINT32 i = 0; i < count; i++) {
+                HistToValue(in, result[i]);
+            }
+        }
+        break;
+      default:
+        ostringstream os;
+        os << "unknown state type " << type;
+        result = os.str();
+    }
+}
+
+//----- Query -----
+/**
+ * Append 'size' bytes at 'data' to the packed reply 'out'.
+ */
+static inline void
+Pack (
+    XmlRpcValue::BinaryData & out,
+    const void * data,
+    size_t size)
+{
+    const char * bytes = (const char *) data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+static inline void
+PackUINT32 (
+    XmlRpcValue::BinaryData & out,
+    UINT32 value)
+{
+    Pack(out, &value, sizeof(value));
+}
+
+/**
+ * Append 'hist' to the packed reply 'out', leaving out empty rows.
+ */
+static void
+PackHist (
+    XmlRpcValue::BinaryData & out,
+    const HISTOGRAM_TEMPLATE<true> & hist)
+{
+    UINT32 rows = hist.NumRows();
+    UINT32 cols = hist.NumCols();
+    PackUINT32(out, rows);
+    PackUINT32(out, cols);
+
+    // row count is patched in once we know it
+    size_t countPos = out.size();
+    UINT32 count = 0;
+    PackUINT32(out, count);
+    for (UINT32 r = 0; r < rows; r++) {
+        const UINT64 * data = hist.RowData(r);
+        if (data != NULL) {
+            PackUINT32(out, r);
+            Pack(out, data, cols * sizeof(UINT64));
+            count++;
+        }
+    }
+    memcpy(&out[countPos], &count, sizeof(count));
+}
+
+/**
+ * Append the record of state 'handle' as described for Query to 'out',
+ * reading the live state.
+ */
+void
+Stats::PackState(
+    XmlRpcValue::BinaryData & out,
+    INT32 handle) const
+{
+    ASIM_STATE state = pmState[handle];
+    PackUINT32(out, handle);
+    PackUINT32(out, state->Type());
+
+    switch (state->Type()) {
+      case STATE_UINT:
+        PackUINT32(out, state->Size());
+        for (UINT32 j = 0; j < state->Size(); j++) {
+            UINT64 v = state->IntValue(j);
+            Pack(out, &v, sizeof(v));
+        }
+        break;
+      case STATE_FP:
+        PackUINT32(out, state->Size());
+        for (UINT32 j = 0; j < state->Size(); j++) {
+            double v = state->FpValue(j);
+            Pack(out, &v, sizeof(v));
+        }
+        break;
+      case STATE_STRING:
+        {
+            string v = state->StrValue();
+            PackUINT32(out, v.size());
+            Pack(out, v.data(), v.size());
+        }
+        break;
+      case STATE_HISTOGRAM:
+      case STATE_RESOURCE:
+        PackHist(out, *state->HistValue());
+        break;
+      case STATE_THREE_DIM_HISTOGRAM:
+        {
+            const THREE_DIM_HISTOGRAM_TEMPLATE<true> * tdh =
+                state->ThreeDimHistValue();
+            PackUINT32(out, tdh->NumHist());
+            for (UINT32 j = 0; j < tdh->NumHist(); j++) {
+                PackHist(out, tdh->Hist(j));
+            }
+        }
+        break;
+      default:
+        // just the header, Value reports the unknown type
+        break;
+    }
+}
+
+void
+Stats::Query::execute(
+    XmlRpcValue & params,
+    XmlRpcValue & result)
+{
+    // get params: either the handles or one array of handles
+    if (params.getType() != XmlRpcValue::TypeArray) {
+        throw XmlRpcException("wrong number of arguments in method call");
+    }
+    XmlRpcValue & handles =
+        (params.size() == 1 &&
+         params[0].getType() == XmlRpcValue::TypeArray) ? params[0] : params;
+
+    // check all handles before reading anything
+    for (int i = 0; i < handles.size(); i++) {
+        stats->HandleToState(handles[i]);
+    }
+
+    const Snapshot * snapshot = stats->Reading();
+    XmlRpcValue::BinaryData out;
+    for (int i = 0; i < handles.size(); i++) {
+        int handle = handles[i];
+        if (snapshot != NULL) {
+            const XmlRpcValue::BinaryData & record = snapshot->record[handle];
+            out.insert(out.end(), record.begin(), record.end());
+        } else {
+            stats->PackState(out, handle);
+        }
+    }
+
+    result = XmlRpcValue(out.empty() ? NULL : &out[0], out.size());
+}
+
+//----------------------------------------------------------------------------
+// Snapshot
+//----------------------------------------------------------------------------
+/**
+ * Called on the simulation thread: pack the values of all state into a
+ * new snapshot and publish it for the server thread. A snapshot that is
+ * still waiting there was never read and is dropped.
+ */
+void
+Stats::Publish (void)
+{
+    Snapshot * fresh = new Snapshot;
+    fresh->record.resize(pmState.size());
+    for (INT32 h = 0; h < (INT32) pmState.size(); h++) {
+        PackState(fresh->record[h], h);
+    }
+
+    // the contents must be visible before the pointer is
+    __sync_synchronize();
+    Snapshot * stale = __sync_lock_test_and_set(&published, fresh);
+    delete stale;
+}
+
+/**
+ * Get the values to serve a request from. Without a server thread the
+ * methods read the live state (NULL). Otherwise use the newest snapshot
+ * the simulation thread has published, without waiting for it. Only the
+ * server thread reads snapshots, so it owns 'current' and frees it.
+ */
+const Stats::Snapshot *
+Stats::Reading (void)
+{
+    if ( ! GetServer()->Threaded()) {
+        return NULL;
+    }
+
+    Snapshot * fresh = __sync_lock_test_and_set(&published, (Snapshot *) NULL);
+    if (fresh != NULL) {
+        delete current;
+        current = fresh;
+    }
+    if (current == NULL) {
+        throw XmlRpcException("no snapshot of the model state published yet");
     }
+    return current;
 }
 
 } // namespace AsimTarati
@@ -25,6 +25,10 @@
 #ifndef _TARATI_STATS_
 #define _TARATI_STATS_
 
+// generic
+#include <vector>
+#include <pthread.h>
+
 // ASIM core
 #include "asim/state.h"
 
@@ -41,6 +45,16 @@ namespace AsimTarati {
 //----------------------------------------------------------------------------
 /**
  * @brief Tarati Service: Stats of model
+ *
+ * States are identified by handles, which are their index in the list
+ * of all PM state built at startup. Lookups by name and by path go
+ * through hashed indexes over that list.
+ *
+ * All methods are concurrent. When the Tarati server runs on its own
+ * thread, Value and Query do not touch the live state. They read a
+ * snapshot of all values that the simulation thread publishes every
+ * TARATI_PUBLISH_PERIOD ms (see Publish and Reading), so a client
+ * never waits for the simulation thread.
  */
 class Stats
   : public Service
@@ -63,7 +77,7 @@ class Stats
 
       public:
         States(Stats * _stats)
-          : Method(_stats, "States"),
+          : Method(_stats, "States", true),
             stats(_stats) {};
 
         /// RPC call method
@@ -73,6 +87,9 @@ class Stats
 
     /**
      * @brief Tarati Method: Find(name)
+     *
+     * Returns the lowest handle with that name, which is the state
+     * registered last.
      */
     class Find
       : public Method
@@ -82,7 +99,7 @@ class Stats
 
       public:
         Find(Stats * _stats)
-          : Method(_stats, "Find"),
+          : Method(_stats, "Find", true),
             stats(_stats) {};
 
         /// RPC call method
@@ -96,13 +113,18 @@ class Stats
     class Path
       : public Method
     {
+      private:
+        Stats * stats;
+
       public:
         Path(Stats * _stats)
-          : Method(_stats, "Path") {};
+          : Method(_stats, "Path", true),
+            stats(_stats) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
     };
+    friend class Path;
 
     /**
      * @brief Tarati Method: Name(handle)
@@ -110,13 +132,18 @@ class Stats
     class Name
       : public Method
     {
+      private:
+        Stats * stats;
+
       public:
         Name(Stats * _stats)
-          : Method(_stats, "Name") {};
+          : Method(_stats, "Name", true),
+            stats(_stats) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
     };
+    friend class Name;
 
     /**
      * @brief Tarati Method: Desc(handle)
@@ -124,27 +151,72 @@ class Stats
     class Desc
       : public Method
     {
+      private:
+        Stats * stats;
+
       public:
         Desc(Stats * _stats)
-          : Method(_stats, "Desc") {};
+          : Method(_stats, "Desc", true),
+            stats(_stats) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
     };
+    friend class Desc;
 
     /**
      * @brief Tarati Method: Value(handle)
+     *
+     * Counts above INT_MAX are returned as doubles, since XML-RPC has
+     * no 64-bit integer type.
      */
     class Value
       : public Method
     {
+      private:
+        Stats * stats;
+
       public:
         Value(Stats * _stats)
-          : Method(_stats, "Value") {};
+          : Method(_stats, "Value", true),
+            stats(_stats) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
     };
+    friend class Value;
+
+    /**
+     * @brief Tarati Method: Query(handle, ...)
+     *
+     * Returns the values of all requested states in one base64 blob,
+     * packed in host byte order. For each state the blob holds its
+     * UINT32 handle and UINT32 ASIM_STATETYPE, followed by
+     * <ul>
+     * <li> STATE_UINT, STATE_FP: UINT32 size, size UINT64 or double values
+     * <li> STATE_STRING: UINT32 length, length characters
+     * <li> STATE_HISTOGRAM, STATE_RESOURCE: one histogram
+     * <li> STATE_THREE_DIM_HISTOGRAM: UINT32 count, count histograms
+     * </ul>
+     * A histogram is UINT32 rows, UINT32 cols, UINT32 number of rows
+     * holding data, and for each of those rows its UINT32 index followed
+     * by cols UINT64 values. Rows that are left out are all zero.
+     */
+    class Query
+      : public Method
+    {
+      private:
+        Stats * stats;
+
+      public:
+        Query(Stats * _stats)
+          : Method(_stats, "Query", true),
+            stats(_stats) {};
+
+        /// RPC call method
+        void execute(XmlRpcValue& params, XmlRpcValue& result);
+    };
+    friend class Query;
 
     struct _method {
         States * states;
@@ -153,17 +225,65 @@ class Stats
         Name * name;
         Desc * desc;
         Value * value;
+        Query * query;
     } method;
 
     //------------------------------------------------------------------------
     // Service
     //------------------------------------------------------------------------
-    ASIM_SYSTEM    pmSystem; ///< root of the PM (system module)
-    ASIM_STATELINK pmState;  ///< root of linked list of all PM state
+    /**
+     * @brief Hashed index of the PM state by one of its strings
+     *
+     * Keys compare case insensitive. States with the same key are
+     * chained in handle order.
+     */
+    class Index
+    {
+      private:
+        typedef const char * (ASIM_STATE_CLASS::*KeyFunc)(void) const;
+
+        const vector<ASIM_STATE> & states; ///< states being indexed
+        KeyFunc key;            ///< state accessor giving the key
+        vector<INT32> bucket;   ///< first handle per bucket, or -1
+        vector<INT32> next;     ///< next handle in chain, or -1
+
+        static UINT32 Hash (const char * k);
+
+      public:
+        Index(const vector<ASIM_STATE> & states, KeyFunc key);
+
+        /// First handle with key 'k', or -1
+        INT32 First (const char * k) const;
+        /// Handle after 'handle' with key 'k', or -1
+        INT32 Next (INT32 handle, const char * k) const;
+    };
+
+    /// Records of all PM state, as packed by Query, indexed by handle
+    struct Snapshot {
+        vector<XmlRpcValue::BinaryData> record;
+    };
+
+    ASIM_SYSTEM pmSystem;       ///< root of the PM (system module)
+    vector<ASIM_STATE> pmState; ///< all PM state, indexed by handle
+    Index * nameIndex;          ///< pmState by state name
+    Index * pathIndex;          ///< pmState by state path
+
+    Snapshot * volatile published; ///< newest snapshot, not picked up yet
+    Snapshot * current;         ///< snapshot owned by the server thread
+
+    /// Map a handle parameter to its state
+    ASIM_STATE HandleToState (XmlRpcValue & handle);
+    /// Append the record of a state, read from the live state
+    void PackState (XmlRpcValue::BinaryData & out, INT32 handle) const;
+    /// Snapshot to serve a request from, NULL for the live state
+    const Snapshot * Reading (void);
 
   public:
     Stats(Server * server, ASIM_SYSTEM system);
     ~Stats();
+
+    /// Publish a snapshot of all values (simulation thread)
+    void Publish (void);
 };
 
 } // namespace AsimTarati
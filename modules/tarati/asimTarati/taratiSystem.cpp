@@ -46,10 +46,16 @@ System::System(ASIM_SYSTEM system)
     service.globalState = new GlobalState(server, system);
     service.stats = new Stats(server, system);
     service.timeScheduler = new TimeScheduler(server);
+
+    // all services are in place, serve requests
+    server->Start();
 }
 
 System::~System()
 {
+    // no more requests from the server thread
+    server->Stop();
+
     // delete services
     delete service.tclBeamer;
     delete service.globalState;
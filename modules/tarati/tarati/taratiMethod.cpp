@@ -35,11 +35,13 @@ namespace Tarati {
  */
 Method::Method(
     Service * service,
-    const string & name)
+    const string & name,
+    bool concurrent)
   : XmlRpcServerMethod ("undefined-method-name")
 {
     this->name = name;
     this->service = service;
+    this->concurrent = concurrent;
     service->MethodRegister(this);
 }
 
@@ -44,6 +44,11 @@ class Service;
  * @brief Tarati Method Object
  *
  * This class ...
+ *
+ * When the server runs on its own thread, methods are executed on the
+ * simulation thread (see Server::Work) unless they are created as
+ * concurrent, i.e. safe to run on the server thread while the model
+ * keeps running.
  */
 class Method
   : public XmlRpcServerMethod
@@ -53,10 +58,11 @@ class Method
   protected:
     Service * service;
     string name;
+    bool concurrent;
 
   public:
     // contructors / destructors
-    Method(Service * service, const string & name);
+    Method(Service * service, const string & name, bool concurrent = false);
     //~Method();
 
     // accessors / modifiers
@@ -68,6 +74,8 @@ class Method
     const string & GetName (void) const { return name; }
     /// Set method name
     //void SetName (const string & name) { this->name = name; }
+    /// May this method run on the server thread?
+    bool IsConcurrent (void) const { return concurrent; }
     //
     /// Get name from base class
     const string & GetXmlName (void) const { return _name; }
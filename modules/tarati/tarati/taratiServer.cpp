@@ -26,6 +26,8 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
+#include <errno.h>
   // semaphore stuff
 #include <sys/types.h>
 #include <sys/ipc.h>
@@ -40,6 +42,7 @@
 
 // ASIM public modules
 #include "asim/provides/tarati.h"
+#include "asim/smp.h"
 
 namespace Tarati {
 
@@ -83,6 +86,42 @@ void IoAttention(int signo, siginfo_t * info, void * context)
     ServerNeedsAttention = true;
 }
 
+//----------------------------------------------------------------------------
+// Hand off of non-concurrent methods
+//----------------------------------------------------------------------------
+/**
+ * @brief XML-RPC stand-in for a non-concurrent Method
+ *
+ * Runs the method right away unless the server is threaded, in which
+ * case the call is handed to the simulation thread.
+ */
+class Server::Handoff
+  : public XmlRpcServerMethod
+{
+  private:
+    Server * server;
+    Method * method;
+
+  public:
+    Handoff(Server * _server, Method * _method)
+      : XmlRpcServerMethod(_method->GetXmlName()),
+        server(_server),
+        method(_method)
+    {};
+
+    /// RPC call method
+    void execute(XmlRpcValue& params, XmlRpcValue& result)
+    {
+        if (server->Threaded()) {
+            server->HandOff(method, params, result);
+        } else {
+            method->execute(params, result);
+        }
+    }
+
+    std::string help() { return method->help(); }
+};
+
 //----------------------------------------------------------------------------
 // Server proper
 //----------------------------------------------------------------------------
@@ -91,6 +130,18 @@ void IoAttention(int signo, siginfo_t * info, void * context)
  */
 Server::Server()
 {
+    //
+    // no server thread until Start()
+    //
+    threaded = false;
+    stopThread = false;
+    threadExited = false;
+    callsPending = false;
+    publishCalls = 0;
+    timerclear(&lastPublish);
+    pthread_mutex_init(&callLock, NULL);
+    pthread_cond_init(&callDone, NULL);
+
     //
     // set a custom error handler for underlying XML-RPC errors
     //
@@ -157,13 +208,86 @@ Server::Server()
  */
 Server::~Server()
 {
+    Stop();
+
     // Server's built-in Service
     delete service.server;
 
+    // proxies of methods that were not unregistered
+    for (HandoffMap::iterator it = handoffs.begin();
+         it != handoffs.end();
+         ++it)
+    {
+        delete it->second;
+    }
+
     // XML-RPC
     delete xmlrpcServer;
+
+    pthread_mutex_destroy(&callLock);
+    pthread_cond_destroy(&callDone);
 };
 
+/**
+ * Start serving requests. With TARATI_SERVER_THREAD the XML-RPC server
+ * runs on its own thread from here on. All services and methods must be
+ * registered before calling this.
+ */
+void
+Server::Start (void)
+{
+    if (TARATI_SERVER_THREAD && ! threaded) {
+        // the first requests already have a snapshot to read
+        PublishAll();
+        gettimeofday(&lastPublish, NULL);
+
+        stopThread = false;
+        threadExited = false;
+        threaded = true;
+        if (pthread_create(&thread, NULL, ThreadMain, this) != 0) {
+            TARATI_ERROR("can't create Tarati server thread");
+        }
+        ASIM_SMP_CLASS::NoteHelperThreadStarted();
+    }
+}
+
+/**
+ * Stop the server thread. Calls it handed off are still served until it
+ * has exited.
+ */
+void
+Server::Stop (void)
+{
+    if (threaded) {
+        stopThread = true;
+        while ( ! threadExited) {
+            RunPending();
+            usleep(1000);
+        }
+        pthread_join(thread, NULL);
+        threaded = false;
+        ASIM_SMP_CLASS::NoteHelperThreadStopped();
+    }
+}
+
+/**
+ * Body of the server thread
+ */
+void *
+Server::ThreadMain (
+    void * arg)
+{
+    Server * server = (Server *) arg;
+
+    // look at stopThread every so often
+    while ( ! server->stopThread) {
+        server->xmlrpcServer->work(0.25);
+    }
+
+    server->threadExited = true;
+    return NULL;
+}
+
 /**
  * Register a new service
  */
@@ -198,7 +322,13 @@ Server::MethodRegister (
     Method * method) ///< new method to register
 { 
     method->SetXmlName (GenerateMethodName (method));
-    xmlrpcServer->addMethod (method);
+    if (method->IsConcurrent()) {
+        xmlrpcServer->addMethod (method);
+    } else {
+        Handoff * handoff = new Handoff (this, method);
+        handoffs[method] = handoff;
+        xmlrpcServer->addMethod (handoff);
+    }
 }
 
 /**
@@ -208,7 +338,14 @@ void
 Server::MethodUnregister (
     Method * method) ///< existing method to unregister
 {
+    // note: this goes by name, so it removes a hand off proxy as well
     xmlrpcServer->removeMethod (method);
+
+    HandoffMap::iterator it = handoffs.find(method);
+    if (it != handoffs.end()) {
+        delete it->second;
+        handoffs.erase(it);
+    }
 }
 
 /**
@@ -238,8 +375,141 @@ Server::Work (
         if (semctl (ServerAttentionSema, 0, SETVAL, 0) == -1) {
             TARATI_ERROR("internal semaphore error: " << strerror(errno));
         }
-        // and pick up all accumulated work
-        xmlrpcServer->work(timeout);
+        if (threaded) {
+            // the server thread does the I/O, we only run the calls
+            // it handed to us
+            RunPending();
+        } else {
+            // and pick up all accumulated work
+            xmlrpcServer->work(timeout);
+        }
+    }
+
+    RunPublish();
+}
+
+/**
+ * Make the next Work() do something, and wake up Wait().
+ */
+void
+Server::Attention (void)
+{
+    ServerNeedsAttention = true;
+
+    struct sembuf operation;
+    operation.sem_num = 0;
+    operation.sem_op = 1; // increment by 1
+    operation.sem_flg = 0;
+    semop (ServerAttentionSema, &operation, 1);
+}
+
+/**
+ * Called on the server thread: queue a call for the simulation thread
+ * and wait until it has been run.
+ */
+void
+Server::HandOff (
+    Method * method,
+    XmlRpcValue & params,
+    XmlRpcValue & result)
+{
+    PendingCall call;
+    call.method = method;
+    call.params = &params;
+    call.result = &result;
+    call.done = false;
+    call.failed = false;
+    call.errorCode = 0;
+
+    pthread_mutex_lock(&callLock);
+    pendingCalls.push_back(&call);
+    callsPending = true;
+    pthread_mutex_unlock(&callLock);
+
+    Attention();
+
+    pthread_mutex_lock(&callLock);
+    while ( ! call.done) {
+        pthread_cond_wait(&callDone, &callLock);
+    }
+    pthread_mutex_unlock(&callLock);
+
+    if (call.failed) {
+        throw XmlRpcException(call.error, call.errorCode);
+    }
+}
+
+/**
+ * Called on the simulation thread: run all calls handed off by the
+ * server thread.
+ */
+void
+Server::RunPending (void)
+{
+    if ( ! callsPending) {
+        return;
+    }
+
+    pthread_mutex_lock(&callLock);
+    while ( ! pendingCalls.empty()) {
+        PendingCall * call = pendingCalls.front();
+        pendingCalls.pop_front();
+        pthread_mutex_unlock(&callLock);
+
+        try {
+            call->method->execute(*call->params, *call->result);
+        }
+        catch (const XmlRpcException & e) {
+            call->failed = true;
+            call->error = e.getMessage();
+            call->errorCode = e.getCode();
+        }
+
+        pthread_mutex_lock(&callLock);
+        call->done = true;
+        pthread_cond_broadcast(&callDone);
+    }
+    callsPending = false;
+    pthread_mutex_unlock(&callLock);
+}
+
+/**
+ * Called on the simulation thread: call Publish() on all services once
+ * TARATI_PUBLISH_PERIOD ms have passed since the last time. Requests
+ * play no part in it, so the server thread never waits for a snapshot.
+ */
+void
+Server::RunPublish (void)
+{
+    if ( ! threaded || ++publishCalls < publishCheck) {
+        return;
+    }
+    publishCalls = 0;
+
+    struct timeval now, elapsed;
+    gettimeofday(&now, NULL);
+    timersub(&now, &lastPublish, &elapsed);
+    if (elapsed.tv_sec * 1000 + elapsed.tv_usec / 1000 <
+        (long) TARATI_PUBLISH_PERIOD)
+    {
+        return;
+    }
+
+    lastPublish = now;
+    PublishAll();
+}
+
+/**
+ * Call Publish() on all services (simulation thread)
+ */
+void
+Server::PublishAll (void)
+{
+    for (ServiceMap::iterator it = services.begin();
+         it != services.end();
+         ++it)
+    {
+        it->second->Publish();
     }
 }
 
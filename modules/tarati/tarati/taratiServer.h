@@ -28,6 +28,9 @@
 // generic
 #include <string>
 #include <map>
+#include <deque>
+#include <pthread.h>
+#include <sys/time.h>
 
 // XML-RPC low level transport library
 #include <asim/provides/xmlrpc.h>
@@ -51,6 +54,15 @@ namespace ServerBuiltin {
  * @brief Tarati Server Object
  *
  * This class ...
+ *
+ * By default all requests are served from Work(), i.e. on the simulation
+ * thread. With TARATI_SERVER_THREAD set, Start() moves the XML-RPC server
+ * to a thread of its own. Concurrent methods then run on that thread,
+ * and all other methods are handed to the simulation thread, which runs
+ * them the next time it calls Work() while the server thread waits.
+ * Every TARATI_PUBLISH_PERIOD ms Work() also calls Publish() on all
+ * services, which gives concurrent methods a copy of the model state
+ * to read.
  */
 class Server
 {
@@ -59,16 +71,55 @@ class Server
     typedef map<string, Service *> ServiceMap;
 
   private:
+    // types
+    class Handoff;
+    typedef map<Method *, Handoff *> HandoffMap;
+
+    /// A method call waiting for the simulation thread
+    struct PendingCall {
+        Method * method;
+        XmlRpcValue * params;
+        XmlRpcValue * result;
+        bool done;          ///< call has been executed
+        bool failed;        ///< call threw 'error'
+        string error;
+        int errorCode;
+    };
+
     // members
     // -- XML-RPC
     XmlRpcServer * xmlrpcServer;  ///< XML-RPC transport layer server
     // -- registered services 
     ServiceMap services;           ///< registered service to object map
+    HandoffMap handoffs;           ///< proxies of non-concurrent methods
 
     struct _service {
       ServerBuiltin::Server * server; ///< built-in server service
     } service;
 
+    // -- server thread
+    pthread_t thread;              ///< thread running the XML-RPC server
+    volatile bool threaded;        ///< 'thread' is serving requests
+    volatile bool stopThread;      ///< ask 'thread' to exit
+    volatile bool threadExited;    ///< 'thread' has left its loop
+    pthread_mutex_t callLock;      ///< protects pendingCalls and done
+    pthread_cond_t callDone;       ///< signaled when calls are done
+    deque<PendingCall *> pendingCalls; ///< calls for the simulation thread
+    volatile bool callsPending;    ///< hint: pendingCalls is not empty
+    unsigned int publishCalls;     ///< Work() calls since the clock was read
+    struct timeval lastPublish;    ///< time of the last Publish()
+
+    /// Work() calls between looks at the clock for the next Publish()
+    static const unsigned int publishCheck = 16;
+
+    static void * ThreadMain (void * server);
+    void Attention (void);
+    void RunPending (void);
+    void RunPublish (void);
+    void PublishAll (void);
+    void HandOff (Method * method, XmlRpcValue & params,
+                  XmlRpcValue & result);
+
   public:
     // constructors / destructors
     Server();
@@ -84,8 +135,14 @@ class Server
     /// Accessor for registered services
     const ServiceMap & GetServices (void) const { return services; }
     int GetPort (void) const { return xmlrpcServer->getPort(); }
+    /// Are requests served from the server thread?
+    bool Threaded (void) const { return threaded; }
 
     // other methods
+    /// start serving requests (from a thread if TARATI_SERVER_THREAD)
+    void Start (void);
+    /// stop the server thread, if any
+    void Stop (void);
     /// check if there is work and do it
     void Work (double timeout = 0.0);
     /// wait for work to become available
@@ -64,7 +64,7 @@ class Server
     {
       public:
         ServiceDirectory(Service * service)
-          : Method(service, "ServiceDirectory") {};
+          : Method(service, "ServiceDirectory", true) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
@@ -78,7 +78,7 @@ class Server
     {
       public:
         Rusage(Service * service)
-          : Method(service, "Rusage") {};
+          : Method(service, "Rusage", true) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
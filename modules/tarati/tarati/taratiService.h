@@ -73,7 +73,7 @@ class Service
     {
       public:
         MethodDirectory(Service * service)
-          : Method(service, "MethodDirectory") {};
+          : Method(service, "MethodDirectory", true) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
@@ -87,7 +87,7 @@ class Service
     {
       public:
         Version(Service * service)
-          : Method(service, "Version") {};
+          : Method(service, "Version", true) {};
 
         /// RPC call method
         void execute(XmlRpcValue& params, XmlRpcValue& result);
@@ -103,7 +103,7 @@ class Service
     // constructors / destructors
     Service(Server * server, const string & name,
         const string & version);
-    ~Service();
+    virtual ~Service();
 
     // registration methods
     void MethodRegister (Method * method);
@@ -113,6 +113,9 @@ class Service
     // accessors / modifiers
     Server * GetServer(void) const { return server; }
     const string & GetName(void) const { return name; }
+
+    /// Publish model state for concurrent methods (see Server::RunPublish)
+    virtual void Publish (void) {}
 };
 
 } // namespace Tarati
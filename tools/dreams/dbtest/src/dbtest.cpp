@@ -50,12 +50,19 @@ bool trackItems;
 bool trackCycles;
 bool verbose;
 bool backProp;
+bool tagValueIndex;
+bool useCache;
+INT32 windowFirst;
+INT32 windowLast;
+INT32 decodeThreads;
+INT32 pagingBudget;
 QStringList trackNodeList;
 QStringList trackEdgeList;
 QStringList trackEnterNodeList;
 QStringList trackExitNodeList;
 QStringList getItemTagList;
 QStringList getTrackTagList;
+QStringList lookForValueList;
 
 INT32 cycleTrackId;
 DralDB* db;
@@ -104,6 +111,11 @@ bool parseNextParameter(int argc, char** argv, int *idx)
     static bool option_trackcycles = false;
     static bool option_verbose     = false;
     static bool option_bprop       = false;
+    static bool option_tvindex     = false;
+    static bool option_cache       = false;
+    static bool option_window      = false;
+    static bool option_threads     = false;
+    static bool option_paging      = false;
     int carg = *idx;
 
     // check -l option
@@ -228,6 +240,89 @@ bool parseNextParameter(int argc, char** argv, int *idx)
         return true;
     }
 
+    if (!strcmp(argv[carg],"-tagValueIndex"))
+    {
+        if (option_tvindex) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        char* value =argv[carg++];
+        *idx = carg;
+        if (!strcasecmp(value,"false"))
+        {
+            tagValueIndex = false;
+        }
+        else if (!strcasecmp(value,"true"))
+        {
+            tagValueIndex = true;
+        }
+        else
+        {
+            return false;
+        }
+        option_tvindex = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-cache"))
+    {
+        if (option_cache) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        char* value =argv[carg++];
+        *idx = carg;
+        if (!strcasecmp(value,"false"))
+        {
+            useCache = false;
+        }
+        else if (!strcasecmp(value,"true"))
+        {
+            useCache = true;
+        }
+        else
+        {
+            return false;
+        }
+        option_cache = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-window"))
+    {
+        if (option_window) return false;
+        ++carg;
+        if ((carg+1)>=argc) return false;
+        windowFirst = atoi(argv[carg++]);
+        windowLast = atoi(argv[carg++]);
+        *idx = carg;
+        if ((windowFirst<0) || (windowLast<windowFirst)) return false;
+        option_window = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-threads"))
+    {
+        if (option_threads) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        decodeThreads = atoi(argv[carg++]);
+        *idx = carg;
+        if (decodeThreads<0) return false;
+        option_threads = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-pagingBudget"))
+    {
+        if (option_paging) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        pagingBudget = atoi(argv[carg++]);
+        *idx = carg;
+        if (pagingBudget<0) return false;
+        option_paging = true;
+        return true;
+    }
+
 
     if (!strcmp(argv[carg],"-trackNode"))
     {
@@ -283,6 +378,15 @@ bool parseNextParameter(int argc, char** argv, int *idx)
         return true;
     }
 
+    if (!strcmp(argv[carg],"-lookForValue"))
+    {
+        ++carg;
+        if (carg>=argc) return false;
+        lookForValueList += QString(argv[carg++]);
+        *idx = carg;
+        return true;
+    }
+
     // nothing known
     return false;
 }
@@ -297,6 +401,11 @@ void dumpSyntax(char* binname)
     printf("-trackItemTags true|false:\t\tEnable/disable item tags tracking. False by default.\n");
     printf("-itemTagBackPropagate true|false:\tEnable/disable item tags value back propagation. False by default.\n");
     printf("-trackCycleTags true|false:\t\tEnable/disable cycle-tag tracking. False by default.\n");
+    printf("-tagValueIndex true|false:\t\tEnable/disable the item tag-value index. False by default.\n");
+    printf("-cache true|false:\t\t\tLoad/save the database from/to dralfile.dbc. False by default.\n");
+    printf("-window first last:\t\t\tOnly read the given cycles, jumping to the sync point before first.\n");
+    printf("-threads n:\t\t\t\tDecompress the trace on n threads ahead of the reader. 0 by default.\n");
+    printf("-pagingBudget mb:\t\t\tKeep the closed track chunks under mb megabytes, paging out the rest. 0 (disabled) by default.\n");
     printf("-trackNode \"node[inst];d1,d2,...dN\":\tRequest tracking of such a node slot.\n");
     printf("-trackEnterNode \"node[i];d1...\":\tRequest tracking of enter nodes on such a node slot.\n");
     printf("-trackExitNode \"node[i];d1...\":\t\tRequest tracking of exit nodes on such a node slot.\n");
@@ -304,6 +413,7 @@ void dumpSyntax(char* binname)
     printf("\n");
     printf("-getTrackValue \"track_id tag cycle\":\tQuery the tag's value on a given cycle and track.\n");
     printf("-getItemValue \"item_id tag cycle\":\tQuery the tag's value on a given cycle and item.\n");
+    printf("-lookForValue \"tag value cycle\":\tQuery the items with such a tag value on a given cycle.\n");
     printf("\n");
     printf("-dumpgraph:\t\t\t\tDumps out the contents of the encoded dral graph\n");
     printf("-dumpitems:\t\t\t\tDumps out all the stored items with all their tags\n");
@@ -314,7 +424,7 @@ void dumpSyntax(char* binname)
     printf("\n");
     printf("Notes:\n");
     printf("1) Multiple -trackNode, -trackEnterNode, -trackExitNode, -trackEdge, \n");
-    printf("   -getTrackValue and -getItemValue instances supported.\n");
+    printf("   -getTrackValue, -getItemValue and -lookForValue instances supported.\n");
     printf("\n");
     printf("2) If you are unsure about the dral-graph structure of the examined drl file, run DBTEST\n");
     printf("   first only with the -dumpgraph option to get header information.\n");
@@ -341,6 +451,12 @@ void initGlobals()
     trackCycles = false;
     verbose = false;
     backProp = false;
+    tagValueIndex = false;
+    useCache = false;
+    windowFirst = -1;
+    windowLast = -1;
+    decodeThreads = 0;
+    pagingBudget = 0;
     cycleTrackId = -1;
     trackNodeList.clear();
     trackEdgeList.clear();
@@ -348,6 +464,7 @@ void initGlobals()
     trackExitNodeList.clear();
     getItemTagList.clear();
     getTrackTagList.clear();
+    lookForValueList.clear();
 
     db=NULL;
 }
@@ -361,6 +478,8 @@ void applyConf()
 
     // apply item conf
     db->trackItemTags(trackItems);
+    db->setTagValueIndex(tagValueIndex);
+    db->setUseCache(useCache);
 
     // apply cycle conf
     if (trackCycles)
@@ -526,6 +645,66 @@ void applyQueries()
             ++it;
         }
     }
+
+    // 3) check for item value searches
+    if (lookForValueList.count()>0)
+    {
+        QStringList::Iterator it = lookForValueList.begin();
+        while (it != lookForValueList.end())
+        {
+            QString tagName;
+            QString value;
+            UINT32 cycle;
+            INT32 tagId = -1;
+            bool dok = decodeValueQuery(*it,&tagName,&value,&cycle);
+            if (dok)
+            {
+                tagId = db->scanTagName(tagName);
+            }
+            if (tagId<0)
+            {
+                printf("Warning, the query '%s' is invalid for this drl, skipping...\n",(*it).latin1());
+            }
+            else
+            {
+                bool isString = (db->getTagValueType(tagId)==TagStringValue);
+                UINT64 intValue = 0;
+                bool vok = true;
+                if (!isString)
+                {
+                    intValue = value.toULongLong(&vok,0);
+                }
+                if (!vok)
+                {
+                    printf("Warning, the query '%s' is invalid. Value is not an integer.\n",(*it).latin1());
+                }
+                else
+                {
+                    // walk all the matching items
+                    ItemHandler ih;
+                    INT32 start = 0;
+                    INT32 found = 0;
+                    while (true)
+                    {
+                        if (isString)
+                        {
+                            db->lookForStrValue(&ih,(UINT16)tagId,value,true,true,cycle,start);
+                        }
+                        else
+                        {
+                            db->lookForIntegerValue(&ih,(UINT16)tagId,intValue,cycle,start);
+                        }
+                        if (!ih.isValidItemHandler()) break;
+                        printf("Value query '%s': found on item_id=%d\n",(*it).latin1(),(int)ih.getItemId());
+                        start = ih.getItemEntry()+1;
+                        ++found;
+                    }
+                    printf("Value query '%s': %d items found\n",(*it).latin1(),(int)found);
+                }
+            }
+            ++it;
+        }
+    }
 }
 
 bool decodeQuery(QString query,INT32* itemid,QString* tag,UINT32* cycle)
@@ -546,6 +725,22 @@ bool decodeQuery(QString query,INT32* itemid,QString* tag,UINT32* cycle)
     return pok;
 }
 
+bool decodeValueQuery(QString query,QString* tag,QString* value,UINT32* cycle)
+{
+    bool pok;
+    QRegExp rx( "^(\\S+)\\s(\\S+)\\s(\\S+)");
+    int pos = rx.search(query);
+    QStringList list = rx.capturedTexts();
+
+    if (pos<0) return false;
+    *tag = list[1];
+    *value = list[2];
+
+    *cycle = list[3].toUInt(&pok);
+
+    return pok;
+}
+
 
 void applyDumps()
 {
@@ -574,6 +769,8 @@ void applyDumps()
 void openfile()
 {
     if (verbose) { printf ("opening file...\n");fflush(stdout); }
+    db->setDecodeThreads(decodeThreads);
+    db->setPagingBudget(pagingBudget);
     bool openok = db->openDRLFile(drlFileName);
     if (!openok)
     {
@@ -612,7 +809,15 @@ void readAll()
 {
     // read it all
     if (verbose) {printf ("reading trace...\n");fflush(stdout);}
-    bool sok = db->processAllEvents();
+    bool sok;
+    if (windowFirst>=0)
+    {
+        sok = db->processCycleWindow(windowFirst,windowLast);
+    }
+    else
+    {
+        sok = db->processAllEvents();
+    }
     if (!sok)
     {
         printf("drl simulation trace processing failed, see log for details on %s\n",
@@ -623,6 +828,10 @@ void readAll()
 
 void closefile()
 {
+    if (verbose && (pagingBudget>0))
+    {
+        printf("pager stats:\n%s",DBPager::getInstance()->getStats().latin1());
+    }
     bool closeok = db->closeDRLFile();
     if (!closeok)
     {
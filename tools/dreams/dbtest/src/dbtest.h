@@ -62,6 +62,7 @@ void readAll();
 void applyDumps();
 void closefile();
 bool decodeQuery(QString query,INT32* itemid,QString* tag,UINT32* cycle);
+bool decodeValueQuery(QString query,QString* tag,QString* value,UINT32* cycle);
 
 #endif
 
@@ -0,0 +1,843 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+  * @file
+  * @brief Streaming filter of DRAL traces.
+  */
+
+#include "dralfilter.h"
+
+#include <fcntl.h>
+#include <string.h>
+
+/** @def Events processed between checks of the end of the window. */
+#define DRALFILTER_PROCESS_STEP 4096
+
+const char * inFileName;
+const char * outFileName;
+vector<const char *> nodeList;
+vector<const char *> edgeList;
+vector<const char *> tagList;
+bool window;
+UINT64 windowFirst;
+UINT64 windowLast;
+INT32 sampling;
+INT32 syncInterval;
+INT32 decodeThreads;
+bool verbose;
+
+int main (int argc, char** argv)
+{
+    initGlobals();
+    if (!parseParameters(argc,argv))
+    {
+        dumpSyntax(argv[0]);
+        exit(-1);
+    }
+
+    int fd = open(inFileName,O_RDONLY);
+    if (fd<0)
+    {
+        printf("unable to read %s\n",inFileName);
+        exit(-1);
+    }
+
+    int outFd = open(outFileName,O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE,00660);
+    if (outFd<0)
+    {
+        printf("unable to write %s\n",outFileName);
+        exit(-1);
+    }
+
+    // The comments of the input trace are copied, so the server must
+    // not add its own embedded tar file.
+    DRAL_SERVER server = new DRAL_SERVER_CLASS(outFd,32768,false,true,false);
+    server->SetSyncInterval(syncInterval);
+    server->TurnOn();
+
+    DralFilter filter(server);
+    for (UINT32 i=0;i<nodeList.size();i++)
+    {
+        filter.selectNode(nodeList[i]);
+    }
+    for (UINT32 i=0;i<edgeList.size();i++)
+    {
+        filter.selectEdge(edgeList[i]);
+    }
+    for (UINT32 i=0;i<tagList.size();i++)
+    {
+        filter.selectTag(tagList[i]);
+    }
+    if (window)
+    {
+        filter.setWindow(windowFirst,windowLast);
+    }
+    filter.setSampling(sampling);
+
+    DRAL_CLIENT client = new DRAL_CLIENT_CLASS(fd,&filter,1024*64,decodeThreads);
+
+    // The header (nodes, edges, tags...) is always copied, then the
+    // trace jumps to the sync point before the window if it has one.
+    INT32 result = 1;
+    while (filter.isProcessingHeader() && !filter.isDone() && (result==1))
+    {
+        result = client->ProcessNextEvent(true,1);
+    }
+    if (window && (windowFirst>0) && (result==1))
+    {
+        UINT64 syncCycle;
+        if (client->SeekCycle(windowFirst,&syncCycle))
+        {
+            if (verbose) printf("jumped to the sync point at cycle %llu\n",(unsigned long long) syncCycle);
+        }
+    }
+    while (!filter.isDone() && (result>0))
+    {
+        result = client->ProcessNextEvent(true,DRALFILTER_PROCESS_STEP);
+    }
+
+    delete client;
+    delete server;
+    close(outFd);
+    close(fd);
+
+    if (verbose) filter.dumpStats();
+    exit((filter.hasError() || (result<0)) ? -1 : 0);
+}
+
+bool parseParameters(int argc, char** argv)
+{
+    int carg = 1;
+    if (carg>=argc) return false;
+
+    bool ok = true;
+    while (ok && carg<(argc-2))
+    {
+        ok = parseNextParameter(argc,argv,&carg);
+    }
+    if (!ok) return false;
+
+    // get file names
+    if (carg+2!=argc) return false;
+    inFileName = argv[carg++];
+    outFileName = argv[carg++];
+    return true;
+}
+
+bool parseNextParameter(int argc, char** argv, int *idx)
+{
+    static bool option_window   = false;
+    static bool option_sample   = false;
+    static bool option_sync     = false;
+    static bool option_threads  = false;
+    static bool option_verbose  = false;
+    int carg = *idx;
+
+    if (!strcmp(argv[carg],"-node"))
+    {
+        ++carg;
+        if (carg>=argc) return false;
+        nodeList.push_back(argv[carg++]);
+        *idx = carg;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-edge"))
+    {
+        ++carg;
+        if (carg>=argc) return false;
+        edgeList.push_back(argv[carg++]);
+        *idx = carg;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-tag"))
+    {
+        ++carg;
+        if (carg>=argc) return false;
+        tagList.push_back(argv[carg++]);
+        *idx = carg;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-window"))
+    {
+        if (option_window) return false;
+        ++carg;
+        if (carg+1>=argc) return false;
+        INT64 first = atoll(argv[carg++]);
+        INT64 last = atoll(argv[carg++]);
+        *idx = carg;
+        if ((first<0) || (last<first)) return false;
+        windowFirst = (UINT64) first;
+        windowLast = (UINT64) last;
+        window = true;
+        option_window = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-sample"))
+    {
+        if (option_sample) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        sampling = atoi(argv[carg++]);
+        *idx = carg;
+        if (sampling<1) return false;
+        option_sample = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-sync"))
+    {
+        if (option_sync) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        syncInterval = atoi(argv[carg++]);
+        *idx = carg;
+        if (syncInterval<0) return false;
+        option_sync = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-threads"))
+    {
+        if (option_threads) return false;
+        ++carg;
+        if (carg>=argc) return false;
+        decodeThreads = atoi(argv[carg++]);
+        *idx = carg;
+        if (decodeThreads<0) return false;
+        option_threads = true;
+        return true;
+    }
+
+    if (!strcmp(argv[carg],"-verbose"))
+    {
+        if (option_verbose) return false;
+        verbose = true;
+        ++carg;
+        *idx = carg;
+        option_verbose = true;
+        return true;
+    }
+
+    return false;
+}
+
+void dumpSyntax(char* binname)
+{
+    printf("Usage:\n");
+    printf("%s [options] input.drl output.drl\n",binname);
+    printf("Copies the DRAL trace input.drl to output.drl keeping only the selected parts of it.\n");
+    printf("Options:\n");
+    printf("-node name|name{instance}:\t\tKeep the events of the node. Can be repeated.\n");
+    printf("-edge name:\t\t\t\tKeep the moves through the edge. Can be repeated.\n");
+    printf("   If no -node nor -edge is given the events of all the nodes and edges are kept.\n");
+    printf("-tag name:\t\t\t\tKeep the values of the tag. Can be repeated. All the tags by default.\n");
+    printf("-window first last:\t\t\tKeep the cycles from first to last, jumping to the sync point before first.\n");
+    printf("-sample n:\t\t\t\tKeep only the items with an id multiple of n. 1 by default.\n");
+    printf("-sync n:\t\t\t\tAdd a sync point to the output every n cycles. 0 (none) by default.\n");
+    printf("-threads n:\t\t\t\tDecompress the input on n threads ahead of the reader. 0 by default.\n");
+    printf("-verbose:\t\t\t\tDumps the number of read and written items.\n");
+}
+
+void initGlobals()
+{
+    inFileName = NULL;
+    outFileName = NULL;
+    nodeList.clear();
+    edgeList.clear();
+    tagList.clear();
+    window = false;
+    windowFirst = 0;
+    windowLast = 0;
+    sampling = 1;
+    syncInterval = 0;
+    decodeThreads = 0;
+    verbose = false;
+}
+
+// -------------------------------------------------------------------
+// -- DralFilter
+// -------------------------------------------------------------------
+
+/**
+ * Creator of this class. Everything is kept until something is
+ * selected.
+ *
+ * @return new object.
+ */
+DralFilter::DralFilter(DRAL_SERVER _server)
+{
+    server = _server;
+    projectGraph = false;
+    firstCycle = 0;
+    lastCycle = (UINT64) -1;
+    sampling = 1;
+    header = true;
+    windowOpen = false;
+    done = false;
+    error = false;
+    itemsRead = 0;
+    itemsWritten = 0;
+}
+
+/**
+ * Keeps the events of the nodes called name. The instance can be
+ * given as name{instance}.
+ *
+ * @return void.
+ */
+void
+DralFilter::selectNode(const char * name)
+{
+    nodeNames.insert(name);
+    projectGraph = true;
+}
+
+/**
+ * Keeps the moves through the edges called name.
+ *
+ * @return void.
+ */
+void
+DralFilter::selectEdge(const char * name)
+{
+    edgeNames.insert(name);
+    projectGraph = true;
+}
+
+/**
+ * Keeps the values of the tag called name.
+ *
+ * @return void.
+ */
+void
+DralFilter::selectTag(const char * name)
+{
+    tagNames.insert(name);
+}
+
+/**
+ * Keeps only the cycles from first to last.
+ *
+ * @return void.
+ */
+void
+DralFilter::setWindow(UINT64 first, UINT64 last)
+{
+    firstCycle = first;
+    lastCycle = last;
+}
+
+/**
+ * Keeps only one of every rate item ids.
+ *
+ * @return void.
+ */
+void
+DralFilter::setSampling(UINT32 rate)
+{
+    sampling = rate;
+}
+
+/**
+ * Prints the number of items read and written.
+ *
+ * @return void.
+ */
+void
+DralFilter::dumpStats()
+{
+    printf("items read: %llu\n",(unsigned long long) itemsRead);
+    printf("items written: %llu\n",(unsigned long long) itemsWritten);
+}
+
+/**
+ * Returns if the item is kept by the sampling.
+ *
+ * @return true if kept.
+ */
+bool
+DralFilter::keepItem(UINT32 item_id)
+{
+    return (sampling<=1) || ((item_id % sampling)==0);
+}
+
+/**
+ * Makes sure that the item is written, writing it with the tags
+ * set before if it is pending.
+ *
+ * @return false if the item is not kept.
+ */
+bool
+DralFilter::emitItem(UINT32 item_id)
+{
+    if (writtenItems.find(item_id)!=writtenItems.end())
+    {
+        return true;
+    }
+    map<UINT32, PendingTagList>::iterator it = pendingItems.find(item_id);
+    if (it==pendingItems.end())
+    {
+        return false;
+    }
+    server->NewItem(item_id);
+    for (UINT32 i=0;i<it->second.size();i++)
+    {
+        writeItemTag(item_id,it->second[i]);
+    }
+    pendingItems.erase(it);
+    writtenItems.insert(item_id);
+    ++itemsWritten;
+    return true;
+}
+
+/**
+ * Writes all the pending items. Used when the window starts and no
+ * node or edge was selected.
+ *
+ * @return void.
+ */
+void
+DralFilter::emitPendingItems()
+{
+    while (!pendingItems.empty())
+    {
+        emitItem(pendingItems.begin()->first);
+    }
+}
+
+/**
+ * Updates the state of the window with a new cycle.
+ *
+ * @return true if the cycle is inside the window.
+ */
+bool
+DralFilter::checkWindow(UINT64 cycle)
+{
+    if (cycle>lastCycle)
+    {
+        done = true;
+        windowOpen = false;
+        return false;
+    }
+    windowOpen = (cycle>=firstCycle);
+    return windowOpen;
+}
+
+/**
+ * Writes an item tag or keeps it until the item is written.
+ *
+ * @return void.
+ */
+void
+DralFilter::setItemTag(UINT32 item_id, const PendingTag & tag)
+{
+    if (writtenItems.find(item_id)!=writtenItems.end())
+    {
+        writeItemTag(item_id,tag);
+        return;
+    }
+    map<UINT32, PendingTagList>::iterator it = pendingItems.find(item_id);
+    if (it!=pendingItems.end())
+    {
+        it->second.push_back(tag);
+    }
+}
+
+/**
+ * Writes an item tag.
+ *
+ * @return void.
+ */
+void
+DralFilter::writeItemTag(UINT32 item_id, const PendingTag & tag)
+{
+    if (!tag.set.empty())
+    {
+        server->SetItemTag(item_id,tagHandles[tag.tag_idx],(UINT32) tag.set.size(),(UINT64 *) &tag.set[0]);
+    }
+    else if (tag.isString)
+    {
+        server->SetItemTag(item_id,tagHandles[tag.tag_idx],stringHandles[tag.value]);
+    }
+    else
+    {
+        server->SetItemTag(item_id,tagHandles[tag.tag_idx],tag.value);
+    }
+}
+
+void
+DralFilter::Cycle (UINT64 cycle)
+{
+    header = false;
+    if (checkWindow(cycle))
+    {
+        server->Cycle(cycle);
+        if (!projectGraph)
+        {
+            emitPendingItems();
+        }
+    }
+}
+
+void
+DralFilter::Cycle (UINT16 clockId, UINT64 cycle, UINT16 phase)
+{
+    header = false;
+    // The window is given in cycles of the clock 0.
+    if ((clockId==0) ? checkWindow(cycle) : windowOpen)
+    {
+        server->Cycle(clockId,cycle,phase);
+        if (!projectGraph)
+        {
+            emitPendingItems();
+        }
+    }
+}
+
+void
+DralFilter::NewItem (UINT32 item_id)
+{
+    ++itemsRead;
+    if (!keepItem(item_id))
+    {
+        return;
+    }
+    pendingItems[item_id];
+    if (windowOpen && !projectGraph)
+    {
+        emitItem(item_id);
+    }
+}
+
+void
+DralFilter::DeleteItem (UINT32 item_id)
+{
+    if (writtenItems.erase(item_id))
+    {
+        server->DeleteItem(item_id);
+    }
+    else
+    {
+        pendingItems.erase(item_id);
+    }
+}
+
+void
+DralFilter::MoveItems (UINT16 edge_id, UINT32 numOfItems, UINT32 * items)
+{
+    MoveItemsWithPositions(edge_id,numOfItems,items,NULL);
+}
+
+void
+DralFilter::MoveItemsWithPositions (
+    UINT16 edge_id, UINT32 numOfItems, UINT32 * items, UINT32 * positions)
+{
+    if (!windowOpen || !keepEdge(edge_id))
+    {
+        return;
+    }
+    moveItems.clear();
+    movePositions.clear();
+    for (UINT32 i=0;i<numOfItems;i++)
+    {
+        if (emitItem(items[i]))
+        {
+            moveItems.push_back(items[i]);
+            if (positions!=NULL)
+            {
+                movePositions.push_back(positions[i]);
+            }
+        }
+    }
+    if (!moveItems.empty())
+    {
+        server->MoveItems(edge_id,(UINT32) moveItems.size(),&moveItems[0],(positions!=NULL) ? &movePositions[0] : NULL);
+    }
+}
+
+void
+DralFilter::EndSimulation (void)
+{
+    done = true;
+}
+
+void
+DralFilter::Error (const char * error_msg)
+{
+    printf("error reading %s: %s\n",inFileName,error_msg);
+    error = true;
+}
+
+void
+DralFilter::NonCriticalError (const char * error_msg)
+{
+    printf("warning reading %s: %s\n",inFileName,error_msg);
+}
+
+void
+DralFilter::Version (UINT16 version)
+{
+    if (version<2)
+    {
+        printf("DRAL %d traces can't be filtered\n",(int) version);
+        error = true;
+    }
+}
+
+void
+DralFilter::NewNode (UINT16 node_id, const char * node_name, UINT16 parent_id, UINT16 instance)
+{
+    server->NewNode(node_id,node_name,parent_id,instance);
+    if (node_id>=nodeKept.size())
+    {
+        nodeKept.resize(node_id+1,false);
+    }
+    char full[32];
+    snprintf(full,sizeof(full),"{%d}",(int) instance);
+    nodeKept[node_id] = !projectGraph ||
+                        (nodeNames.find(node_name)!=nodeNames.end()) ||
+                        (nodeNames.find(string(node_name)+full)!=nodeNames.end());
+}
+
+void
+DralFilter::NewEdge (
+    UINT16 sourceNode, UINT16 destNode, UINT16 edge_id,
+    UINT32 bandwidth, UINT32 latency, const char * name)
+{
+    server->NewEdge(edge_id,sourceNode,destNode,bandwidth,latency,name);
+    if (edge_id>=edgeKept.size())
+    {
+        edgeKept.resize(edge_id+1,false);
+    }
+    edgeKept[edge_id] = !projectGraph || (edgeNames.find(name)!=edgeNames.end());
+}
+
+void
+DralFilter::SetNodeLayout (UINT16 node_id, UINT32 capacity, UINT16 dim, UINT32 capacities [])
+{
+    server->SetNodeLayout(node_id,dim,capacities);
+}
+
+void
+DralFilter::EnterNode (UINT16 node_id, UINT32 item_id, UINT16 dim, UINT32 position [])
+{
+    if (windowOpen && keepNode(node_id) && emitItem(item_id))
+    {
+        server->EnterNode(node_id,item_id,dim,position);
+    }
+}
+
+void
+DralFilter::ExitNode (UINT16 node_id, UINT32 item_id, UINT16 dim, UINT32 position [])
+{
+    if (windowOpen && keepNode(node_id) && emitItem(item_id))
+    {
+        server->ExitNode(node_id,item_id,dim,position);
+    }
+}
+
+void
+DralFilter::SetCycleTag(UINT32 tag_idx, UINT64 value)
+{
+    if (windowOpen && keepTag(tag_idx))
+    {
+        server->SetCycleTag(tagHandles[tag_idx],value);
+    }
+}
+
+void
+DralFilter::SetCycleTagString(UINT32 tag_idx, UINT32 str_idx)
+{
+    if (windowOpen && keepTag(tag_idx))
+    {
+        server->SetCycleTag(tagHandles[tag_idx],stringHandles[str_idx]);
+    }
+}
+
+void
+DralFilter::SetCycleTagSet(UINT32 tag_idx, UINT32 nval, UINT64 set [])
+{
+    if (windowOpen && keepTag(tag_idx))
+    {
+        server->SetCycleTag(tags[tag_idx].c_str(),nval,set);
+    }
+}
+
+void
+DralFilter::SetItemTag(UINT32 item_id, UINT32 tag_idx, UINT64 value)
+{
+    if (keepTag(tag_idx))
+    {
+        PendingTag tag;
+        tag.tag_idx = tag_idx;
+        tag.isString = false;
+        tag.value = value;
+        setItemTag(item_id,tag);
+    }
+}
+
+void
+DralFilter::SetItemTagString(UINT32 item_id, UINT32 tag_idx, UINT32 str_idx)
+{
+    if (keepTag(tag_idx))
+    {
+        PendingTag tag;
+        tag.tag_idx = tag_idx;
+        tag.isString = true;
+        tag.value = str_idx;
+        setItemTag(item_id,tag);
+    }
+}
+
+void
+DralFilter::SetItemTagSet(UINT32 item_id, UINT32 tag_idx, UINT32 nval, UINT64 set [])
+{
+    if (keepTag(tag_idx) && (nval>0))
+    {
+        PendingTag tag;
+        tag.tag_idx = tag_idx;
+        tag.isString = false;
+        tag.value = 0;
+        tag.set.assign(set,set+nval);
+        setItemTag(item_id,tag);
+    }
+}
+
+void
+DralFilter::SetNodeTag(
+    UINT16 node_id, UINT32 tag_idx, UINT64 value, UINT16 level, UINT32 list [])
+{
+    if (windowOpen && keepNode(node_id) && keepTag(tag_idx))
+    {
+        server->SetNodeTag(node_id,tagHandles[tag_idx],value,level,list);
+    }
+}
+
+void
+DralFilter::SetNodeTagString(
+    UINT16 node_id, UINT32 tag_idx, UINT32 str_idx, UINT16 level, UINT32 list [])
+{
+    if (windowOpen && keepNode(node_id) && keepTag(tag_idx))
+    {
+        server->SetNodeTag(node_id,tagHandles[tag_idx],stringHandles[str_idx],level,list);
+    }
+}
+
+void
+DralFilter::SetNodeTagSet(
+    UINT16 node_id, UINT32 tag_idx, UINT16 n, UINT64 set [], UINT16 level, UINT32 list [])
+{
+    if (windowOpen && keepNode(node_id) && keepTag(tag_idx))
+    {
+        server->SetNodeTag(node_id,tags[tag_idx].c_str(),n,set,level,list);
+    }
+}
+
+void
+DralFilter::Comment (UINT32 magic_num, const char * cont)
+{
+    server->Comment(magic_num,cont);
+}
+
+void
+DralFilter::CommentBin (UINT16 magic_num, const char * cont, UINT32 length)
+{
+    server->CommentBin(magic_num,cont,length);
+}
+
+void
+DralFilter::SetNodeInputBandwidth(UINT16 node_id, UINT32 bandwidth)
+{
+    server->SetNodeInputBandwidth(node_id,bandwidth);
+}
+
+void
+DralFilter::SetNodeOutputBandwidth(UINT16 node_id, UINT32 bandwidth)
+{
+    server->SetNodeOutputBandwidth(node_id,bandwidth);
+}
+
+void
+DralFilter::StartActivity (UINT64 start_activity_cycle)
+{
+    server->StartActivity(start_activity_cycle);
+}
+
+void
+DralFilter::SetTagDescription (UINT32 tag_idx, const char description [])
+{
+    if (keepTag(tag_idx))
+    {
+        server->SetTagDescription(tags[tag_idx].c_str(),description);
+    }
+}
+
+void
+DralFilter::SetNodeClock (UINT16 nodeId, UINT16 clockId)
+{
+    server->SetNodeClock(nodeId,clockId);
+}
+
+void
+DralFilter::NewClock (UINT16 clockId, UINT64 freq, UINT16 skew, UINT16 divisions, const char name [])
+{
+    server->NewClock(clockId,freq,skew,divisions,name);
+}
+
+void
+DralFilter::NewTag (UINT32 tag_idx, const char * tag_name, INT32 tag_name_len)
+{
+    string name(tag_name,strnlen(tag_name,tag_name_len));
+    if (tag_idx>=tags.size())
+    {
+        tags.resize(tag_idx+1);
+        tagHandles.resize(tag_idx+1);
+        tagKept.resize(tag_idx+1,false);
+    }
+    tags[tag_idx] = name;
+    tagHandles[tag_idx] = server->RegisterTag(name.c_str());
+    tagKept[tag_idx] = tagNames.empty() || (tagNames.find(name)!=tagNames.end());
+}
+
+void
+DralFilter::NewString (UINT32 string_idx, const char * str, INT32 str_len)
+{
+    string value(str,strnlen(str,str_len));
+    if (string_idx>=stringHandles.size())
+    {
+        stringHandles.resize(string_idx+1);
+    }
+    stringHandles[string_idx] = server->RegisterString(value.c_str());
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2014, Intel Corporation
+ *
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are 
+ * met:
+ * 
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Intel Corporation nor the names of its 
+ *   contributors may be used to endorse or promote products derived from 
+ *   this software without specific prior written permission.
+ *  
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+  * @file
+  * @brief Streaming filter of DRAL traces.
+  */
+
+#ifndef _DRALFILTER_H
+#define _DRALFILTER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "asim/dralClient.h"
+#include "asim/dralServer.h"
+#include "asim/dralListener.h"
+
+using namespace std;
+
+/**
+  * @brief
+  * Listener that copies a trace to a dral server keeping only a
+  * part of it.
+  *
+  * @description
+  * The nodes, edges, clocks and comments are always copied so the
+  * ids of the output trace are the ones of the input trace. The
+  * events of the nodes and edges that were not selected, of the
+  * tags that were not selected and of the cycles out of the window
+  * are dropped. When sampling, only the items whose id is a multiple
+  * of the sampling rate are kept.
+  *
+  * An item is written when it is first needed: when it is created
+  * inside the window if no node or edge was selected, or when it
+  * enters a selected node or moves through a selected edge. Until
+  * then its tags are kept in memory and are written right after it.
+  * The items that never reach a selected node or edge are dropped
+  * with their tags when they are deleted.
+  */
+class DralFilter : public DRAL_LISTENER_CLASS
+{
+  public:
+    DralFilter(DRAL_SERVER server);
+
+    void selectNode(const char * name);
+    void selectEdge(const char * name);
+    void selectTag(const char * name);
+    void setWindow(UINT64 first, UINT64 last);
+    void setSampling(UINT32 rate);
+
+    inline bool isProcessingHeader() { return header; }
+    inline bool isDone() { return done || error; }
+    inline bool hasError() { return error; }
+    void dumpStats();
+
+    // ---- DRAL 2.0 and newer callbacks
+    void Cycle (UINT64 cycle);
+    void NewItem (UINT32 item_id);
+    void MoveItems (UINT16 edge_id, UINT32 numOfItems, UINT32 * items);
+    void MoveItemsWithPositions (
+        UINT16 edge_id, UINT32 numOfItems, UINT32 * items, UINT32 * positions);
+    void DeleteItem (UINT32 item_id);
+    void EndSimulation (void);
+    void Error (const char * error);
+    void NonCriticalError (const char * error);
+    void Version (UINT16 version);
+    void NewNode (UINT16 node_id, const char * node_name, UINT16 parent_id, UINT16 instance);
+    void NewEdge (
+        UINT16 sourceNode, UINT16 destNode, UINT16 edge_id,
+        UINT32 bandwidth, UINT32 latency, const char * name);
+    void SetNodeLayout (UINT16 node_id, UINT32 capacity, UINT16 dim, UINT32 capacities []);
+    void EnterNode (UINT16 node_id, UINT32 item_id, UINT16 dim, UINT32 position []);
+    void ExitNode (UINT16 node_id, UINT32 item_id, UINT16 dim, UINT32 position []);
+    void SetCycleTag(UINT32 tag_idx, UINT64 value);
+    void SetCycleTagString(UINT32 tag_idx, UINT32 str_idx);
+    void SetCycleTagSet(UINT32 tag_idx, UINT32 nval, UINT64 set []);
+    void SetItemTag(UINT32 item_id, UINT32 tag_idx, UINT64 value);
+    void SetItemTagString(UINT32 item_id, UINT32 tag_idx, UINT32 str_idx);
+    void SetItemTagSet(UINT32 item_id, UINT32 tag_idx, UINT32 nval, UINT64 set []);
+    void SetNodeTag(
+        UINT16 node_id, UINT32 tag_idx, UINT64 value, UINT16 level, UINT32 list []);
+    void SetNodeTagString(
+        UINT16 node_id, UINT32 tag_idx, UINT32 str_idx, UINT16 level, UINT32 list []);
+    void SetNodeTagSet(
+        UINT16 node_id, UINT32 tag_idx, UINT16 n, UINT64 set [], UINT16 level, UINT32 list []);
+    void Comment (UINT32 magic_num, const char * cont);
+    void CommentBin (UINT16 magic_num, const char * cont, UINT32 length);
+    void SetNodeInputBandwidth(UINT16 node_id, UINT32 bandwidth);
+    void SetNodeOutputBandwidth(UINT16 node_id, UINT32 bandwidth);
+    void StartActivity (UINT64 start_activity_cycle);
+    void SetTagDescription (UINT32 tag_idx, const char description []);
+    void SetNodeClock (UINT16 nodeId, UINT16 clockId);
+    void NewClock (UINT16 clockId, UINT64 freq, UINT16 skew, UINT16 divisions, const char name []);
+    void Cycle (UINT16 clockId, UINT64 cycle, UINT16 phase);
+    void NewTag (UINT32 tag_idx, const char * tag_name, INT32 tag_name_len);
+    void NewString (UINT32 string_idx, const char * str, INT32 str_len);
+
+    // ---- DRAL 1.0 callbacks, not produced by the clients of the
+    // ---- traces that can be filtered (see Version).
+    void SetTagSingleValue (UINT32 item_id, UINT32 tag_idx, UINT64 value, UBYTE time_span_flags) {}
+    void SetTagString (UINT32 item_id, UINT32 tag_idx, UINT32 str_idx, UBYTE time_span_flags) {}
+    void SetTagSet (UINT32 item_id, UINT32 tag_idx, UINT32 set_size, UINT64 * set, UBYTE time_span_flags) {}
+    void EnterNode (UINT16 node_id, UINT32 item_id, UINT32 slot) {}
+    void ExitNode (UINT16 node_id, UINT32 slot) {}
+    void SetCapacity (UINT16 node_id, UINT32 capacity, UINT32 capacities [], UINT16 dimensions) {}
+    void SetHighWaterMark (UINT16 node_id, UINT32 mark) {}
+    void Comment (const char * comment) {}
+    void AddNode (UINT16 node_id, const char * node_name, UINT16 parent_id, UINT16 instance) {}
+    void AddEdge (
+        UINT16 sourceNode, UINT16 destNode, UINT16 edge_id,
+        UINT32 bandwidth, UINT32 latency, const char * name) {}
+
+  private:
+    /**
+      * Item tag set before the item was written.
+      */
+    struct PendingTag
+    {
+        UINT32 tag_idx;      // Tag of the value.
+        bool isString;       // value is a string index.
+        UINT64 value;        // Value or string index.
+        vector<UINT64> set;  // Values of a set, value is not used.
+    };
+    typedef vector<PendingTag> PendingTagList;
+
+    bool keepItem(UINT32 item_id);
+    bool emitItem(UINT32 item_id);
+    void emitPendingItems();
+    bool checkWindow(UINT64 cycle);
+    void setItemTag(UINT32 item_id, const PendingTag & tag);
+    void writeItemTag(UINT32 item_id, const PendingTag & tag);
+    inline bool keepTag(UINT32 tag_idx) { return (tag_idx < tagKept.size()) && tagKept[tag_idx]; }
+    inline bool keepNode(UINT16 node_id) { return (node_id < nodeKept.size()) && nodeKept[node_id]; }
+    inline bool keepEdge(UINT16 edge_id) { return (edge_id < edgeKept.size()) && edgeKept[edge_id]; }
+
+  private:
+    DRAL_SERVER server;               // Writer of the filtered trace.
+    set<string> nodeNames;            // Selected nodes, as name or name{instance}.
+    set<string> edgeNames;            // Selected edges.
+    set<string> tagNames;             // Selected tags, all if empty.
+    bool projectGraph;                // Some node or edge was selected.
+    vector<bool> nodeKept;            // Events of the node are kept.
+    vector<bool> edgeKept;            // Events of the edge are kept.
+    vector<bool> tagKept;             // Values of the tag are kept.
+    vector<string> tags;              // Names of the tags.
+    vector<DRAL_TAG_HANDLE> tagHandles;       // Tags registered in the server.
+    vector<DRAL_STRING_HANDLE> stringHandles; // Strings registered in the server.
+    map<UINT32, PendingTagList> pendingItems; // Live items not written yet.
+    set<UINT32> writtenItems;         // Live items already written.
+    vector<UINT32> moveItems;         // Kept items of a move.
+    vector<UINT32> movePositions;     // Positions of the kept items of a move.
+    UINT64 firstCycle;                // First cycle of the window.
+    UINT64 lastCycle;                 // Last cycle of the window.
+    UINT32 sampling;                  // Keep 1 of every sampling item ids.
+    bool header;                      // No cycle was found yet.
+    bool windowOpen;                  // The cycles are inside the window.
+    bool done;                        // The window is over or the trace ended.
+    bool error;                       // The trace could not be read.
+
+    UINT64 itemsRead;                 // Items found in the input.
+    UINT64 itemsWritten;              // Items written to the output.
+};
+
+int main (int argc, char** argv);
+void dumpSyntax(char* binname);
+bool parseParameters(int argc, char** argv);
+bool parseNextParameter(int argc, char** argv, int *idx);
+void initGlobals();
+
+#endif